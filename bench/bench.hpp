@@ -0,0 +1,131 @@
+#pragma once
+
+#include "common/types.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness for hft_bench: run a case a few times, keep the per-op timings of
+// every repetition and report min/median, then emit the lot as JSON. No framework dependency so
+// the benchmark builds wherever the engine builds.
+namespace hft::bench
+{
+// Keep a value alive without letting the compiler see through it.
+template <typename T> inline void do_not_optimize(const T &v) noexcept
+{
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(v) : "memory");
+#else
+  const volatile T *sink = &v;
+  (void)sink;
+#endif
+}
+
+struct Result
+{
+  std::string name;
+  std::string params;     // "key=value,..." describing the case
+  u64 ops{0};             // operations per repetition
+  std::vector<double> ns; // ns/op of each repetition
+  double min_ns{0};
+  double median_ns{0};
+
+  double ops_per_sec() const noexcept
+  {
+    return median_ns > 0 ? 1e9 / median_ns : 0.0;
+  }
+};
+
+struct Options
+{
+  int reps{5};
+  u64 seed{1};
+  std::string filter;    // run only cases whose name contains this
+  std::string json_path; // empty: no JSON; "-": stdout
+  std::string label;     // free-form tag, e.g. the commit under test
+};
+
+class Runner
+{
+  Options opts_;
+  std::vector<Result> results_;
+  std::FILE *table_; // human-readable table; stderr when the JSON goes to stdout
+
+public:
+  explicit Runner(Options opts)
+      : opts_(std::move(opts)), table_(opts_.json_path == "-" ? stderr : stdout)
+  {
+  }
+
+  const Options &options() const noexcept
+  {
+    return opts_;
+  }
+
+  bool enabled(const std::string &name) const
+  {
+    return opts_.filter.empty() || name.find(opts_.filter) != std::string::npos;
+  }
+
+  // `body(rep)` runs one repetition and returns its elapsed nanoseconds for `ops` operations.
+  // Setup that must not be timed belongs inside body, around the part it times.
+  template <typename Body>
+  void run(const std::string &name, const std::string &params, u64 ops, Body body)
+  {
+    if (!enabled(name))
+      return;
+    Result r{name, params, ops, {}, 0, 0};
+    for (int rep = 0; rep < opts_.reps; ++rep)
+    {
+      const u64 elapsed = body(rep);
+      r.ns.push_back(static_cast<double>(elapsed) / static_cast<double>(ops));
+    }
+    std::vector<double> sorted = r.ns;
+    std::sort(sorted.begin(), sorted.end());
+    r.min_ns = sorted.front();
+    r.median_ns = sorted[sorted.size() / 2];
+    std::fprintf(table_, "%-28s %-24s %12.1f %12.1f %14.0f\n", r.name.c_str(), r.params.c_str(),
+                 r.min_ns, r.median_ns, r.ops_per_sec());
+    std::fflush(table_);
+    results_.push_back(std::move(r));
+  }
+
+  void print_header() const
+  {
+    std::fprintf(table_, "%-28s %-24s %12s %12s %14s\n", "case", "params", "min ns/op",
+                 "median ns/op", "ops/s");
+  }
+
+  // Write every result as one JSON document. Returns false if the file cannot be written.
+  bool write_json(const char *clock_source) const
+  {
+    if (opts_.json_path.empty())
+      return true;
+    std::FILE *f = opts_.json_path == "-" ? stdout : std::fopen(opts_.json_path.c_str(), "w");
+    if (f == nullptr)
+      return false;
+    std::fprintf(f, "{\n  \"label\": \"%s\",\n  \"seed\": %llu,\n  \"reps\": %d,\n",
+                 opts_.label.c_str(), static_cast<unsigned long long>(opts_.seed), opts_.reps);
+    std::fprintf(f, "  \"clock\": \"%s\",\n  \"results\": [\n", clock_source);
+    for (std::size_t i = 0; i < results_.size(); ++i)
+    {
+      const Result &r = results_[i];
+      std::fprintf(f,
+                   "    {\"name\": \"%s\", \"params\": \"%s\", \"ops\": %llu, \"min_ns\": %.3f, "
+                   "\"median_ns\": %.3f, \"ops_per_sec\": %.1f, \"rep_ns\": [",
+                   r.name.c_str(), r.params.c_str(), static_cast<unsigned long long>(r.ops),
+                   r.min_ns, r.median_ns, r.ops_per_sec());
+      for (std::size_t k = 0; k < r.ns.size(); ++k)
+        std::fprintf(f, "%s%.3f", k == 0 ? "" : ", ", r.ns[k]);
+      std::fprintf(f, "]}%s\n", i + 1 == results_.size() ? "" : ",");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    if (f != stdout)
+      std::fclose(f);
+    return true;
+  }
+};
+} // namespace hft::bench
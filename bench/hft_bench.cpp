@@ -0,0 +1,638 @@
+#include "bench.hpp"
+#include "common/broadcast_ring.hpp"
+#include "common/clock.hpp"
+#include "common/random.hpp"
+#include "common/spsc_queue.hpp"
+#include "market/agents.hpp"
+#include "market/arrivals.hpp"
+#include "market/itch_replay.hpp"
+#include "market/matching_engine.hpp"
+#include "market/order_book.hpp"
+#include "market/order_flow.hpp"
+#include "strategy/mean_reversion.hpp"
+#include "strategy/signals.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hft;
+using bench::do_not_optimize;
+
+// Microbenchmarks for the hot paths: book insert/cancel/match/top, SPSC queue latency and
+// throughput, MatchingEngine::on_command end to end, ITCH decoding and book replay, street flow
+// generation, and strategy signals and dispatch. Order flow comes from seeded generators, so the same --seed
+// replays the same work on every run.
+// Usage: hft_bench [--reps N] [--seed S] [--filter substr] [--json file|-] [--label text]
+namespace
+{
+constexpr Price kMid = 10'000;
+
+// Spin on `try_op` and fall back to yielding, so the two-thread cases still finish when both
+// threads share a core.
+template <typename Op> void spin_until(Op try_op)
+{
+  for (int polls = 0; !try_op(); ++polls)
+  {
+    if (polls < 256)
+      wait::cpu_relax();
+    else
+      std::this_thread::yield();
+  }
+}
+
+// Hide where `p` points, so calls through it cannot be devirtualised.
+template <typename T> T *opaque(T *p) noexcept
+{
+#if defined(__GNUC__)
+  asm volatile("" : "+r"(p));
+#endif
+  return p;
+}
+
+std::string param(const char *key, u64 v)
+{
+  return std::string(key) + "=" + std::to_string(v);
+}
+
+void bench_add_passive(bench::Runner &r)
+{
+  constexpr u64 kOrders = 100'000;
+  for (int levels : {8, 64, 512})
+  {
+    OrderFlowConfig cfg{};
+    cfg.seed = r.options().seed;
+    cfg.levels = levels;
+    OrderFlowGenerator gen(cfg);
+    std::vector<NewOrder> orders;
+    orders.reserve(kOrders);
+    for (u64 i = 0; i < kOrders; ++i)
+      orders.push_back(gen.passive());
+
+    r.run("book.add_passive", param("levels", static_cast<u64>(levels)), kOrders,
+          [&](int)
+          {
+            OrderBook book;
+            const u64 t0 = now_ns();
+            for (const NewOrder &o : orders)
+              book.add_passive(o);
+            const u64 t1 = now_ns();
+            do_not_optimize(book);
+            return t1 - t0;
+          });
+  }
+}
+
+// Cancel one order from the middle of each of kLevels price levels, every level `depth` deep.
+// Cancel walks the level's queue, so cost should grow with depth.
+void bench_cancel(bench::Runner &r)
+{
+  constexpr int kLevels = 1024;
+  for (int depth : {1, 16, 256})
+  {
+    std::vector<u64> victims;
+    r.run("book.cancel", param("depth", static_cast<u64>(depth)), kLevels,
+          [&](int)
+          {
+            OrderBook book;
+            victims.clear();
+            u64 id = 1;
+            for (int l = 0; l < kLevels; ++l)
+            {
+              for (int d = 0; d < depth; ++d)
+              {
+                if (d == depth / 2)
+                  victims.push_back(id);
+                book.add_passive(NewOrder{id++, 1, Side::Buy, kMid - 1 - l, 1, TIF::Day, 0});
+              }
+            }
+            const u64 t0 = now_ns();
+            Qty total = 0;
+            for (u64 v : victims)
+              total += book.cancel(v);
+            const u64 t1 = now_ns();
+            do_not_optimize(total);
+            return t1 - t0;
+          });
+  }
+}
+
+// Aggressive orders each sweeping `levels` full ask levels of 4 resting orders.
+void bench_match(bench::Runner &r)
+{
+  constexpr int kSweeps = 2'000;
+  constexpr int kPerLevel = 4;
+  for (int levels : {1, 4, 16})
+  {
+    r.run("book.match", param("levels", static_cast<u64>(levels)), kSweeps,
+          [&](int)
+          {
+            OrderBook book;
+            u64 id = 1;
+            for (int l = 0; l < kSweeps * levels; ++l)
+              for (int k = 0; k < kPerLevel; ++k)
+                book.add_passive(NewOrder{id++, 1, Side::Sell, kMid + l, 1, TIF::Day, 0});
+            Qty filled = 0;
+            const u64 t0 = now_ns();
+            for (int s = 0; s < kSweeps; ++s)
+            {
+              const Price limit = kMid + (s + 1) * levels - 1;
+              const NewOrder aggressor{id++,     2, Side::Buy, limit, levels * kPerLevel,
+                                       TIF::IOC, 0};
+              book.match(aggressor, [&](Price, Qty q, const Order &) { filled += q; });
+            }
+            const u64 t1 = now_ns();
+            do_not_optimize(filled);
+            return t1 - t0;
+          });
+  }
+}
+
+void bench_top(bench::Runner &r)
+{
+  constexpr u64 kCalls = 1'000'000;
+  for (int depth : {1, 8, 64})
+  {
+    OrderBook book;
+    u64 id = 1;
+    for (int l = 0; l < 64; ++l)
+      for (int d = 0; d < depth; ++d)
+      {
+        book.add_passive(NewOrder{id++, 1, Side::Buy, kMid - 1 - l, 1, TIF::Day, 0});
+        book.add_passive(NewOrder{id++, 1, Side::Sell, kMid + 1 + l, 1, TIF::Day, 0});
+      }
+    r.run("book.top", param("depth", static_cast<u64>(depth)), kCalls,
+          [&](int)
+          {
+            const u64 t0 = now_ns();
+            for (u64 i = 0; i < kCalls; ++i)
+            {
+              const TopOfBook t = book.top(i);
+              do_not_optimize(t);
+            }
+            return now_ns() - t0;
+          });
+  }
+}
+
+// Round trip: main thread pushes, echo thread pops and pushes back.
+void bench_spsc_ping_pong(bench::Runner &r)
+{
+  constexpr u64 kTrips = 200'000;
+  auto ping = std::make_unique<spsc::Queue<u64, 1024>>();
+  auto pong = std::make_unique<spsc::Queue<u64, 1024>>();
+  r.run("spsc.ping_pong", param("trips", kTrips), kTrips,
+        [&](int)
+        {
+          std::thread echo(
+              [&]
+              {
+                u64 v = 0;
+                for (u64 i = 0; i < kTrips; ++i)
+                {
+                  spin_until([&] { return ping->pop(v); });
+                  spin_until([&] { return pong->push(v); });
+                }
+              });
+          u64 v = 0;
+          const u64 t0 = now_ns();
+          for (u64 i = 0; i < kTrips; ++i)
+          {
+            spin_until([&] { return ping->push(i); });
+            spin_until([&] { return pong->pop(v); });
+          }
+          const u64 t1 = now_ns();
+          echo.join();
+          do_not_optimize(v);
+          return t1 - t0;
+        });
+}
+
+void bench_spsc_throughput(bench::Runner &r)
+{
+  constexpr u64 kItems = 5'000'000;
+  auto q = std::make_unique<spsc::Queue<u64, 1 << 14>>();
+  r.run("spsc.throughput", param("items", kItems), kItems,
+        [&](int)
+        {
+          const u64 t0 = now_ns();
+          std::thread producer(
+              [&]
+              {
+                for (u64 i = 0; i < kItems; ++i)
+                  spin_until([&] { return q->push(i); });
+              });
+          u64 v = 0;
+          u64 sum = 0;
+          for (u64 i = 0; i < kItems; ++i)
+          {
+            spin_until([&] { return q->pop(v); });
+            sum += v;
+          }
+          const u64 t1 = now_ns();
+          producer.join();
+          do_not_optimize(sum);
+          return t1 - t0;
+        });
+}
+
+// Generated command mix through MatchingEngine, including exec/market-data publication. Execs are
+// drained every batch (inside the timing, as a real consumer would keep the queue moving).
+void bench_engine(bench::Runner &r)
+{
+  constexpr u64 kCommands = 200'000;
+  constexpr u64 kBatch = 1024;
+  struct Mix
+  {
+    const char *name;
+    double cancel_ratio;
+    double marketable_ratio;
+  };
+  for (const Mix &mix : {Mix{"passive", 0.0, 0.0}, Mix{"mixed", 0.2, 0.1},
+                         Mix{"aggressive", 0.1, 0.4}})
+  {
+    OrderFlowConfig cfg{};
+    cfg.seed = r.options().seed;
+    cfg.cancel_ratio = mix.cancel_ratio;
+    cfg.marketable_ratio = mix.marketable_ratio;
+    OrderFlowGenerator gen(cfg);
+    std::vector<EngineCommand> cmds;
+    gen.generate(kCommands, cmds);
+
+    auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+    auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+    for (const bool risk : {false, true})
+    {
+      // With risk=on every order runs all the pre-trade checks, none of which ever trips.
+      const std::string name = std::string("mix=") + mix.name + (risk ? " risk=on" : "");
+      r.run("engine.on_command", name, kCommands,
+            [&](int)
+            {
+              OrderBook book;
+              MatchingEngine engine(book, *exec_q, *md_q);
+              if (risk)
+                engine.set_risk_limits(cfg.user_id, RiskLimits{1 << 30, 1 << 30, i64{1} << 40,
+                                                               i64{1} << 60, 1 << 30});
+              ExecEvent e;
+              const u64 t0 = now_ns();
+              for (u64 i = 0; i < kCommands; ++i)
+              {
+                engine.on_command(cmds[i], t0);
+                if (i % kBatch == kBatch - 1)
+                  while (exec_q->pop(e))
+                    ;
+              }
+              const u64 t1 = now_ns();
+              while (exec_q->pop(e))
+                ;
+              return t1 - t0;
+            });
+    }
+  }
+}
+
+// ITCH decoding alone, then applied to per-instrument books, over an in-memory synthetic session.
+void bench_itch(bench::Runner &r)
+{
+  constexpr u64 kMessages = 1'000'000;
+  std::vector<std::byte> session;
+  itch::generate_session(session, kMessages, r.options().seed);
+  struct Sum
+  {
+    u64 v{0};
+    void on_add(const itch::AddOrder &m)
+    {
+      v += m.shares;
+    }
+    void on_executed(const itch::Executed &m)
+    {
+      v += m.shares;
+    }
+    void on_cancel(const itch::Cancel &m)
+    {
+      v += m.shares;
+    }
+    void on_delete(const itch::Delete &m)
+    {
+      v += m.ref;
+    }
+    void on_replace(const itch::Replace &m)
+    {
+      v += m.shares;
+    }
+  };
+  r.run("itch.parse", param("messages", kMessages), kMessages,
+        [&](int)
+        {
+          Sum h;
+          const u64 t0 = now_ns();
+          itch::parse(session.data(), session.size(), h);
+          const u64 t1 = now_ns();
+          do_not_optimize(h.v);
+          return t1 - t0;
+        });
+  r.run("itch.replay", param("messages", kMessages), kMessages,
+        [&](int)
+        {
+          ItchBooks<> books;
+          const u64 t0 = now_ns();
+          replay_itch(session.data(), session.size(), books);
+          const u64 t1 = now_ns();
+          do_not_optimize(books.stats().tops);
+          return t1 - t0;
+        });
+}
+// Street flow generation without a book: raw draws, Poisson and Hawkes arrivals (thinning, kind,
+// side and power-law depth), and agent populations of two sizes (the scheduling heap should make
+// the per-action cost grow with log N only), to compare against engine.on_command per event.
+void bench_flow(bench::Runner &r)
+{
+  constexpr u64 kDraws = 10'000'000;
+  r.run("rng.next", "gen=mt19937_64", kDraws,
+        [&](int)
+        {
+          std::mt19937_64 gen(r.options().seed);
+          u64 acc = 0;
+          const u64 t0 = now_ns();
+          for (u64 i = 0; i < kDraws; ++i)
+            acc += gen();
+          const u64 t1 = now_ns();
+          do_not_optimize(acc);
+          return t1 - t0;
+        });
+  r.run("rng.next", "gen=xoshiro256x8", kDraws,
+        [&](int)
+        {
+          rng::Xoshiro256 gen(r.options().seed);
+          u64 acc = 0;
+          const u64 t0 = now_ns();
+          for (u64 i = 0; i < kDraws; ++i)
+            acc += gen.next();
+          const u64 t1 = now_ns();
+          do_not_optimize(acc);
+          return t1 - t0;
+        });
+
+  constexpr u64 kArrivals = 1'000'000;
+  for (const bool hawkes : {false, true})
+  {
+    ArrivalConfig cfg{};
+    cfg.hawkes = hawkes;
+    r.run("sim.arrivals", hawkes ? "model=hawkes" : "model=poisson", kArrivals,
+          [&](int)
+          {
+            ArrivalProcess p(cfg, r.options().seed);
+            p.start(0);
+            u64 acc = 0;
+            const u64 t0 = now_ns();
+            for (u64 i = 0; i < kArrivals; ++i)
+              acc += static_cast<u64>(p.pop().depth);
+            const u64 t1 = now_ns();
+            do_not_optimize(acc);
+            return t1 - t0;
+          });
+  }
+
+  // Orders go nowhere, so only the agents' own work is timed.
+  struct NullEngine
+  {
+    u64 acc{0};
+
+    TopOfBook top_snapshot() const noexcept
+    {
+      return TopOfBook{kMid - 1, 10, kMid + 1, 10, 0};
+    }
+
+    void inject_new(const NewOrder &n) noexcept
+    {
+      acc += n.order_id;
+    }
+
+    void inject_cancel(const CancelOrder &c) noexcept
+    {
+      acc += c.order_id;
+    }
+  };
+  constexpr u64 kActions = 1'000'000;
+  for (const u32 noise : {1'000U, 100'000U})
+  {
+    AgentsConfig cfg{};
+    cfg.noise = noise;
+    r.run("sim.agents", "agents=" + std::to_string(noise), kActions,
+          [&](int)
+          {
+            AgentPopulation pop(cfg, kMid, 1, r.options().seed);
+            NullEngine engine;
+            u64 next_id = 1;
+            pop.start(0);
+            const u64 t0 = now_ns();
+            for (u64 ts = 1'000'000; pop.actions() < kActions; ts += 1'000'000)
+              pop.run(engine, ts, next_id, [&](const NewOrder &n) { engine.inject_new(n); });
+            const u64 t1 = now_ns();
+            do_not_optimize(engine.acc);
+            // The last millisecond overshoots kActions slightly; charge per action actually run.
+            return (t1 - t0) * kActions / pop.actions();
+          });
+  }
+}
+
+// One mid in, one statistic out per sample, as a strategy does on every book update and timer.
+// vector_sum is MeanReversion's former rolling mean: a ring write, then a long double sum over the
+// whole window on each read.
+void bench_signals(bench::Runner &r)
+{
+  constexpr u64 kSamples = 1'000'000;
+  rng::Xoshiro256 gen(r.options().seed);
+  std::vector<Price> mids;
+  mids.reserve(kSamples);
+  Price mid = kMid;
+  for (u64 i = 0; i < kSamples; ++i)
+  {
+    mid += static_cast<Price>(gen.next() % 3) - 1;
+    mids.push_back(mid);
+  }
+
+  for (const std::size_t window : {std::size_t{64}, std::size_t{1024}})
+  {
+    const std::string w = param("window", window);
+    r.run("signal.rolling_mean", "impl=vector_sum " + w, kSamples,
+          [&](int)
+          {
+            std::vector<Price> ring(window, 0);
+            u64 idx = 0;
+            double acc = 0;
+            const u64 t0 = now_ns();
+            for (const Price m : mids)
+            {
+              ring[idx++ % window] = m;
+              long double sum = 0;
+              for (const Price p : ring)
+                sum += p;
+              acc += static_cast<double>(sum / static_cast<long double>(window));
+            }
+            const u64 t1 = now_ns();
+            do_not_optimize(acc);
+            return t1 - t0;
+          });
+    r.run("signal.rolling_mean", "impl=ring_sum " + w, kSamples,
+          [&](int)
+          {
+            signal::RollingMean<Price, 1024> mean(window);
+            double acc = 0;
+            const u64 t0 = now_ns();
+            for (const Price m : mids)
+            {
+              mean.push(m);
+              acc += mean.mean();
+            }
+            const u64 t1 = now_ns();
+            do_not_optimize(acc);
+            return t1 - t0;
+          });
+    r.run("signal.rolling_max", "impl=monotonic_deque " + w, kSamples,
+          [&](int)
+          {
+            auto max = std::make_unique<signal::RollingMax<Price, 1024>>(window);
+            Price acc = 0;
+            const u64 t0 = now_ns();
+            for (const Price m : mids)
+            {
+              max->push(m);
+              acc += max->value();
+            }
+            const u64 t1 = now_ns();
+            do_not_optimize(acc);
+            return t1 - t0;
+          });
+  }
+}
+
+// Cheapest possible strategy, so the cases below time the call itself.
+struct Tally
+{
+  i64 sum{0};
+
+  void on_market_data(const MarketDataEvent &e) noexcept
+  {
+    if (const TopOfBook *t = std::get_if<TopOfBook>(&e))
+      sum += t->bid_price;
+  }
+
+  void on_exec(const ExecEvent &e) noexcept
+  {
+    sum += e.filled;
+  }
+
+  void on_timer(u64) noexcept
+  {
+  }
+};
+
+template <Strategy S> void feed(S &s, const std::vector<MarketDataEvent> &events)
+{
+  for (const MarketDataEvent &e : events)
+    s.on_market_data(e);
+}
+
+// Market data into a strategy bound at compile time (impl=static) or called through IStrategy
+// (impl=virtual), as the consumer loops and backtester would.
+void bench_dispatch(bench::Runner &r)
+{
+  constexpr u64 kEvents = 1'000'000;
+  rng::Xoshiro256 gen(r.options().seed);
+  std::vector<MarketDataEvent> events;
+  events.reserve(kEvents);
+  for (u64 i = 0; i < kEvents; ++i)
+  {
+    const Price bid = kMid - 1 - static_cast<Price>(gen.next() % 4);
+    events.push_back(TopOfBook{bid, 10, bid + 2, 10, i});
+  }
+
+  const auto both = [&](const char *name, auto &strat)
+  {
+    StrategyAdapter adapter(strat);
+    r.run("strategy.dispatch", std::string(name) + " impl=static", kEvents,
+          [&](int)
+          {
+            const u64 t0 = now_ns();
+            feed(strat, events);
+            const u64 t1 = now_ns();
+            do_not_optimize(strat);
+            return t1 - t0;
+          });
+    r.run("strategy.dispatch", std::string(name) + " impl=virtual", kEvents,
+          [&](int)
+          {
+            IStrategy *any = opaque<IStrategy>(&adapter);
+            const u64 t0 = now_ns();
+            feed(*any, events);
+            const u64 t1 = now_ns();
+            do_not_optimize(strat);
+            return t1 - t0;
+          });
+  };
+  Tally tally;
+  both("strategy=tally", tally);
+
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  StrategyContext ctx;
+  RiskManager risk(100, 1'000'000, 10);
+  MeanReversion mr(ctx, risk, *cmd_q);
+  both("strategy=mean_reversion", mr);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  bench::Options opts{};
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--reps") == 0 && has_value)
+      opts.reps = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+      opts.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--filter") == 0 && has_value)
+      opts.filter = argv[++i];
+    else if (std::strcmp(argv[i], "--json") == 0 && has_value)
+      opts.json_path = argv[++i];
+    else if (std::strcmp(argv[i], "--label") == 0 && has_value)
+      opts.label = argv[++i];
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--reps N] [--seed S] [--filter substr] [--json file|-] "
+                   "[--label text]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+  if (opts.reps < 1)
+    opts.reps = 1;
+
+  bench::Runner runner(opts);
+  runner.print_header();
+  bench_add_passive(runner);
+  bench_cancel(runner);
+  bench_match(runner);
+  bench_top(runner);
+  bench_spsc_ping_pong(runner);
+  bench_spsc_throughput(runner);
+  bench_engine(runner);
+  bench_itch(runner);
+  bench_flow(runner);
+  bench_signals(runner);
+  bench_dispatch(runner);
+
+  if (!runner.write_json(clock::to_string(clock::instance().source())))
+  {
+    std::fprintf(stderr, "cannot write %s\n", opts.json_path.c_str());
+    return 1;
+  }
+  return 0;
+}
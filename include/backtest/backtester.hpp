@@ -0,0 +1,381 @@
+#pragma once
+
+#include "common/broadcast_ring.hpp"
+#include "common/latency.hpp"
+#include "common/spsc_queue.hpp"
+#include "market/matching_engine.hpp"
+#include "market/simulator.hpp"
+#include "strategy/strategy.hpp"
+
+#include <memory>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// Discrete-event backtest: engine, street simulator and strategy on one thread, driven by a
+// virtual clock and an event queue instead of sleeps and real threads. Time only moves when the
+// next event is taken off the queue, so a trading day runs as fast as the events can be handled,
+// and the same configuration and seed produce the same event sequence on every run.
+//
+// Events, each handled at its virtual time (ties in scheduling order):
+//   Step       -> Simulator::step against the engine; repeats every street.step_interval_ns, or
+//                 at each street arrival under the Arrivals flow model
+//   Timer      -> strategy.on_timer(now); repeats every timer_ns
+//   Command    -> a strategy command reaching the engine: MatchingEngine::on_command(cmd, now)
+//   MarketData -> an engine market data event reaching the strategy: on_market_data
+//   Exec       -> an engine exec for the strategy's user id reaching the strategy: on_exec
+// Whatever the engine emits while handling an event is scheduled to arrive `latency` later, and
+// so is every command the strategy pushes into its queue from a callback. Jitter, when enabled,
+// is drawn from its own seeded generator and never reorders a link: each link stays FIFO.
+//
+// The engine reports passive fills too, and the backtester keeps a ledger of the strategy's own
+// orders (those it sent as commands): fills, position, PnL marked at the last mid, and how long
+// after sending an order the strategy heard of each of its fills.
+namespace hft::backtest
+{
+struct Latency
+{
+  u64 command_ns{5'000};     // strategy -> engine
+  u64 market_data_ns{2'000}; // engine -> strategy
+  u64 exec_ns{3'000};        // engine -> strategy
+  u64 jitter_ns{0};          // uniform extra delay in [0, jitter_ns) per message
+};
+
+struct Config
+{
+  u64 start_ns{34'200'000'000'000};    // 09:30, as ns since midnight
+  u64 duration_ns{23'400'000'000'000}; // 6.5 hours
+  u64 timer_ns{1'000'000};             // strategy on_timer period
+  Latency latency{};
+  StreetFlowConfig street{.step_interval_ns = 1'000'000};
+  u64 seed{7}; // latency jitter; the street flow has its own seed
+};
+
+struct Result
+{
+  u64 events{0};
+  u64 sim_steps{0};
+  u64 timers{0};
+  u64 commands{0};  // strategy commands handled by the engine
+  u64 execs{0};     // execs delivered to the strategy (its own user id only)
+  u64 trades{0};    // of which fills
+  u64 md_events{0}; // market data delivered to the strategy
+  u64 end_ns{0};    // virtual time of the last event handled
+  u64 wall_ns{0};   // real time the run took
+  u64 digest{0};    // FNV-1a over every delivery (time and payload); equal runs, equal digests
+
+  // The strategy's own orders.
+  u64 fills{0};
+  i64 position{0};    // net quantity bought
+  i64 pnl{0};         // cash plus position at the last mid, in ticks times quantity
+  u64 fill_p50_ns{0}; // virtual time from sending an order to hearing of one of its fills
+  u64 fill_p99_ns{0};
+};
+
+// S is the strategy type, bound at compile time so its callbacks inline into the event loop; pass
+// IStrategy to drive one through the virtual interface.
+template <Strategy S = IStrategy> class Backtester
+{
+  enum class Kind : u8
+  {
+    Step,
+    Timer,
+    Command,
+    MarketData,
+    Exec
+  };
+
+  struct Event
+  {
+    u64 at{0};
+    u64 seq{0};
+    Kind kind{Kind::Step};
+    std::variant<std::monostate, EngineCommand, MarketDataEvent, ExecEvent> payload;
+  };
+
+  struct Later
+  {
+    bool operator()(const Event &a, const Event &b) const noexcept
+    {
+      return a.at != b.at ? a.at > b.at : a.seq > b.seq;
+    }
+  };
+
+  // What the Simulator sees: the engine's book and an injection point, both at virtual time.
+  struct Exchange
+  {
+    Backtester &bt;
+
+    TopOfBook top_snapshot() const noexcept
+    {
+      return bt.book_.top(bt.now_);
+    }
+
+    bool resting(u64 order_id) const noexcept
+    {
+      Price px;
+      Side side;
+      return bt.book_.find(order_id, px, side);
+    }
+
+    void inject_new(const NewOrder &n)
+    {
+      bt.engine_.on_command(EngineCommand{EngineCommand::Kind::New, n, {}, {}}, bt.now_);
+    }
+
+    void inject_cancel(const CancelOrder &c)
+    {
+      bt.engine_.on_command(EngineCommand{EngineCommand::Kind::Cancel, {}, c, {}}, bt.now_);
+    }
+  };
+
+  struct Working
+  {
+    Side side{Side::Buy};
+    u64 sent_at{0};
+  };
+
+  using CommandQueue = spsc::Queue<EngineCommand, 1 << 14>;
+
+  Config cfg_;
+  S &strategy_;
+  u64 user_id_; // only execs for this user reach the strategy, as Reactor routes them live
+  CommandQueue &commands_;
+  std::unique_ptr<spsc::Queue<ExecEvent, 1 << 14>> exec_q_;
+  std::unique_ptr<broadcast::Ring<MarketDataEvent, 1 << 14>> md_q_;
+  broadcast::Ring<MarketDataEvent, 1 << 14>::Subscriber md_sub_;
+  OrderBook book_;
+  MatchingEngine engine_;
+  Simulator sim_;
+  std::priority_queue<Event, std::vector<Event>, Later> events_;
+  std::mt19937_64 jitter_rng_;
+  u64 now_{0};
+  u64 seq_{0};
+  u64 last_command_at_{0}; // per-link arrival floors keep each link FIFO under jitter
+  u64 last_md_at_{0};
+  u64 last_exec_at_{0};
+  Result result_{};
+  std::unordered_map<u64, Working> working_; // strategy orders by id until they are done
+  latency::Histogram fill_latency_;
+  i64 cash_{0};
+  Price last_mid_{0};
+
+  void schedule(u64 at, Kind kind)
+  {
+    events_.push(Event{at, seq_++, kind, std::monostate{}});
+  }
+
+  template <typename T> void send(u64 latency_ns, u64 &floor, Kind kind, const T &v)
+  {
+    u64 at = now_ + latency_ns;
+    if (cfg_.latency.jitter_ns > 0)
+      at += jitter_rng_() % cfg_.latency.jitter_ns;
+    if (at < floor)
+      at = floor;
+    floor = at;
+    events_.push(Event{at, seq_++, kind, v});
+  }
+
+  // Schedule everything the engine emitted while handling the current event. Execs for street and
+  // agent users go nowhere.
+  void collect_engine_output()
+  {
+    ExecEvent e;
+    while (exec_q_->pop(e))
+      if (e.user_id == user_id_)
+        send(cfg_.latency.exec_ns, last_exec_at_, Kind::Exec, e);
+    MarketDataEvent md;
+    while (md_sub_.pop(md))
+      send(cfg_.latency.market_data_ns, last_md_at_, Kind::MarketData, md);
+  }
+
+  // Schedule every command the strategy pushed during the current callback.
+  void collect_commands()
+  {
+    EngineCommand cmd;
+    while (commands_.pop(cmd))
+    {
+      if (cmd.kind == EngineCommand::Kind::New)
+        working_[cmd.new_order.order_id] = Working{cmd.new_order.side, now_};
+      send(cfg_.latency.command_ns, last_command_at_, Kind::Command, cmd);
+    }
+  }
+
+  // Book an exec if it is for one of the orders the strategy sent.
+  void account(const ExecEvent &e)
+  {
+    const auto it = working_.find(e.order_id);
+    if (it == working_.end())
+      return;
+    if (e.type == ExecType::Trade)
+    {
+      const i64 notional = e.price * e.filled;
+      const bool buy = it->second.side == Side::Buy;
+      result_.position += buy ? e.filled : -e.filled;
+      cash_ += buy ? -notional : notional;
+      fill_latency_.record(now_ - it->second.sent_at);
+      ++result_.fills;
+    }
+    const bool done = e.type == ExecType::CancelAck || e.type == ExecType::Reject ||
+                      ((e.type == ExecType::Trade || e.type == ExecType::Ack) && e.leaves == 0);
+    if (done)
+      working_.erase(it);
+  }
+
+  void mix(u64 v) noexcept
+  {
+    for (int i = 0; i < 8; ++i)
+    {
+      result_.digest ^= (v >> (8 * i)) & 0xff;
+      result_.digest *= 0x100000001b3ULL;
+    }
+  }
+
+  void record(const ExecEvent &e) noexcept
+  {
+    mix(now_);
+    mix(static_cast<u64>(e.type));
+    mix(e.order_id);
+    mix(e.user_id);
+    mix(static_cast<u64>(e.filled));
+    mix(static_cast<u64>(e.price));
+    mix(static_cast<u64>(e.leaves));
+    mix(e.ts_ns);
+  }
+
+  void record(const MarketDataEvent &ev) noexcept
+  {
+    mix(now_);
+    if (const TopOfBook *t = std::get_if<TopOfBook>(&ev))
+    {
+      if (t->bid_price > 0 && t->ask_price > 0)
+        last_mid_ = (t->bid_price + t->ask_price) / 2;
+      mix(static_cast<u64>(t->bid_price));
+      mix(static_cast<u64>(t->bid_qty));
+      mix(static_cast<u64>(t->ask_price));
+      mix(static_cast<u64>(t->ask_qty));
+      mix(t->ts_ns);
+    }
+    else
+    {
+      const TradePrint &p = std::get<TradePrint>(ev);
+      mix(static_cast<u64>(p.price));
+      mix(static_cast<u64>(p.qty));
+      mix(static_cast<u64>(p.aggressor));
+      mix(p.ts_ns);
+    }
+  }
+
+  void handle(const Event &ev)
+  {
+    switch (ev.kind)
+    {
+    case Kind::Step:
+    {
+      Exchange ex{*this};
+      sim_.step(ex, now_);
+      collect_engine_output();
+      ++result_.sim_steps;
+      schedule(sim_.next_step_ns(now_), Kind::Step);
+      break;
+    }
+    case Kind::Timer:
+      strategy_.on_timer(now_);
+      collect_commands();
+      ++result_.timers;
+      schedule(now_ + cfg_.timer_ns, Kind::Timer);
+      break;
+    case Kind::Command:
+      engine_.on_command(std::get<EngineCommand>(ev.payload), now_);
+      collect_engine_output();
+      ++result_.commands;
+      break;
+    case Kind::MarketData:
+    {
+      const MarketDataEvent &md = std::get<MarketDataEvent>(ev.payload);
+      record(md);
+      strategy_.on_market_data(md);
+      collect_commands();
+      ++result_.md_events;
+      break;
+    }
+    case Kind::Exec:
+    {
+      const ExecEvent &e = std::get<ExecEvent>(ev.payload);
+      record(e);
+      account(e);
+      strategy_.on_exec(e);
+      collect_commands();
+      ++result_.execs;
+      result_.trades += e.type == ExecType::Trade ? 1 : 0;
+      break;
+    }
+    }
+  }
+
+public:
+  // `commands` is the queue the strategy was constructed with; the backtester drains it after
+  // every strategy callback. `user_id` is the one the strategy sends its orders under. One run per
+  // Backtester.
+  Backtester(const Config &cfg, S &strategy, u64 user_id, CommandQueue &commands)
+      : cfg_(cfg), strategy_(strategy), user_id_(user_id), commands_(commands),
+        exec_q_(std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>()),
+        md_q_(std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>()),
+        md_sub_(md_q_->subscribe()), engine_(book_, *exec_q_, *md_q_), sim_(cfg.street),
+        jitter_rng_(cfg.seed)
+  {
+    if (cfg_.street.step_interval_ns == 0)
+      cfg_.street.step_interval_ns = 1;
+    if (cfg_.timer_ns == 0)
+      cfg_.timer_ns = 1;
+    engine_.set_passive_fills(true);
+  }
+
+  Backtester(const Backtester &) = delete;
+  Backtester &operator=(const Backtester &) = delete;
+
+  Result run()
+  {
+    const u64 wall0 = now_ns();
+    result_ = Result{};
+    result_.digest = 0xcbf29ce484222325ULL;
+    now_ = cfg_.start_ns;
+    const u64 end = cfg_.start_ns + cfg_.duration_ns;
+
+    // As the live engine does: seed the book and publish its top before any flow.
+    sim_.seed_book(engine_, now_);
+    send(cfg_.latency.market_data_ns, last_md_at_, Kind::MarketData,
+         MarketDataEvent{book_.top(now_)});
+    schedule(now_, Kind::Step);
+    schedule(now_, Kind::Timer);
+
+    while (!events_.empty() && events_.top().at <= end)
+    {
+      const Event ev = events_.top();
+      events_.pop();
+      now_ = ev.at;
+      handle(ev);
+      ++result_.events;
+    }
+    result_.end_ns = now_;
+    result_.pnl = cash_ + result_.position * last_mid_;
+    result_.fill_p50_ns = fill_latency_.percentile(0.50);
+    result_.fill_p99_ns = fill_latency_.percentile(0.99);
+    result_.wall_ns = now_ns() - wall0;
+    return result_;
+  }
+
+  // Virtual time of the event being handled; strategies may read it from their callbacks.
+  u64 now() const noexcept
+  {
+    return now_;
+  }
+
+  const OrderBook &book() const noexcept
+  {
+    return book_;
+  }
+};
+} // namespace hft::backtest
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "backtester.hpp"
+#include "common/stats.hpp"
+#include "common/work_stealing.hpp"
+#include "risk/risk_manager.hpp"
+#include "strategy/mean_reversion.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Parameter sweep: one backtest per combination of a grid of MeanReversion and street flow
+// settings, spread over all cores by parallel_for (common/work_stealing.hpp). Each combination
+// builds its own engine, simulator, strategy, queues and risk limits inside a stats::Private
+// scope, so instances share nothing mutable, not even counters, and a combination's result does
+// not depend on which worker ran it or what ran next to it.
+namespace hft::backtest
+{
+// Strategy defaults are hft_app's, quoting included.
+struct Grid
+{
+  std::vector<std::size_t> window_len{64};
+  std::vector<double> dev_ticks{2.0};
+  std::vector<Qty> quote_qty{2};
+  std::vector<Price> requote_ticks{1};
+  std::vector<u64> min_requote_ns{5'000'000};
+  std::vector<double> move_prob{0.55};
+  std::vector<double> spread_prob{0.6};
+  std::vector<u64> seed{42}; // street flow
+};
+
+struct Params
+{
+  std::size_t window_len{64};
+  double dev_ticks{2.0};
+  Qty quote_qty{2};
+  Price requote_ticks{1};
+  u64 min_requote_ns{5'000'000};
+  double move_prob{0.55};
+  double spread_prob{0.6};
+  u64 seed{42};
+};
+
+struct Outcome
+{
+  Params params{};
+  Result result{};
+  u64 cmd_drops{0}; // strategy quotes dropped on a full command queue
+};
+
+struct SweepSummary
+{
+  std::vector<Outcome> outcomes; // in grid order, whatever order they ran in
+  ParallelStats parallel{};
+  u64 wall_ns{0};
+};
+
+// Every combination, last dimension (seed) varying fastest.
+inline std::vector<Params> expand(const Grid &g)
+{
+  std::vector<Params> out;
+  for (std::size_t w : g.window_len)
+    for (double d : g.dev_ticks)
+      for (Qty q : g.quote_qty)
+        for (Price rt : g.requote_ticks)
+          for (u64 rn : g.min_requote_ns)
+            for (double m : g.move_prob)
+              for (double s : g.spread_prob)
+                for (u64 seed : g.seed)
+                  out.push_back(Params{w, d, q, rt, rn, m, s, seed});
+  return out;
+}
+
+// One combination, on the calling thread. `base` supplies duration, timers, latency and the rest
+// of the street flow settings.
+inline Outcome run_one(const Config &base, const Params &p)
+{
+  stats::Private scope;
+  Config cfg = base;
+  cfg.street.move_prob = p.move_prob;
+  cfg.street.spread_prob = p.spread_prob;
+  cfg.street.seed = p.seed;
+
+  // Same strategy setup as hft_app.
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  StrategyContext ctx;
+  ctx.user_id = 1;
+  ctx.next_order_id = 1;
+  ctx.tick = cfg.street.tick;
+  RiskManager risk(/*max_position*/ 100, /*max_notional*/ 1'000'000'000'000, /*max_order_qty*/ 10);
+  MeanReversion strat(ctx, risk, *cmd_q, p.window_len, p.dev_ticks, p.quote_qty,
+                      {overflow::Policy::Drop}, QuoteConfig{p.requote_ticks, p.min_requote_ns});
+  Backtester bt(cfg, strat, ctx.user_id, *cmd_q);
+  Outcome o{p, bt.run(), 0};
+  o.cmd_drops = scope.value("strategy.cmd.drops");
+  return o;
+}
+
+// `workers` 0 means one per hardware thread.
+inline SweepSummary sweep(const Config &base, const Grid &grid, unsigned workers = 0)
+{
+  const std::vector<Params> params = expand(grid);
+  SweepSummary summary;
+  summary.outcomes.resize(params.size());
+  const u64 t0 = now_ns();
+  // Each job writes only its own slot.
+  summary.parallel = parallel_for(params.size(), workers, [&](std::size_t i, unsigned)
+                                  { summary.outcomes[i] = run_one(base, params[i]); });
+  summary.wall_ns = now_ns() - t0;
+  return summary;
+}
+
+inline void print_table(std::FILE *out, const SweepSummary &s)
+{
+  std::fprintf(out, "%6s %5s %4s %3s %6s %5s %6s %6s | %9s %6s %12s %10s %10s %4s | %9s\n",
+               "window", "dev", "qty", "rq", "rq_us", "move", "spread", "seed", "fills", "pos",
+               "pnl", "fill_p50us", "fill_p99us", "drop", "wall_ms");
+  for (const Outcome &o : s.outcomes)
+  {
+    const Params &p = o.params;
+    const Result &r = o.result;
+    std::fprintf(out,
+                 "%6zu %5.2f %4d %3lld %6llu %5.2f %6.2f %6llu | %9llu %6lld %12lld %10.1f %10.1f "
+                 "%4llu | %9.1f\n",
+                 p.window_len, p.dev_ticks, static_cast<int>(p.quote_qty),
+                 static_cast<long long>(p.requote_ticks),
+                 static_cast<unsigned long long>(p.min_requote_ns / 1'000), p.move_prob,
+                 p.spread_prob, static_cast<unsigned long long>(p.seed),
+                 static_cast<unsigned long long>(r.fills), static_cast<long long>(r.position),
+                 static_cast<long long>(r.pnl), static_cast<double>(r.fill_p50_ns) / 1e3,
+                 static_cast<double>(r.fill_p99_ns) / 1e3,
+                 static_cast<unsigned long long>(o.cmd_drops),
+                 static_cast<double>(r.wall_ns) / 1e6);
+  }
+  std::fprintf(out, "%zu combinations on %u workers in %.3f s (%llu stolen)\n", s.outcomes.size(),
+               s.parallel.workers, static_cast<double>(s.wall_ns) / 1e9,
+               static_cast<unsigned long long>(s.parallel.steals));
+}
+} // namespace hft::backtest
@@ -0,0 +1,803 @@
+#pragma once
+
+#include "logging.hpp"
+#include "spsc_queue.hpp"
+#include "stats.hpp"
+#include "wait_strategy.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HFT_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+// Asynchronous file writer for hot threads (journals, captures). The producer fills page-aligned
+// buffers from a fixed pool and hands them to an I/O thread through a lock-free SPSC queue; the
+// I/O thread writes them and returns each buffer through a second queue once its write completed.
+// Nothing on the producer side waits on disk:
+//   * acquire() returns nullptr instead of waiting when every buffer is in flight, and append()
+//     then keeps the bytes in a private backlog (counted as "<name>.starved") until one returns.
+//   * sync() only queues an fdatasync behind the writes already submitted; the I/O thread runs it.
+//   * close() is the one call that waits, for the I/O thread to finish. Call it off the hot path.
+//
+// Backends, chosen at open():
+//   Uring  -> io_uring through the raw syscalls (no liburing). The pool is registered with the
+//             ring and written with WRITE_FIXED; fsync goes in as a drained FSYNC so it follows
+//             every earlier write. Falls back to Thread when the kernel or seccomp refuses a ring.
+//   Thread -> the I/O thread itself calls pwrite/fdatasync.
+// With `direct` the file is opened O_DIRECT. Writes then have to be block multiples: flush()
+// submits only whole kAlign blocks and keeps the remainder, and close() pads the final block and
+// truncates the file back to the bytes appended. Filesystems that refuse O_DIRECT (tmpfs) get a
+// warning and buffered I/O.
+namespace hft::aio
+{
+inline constexpr std::size_t kAlign = 4096;     // buffer alignment and O_DIRECT block size
+inline constexpr std::size_t kMaxBuffers = 256; // pool size limit (the free queue's capacity)
+
+enum class Backend : u8
+{
+  Auto = 0, // io_uring when available, else Thread
+  Uring = 1,
+  Thread = 2
+};
+
+inline const char *to_string(Backend b) noexcept
+{
+  switch (b)
+  {
+  case Backend::Auto:
+    return "auto";
+  case Backend::Uring:
+    return "io_uring";
+  case Backend::Thread:
+    return "thread";
+  }
+  return "unknown";
+}
+
+struct Config
+{
+  std::size_t buffer_size{1 << 16}; // bytes per buffer, rounded up to kAlign
+  std::size_t buffers{32};          // pool size, at most kMaxBuffers
+  Backend backend{Backend::Auto};
+  bool direct{false};               // O_DIRECT
+  bool sync_on_close{true};         // fdatasync before closing the file
+  u64 idle_ns{50'000};              // I/O thread sleep when it has nothing to submit or reap
+};
+
+#if defined(HFT_HAVE_IO_URING)
+// Minimal io_uring: one submission and one completion ring mapped from the kernel, driven by the
+// I/O thread only. Head/tail words are shared with the kernel, hence the atomic_refs.
+class Ring
+{
+  int _fd{-1};
+  void *_sq_ring{MAP_FAILED};
+  void *_cq_ring{MAP_FAILED};
+  io_uring_sqe *_sqes{static_cast<io_uring_sqe *>(MAP_FAILED)};
+  std::size_t _sq_len{0};
+  std::size_t _cq_len{0};
+  std::size_t _sqes_len{0};
+  unsigned *_sq_head{nullptr};
+  unsigned *_sq_tail{nullptr};
+  unsigned *_sq_array{nullptr};
+  unsigned _sq_mask{0};
+  unsigned _sq_entries{0};
+  unsigned *_cq_head{nullptr};
+  unsigned *_cq_tail{nullptr};
+  io_uring_cqe *_cqes{nullptr};
+  unsigned _cq_mask{0};
+  unsigned _local_tail{0}; // sqes prepared, not yet published to the kernel
+  unsigned _unsubmitted{0};
+
+  static unsigned load(unsigned *p) noexcept
+  {
+    return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+  }
+
+  static void store(unsigned *p, unsigned v) noexcept
+  {
+    std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+  }
+
+  bool supports(const u8 *ops, std::size_t n) const noexcept
+  {
+    constexpr std::size_t kOps = 64;
+    constexpr std::size_t kBytes = sizeof(io_uring_probe) + kOps * sizeof(io_uring_probe_op);
+    alignas(io_uring_probe) std::byte buf[kBytes]{};
+    auto *probe = reinterpret_cast<io_uring_probe *>(buf);
+    if (syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, kOps) < 0)
+      return false;
+    for (std::size_t i = 0; i < n; ++i)
+      if (ops[i] > probe->last_op || (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED) == 0)
+        return false;
+    return true;
+  }
+
+public:
+  Ring() = default;
+  Ring(const Ring &) = delete;
+  Ring &operator=(const Ring &) = delete;
+
+  ~Ring()
+  {
+    if (_sqes != MAP_FAILED)
+      munmap(_sqes, _sqes_len);
+    if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring)
+      munmap(_cq_ring, _cq_len);
+    if (_sq_ring != MAP_FAILED)
+      munmap(_sq_ring, _sq_len);
+    if (_fd >= 0)
+      ::close(_fd);
+  }
+
+  // Set up a ring with at least `entries` submission slots. False when io_uring is unavailable
+  // or lacks the write/fsync opcodes (kernels before 5.6).
+  bool init(unsigned entries) noexcept
+  {
+    io_uring_params p{};
+    _fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+    if (_fd < 0)
+      return false;
+    _sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    _cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single)
+      _sq_len = _cq_len = _sq_len > _cq_len ? _sq_len : _cq_len;
+    _sq_ring = mmap(nullptr, _sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                    IORING_OFF_SQ_RING);
+    if (_sq_ring == MAP_FAILED)
+      return false;
+    _cq_ring = single ? _sq_ring
+                      : mmap(nullptr, _cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             _fd, IORING_OFF_CQ_RING);
+    if (_cq_ring == MAP_FAILED)
+      return false;
+    _sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe *>(mmap(nullptr, _sqes_len, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+    if (_sqes == MAP_FAILED)
+      return false;
+
+    auto *sq = static_cast<std::byte *>(_sq_ring);
+    auto *cq = static_cast<std::byte *>(_cq_ring);
+    _sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+    _sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+    _sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+    _sq_entries = p.sq_entries;
+    _cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+    _cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+    _cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+    _local_tail = load(_sq_tail);
+
+    const u8 ops[] = {IORING_OP_WRITE, IORING_OP_WRITE_FIXED, IORING_OP_FSYNC};
+    return supports(ops, sizeof(ops));
+  }
+
+  // Register `n` buffers for WRITE_FIXED. Can fail on RLIMIT_MEMLOCK; plain WRITE still works.
+  bool register_buffers(const iovec *iov, unsigned n) noexcept
+  {
+    return syscall(__NR_io_uring_register, _fd, IORING_REGISTER_BUFFERS, iov, n) == 0;
+  }
+
+  unsigned entries() const noexcept
+  {
+    return _sq_entries;
+  }
+
+  // A zeroed submission slot, or nullptr while the submission ring is full.
+  io_uring_sqe *sqe() noexcept
+  {
+    if (_local_tail - load(_sq_head) >= _sq_entries)
+      return nullptr;
+    const unsigned idx = _local_tail & _sq_mask;
+    _sq_array[idx] = idx;
+    ++_local_tail;
+    ++_unsubmitted;
+    io_uring_sqe *s = &_sqes[idx];
+    std::memset(s, 0, sizeof(*s));
+    return s;
+  }
+
+  // Publish prepared sqes and enter the kernel; with `wait`, also block for one completion.
+  // Returns the number submitted or -errno (EINTR/EAGAIN/EBUSY mean "try again").
+  int submit(bool wait = false) noexcept
+  {
+    store(_sq_tail, _local_tail);
+    if (_unsubmitted == 0 && !wait)
+      return 0;
+    const long r = syscall(__NR_io_uring_enter, _fd, _unsubmitted, wait ? 1U : 0U,
+                           wait ? IORING_ENTER_GETEVENTS : 0U, nullptr, 0);
+    if (r < 0)
+      return -errno;
+    _unsubmitted -= static_cast<unsigned>(r);
+    return static_cast<int>(r);
+  }
+
+  // Hand every available completion to f(user_data, res). Returns how many there were.
+  template <typename F> unsigned reap(F &&f)
+  {
+    unsigned head = *_cq_head;
+    const unsigned tail = load(_cq_tail);
+    const unsigned n = tail - head;
+    for (; head != tail; ++head)
+    {
+      const io_uring_cqe &c = _cqes[head & _cq_mask];
+      f(c.user_data, c.res);
+    }
+    store(_cq_head, head);
+    return n;
+  }
+};
+#endif
+
+// One producer thread (the hot one) and the writer's own I/O thread.
+class AsyncWriter
+{
+  struct Request
+  {
+    u32 buf{0}; // pool index; kSync for an fdatasync
+    u32 len{0};
+    u64 offset{0};
+  };
+
+  struct Slot // I/O thread only
+  {
+    u64 offset{0};
+    u32 len{0};
+    u32 done{0};
+  };
+
+  static constexpr u32 kSync = ~u32{0};
+  using FreeQueue = spsc::Queue<u32, kMaxBuffers>;
+  using RequestQueue = spsc::Queue<Request, 2 * kMaxBuffers>; // buffers plus queued syncs
+
+  Config _cfg;
+  int _fd{-1};
+  Backend _backend{Backend::Thread};
+  bool _direct{false};
+  std::byte *_pool{nullptr};
+  std::unique_ptr<FreeQueue> _free;
+  std::unique_ptr<RequestQueue> _requests;
+  std::atomic<bool> _running{false};
+  std::thread _thread;
+
+  // Producer side.
+  std::byte *_cur{nullptr}; // buffer being filled by append()
+  std::size_t _fill{0};
+  u64 _offset{0};   // file offset of the next submitted buffer
+  u64 _appended{0}; // bytes accepted by append() or submit()
+  std::vector<std::byte> _backlog;
+  std::size_t _backlog_head{0};
+  stats::Counter _starved;
+
+  // I/O thread side.
+  std::vector<Slot> _slots;
+  unsigned _inflight{0};
+  std::atomic<u64> _written{0};
+  std::atomic<u64> _syncs{0};
+  std::atomic<bool> _failed{false};
+  stats::Counter _writes;
+  stats::Counter _errors;
+#if defined(HFT_HAVE_IO_URING)
+  std::unique_ptr<Ring> _ring;
+  std::vector<u32> _resubmit; // buffers with a short write to finish
+  bool _fixed{false};
+#endif
+
+  static std::string stat_name(const char *prefix, const char *what)
+  {
+    return std::string(prefix) + "." + what;
+  }
+
+  std::byte *buffer(u32 i) const noexcept
+  {
+    return _pool + static_cast<std::size_t>(i) * _cfg.buffer_size;
+  }
+
+  u32 index(const std::byte *p) const noexcept
+  {
+    return static_cast<u32>(static_cast<std::size_t>(p - _pool) / _cfg.buffer_size);
+  }
+
+  // --- I/O thread ------------------------------------------------------------------------------
+
+  void fail(const char *what, int err) noexcept
+  {
+    _errors.add();
+    if (!_failed.exchange(true, std::memory_order_relaxed))
+      HFT_ERROR("aio: %s failed: %s", what, std::strerror(err));
+  }
+
+  void release(u32 buf) noexcept
+  {
+    _free->push(buf); // cannot fail: the queue holds the whole pool
+  }
+
+  void write_blocking(const Request &r) noexcept
+  {
+    u32 done = 0;
+    while (done < r.len)
+    {
+      const ssize_t n = ::pwrite(_fd, buffer(r.buf) + done, r.len - done,
+                                 static_cast<off_t>(r.offset + done));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+      {
+        fail("pwrite", n < 0 ? errno : EIO);
+        break;
+      }
+      done += static_cast<u32>(n);
+    }
+    _written.fetch_add(done, std::memory_order_relaxed);
+    _writes.add();
+    release(r.buf);
+  }
+
+  void sync_blocking() noexcept
+  {
+    if (::fdatasync(_fd) != 0)
+      fail("fdatasync", errno);
+    _syncs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+#if defined(HFT_HAVE_IO_URING)
+  // Queue the unwritten rest of slot `buf`. False while the submission ring is full.
+  bool prep_write(u32 buf) noexcept
+  {
+    io_uring_sqe *s = _ring->sqe();
+    if (s == nullptr)
+      return false;
+    const Slot &slot = _slots[buf];
+    s->opcode = _fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    s->fd = _fd;
+    s->addr = reinterpret_cast<u64>(buffer(buf) + slot.done);
+    s->len = slot.len - slot.done;
+    s->off = slot.offset + slot.done;
+    if (_fixed)
+      s->buf_index = static_cast<u16>(buf);
+    s->user_data = buf;
+    ++_inflight;
+    return true;
+  }
+
+  bool prep_sync() noexcept
+  {
+    io_uring_sqe *s = _ring->sqe();
+    if (s == nullptr)
+      return false;
+    s->opcode = IORING_OP_FSYNC;
+    s->fd = _fd;
+    s->fsync_flags = IORING_FSYNC_DATASYNC;
+    s->flags = IOSQE_IO_DRAIN; // after every write submitted before it
+    s->user_data = kSync;
+    ++_inflight;
+    return true;
+  }
+
+  void on_complete(u64 user_data, int res) noexcept
+  {
+    --_inflight;
+    if (user_data == kSync)
+    {
+      if (res < 0)
+        fail("fsync", -res);
+      _syncs.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    const u32 buf = static_cast<u32>(user_data);
+    Slot &slot = _slots[buf];
+    const bool retry = res == -EINTR || res == -EAGAIN;
+    if (!retry && res <= 0)
+    {
+      fail("write", res < 0 ? -res : EIO);
+      slot.done = slot.len;
+    }
+    else if (!retry)
+    {
+      slot.done += static_cast<u32>(res);
+      _written.fetch_add(static_cast<u64>(res), std::memory_order_relaxed);
+    }
+    if (slot.done < slot.len)
+    {
+      _resubmit.push_back(buf); // short write: the rest goes in on the next poll
+      return;
+    }
+    _writes.add();
+    release(buf);
+  }
+
+  // Submission ring full: submit what is prepared and wait for a completion.
+  void make_room()
+  {
+    _ring->submit(true);
+    _ring->reap([this](u64 ud, int res) { on_complete(ud, res); });
+  }
+
+  // Submit queued requests to the ring and reap completions. True if anything happened.
+  bool poll_ring()
+  {
+    bool busy = !_resubmit.empty();
+    for (std::size_t i = 0; i < _resubmit.size(); ++i)
+      while (!prep_write(_resubmit[i]))
+        make_room();
+    _resubmit.clear();
+    Request r;
+    while (_inflight < _ring->entries() && _requests->pop(r))
+    {
+      busy = true;
+      if (r.buf != kSync)
+        _slots[r.buf] = Slot{r.offset, r.len, 0};
+      while (!(r.buf == kSync ? prep_sync() : prep_write(r.buf)))
+        make_room();
+    }
+    _ring->submit();
+    busy |= _ring->reap([this](u64 ud, int res) { on_complete(ud, res); }) > 0;
+    return busy;
+  }
+#endif
+
+  bool poll_thread() noexcept
+  {
+    bool busy = false;
+    Request r;
+    while (_requests->pop(r))
+    {
+      busy = true;
+      if (r.buf == kSync)
+        sync_blocking();
+      else
+        write_blocking(r);
+    }
+    return busy;
+  }
+
+  // Nothing queued, in flight or waiting to be resubmitted.
+  bool drained() const noexcept
+  {
+#if defined(HFT_HAVE_IO_URING)
+    if (!_resubmit.empty())
+      return false;
+#endif
+    return _requests->empty() && _inflight == 0;
+  }
+
+  void run()
+  {
+    wait::Waiter waiter(wait::WaitConfig{wait::WaitPolicy::Sleep, 0, 0, _cfg.idle_ns});
+    while (true)
+    {
+      // Read the flag before polling: every request pushed before close() is then drained below.
+      const bool stopping = !_running.load(std::memory_order_acquire);
+      bool busy = false;
+#if defined(HFT_HAVE_IO_URING)
+      if (_ring)
+        busy = poll_ring();
+      else
+#endif
+        busy = poll_thread();
+      if (stopping && drained())
+        break;
+      if (busy)
+        waiter.reset();
+      else
+        waiter.idle([] { return false; });
+    }
+  }
+
+  // --- producer --------------------------------------------------------------------------------
+
+  // sync() leaves room for every pool buffer, so this only waits if that reserve is ever broken;
+  // losing the request would leave a hole in the file.
+  void push(std::byte *buf, std::size_t len) noexcept
+  {
+    const Request r{index(buf), static_cast<u32>(len), _offset};
+    while (!_requests->push(r)) [[unlikely]]
+      std::this_thread::yield();
+    _offset += len;
+  }
+
+  // Copy as much of [src, src + n) into pool buffers as they allow; returns the bytes taken.
+  std::size_t fill(const std::byte *src, std::size_t n) noexcept
+  {
+    std::size_t taken = 0;
+    while (taken < n)
+    {
+      if (_cur == nullptr && (_cur = acquire()) == nullptr)
+        break;
+      const std::size_t room = _cfg.buffer_size - _fill;
+      const std::size_t k = n - taken < room ? n - taken : room;
+      std::memcpy(_cur + _fill, src + taken, k);
+      _fill += k;
+      taken += k;
+      if (_fill == _cfg.buffer_size)
+      {
+        push(_cur, _fill);
+        _cur = nullptr;
+        _fill = 0;
+      }
+    }
+    return taken;
+  }
+
+  bool drain_backlog() noexcept
+  {
+    if (_backlog_head == _backlog.size())
+      return true;
+    _backlog_head += fill(_backlog.data() + _backlog_head, _backlog.size() - _backlog_head);
+    if (_backlog_head < _backlog.size())
+      return false;
+    _backlog.clear();
+    _backlog_head = 0;
+    return true;
+  }
+
+  bool setup_backend()
+  {
+#if defined(HFT_HAVE_IO_URING)
+    if (_cfg.backend != Backend::Thread)
+    {
+      _ring = std::make_unique<Ring>();
+      if (_ring->init(static_cast<unsigned>(_cfg.buffers) + 8))
+      {
+        std::vector<iovec> iov(_cfg.buffers);
+        for (std::size_t i = 0; i < _cfg.buffers; ++i)
+          iov[i] = iovec{buffer(static_cast<u32>(i)), _cfg.buffer_size};
+        _fixed = _ring->register_buffers(iov.data(), static_cast<unsigned>(_cfg.buffers));
+        _backend = Backend::Uring;
+        return true;
+      }
+      _ring.reset();
+    }
+#endif
+    if (_cfg.backend == Backend::Uring)
+      HFT_WARN("aio: io_uring unavailable, writing from a pwrite thread");
+    _backend = Backend::Thread;
+    return true;
+  }
+
+public:
+  AsyncWriter() = default;
+  AsyncWriter(const AsyncWriter &) = delete;
+  AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+  ~AsyncWriter()
+  {
+    close();
+  }
+
+  // Create or truncate `path`, allocate the pool and start the I/O thread. `name` prefixes the
+  // "<name>.starved/writes/errors" counters.
+  bool open(const char *path, Config cfg = {}, const char *name = "aio")
+  {
+    if (_fd >= 0)
+      return false;
+    _cfg = cfg;
+    _cfg.buffer_size = (_cfg.buffer_size + kAlign - 1) / kAlign * kAlign;
+    if (_cfg.buffer_size == 0)
+      _cfg.buffer_size = kAlign;
+    if (_cfg.buffers == 0 || _cfg.buffers > kMaxBuffers)
+      _cfg.buffers = _cfg.buffers == 0 ? 1 : kMaxBuffers;
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    _direct = false;
+#if defined(O_DIRECT)
+    if (_cfg.direct)
+    {
+      _fd = ::open(path, flags | O_DIRECT, 0644);
+      if (_fd >= 0)
+        _direct = true;
+      else if (errno == EINVAL)
+        HFT_WARN("aio: %s does not support O_DIRECT, using buffered writes", path);
+    }
+#endif
+    if (_fd < 0)
+      _fd = ::open(path, flags, 0644);
+    if (_fd < 0)
+    {
+      HFT_WARN("aio: cannot open %s: %s", path, std::strerror(errno));
+      return false;
+    }
+
+    _pool = static_cast<std::byte *>(std::aligned_alloc(kAlign, _cfg.buffers * _cfg.buffer_size));
+    if (_pool == nullptr)
+    {
+      ::close(_fd);
+      _fd = -1;
+      return false;
+    }
+    _free = std::make_unique<FreeQueue>();
+    _requests = std::make_unique<RequestQueue>();
+    for (u32 i = 0; i < _cfg.buffers; ++i)
+      _free->push(i);
+    _slots.assign(_cfg.buffers, Slot{});
+    _cur = nullptr;
+    _fill = 0;
+    _offset = 0;
+    _appended = 0;
+    _backlog.clear();
+    _backlog_head = 0;
+    _inflight = 0;
+    _written.store(0, std::memory_order_relaxed);
+    _syncs.store(0, std::memory_order_relaxed);
+    _failed.store(false, std::memory_order_relaxed);
+    _starved = stats::counter(stat_name(name, "starved").c_str());
+    _writes = stats::counter(stat_name(name, "writes").c_str());
+    _errors = stats::counter(stat_name(name, "errors").c_str());
+
+    setup_backend();
+    _running.store(true, std::memory_order_release);
+    _thread = std::thread([this] { run(); });
+    return true;
+  }
+
+  bool is_open() const noexcept
+  {
+    return _fd >= 0;
+  }
+
+  // Backend in use; meaningful after open().
+  Backend backend() const noexcept
+  {
+    return _backend;
+  }
+
+  // True when the file really is open O_DIRECT.
+  bool direct() const noexcept
+  {
+    return _direct;
+  }
+
+  std::size_t buffer_size() const noexcept
+  {
+    return _cfg.buffer_size;
+  }
+
+  // A free kAlign-aligned buffer of buffer_size() bytes, or nullptr when all are in flight.
+  // Buffers taken here go back with submit(); do not mix with an append() in progress.
+  std::byte *acquire() noexcept
+  {
+    u32 i = 0;
+    return _free->pop(i) ? buffer(i) : nullptr;
+  }
+
+  // Queue `len` bytes of an acquired buffer for writing after everything submitted before.
+  // Under O_DIRECT `len` must be a multiple of kAlign except on the last submit.
+  void submit(std::byte *buf, std::size_t len) noexcept
+  {
+    _appended += len;
+    push(buf, _direct ? (len + kAlign - 1) / kAlign * kAlign : len);
+  }
+
+  // Copy bytes into the current buffer, submitting each one as it fills. Never waits: with the
+  // pool exhausted the bytes go to the backlog and follow once buffers come back.
+  void append(const void *p, std::size_t n)
+  {
+    const auto *src = static_cast<const std::byte *>(p);
+    _appended += n;
+    std::size_t taken = 0;
+    if (drain_backlog())
+      taken = fill(src, n);
+    if (taken < n)
+    {
+      if (_backlog.empty())
+        _starved.add();
+      _backlog.insert(_backlog.end(), src + taken, src + n);
+    }
+  }
+
+  // Submit the partly filled buffer (whole blocks only under O_DIRECT) and as much backlog as
+  // buffers allow. True once nothing is left in the backlog.
+  bool flush() noexcept
+  {
+    if (!drain_backlog())
+      return false;
+    const std::size_t n = _direct ? _fill / kAlign * kAlign : _fill;
+    if (n == 0)
+      return true;
+    std::byte *next = nullptr;
+    if (n < _fill && (next = acquire()) == nullptr)
+      return true; // the tail waits for a buffer; what is submitted stays whole blocks
+    if (next != nullptr)
+      std::memcpy(next, _cur + n, _fill - n);
+    push(_cur, n);
+    _fill -= n;
+    _cur = next;
+    return true;
+  }
+
+  // Queue an fdatasync after every write submitted so far (call flush() first to include the
+  // current buffer). False, without queueing, when the request queue is too full: syncs never take
+  // the room kept for every pool buffer to be queued at once.
+  bool sync() noexcept
+  {
+    if (_requests->size() + _cfg.buffers >= RequestQueue::capacity())
+      return false;
+    return _requests->push(Request{kSync, 0, 0});
+  }
+
+  // Write out everything appended, optionally fdatasync, stop the I/O thread and close the file.
+  // Blocks until the disk is done; never call it from a hot loop.
+  void close()
+  {
+    if (_fd < 0)
+      return;
+    while (!drain_backlog())
+      std::this_thread::yield();
+    if (_fill > 0)
+    {
+      if (_direct)
+      {
+        const std::size_t padded = (_fill + kAlign - 1) / kAlign * kAlign;
+        std::memset(_cur + _fill, 0, padded - _fill);
+        _fill = padded;
+      }
+      push(_cur, _fill);
+      _cur = nullptr;
+      _fill = 0;
+    }
+    if (_cfg.sync_on_close)
+      while (!sync())
+        std::this_thread::yield();
+    _running.store(false, std::memory_order_release);
+    if (_thread.joinable())
+      _thread.join();
+    if (_direct && ::ftruncate(_fd, static_cast<off_t>(_appended)) != 0)
+      HFT_WARN("aio: ftruncate failed: %s", std::strerror(errno));
+#if defined(HFT_HAVE_IO_URING)
+    _ring.reset();
+#endif
+    ::close(_fd);
+    _fd = -1;
+    std::free(_pool);
+    _pool = nullptr;
+  }
+
+  // Bytes appended or submitted so far (the file size once closed).
+  u64 appended() const noexcept
+  {
+    return _appended;
+  }
+
+  // Bytes the I/O thread has written, padding included. Any thread.
+  u64 written() const noexcept
+  {
+    return _written.load(std::memory_order_relaxed);
+  }
+
+  // fdatasyncs completed. Any thread.
+  u64 syncs() const noexcept
+  {
+    return _syncs.load(std::memory_order_relaxed);
+  }
+
+  // True once a write or sync has failed (the first failure is logged).
+  bool failed() const noexcept
+  {
+    return _failed.load(std::memory_order_relaxed);
+  }
+
+  // Bytes waiting for a free buffer.
+  std::size_t backlog() const noexcept
+  {
+    return _backlog.size() - _backlog_head;
+  }
+};
+} // namespace hft::aio
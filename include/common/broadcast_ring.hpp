@@ -0,0 +1,297 @@
+#pragma once
+
+#include "wait_strategy.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Single-producer/multi-consumer broadcast ring in the style of a disruptor sequence barrier.
+//   * The producer writes each element exactly once. Every subscriber owns a private cursor and
+//     reads the same slots independently, so adding consumers never adds producer-side copies.
+//   * Each slot is stamped with the sequence it holds. Readers validate the stamp before and after
+//     copying (seqlock style), which lets them tell a fresh value from one that was lapped.
+//   * OverrunPolicy decides what happens to slow subscribers:
+//       DropAndFlag  -> producer never waits; a lapped subscriber skips to the oldest intact slot,
+//                       counts what it lost and raises its overrun flag.
+//       BackPressure -> producer refuses to overwrite a slot the slowest subscriber still needs;
+//                       push() returns false exactly like spsc::Queue does when full.
+//   * Publish cost is O(1) in the number of subscribers: the producer caches the slowest cursor and
+//     only rescans the cursor table when that cached value says the ring is full.
+namespace hft::broadcast
+{
+enum class OverrunPolicy : std::uint8_t
+{
+  DropAndFlag = 0,
+  BackPressure = 1
+};
+
+template <typename T, std::size_t CapacityPow2, std::size_t MaxSubscribers = 8> class Ring
+{
+  static_assert((CapacityPow2 & (CapacityPow2 - 1)) == 0, "Capacity must be a power of two");
+  // Readers copy slots optimistically and discard torn copies, which is only sound for PODs.
+  static_assert(std::is_trivially_copyable_v<T>, "Broadcast elements must be trivially copyable");
+  static constexpr std::size_t kMask = CapacityPow2 - 1;
+  // Stamp written while a slot is being overwritten; never matches a valid sequence.
+  static constexpr std::uint64_t kWriting = ~std::uint64_t{0};
+
+  // `seq` holds (sequence + 1) of the element stored in `value`.
+  struct Slot
+  {
+    std::uint64_t seq;
+    T value;
+  };
+
+  // One cache line per subscriber so cursor updates do not bounce between consumer cores.
+  struct alignas(64) Cursor
+  {
+    std::atomic<std::uint64_t> next{0}; // next sequence this subscriber will read
+    std::atomic<bool> active{false};    // slot claimed by a live Subscriber
+  };
+
+  OverrunPolicy _policy;
+  // Number of elements published so far. Only the producer modifies it.
+  alignas(64) std::atomic<std::uint64_t> _tail{0};
+  // Producer-private cache of the slowest subscriber cursor (BackPressure only).
+  std::uint64_t _gate{0};
+  Cursor _cursors[MaxSubscribers];
+  // Raw slot storage, written in place by the producer.
+  alignas(64) std::byte _storage[sizeof(Slot) * CapacityPow2];
+  // Shared parking spot; notify() wakes every parked subscriber.
+  wait::EventCount _event;
+
+  Slot *slot(std::uint64_t seq) noexcept
+  {
+    return std::launder(reinterpret_cast<Slot *>(&_storage[sizeof(Slot) * (seq & kMask)]));
+  }
+
+  // Minimum cursor over active subscribers. With nobody subscribed nothing gates the producer.
+  std::uint64_t slowest(std::uint64_t tail) const noexcept
+  {
+    std::uint64_t min = tail;
+    for (const Cursor &c : _cursors)
+    {
+      if (!c.active.load(std::memory_order_acquire))
+        continue;
+      const std::uint64_t n = c.next.load(std::memory_order_acquire);
+      if (n < min)
+        min = n;
+    }
+    return min;
+  }
+
+public:
+  // Handle owned by one consumer thread. Destroying it releases the cursor so the producer stops
+  // gating on it.
+  class Subscriber
+  {
+    Ring *_ring{nullptr};
+    std::size_t _index{0};
+    std::uint64_t _next{0};    // consumer-local copy of the shared cursor
+    std::uint64_t _dropped{0}; // events skipped after being lapped
+    bool _overrun{false};
+
+    friend class Ring;
+    Subscriber(Ring *ring, std::size_t index, std::uint64_t next) noexcept
+        : _ring(ring), _index(index), _next(next)
+    {
+    }
+
+    void skip_to(std::uint64_t next) noexcept
+    {
+      _dropped += next - _next;
+      _overrun = true;
+      _next = next;
+    }
+
+  public:
+    Subscriber() = default;
+    Subscriber(const Subscriber &) = delete;
+    Subscriber &operator=(const Subscriber &) = delete;
+
+    Subscriber(Subscriber &&o) noexcept
+        : _ring(o._ring), _index(o._index), _next(o._next), _dropped(o._dropped),
+          _overrun(o._overrun)
+    {
+      o._ring = nullptr;
+    }
+
+    Subscriber &operator=(Subscriber &&o) noexcept
+    {
+      if (this != &o)
+      {
+        release();
+        _ring = o._ring;
+        _index = o._index;
+        _next = o._next;
+        _dropped = o._dropped;
+        _overrun = o._overrun;
+        o._ring = nullptr;
+      }
+      return *this;
+    }
+
+    ~Subscriber()
+    {
+      release();
+    }
+
+    // False when subscribe() ran out of cursor slots.
+    bool valid() const noexcept
+    {
+      return _ring != nullptr;
+    }
+
+    bool pop(T &out) noexcept
+    {
+      for (;;)
+      {
+        const std::uint64_t tail = _ring->_tail.load(std::memory_order_acquire);
+        if (_next == tail) // caught up
+          return false;
+        if (tail - _next > CapacityPow2)
+        {
+          // Lapped before we even looked: the producer may be rewriting the oldest slot right now,
+          // so resume one past it.
+          skip_to(tail - CapacityPow2 + 1);
+          continue;
+        }
+        Slot *s = _ring->slot(_next);
+        const std::uint64_t want = _next + 1;
+        if (std::atomic_ref<std::uint64_t>(s->seq).load(std::memory_order_acquire) != want)
+        {
+          skip_to(_ring->_tail.load(std::memory_order_acquire) - CapacityPow2 + 1);
+          continue;
+        }
+        std::memcpy(static_cast<void *>(&out), &s->value, sizeof(T));
+        // Re-check the stamp after the copy; a changed stamp means the copy may be torn.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (std::atomic_ref<std::uint64_t>(s->seq).load(std::memory_order_relaxed) != want)
+        {
+          skip_to(_ring->_tail.load(std::memory_order_acquire) - CapacityPow2 + 1);
+          continue;
+        }
+        ++_next;
+        // Publish progress so a back-pressured producer can reuse the slot.
+        _ring->_cursors[_index].next.store(_next, std::memory_order_release);
+        return true;
+      }
+    }
+
+    bool empty() const noexcept
+    {
+      return _next == _ring->_tail.load(std::memory_order_acquire);
+    }
+
+    // Number of published events this subscriber has not consumed yet.
+    std::uint64_t lag() const noexcept
+    {
+      return _ring->_tail.load(std::memory_order_acquire) - _next;
+    }
+
+    bool overrun() const noexcept
+    {
+      return _overrun;
+    }
+
+    std::uint64_t dropped() const noexcept
+    {
+      return _dropped;
+    }
+
+    void clear_overrun() noexcept
+    {
+      _overrun = false;
+    }
+
+  private:
+    void release() noexcept
+    {
+      if (_ring)
+        _ring->_cursors[_index].active.store(false, std::memory_order_release);
+      _ring = nullptr;
+    }
+  };
+
+  explicit Ring(OverrunPolicy policy = OverrunPolicy::DropAndFlag) noexcept : _policy(policy) {}
+  Ring(const Ring &) = delete;
+  Ring &operator=(const Ring &) = delete;
+
+  // Register a consumer. It observes events published after this call, so subscribe before the
+  // producer starts when the first events matter. Returns an invalid handle when all
+  // MaxSubscribers cursors are taken.
+  Subscriber subscribe() noexcept
+  {
+    for (std::size_t i = 0; i < MaxSubscribers; ++i)
+    {
+      bool expected = false;
+      if (!_cursors[i].active.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        continue;
+      // Until the cursor is stored the producer may gate on a stale (older) value, which only
+      // makes it more conservative.
+      const std::uint64_t start = _tail.load(std::memory_order_acquire);
+      _cursors[i].next.store(start, std::memory_order_release);
+      return Subscriber(this, i, start);
+    }
+    return Subscriber{};
+  }
+
+  bool push(const T &v) noexcept
+  {
+    const std::uint64_t t = _tail.load(std::memory_order_relaxed);
+    if (_policy == OverrunPolicy::BackPressure && t - _gate >= CapacityPow2)
+    {
+      // Cached gate says full: rescan cursors once before giving up.
+      _gate = slowest(t);
+      if (t - _gate >= CapacityPow2)
+        return false;
+    }
+    Slot *s = slot(t);
+    // Mark the slot as in-flight before touching the payload so readers can detect tearing.
+    std::atomic_ref<std::uint64_t>(s->seq).store(kWriting, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(static_cast<void *>(&s->value), &v, sizeof(T));
+    std::atomic_ref<std::uint64_t>(s->seq).store(t + 1, std::memory_order_release);
+    _tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // First-touch the slot pages from the calling (pinned producer) thread so they land on its NUMA
+  // node. Only valid before the first push.
+  void prefault() noexcept
+  {
+    for (std::size_t off = 0; off < sizeof(_storage); off += 4096)
+      reinterpret_cast<volatile std::byte &>(_storage[off]) = std::byte{0};
+  }
+
+  // Wake parked subscribers after publishing a batch.
+  void notify() noexcept
+  {
+    _event.notify();
+  }
+
+  wait::EventCount &event() noexcept
+  {
+    return _event;
+  }
+
+  OverrunPolicy policy() const noexcept
+  {
+    return _policy;
+  }
+
+  static constexpr std::size_t capacity() noexcept
+  {
+    return CapacityPow2;
+  }
+
+  // Total number of elements published since construction.
+  std::uint64_t published() const noexcept
+  {
+    return _tail.load(std::memory_order_acquire);
+  }
+};
+} // namespace hft::broadcast
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HFT_HAVE_TSC 1
+#elif defined(_M_X64)
+#include <intrin.h>
+#define HFT_HAVE_TSC 1
+#endif
+
+// Clock sources for timestamps and latency metrics.
+//   * Tsc: reads the invariant time-stamp counter (~7ns, no syscall, no vDSO) and converts ticks to
+//     nanoseconds with a fixed-point multiplier calibrated against CLOCK_MONOTONIC (steady_clock).
+//     resync() re-measures the rate over the whole run and slews toward CLOCK_MONOTONIC instead of
+//     stepping, so readings stay monotonic.
+//   * Steady: std::chrono::steady_clock. Used when the CPU does not advertise an invariant TSC,
+//     when calibration looks implausible, or when HFT_CLOCK=steady is set in the environment.
+// This header only depends on the standard library so types.hpp can expose now_ns() on top of it.
+namespace hft::clock
+{
+enum class Source : std::uint8_t
+{
+  Steady = 0,
+  Tsc = 1
+};
+
+inline const char *to_string(Source s) noexcept
+{
+  return s == Source::Tsc ? "tsc" : "steady";
+}
+
+inline std::uint64_t steady_ns() noexcept
+{
+  using namespace std::chrono;
+  return static_cast<std::uint64_t>(
+      duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+inline std::uint64_t read_tsc() noexcept
+{
+#if defined(HFT_HAVE_TSC)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// CPUID.80000007H:EDX[8] - TSC ticks at a constant rate in all P/C-states.
+inline bool tsc_is_invariant() noexcept
+{
+#if defined(HFT_HAVE_TSC) && defined(_MSC_VER)
+  int regs[4] = {};
+  __cpuid(regs, 0x80000000);
+  if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+    return false;
+  __cpuid(regs, 0x80000007);
+  return (regs[3] & (1 << 8)) != 0;
+#elif defined(HFT_HAVE_TSC)
+  unsigned a = 0, b = 0, c = 0, d = 0;
+  if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u)
+    return false;
+  __get_cpuid(0x80000007u, &a, &b, &c, &d);
+  return (d & (1u << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+class TscClock
+{
+  static constexpr unsigned kShift = 32;
+
+  // Conversion: ns = base_ns + ((tsc - base_tsc) * mult >> kShift), guarded by a seqlock so
+  // resync() can swap parameters while other threads read.
+  std::atomic<std::uint32_t> _seq{0};
+  std::atomic<std::uint64_t> _base_tsc{0};
+  std::atomic<std::uint64_t> _base_ns{0};
+  std::atomic<std::uint64_t> _mult{0};
+
+  Source _source{Source::Steady};
+  std::uint64_t _anchor_tsc{0}; // first calibration sample, for long-baseline rate estimates
+  std::uint64_t _anchor_ns{0};
+  std::uint64_t _resync_ticks{0};
+  std::atomic<std::uint64_t> _next_resync_tsc{0};
+
+  static std::uint64_t mul_shift(std::uint64_t delta, std::uint64_t mult) noexcept
+  {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using u128 = unsigned __int128; // __extension__ keeps -Wpedantic quiet
+    return static_cast<std::uint64_t>((static_cast<u128>(delta) * mult) >> kShift);
+#else
+    const std::uint64_t hi = (delta >> 32) * mult;
+    const std::uint64_t lo = ((delta & 0xFFFFFFFFu) * mult) >> kShift;
+    return hi + lo;
+#endif
+  }
+
+  // Read TSC and CLOCK_MONOTONIC as close together as possible; the TSC value is the midpoint of
+  // the two reads bracketing the clock call. Of a few attempts, keep the one with the narrowest
+  // bracket so a preemption or interrupt mid-sample does not skew the calibration.
+  static void sample(std::uint64_t &tsc, std::uint64_t &ns) noexcept
+  {
+    std::uint64_t best = ~std::uint64_t{0};
+    for (int i = 0; i < 8; ++i)
+    {
+      const std::uint64_t t0 = read_tsc();
+      const std::uint64_t mono = steady_ns();
+      const std::uint64_t t1 = read_tsc();
+      if (t1 >= t0 && t1 - t0 < best)
+      {
+        best = t1 - t0;
+        tsc = t0 + (t1 - t0) / 2;
+        ns = mono;
+      }
+    }
+  }
+
+  void store(std::uint64_t base_tsc, std::uint64_t base_ns, std::uint64_t mult) noexcept
+  {
+    const std::uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _base_tsc.store(base_tsc, std::memory_order_relaxed);
+    _base_ns.store(base_ns, std::memory_order_relaxed);
+    _mult.store(mult, std::memory_order_relaxed);
+    _seq.store(s + 2, std::memory_order_release);
+  }
+
+  bool calibrate() noexcept
+  {
+    if (!tsc_is_invariant())
+      return false;
+    std::uint64_t tsc0 = 0, ns0 = 0, tsc1 = 0, ns1 = 0;
+    sample(tsc0, ns0);
+    // Spin rather than sleep: a 2ms window is plenty for a first estimate and resync() refines it.
+    do
+      sample(tsc1, ns1);
+    while (ns1 - ns0 < 2'000'000);
+    if (tsc1 <= tsc0)
+      return false;
+    const double ghz = static_cast<double>(tsc1 - tsc0) / static_cast<double>(ns1 - ns0);
+    if (ghz < 0.2 || ghz > 10.0)
+      return false;
+    _anchor_tsc = tsc0;
+    _anchor_ns = ns0;
+    _resync_ticks = static_cast<std::uint64_t>(ghz * 1e9); // about one second
+    _next_resync_tsc.store(tsc1 + _resync_ticks, std::memory_order_relaxed);
+    store(tsc1, ns1, ((ns1 - ns0) << kShift) / (tsc1 - tsc0));
+    return true;
+  }
+
+public:
+  explicit TscClock(Source preferred = Source::Tsc) noexcept
+  {
+    const char *env = std::getenv("HFT_CLOCK");
+    if (env != nullptr && std::strcmp(env, "steady") == 0)
+      preferred = Source::Steady;
+    if (preferred == Source::Tsc && calibrate())
+      _source = Source::Tsc;
+  }
+
+  Source source() const noexcept
+  {
+    return _source;
+  }
+
+  std::uint64_t now() const noexcept
+  {
+    if (_source != Source::Tsc)
+      return steady_ns();
+    const std::uint64_t tsc = read_tsc();
+    for (;;)
+    {
+      const std::uint32_t s1 = _seq.load(std::memory_order_acquire);
+      const std::uint64_t base_tsc = _base_tsc.load(std::memory_order_relaxed);
+      const std::uint64_t base_ns = _base_ns.load(std::memory_order_relaxed);
+      const std::uint64_t mult = _mult.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if ((s1 & 1u) == 0 && _seq.load(std::memory_order_relaxed) == s1)
+        return base_ns + (tsc > base_tsc ? mul_shift(tsc - base_tsc, mult) : 0);
+    }
+  }
+
+  // Ticks per nanosecond as currently calibrated (0 for the steady source).
+  double ghz() const noexcept
+  {
+    const std::uint64_t mult = _mult.load(std::memory_order_relaxed);
+    return mult == 0 ? 0.0 : static_cast<double>(1ull << kShift) / static_cast<double>(mult);
+  }
+
+  // Re-measure the TSC rate over the whole run and slew toward CLOCK_MONOTONIC: the new
+  // multiplier makes the clock meet monotonic time again one resync interval from now, without
+  // ever stepping backwards.
+  void resync() noexcept
+  {
+    if (_source != Source::Tsc)
+      return;
+    std::uint64_t tsc = 0, mono = 0;
+    sample(tsc, mono);
+    if (tsc <= _anchor_tsc)
+      return;
+    const std::uint64_t est = now();
+    const double rate = static_cast<double>(mono - _anchor_ns) /
+                        static_cast<double>(tsc - _anchor_tsc); // ns per tick, long baseline
+    const double interval = static_cast<double>(_resync_ticks);
+    double slewed = rate + (static_cast<double>(mono) - static_cast<double>(est)) / interval;
+    if (slewed < rate / 2)
+      slewed = rate / 2;
+    if (slewed > rate * 2)
+      slewed = rate * 2;
+    store(tsc, est, static_cast<std::uint64_t>(slewed * static_cast<double>(1ull << kShift)));
+  }
+
+  // Cheap check intended for a loop that is about to idle: resyncs roughly once per second.
+  // Safe to call from several threads; only one performs each resync.
+  bool maybe_resync() noexcept
+  {
+    if (_source != Source::Tsc)
+      return false;
+    const std::uint64_t tsc = read_tsc();
+    std::uint64_t due = _next_resync_tsc.load(std::memory_order_relaxed);
+    if (tsc < due ||
+        !_next_resync_tsc.compare_exchange_strong(due, tsc + _resync_ticks,
+                                                  std::memory_order_relaxed))
+      return false;
+    resync();
+    return true;
+  }
+};
+
+// Process-wide clock, calibrated on first use.
+inline TscClock &instance() noexcept
+{
+  static TscClock clock;
+  return clock;
+}
+} // namespace hft::clock
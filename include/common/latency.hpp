@@ -0,0 +1,169 @@
+#pragma once
+
+#include "logging.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <bit>
+
+// Latency recording for the order path. Commands and execs carry LatencyStamps (see order.hpp);
+// whichever thread observes the end of a hop records the span into that hop's histogram. Each
+// histogram has exactly one writer, so recording is a handful of relaxed loads and stores with no
+// read-modify-write, and any thread may read a consistent-enough snapshot at shutdown.
+namespace hft::latency
+{
+// HDR-style log-bucketed histogram: values below 2^kSubBits are exact, larger values fall in one of
+// 2^kSubBits linear sub-buckets per power of two, so the relative error stays under 1/2^kSubBits
+// (~6%) across the whole u64 range with a fixed ~8KB footprint.
+class Histogram
+{
+public:
+  static constexpr unsigned kSubBits = 4;
+  static constexpr u64 kSubCount = u64{1} << kSubBits;
+  static constexpr std::size_t kBuckets = (64 - kSubBits + 1) * kSubCount;
+
+private:
+  std::atomic<u64> _buckets[kBuckets]{};
+  std::atomic<u64> _count{0};
+  std::atomic<u64> _sum{0};
+  std::atomic<u64> _max{0};
+
+  static void bump(std::atomic<u64> &a, u64 by) noexcept
+  {
+    a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+  }
+
+public:
+  static constexpr std::size_t bucket_of(u64 v) noexcept
+  {
+    if (v < kSubCount)
+      return static_cast<std::size_t>(v);
+    const unsigned msb = 63u - static_cast<unsigned>(std::countl_zero(v));
+    const unsigned shift = msb - kSubBits;
+    return static_cast<std::size_t>((shift + 1) * kSubCount + ((v >> shift) & (kSubCount - 1)));
+  }
+
+  // Highest value that maps to bucket i; percentiles report this so they never under-state.
+  static constexpr u64 bucket_high(std::size_t i) noexcept
+  {
+    if (i < kSubCount)
+      return i;
+    const unsigned shift = static_cast<unsigned>(i / kSubCount) - 1;
+    const u64 low = (kSubCount + i % kSubCount) << shift;
+    return low + ((u64{1} << shift) - 1);
+  }
+
+  // Single writer only.
+  void record(u64 v) noexcept
+  {
+    bump(_buckets[bucket_of(v)], 1);
+    bump(_count, 1);
+    bump(_sum, v);
+    if (v > _max.load(std::memory_order_relaxed))
+      _max.store(v, std::memory_order_relaxed);
+  }
+
+  u64 count() const noexcept
+  {
+    return _count.load(std::memory_order_relaxed);
+  }
+
+  u64 max() const noexcept
+  {
+    return _max.load(std::memory_order_relaxed);
+  }
+
+  double mean() const noexcept
+  {
+    const u64 n = count();
+    return n == 0 ? 0.0
+                  : static_cast<double>(_sum.load(std::memory_order_relaxed)) /
+                        static_cast<double>(n);
+  }
+
+  // Value at quantile q in [0, 1], e.g. 0.999 for p99.9. Clamped to the recorded max.
+  u64 percentile(double q) const noexcept
+  {
+    const u64 n = count();
+    if (n == 0)
+      return 0;
+    u64 rank = static_cast<u64>(q * static_cast<double>(n) + 0.5);
+    rank = rank == 0 ? 1 : (rank > n ? n : rank);
+    u64 seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i)
+    {
+      seen += _buckets[i].load(std::memory_order_relaxed);
+      if (seen >= rank)
+      {
+        const u64 hi = bucket_high(i);
+        return hi < max() ? hi : max();
+      }
+    }
+    return max();
+  }
+};
+
+// Hops along the strategy -> engine -> strategy path.
+enum class Hop : u8
+{
+  CmdQueue = 0,   // strategy push -> engine pop (engine thread records)
+  Match = 1,      // engine pop -> command fully processed (engine thread)
+  ExecQueue = 2,  // engine publishes an exec -> consumer pops it (exec consumer thread)
+  TickToTrade = 3 // market data the strategy acted on -> its order reaching the engine (engine)
+};
+
+inline constexpr std::size_t kHopCount = 4;
+
+inline const char *to_string(Hop h) noexcept
+{
+  switch (h)
+  {
+  case Hop::CmdQueue:
+    return "cmd_queue";
+  case Hop::Match:
+    return "match";
+  case Hop::ExecQueue:
+    return "exec_queue";
+  case Hop::TickToTrade:
+    return "tick_to_trade";
+  }
+  return "unknown";
+}
+
+// One histogram per hop. The writer of each hop is fixed by the table above.
+class Tracer
+{
+  Histogram _hops[kHopCount];
+
+public:
+  // Record the span from..to. Unset (zero) stamps and reversed spans are ignored rather than
+  // recorded as garbage.
+  void record(Hop h, u64 from_ns, u64 to_ns) noexcept
+  {
+    if (from_ns != 0 && to_ns >= from_ns)
+      _hops[static_cast<std::size_t>(h)].record(to_ns - from_ns);
+  }
+
+  const Histogram &histogram(Hop h) const noexcept
+  {
+    return _hops[static_cast<std::size_t>(h)];
+  }
+
+  // Log count, p50/p99/p99.9 and max for every hop that saw samples.
+  void dump() const
+  {
+    for (std::size_t i = 0; i < kHopCount; ++i)
+    {
+      const Histogram &h = _hops[i];
+      if (h.count() == 0)
+        continue;
+      HFT_INFO("latency %-13s n=%llu p50=%llu p99=%llu p99.9=%llu max=%llu ns",
+               to_string(static_cast<Hop>(i)), static_cast<unsigned long long>(h.count()),
+               static_cast<unsigned long long>(h.percentile(0.50)),
+               static_cast<unsigned long long>(h.percentile(0.99)),
+               static_cast<unsigned long long>(h.percentile(0.999)),
+               static_cast<unsigned long long>(h.max()));
+    }
+  }
+};
+} // namespace hft::latency
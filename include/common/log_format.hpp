@@ -0,0 +1,496 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary log records and the printf-compatible formatter that turns them back into text.
+// Hot threads never format: they copy the call-site id, a timestamp and the raw argument values
+// into a fixed-size LogRecord. The background writer (or the offline decoder) replays the format
+// string against those values later.
+//
+// Binary log file layout (host byte order, written by Logger in binary mode):
+//   "HFTBLOG1"                                    file magic
+//   then a stream of frames, each starting with a LogFrame tag byte:
+//     Site   u32 id, u8 level, u16 len, len bytes  format string, emitted before its first record
+//     Record sizeof(LogRecord) bytes               one log call
+//     Drops  u32 thread, u64 count                 records lost because a thread buffer was full
+namespace hft
+{
+enum class LogLevel : u8
+{
+  Info = 0,
+  Warn = 1,
+  Error = 2
+};
+
+inline const char *to_string(LogLevel l) noexcept
+{
+  switch (l)
+  {
+  case LogLevel::Info:
+    return "INFO";
+  case LogLevel::Warn:
+    return "WARN";
+  case LogLevel::Error:
+    return "ERROR";
+  }
+  return "?";
+}
+
+inline constexpr char kLogFileMagic[8] = {'H', 'F', 'T', 'B', 'L', 'O', 'G', '1'};
+
+enum class LogFrame : u8
+{
+  Site = 1,
+  Record = 2,
+  Drops = 3
+};
+
+// Tag preceding every encoded argument.
+enum class LogArg : u8
+{
+  I64 = 1,
+  U64 = 2,
+  F64 = 3,
+  Str = 4, // u8 length + bytes, truncated to fit the record
+  Ptr = 5
+};
+
+// One log call. Two cache lines so a per-thread ring of them stays cheap to copy.
+struct LogRecord
+{
+  static constexpr std::size_t kPayload = 112;
+  u32 site{0};      // call-site id (format string + level)
+  u8 nargs{0};      // number of arguments actually encoded
+  u8 truncated{0};  // 1 when arguments did not fit into the payload
+  u16 used{0};      // payload bytes in use
+  u64 ts_ns{0};     // capture time
+  std::byte payload[kPayload];
+};
+static_assert(sizeof(LogRecord) == 128, "LogRecord should stay two cache lines");
+
+// Argument positions a "%.*s" conversion reads as a string bounded by the argument before it: bit
+// i set means argument i. Such a string (a string_view slice, say) need not be NUL-terminated.
+// Scanned once per call site, not per call. Positions past 63 are not tracked.
+inline u64 bounded_string_args(const char *fmt) noexcept
+{
+  u64 mask = 0;
+  u32 arg = 0;
+  while (*fmt != '\0')
+  {
+    if (*fmt++ != '%')
+      continue;
+    if (*fmt == '%')
+    {
+      ++fmt;
+      continue;
+    }
+    while (*fmt != '\0' && std::strchr("-+ #0", *fmt) != nullptr)
+      ++fmt;
+    if (*fmt == '*')
+    {
+      ++fmt;
+      ++arg;
+    }
+    while (*fmt >= '0' && *fmt <= '9')
+      ++fmt;
+    bool star_precision = false;
+    if (*fmt == '.')
+    {
+      ++fmt;
+      if (*fmt == '*')
+      {
+        ++fmt;
+        ++arg;
+        star_precision = true;
+      }
+      while (*fmt >= '0' && *fmt <= '9')
+        ++fmt;
+    }
+    while (*fmt != '\0' && std::strchr("hljztL", *fmt) != nullptr)
+      ++fmt;
+    if (*fmt == '\0')
+      break;
+    if (*fmt++ == 's' && star_precision && arg < 64)
+      mask |= u64{1} << arg;
+    ++arg;
+  }
+  return mask;
+}
+
+// Appends raw argument values to a record. Everything is copied by value; strings are copied up
+// to their terminating NUL (or the remaining space) since the caller's buffer may not outlive the
+// call. A string marked in `bounded` (see bounded_string_args) stops at the precision passed just
+// before it instead, so a slice is never read past its end.
+class LogArgWriter
+{
+  LogRecord &_r;
+  u64 _bounded;
+  u32 _arg{0};                  // position of the next argument
+  std::size_t _limit{SIZE_MAX}; // the previous argument, as a "%.*s" precision
+
+  bool reserve(std::size_t n) noexcept
+  {
+    if (_r.used + n > LogRecord::kPayload)
+    {
+      _r.truncated = 1;
+      return false;
+    }
+    return true;
+  }
+
+  template <typename V> void put(LogArg tag, V v) noexcept
+  {
+    if (!reserve(1 + sizeof(V)))
+      return;
+    _r.payload[_r.used] = static_cast<std::byte>(tag);
+    std::memcpy(&_r.payload[_r.used + 1], &v, sizeof(V));
+    _r.used = static_cast<u16>(_r.used + 1 + sizeof(V));
+    ++_r.nargs;
+  }
+
+  void put_str(const char *s, std::size_t max_len) noexcept
+  {
+    if (s == nullptr)
+      s = "(null)";
+    if (_r.truncated || !reserve(2))
+      return;
+    std::size_t room = LogRecord::kPayload - _r.used - 2;
+    if (room > 255)
+      room = 255;
+    if (room > max_len)
+      room = max_len;
+    // Copy while scanning for the NUL so we never read past the caller's string.
+    std::byte *dst = &_r.payload[_r.used + 2];
+    std::size_t n = 0;
+    for (; n < room && s[n] != '\0'; ++n)
+      dst[n] = static_cast<std::byte>(s[n]);
+    _r.payload[_r.used] = static_cast<std::byte>(LogArg::Str);
+    _r.payload[_r.used + 1] = static_cast<std::byte>(n);
+    _r.used = static_cast<u16>(_r.used + 2 + n);
+    ++_r.nargs;
+  }
+
+  template <typename T> void put_value(const T &v, bool bounded) noexcept
+  {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same_v<D, char *> || std::is_same_v<D, const char *>)
+      put_str(v, bounded ? _limit : SIZE_MAX);
+    else if constexpr (std::is_floating_point_v<D>)
+      put(LogArg::F64, static_cast<double>(v));
+    else if constexpr (std::is_enum_v<D>)
+      put_value(static_cast<std::underlying_type_t<D>>(v), false);
+    else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>)
+      put(LogArg::I64, static_cast<i64>(v));
+    else if constexpr (std::is_integral_v<D>)
+      put(LogArg::U64, static_cast<u64>(v));
+    else if constexpr (std::is_pointer_v<D>)
+      put(LogArg::Ptr, reinterpret_cast<u64>(v));
+    else
+      static_assert(std::is_pointer_v<D>, "unsupported log argument type");
+  }
+
+public:
+  explicit LogArgWriter(LogRecord &r, u64 bounded = 0) noexcept : _r(r), _bounded(bounded) {}
+
+  template <typename T> void add(const T &v) noexcept
+  {
+    using D = std::decay_t<T>;
+    const u32 i = _arg++;
+    const bool bounded = i < 64 && ((_bounded >> i) & 1) != 0;
+    if (!_r.truncated)
+      put_value(v, bounded);
+    // A negative precision means none, as in printf.
+    if constexpr (std::is_integral_v<D> && std::is_signed_v<D>)
+      _limit = v < 0 ? SIZE_MAX : static_cast<std::size_t>(v);
+    else if constexpr (std::is_integral_v<D>)
+      _limit = static_cast<std::size_t>(v);
+    else
+      _limit = SIZE_MAX;
+  }
+};
+
+// Sequential reader over an encoded payload.
+class LogArgReader
+{
+  const std::byte *_p;
+  std::size_t _len;
+  std::size_t _pos{0};
+
+public:
+  struct Value
+  {
+    LogArg tag{};
+    i64 i{0};
+    u64 u{0};
+    double f{0};
+    char s[256]{};
+    bool present{false};
+  };
+
+  LogArgReader(const std::byte *p, std::size_t len) noexcept : _p(p), _len(len) {}
+
+  bool next(Value &v) noexcept
+  {
+    v.present = false;
+    if (_pos >= _len)
+      return false;
+    v.tag = static_cast<LogArg>(_p[_pos++]);
+    if (v.tag == LogArg::Str)
+    {
+      if (_pos >= _len)
+        return false;
+      const std::size_t n = static_cast<std::size_t>(_p[_pos++]);
+      if (_pos + n > _len)
+        return false;
+      std::memcpy(v.s, &_p[_pos], n);
+      v.s[n] = '\0';
+      _pos += n;
+    }
+    else
+    {
+      if (_pos + 8 > _len)
+        return false;
+      std::memcpy(&v.u, &_p[_pos], 8);
+      _pos += 8;
+      std::memcpy(&v.i, &v.u, 8);
+      std::memcpy(&v.f, &v.u, 8);
+      // Make the numeric views agree so a %d given a double (or vice versa) still prints sanely.
+      if (v.tag == LogArg::F64)
+      {
+        v.i = static_cast<i64>(v.f);
+        v.u = static_cast<u64>(v.i);
+      }
+      else if (v.tag == LogArg::I64)
+        v.f = static_cast<double>(v.i);
+      else
+        v.f = static_cast<double>(v.u);
+    }
+    v.present = true;
+    return true;
+  }
+};
+
+// Render `fmt` against encoded arguments into `out` (always NUL-terminated). Supports the usual
+// printf conversions, flags, width and precision including '*'. Length modifiers are accepted and
+// normalised because arguments were widened to 64 bits on capture. Missing arguments print "<?>".
+inline std::size_t format_log(const char *fmt, const std::byte *payload, std::size_t len,
+                              char *out, std::size_t cap) noexcept
+{
+  if (cap == 0)
+    return 0;
+  std::size_t n = 0;
+  auto put = [&](const char *s, std::size_t k)
+  {
+    if (n + k >= cap)
+      k = cap - 1 - n;
+    std::memcpy(out + n, s, k);
+    n += k;
+  };
+
+  LogArgReader rd(payload, len);
+  LogArgReader::Value v;
+  char spec[48];
+  char tmp[320];
+  while (*fmt != '\0')
+  {
+    if (*fmt != '%')
+    {
+      const char *lit = fmt;
+      while (*fmt != '\0' && *fmt != '%')
+        ++fmt;
+      put(lit, static_cast<std::size_t>(fmt - lit));
+      continue;
+    }
+    if (fmt[1] == '%')
+    {
+      put("%", 1);
+      fmt += 2;
+      continue;
+    }
+
+    // Rebuild the conversion spec with '*' resolved and the length modifier normalised.
+    std::size_t sp = 0;
+    spec[sp++] = *fmt++;
+    auto spec_int = [&](i64 x)
+    {
+      const int k =
+          std::snprintf(spec + sp, sizeof(spec) - sp - 4, "%lld", static_cast<long long>(x));
+      if (k > 0)
+        sp += static_cast<std::size_t>(k);
+    };
+    while (*fmt != '\0' && std::strchr("-+ #0", *fmt) != nullptr && sp < 8)
+      spec[sp++] = *fmt++;
+    if (*fmt == '*')
+    {
+      ++fmt;
+      spec_int(rd.next(v) ? v.i : 0);
+    }
+    while (*fmt >= '0' && *fmt <= '9' && sp < 24)
+      spec[sp++] = *fmt++;
+    if (*fmt == '.')
+    {
+      spec[sp++] = *fmt++;
+      if (*fmt == '*')
+      {
+        ++fmt;
+        spec_int(rd.next(v) ? v.i : 0);
+      }
+      while (*fmt >= '0' && *fmt <= '9' && sp < 40)
+        spec[sp++] = *fmt++;
+    }
+    while (*fmt != '\0' && std::strchr("hljztL", *fmt) != nullptr)
+      ++fmt;
+    const char conv = *fmt;
+    if (conv == '\0')
+      break;
+    ++fmt;
+
+    if (!rd.next(v))
+    {
+      put("<?>", 3);
+      continue;
+    }
+    int k = 0;
+    switch (conv)
+    {
+    case 'd':
+    case 'i':
+      spec[sp++] = 'l';
+      spec[sp++] = 'l';
+      spec[sp++] = 'd';
+      spec[sp] = '\0';
+      k = std::snprintf(tmp, sizeof(tmp), spec, static_cast<long long>(v.i));
+      break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+      spec[sp++] = 'l';
+      spec[sp++] = 'l';
+      spec[sp++] = conv;
+      spec[sp] = '\0';
+      k = std::snprintf(tmp, sizeof(tmp), spec, static_cast<unsigned long long>(v.u));
+      break;
+    case 'c':
+      spec[sp++] = 'c';
+      spec[sp] = '\0';
+      k = std::snprintf(tmp, sizeof(tmp), spec, static_cast<int>(v.i));
+      break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      spec[sp++] = conv;
+      spec[sp] = '\0';
+      k = std::snprintf(tmp, sizeof(tmp), spec, v.f);
+      break;
+    case 's':
+      spec[sp++] = 's';
+      spec[sp] = '\0';
+      k = std::snprintf(tmp, sizeof(tmp), spec, v.tag == LogArg::Str ? v.s : "<?>");
+      break;
+    case 'p':
+      spec[sp++] = 'p';
+      spec[sp] = '\0';
+      k = std::snprintf(tmp, sizeof(tmp), spec, reinterpret_cast<void *>(v.u));
+      break;
+    default:
+      tmp[0] = '%';
+      tmp[1] = conv;
+      k = 2;
+      break;
+    }
+    if (k > 0)
+      put(tmp, static_cast<std::size_t>(k) < sizeof(tmp) ? static_cast<std::size_t>(k)
+                                                          : sizeof(tmp) - 1);
+  }
+  out[n] = '\0';
+  return n;
+}
+
+// Convert a binary log file to text lines ("LEVEL [ts] message"). Returns the number of records
+// decoded, or -1 when the input is not a binary log.
+inline long decode_log_file(std::FILE *in, std::FILE *out)
+{
+  char magic[sizeof(kLogFileMagic)];
+  if (std::fread(magic, 1, sizeof(magic), in) != sizeof(magic) ||
+      std::memcmp(magic, kLogFileMagic, sizeof(magic)) != 0)
+    return -1;
+
+  // Site table indexed by id; this is a cold tool path so plain containers are fine.
+  std::vector<std::string> fmts;
+  std::vector<LogLevel> levels;
+  std::vector<bool> known;
+
+  long records = 0;
+  char line[1024];
+  int tag = 0;
+  while ((tag = std::fgetc(in)) != EOF)
+  {
+    switch (static_cast<LogFrame>(tag))
+    {
+    case LogFrame::Site:
+    {
+      u32 id = 0;
+      u8 level = 0;
+      u16 len = 0;
+      if (std::fread(&id, sizeof(id), 1, in) != 1 || std::fread(&level, 1, 1, in) != 1 ||
+          std::fread(&len, sizeof(len), 1, in) != 1)
+        return records;
+      std::string fmt(len, '\0');
+      if (std::fread(fmt.data(), 1, len, in) != len)
+        return records;
+      if (id >= fmts.size())
+      {
+        fmts.resize(id + 1u);
+        levels.resize(id + 1u);
+        known.resize(id + 1u);
+      }
+      fmts[id] = std::move(fmt);
+      levels[id] = static_cast<LogLevel>(level);
+      known[id] = true;
+      break;
+    }
+    case LogFrame::Record:
+    {
+      LogRecord r{};
+      if (std::fread(&r, sizeof(r), 1, in) != 1)
+        return records;
+      const bool have = r.site < known.size() && known[r.site];
+      const char *fmt = have ? fmts[r.site].c_str() : "<unknown site>";
+      format_log(fmt, r.payload, r.used, line, sizeof(line));
+      std::fprintf(out, "%s [%llu] %s%s\n", have ? to_string(levels[r.site]) : "?",
+                   static_cast<unsigned long long>(r.ts_ns), line,
+                   r.truncated ? " <truncated>" : "");
+      ++records;
+      break;
+    }
+    case LogFrame::Drops:
+    {
+      u32 thread = 0;
+      u64 count = 0;
+      if (std::fread(&thread, sizeof(thread), 1, in) != 1 ||
+          std::fread(&count, sizeof(count), 1, in) != 1)
+        return records;
+      std::fprintf(out, "WARN [-] log buffer of thread %u dropped %llu records\n", thread,
+                   static_cast<unsigned long long>(count));
+      break;
+    }
+    default:
+      return records; // corrupt or truncated tail
+    }
+  }
+  return records;
+}
+} // namespace hft
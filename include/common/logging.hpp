@@ -1,30 +1,350 @@
 #pragma once
 
+#include "log_format.hpp"
+#include "spsc_queue.hpp"
 #include "types.hpp"
+#include "wait_strategy.hpp"
 
+#include <atomic>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace hft
 {
-// Very small logging helper. Avoids iostreams for lower overhead and less hidden locks.
-// Designed for educational purposes: it keeps formatting familiar while staying close to C APIs.
-// Serious deployments would push logs into per-thread buffers and write asynchronously.
+// Very small synchronous logging helper. Avoids iostreams for lower overhead and less hidden
+// locks. The line is formatted into a local buffer first so concurrent writers do not interleave.
+// Used before the async Logger starts (and after it stops) so early and late messages still land.
 inline void log(const char *lvl, const char *fmt, ...) noexcept
 {
+  char line[1024];
+  int n = std::snprintf(line, sizeof(line), "%s [%llu] ", lvl,
+                        static_cast<unsigned long long>(now_ns()));
+  if (n < 0)
+    return;
   std::va_list args;
   va_start(args, fmt);
-  std::fputs(lvl, stderr);
-  std::fputc(' ', stderr);
-  std::fprintf(stderr, "[%llu] ", static_cast<unsigned long long>(now_ns()));
-  std::vfprintf(stderr, fmt, args);
-  std::fputc('\n', stderr);
+  const int m = std::vsnprintf(line + n, sizeof(line) - static_cast<std::size_t>(n), fmt, args);
   va_end(args);
+  n = m < 0 ? n : n + m;
+  if (static_cast<std::size_t>(n) >= sizeof(line) - 1)
+    n = static_cast<int>(sizeof(line) - 2);
+  line[n] = '\n';
+  std::fwrite(line, 1, static_cast<std::size_t>(n) + 1, stderr);
 }
-// Convenience macros to match typical logging ergonomics (INFO/WARN/ERROR).
-// They expand to simple printf-style calls keeping call sites compact.
-#define HFT_INFO(fmt, ...) ::hft::log("INFO", fmt, ##__VA_ARGS__)
-#define HFT_WARN(fmt, ...) ::hft::log("WARN", fmt, ##__VA_ARGS__)
-#define HFT_ERROR(fmt, ...) ::hft::log("ERROR", fmt, ##__VA_ARGS__)
+
+struct LogConfig
+{
+  bool binary{false};       // binary records (decode with hft_log_decode) instead of text
+  const char *path{nullptr}; // output file; nullptr means stderr (text mode only)
+  u64 flush_interval_ns{1'000'000}; // how long the writer sleeps when every buffer is empty
+};
+
+// Asynchronous logger. Hot threads encode a LogRecord (site id, timestamp, raw arguments) into
+// their own SPSC ring; a background thread drains every ring, formats or writes the binary
+// records, and reports records dropped because a ring was full. Nothing on the calling thread
+// takes a lock or makes a syscall once its ring exists.
+class Logger
+{
+public:
+  static constexpr u32 kMaxSites = 4096;
+  static constexpr u32 kMaxThreads = 64;
+  static constexpr u32 kInvalidSite = ~u32{0};
+
+private:
+  struct Site
+  {
+    LogLevel level;
+    const char *fmt;  // string literal from the call site, lives for the whole program
+    u64 bounded_strs; // "%.*s" arguments (see bounded_string_args)
+  };
+
+  struct ThreadBuffer
+  {
+    spsc::Queue<LogRecord, 1 << 10> ring;
+    std::atomic<u64> dropped{0}; // written by the owning thread only
+    u64 reported{0};             // drops already reported, writer thread only
+  };
+
+  // Call sites and thread buffers are registered under the mutex (cold path) and published with
+  // a release store of the count, so the writer thread can read them without locking.
+  std::mutex _mu;
+  Site _sites[kMaxSites]{};
+  std::atomic<u32> _nsites{0};
+  ThreadBuffer *_buffers[kMaxThreads]{};
+  std::atomic<u32> _nbuffers{0};
+
+  const u64 _instance; // distinguishes loggers for the per-thread buffer cache
+  LogConfig _cfg{};
+  std::FILE *_out{nullptr};
+  bool _site_written[kMaxSites]{}; // binary mode: Site frame already emitted
+  std::atomic<bool> _running{false};
+  wait::EventCount _wake;
+  std::thread _worker;
+
+  static u64 next_instance() noexcept
+  {
+    static std::atomic<u64> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  ThreadBuffer *local_buffer()
+  {
+    struct Cache
+    {
+      u64 instance{0};
+      ThreadBuffer *buf{nullptr};
+    };
+    thread_local Cache cache;
+    if (cache.instance == _instance)
+      return cache.buf;
+
+    std::lock_guard<std::mutex> lock(_mu);
+    const u32 n = _nbuffers.load(std::memory_order_relaxed);
+    if (n == kMaxThreads)
+      return nullptr;
+    _buffers[n] = new ThreadBuffer();
+    _nbuffers.store(n + 1, std::memory_order_release);
+    cache = Cache{_instance, _buffers[n]};
+    return cache.buf;
+  }
+
+  template <typename... Args>
+  void write_sync(LogLevel level, const char *fmt, const Args &...args) noexcept
+  {
+    log(to_string(level), fmt, args...);
+  }
+
+  void emit(const LogRecord &r)
+  {
+    const Site &site = _sites[r.site];
+    if (_cfg.binary)
+    {
+      if (!_site_written[r.site])
+      {
+        const std::size_t len = std::strlen(site.fmt);
+        const u16 len16 = static_cast<u16>(len > 0xFFFF ? 0xFFFF : len);
+        const u8 tag = static_cast<u8>(LogFrame::Site);
+        const u8 level = static_cast<u8>(site.level);
+        std::fwrite(&tag, 1, 1, _out);
+        std::fwrite(&r.site, sizeof(r.site), 1, _out);
+        std::fwrite(&level, 1, 1, _out);
+        std::fwrite(&len16, sizeof(len16), 1, _out);
+        std::fwrite(site.fmt, 1, len16, _out);
+        _site_written[r.site] = true;
+      }
+      const u8 tag = static_cast<u8>(LogFrame::Record);
+      std::fwrite(&tag, 1, 1, _out);
+      std::fwrite(&r, sizeof(r), 1, _out);
+      return;
+    }
+    char line[1024];
+    const int n = std::snprintf(line, sizeof(line), "%s [%llu] ", to_string(site.level),
+                                static_cast<unsigned long long>(r.ts_ns));
+    std::size_t len = static_cast<std::size_t>(n);
+    len += format_log(site.fmt, r.payload, r.used, line + len, sizeof(line) - len - 1);
+    line[len++] = '\n';
+    std::fwrite(line, 1, len, _out);
+  }
+
+  void report_drops(u32 thread, ThreadBuffer &b)
+  {
+    const u64 dropped = b.dropped.load(std::memory_order_relaxed);
+    if (dropped == b.reported)
+      return;
+    const u64 delta = dropped - b.reported;
+    b.reported = dropped;
+    if (_cfg.binary)
+    {
+      const u8 tag = static_cast<u8>(LogFrame::Drops);
+      std::fwrite(&tag, 1, 1, _out);
+      std::fwrite(&thread, sizeof(thread), 1, _out);
+      std::fwrite(&delta, sizeof(delta), 1, _out);
+    }
+    else
+    {
+      std::fprintf(_out, "WARN [%llu] log buffer of thread %u dropped %llu records\n",
+                   static_cast<unsigned long long>(now_ns()), thread,
+                   static_cast<unsigned long long>(delta));
+    }
+  }
+
+  // One pass over every thread ring. Returns the number of records written.
+  std::size_t drain()
+  {
+    std::size_t written = 0;
+    const u32 n = _nbuffers.load(std::memory_order_acquire);
+    LogRecord r;
+    for (u32 i = 0; i < n; ++i)
+    {
+      ThreadBuffer &b = *_buffers[i];
+      while (b.ring.pop(r))
+      {
+        emit(r);
+        ++written;
+      }
+      report_drops(i, b);
+    }
+    return written;
+  }
+
+  void run()
+  {
+    while (_running.load(std::memory_order_acquire))
+    {
+      if (drain() > 0)
+        continue;
+      std::fflush(_out);
+      const u32 key = _wake.prepare_wait();
+      if (!_running.load(std::memory_order_acquire))
+      {
+        _wake.cancel_wait();
+        break;
+      }
+      _wake.wait(key, _cfg.flush_interval_ns);
+    }
+    // Final drain: producers may have written right up to stop().
+    drain();
+    std::fflush(_out);
+  }
+
+public:
+  Logger() : _instance(next_instance()) {}
+  Logger(const Logger &) = delete;
+  Logger &operator=(const Logger &) = delete;
+
+  ~Logger()
+  {
+    stop();
+    for (u32 i = 0; i < _nbuffers.load(std::memory_order_relaxed); ++i)
+      delete _buffers[i];
+  }
+
+  // Process-wide logger used by the HFT_* macros.
+  static Logger &instance()
+  {
+    static Logger logger;
+    return logger;
+  }
+
+  // Register a call site once (the macros cache the id in a function-local static).
+  u32 register_site(LogLevel level, const char *fmt)
+  {
+    std::lock_guard<std::mutex> lock(_mu);
+    const u32 n = _nsites.load(std::memory_order_relaxed);
+    if (n == kMaxSites)
+      return kInvalidSite;
+    _sites[n] = Site{level, fmt, bounded_string_args(fmt)};
+    _nsites.store(n + 1, std::memory_order_release);
+    return n;
+  }
+
+  // Start the background writer. Until this is called the macros log synchronously to stderr.
+  bool start(const LogConfig &cfg = {})
+  {
+    if (_running.load(std::memory_order_acquire))
+      return false;
+    _cfg = cfg;
+    if (cfg.path != nullptr)
+      _out = std::fopen(cfg.path, cfg.binary ? "wb" : "w");
+    else
+      _out = cfg.binary ? nullptr : stderr;
+    if (_out == nullptr)
+    {
+      log("ERROR", "logger: cannot open '%s'", cfg.path ? cfg.path : "(binary needs a path)");
+      return false;
+    }
+    if (cfg.binary)
+      std::fwrite(kLogFileMagic, 1, sizeof(kLogFileMagic), _out);
+    for (bool &w : _site_written)
+      w = false;
+    _running.store(true, std::memory_order_release);
+    _worker = std::thread([this] { run(); });
+    return true;
+  }
+
+  // Stop the writer after draining every buffer. Later log calls fall back to synchronous output.
+  void stop()
+  {
+    if (!_running.exchange(false, std::memory_order_acq_rel))
+      return;
+    _wake.notify();
+    if (_worker.joinable())
+      _worker.join();
+    if (_out != nullptr && _out != stderr)
+      std::fclose(_out);
+    _out = nullptr;
+  }
+
+  bool running() const noexcept
+  {
+    return _running.load(std::memory_order_acquire);
+  }
+
+  // Total records dropped across all thread buffers so far.
+  u64 dropped() const noexcept
+  {
+    u64 total = 0;
+    const u32 n = _nbuffers.load(std::memory_order_acquire);
+    for (u32 i = 0; i < n; ++i)
+      total += _buffers[i]->dropped.load(std::memory_order_relaxed);
+    return total;
+  }
+
+  template <typename... Args> void write(u32 site, const char *fmt, const Args &...args) noexcept
+  {
+    if (site == kInvalidSite)
+    {
+      write_sync(LogLevel::Error, fmt, args...);
+      return;
+    }
+    if (!_running.load(std::memory_order_relaxed))
+    {
+      write_sync(_sites[site].level, fmt, args...);
+      return;
+    }
+    ThreadBuffer *b = local_buffer();
+    if (b == nullptr)
+    {
+      write_sync(_sites[site].level, fmt, args...);
+      return;
+    }
+    LogRecord r;
+    r.site = site;
+    r.ts_ns = now_ns();
+    LogArgWriter w(r, _sites[site].bounded_strs);
+    (w.add(args), ...);
+    if (!b->ring.push(r))
+      b->dropped.store(b->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+};
+
+namespace detail
+{
+// Never called: lets the compiler check printf formats against the arguments at every call site.
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+inline void check_printf(const char *, ...) noexcept
+{
+}
+} // namespace detail
+
+// Convenience macros to match typical logging ergonomics (INFO/WARN/ERROR). The format string must
+// be a literal: each call site registers it once and afterwards only ships its id plus the raw
+// argument values to the background writer.
+#define HFT_LOG_AT(level, fmt, ...)                                                                \
+  do                                                                                               \
+  {                                                                                                \
+    static const ::hft::u32 hft_log_site_ = ::hft::Logger::instance().register_site(level, fmt);   \
+    if (false)                                                                                     \
+      ::hft::detail::check_printf(fmt, ##__VA_ARGS__);                                             \
+    ::hft::Logger::instance().write(hft_log_site_, fmt, ##__VA_ARGS__);                            \
+  } while (0)
+#define HFT_INFO(fmt, ...) HFT_LOG_AT(::hft::LogLevel::Info, fmt, ##__VA_ARGS__)
+#define HFT_WARN(fmt, ...) HFT_LOG_AT(::hft::LogLevel::Warn, fmt, ##__VA_ARGS__)
+#define HFT_ERROR(fmt, ...) HFT_LOG_AT(::hft::LogLevel::Error, fmt, ##__VA_ARGS__)
 } // namespace hft
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file, for parsers that decode records in place instead of
+// copying them out. The mapping is advised sequential; `populate` faults every page in up front so
+// a timed run measures parsing rather than page faults.
+namespace hft
+{
+class MappedFile
+{
+  const std::byte *_data{nullptr};
+  std::size_t _size{0};
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile()
+  {
+    close();
+  }
+
+  bool open(const char *path, bool populate = false)
+  {
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+      HFT_WARN("mmap: cannot open %s: %s", path, std::strerror(errno));
+      return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+    _size = static_cast<std::size_t>(st.st_size);
+    if (_size > 0)
+    {
+      int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+      if (populate)
+        flags |= MAP_POPULATE;
+#endif
+      void *p = ::mmap(nullptr, _size, PROT_READ, flags, fd, 0);
+      if (p == MAP_FAILED)
+      {
+        HFT_WARN("mmap: cannot map %s: %s", path, std::strerror(errno));
+        ::close(fd);
+        _size = 0;
+        return false;
+      }
+      ::madvise(p, _size, MADV_SEQUENTIAL);
+      _data = static_cast<const std::byte *>(p);
+    }
+    ::close(fd); // the mapping keeps the file referenced
+    return true;
+  }
+
+  void close() noexcept
+  {
+    if (_data != nullptr)
+      ::munmap(const_cast<std::byte *>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+  }
+
+  const std::byte *data() const noexcept
+  {
+    return _data;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return _size;
+  }
+};
+} // namespace hft
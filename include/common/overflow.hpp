@@ -0,0 +1,170 @@
+#pragma once
+
+#include "stats.hpp"
+#include "wait_strategy.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+// What a producer does when the queue in front of it is full. Producers push through a Writer,
+// which applies the queue's policy and counts what happened as "<name>.drops", "<name>.stalls",
+// "<name>.spilled" and the "<name>.spill_depth" gauge:
+//   Block -> spin, then yield, until the consumer frees a slot. Nothing is lost; the producer
+//            stalls for as long as the consumer does (including forever if it has stopped).
+//   Spill -> keep the element in a private FIFO and retry it, in order, before anything newer. The
+//            spill allocates, but only once the queue is already full. Past `spill_limit` elements
+//            the writer blocks instead.
+//   Drop  -> discard the new element and count it.
+// "Drop oldest" is not a Writer policy: for market data it is the broadcast ring's DropAndFlag
+// overrun policy, under which push never fails and lapped subscribers count their own losses.
+namespace hft::overflow
+{
+enum class Policy : u8
+{
+  Block = 0,
+  Spill = 1,
+  Drop = 2
+};
+
+inline const char *to_string(Policy p) noexcept
+{
+  switch (p)
+  {
+  case Policy::Block:
+    return "block";
+  case Policy::Spill:
+    return "spill";
+  case Policy::Drop:
+    return "drop";
+  }
+  return "unknown";
+}
+
+struct Config
+{
+  Policy policy{Policy::Spill};
+  std::size_t spill_limit{1 << 16}; // spilled elements before Spill falls back to Block
+  std::size_t high_water{0};        // queue depth at which saturated() trips; 0 = 3/4 capacity
+
+  bool operator==(const Config &) const = default;
+};
+
+// Single producer only, like the queue it wraps.
+template <typename Queue, typename T> class Writer
+{
+  Queue &_q;
+  Config _cfg;
+  std::deque<T> _spill;
+  stats::Counter _drops;
+  stats::Counter _stalls;
+  stats::Counter _spilled;
+  stats::Gauge _spill_depth;
+
+  static std::string stat_name(const char *prefix, const char *what)
+  {
+    return std::string(prefix) + "." + what;
+  }
+
+  template <typename Done> void stall(Done done)
+  {
+    _stalls.add();
+    wait::Waiter waiter(wait::WaitConfig{wait::WaitPolicy::SpinYield});
+    while (!done())
+      waiter.idle([] { return false; });
+  }
+
+  void spill(const T &v)
+  {
+    if (_spill.size() >= _cfg.spill_limit)
+      stall([this] { return flush() || _spill.size() < _cfg.spill_limit; });
+    _spill.push_back(v);
+    _spilled.add();
+    _spill_depth.set(_spill.size());
+  }
+
+public:
+  Writer(Queue &q, const char *name, Config cfg = {})
+      : _q(q), _drops(stats::counter(stat_name(name, "drops").c_str())),
+        _stalls(stats::counter(stat_name(name, "stalls").c_str())),
+        _spilled(stats::counter(stat_name(name, "spilled").c_str())),
+        _spill_depth(stats::gauge(stat_name(name, "spill_depth").c_str()))
+  {
+    set_config(cfg);
+  }
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  // Push under the configured policy. Returns false only when Drop discarded the element.
+  bool push(const T &v)
+  {
+    if (!_spill.empty() && !flush()) [[unlikely]]
+    {
+      spill(v); // anything newer queues behind what is already spilled
+      return true;
+    }
+    if (_q.push(v)) [[likely]]
+      return true;
+    switch (_cfg.policy)
+    {
+    case Policy::Block:
+      stall([&] { return _q.push(v); });
+      return true;
+    case Policy::Spill:
+      spill(v);
+      return true;
+    case Policy::Drop:
+      _drops.add();
+      return false;
+    }
+    return false;
+  }
+
+  // Move spilled elements into the queue while it has room. True once nothing is left spilled.
+  bool flush()
+  {
+    if (_spill.empty())
+      return true;
+    while (!_spill.empty() && _q.push(_spill.front()))
+      _spill.pop_front();
+    _spill_depth.set(_spill.size());
+    return _spill.empty();
+  }
+
+  // True when the consumer is falling behind: something is spilled or the queue is past its high
+  // water mark. Producers that can slow their own intake use this to do so.
+  bool saturated() const noexcept
+  {
+    return !_spill.empty() || _q.size() >= _cfg.high_water;
+  }
+
+  std::size_t spilled() const noexcept
+  {
+    return _spill.size();
+  }
+
+  const Config &config() const noexcept
+  {
+    return _cfg;
+  }
+
+  // Change the policy from the next push on; anything already spilled stays queued.
+  void set_config(Config cfg) noexcept
+  {
+    _cfg = cfg;
+    if (_cfg.high_water == 0)
+      _cfg.high_water = Queue::capacity() / 4 * 3;
+  }
+
+  void notify() noexcept
+  {
+    _q.notify();
+  }
+
+  Queue &queue() noexcept
+  {
+    return _q;
+  }
+};
+} // namespace hft::overflow
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "logging.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Hardware performance counters (cycles, instructions, L1D/LLC misses, branch misses) attributed
+// to phases of the engine loop. Built only with -DHFT_ENABLE_PERF_COUNTERS=ON, which defines
+// HFT_PERF_COUNTERS; otherwise HFT_PERF_ENTER/HFT_PERF_LEAVE expand to nothing and the engine
+// carries no counter state at all.
+//
+// Counters are per-thread (pid=0, cpu=-1) and user-space only. Where the kernel allows it they are
+// read with rdpmc through the perf mmap page (tens of cycles); otherwise with read(2). Phases nest:
+// time is charged to the innermost active phase, so "sim" excludes the matching it triggers.
+namespace hft::perf
+{
+enum class Phase : u8
+{
+  Other = 0, // loop overhead, polling and anything outside a named phase
+  Drain = 1, // popping commands off the strategy queue
+  Match = 2, // MatchingEngine::on_command
+  Sim = 3,   // simulator step (its matching is charged to Match)
+  Publish = 4
+};
+
+inline constexpr std::size_t kPhaseCount = 5;
+
+enum class Event : u8
+{
+  Cycles = 0,
+  Instructions = 1,
+  L1dMisses = 2,
+  LlcMisses = 3,
+  BranchMisses = 4
+};
+
+inline constexpr std::size_t kEventCount = 5;
+
+inline const char *to_string(Phase p) noexcept
+{
+  switch (p)
+  {
+  case Phase::Other:
+    return "other";
+  case Phase::Drain:
+    return "drain";
+  case Phase::Match:
+    return "match";
+  case Phase::Sim:
+    return "sim";
+  case Phase::Publish:
+    return "publish";
+  }
+  return "unknown";
+}
+
+// A group of kEventCount counters scheduled together on the calling thread.
+class CounterGroup
+{
+#if defined(__linux__)
+  int _fd[kEventCount]{-1, -1, -1, -1, -1};
+  perf_event_mmap_page *_page[kEventCount]{};
+#endif
+  bool _ok{false};
+
+#if defined(__linux__)
+  static int open_event(u32 type, u64 config, int group_fd) noexcept
+  {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    if (group_fd < 0)
+      attr.disabled = 1; // the leader starts disabled and is enabled once all members are open
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+  }
+
+  static u64 cache_config(u64 cache, u64 op, u64 result) noexcept
+  {
+    return cache | (op << 8) | (result << 16);
+  }
+
+  u64 read_one(std::size_t i) const noexcept
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    if (const perf_event_mmap_page *pc = _page[i]; pc != nullptr && pc->cap_user_rdpmc)
+    {
+      u32 seq = 0;
+      u64 value = 0;
+      do
+      {
+        seq = pc->lock;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        const u32 idx = pc->index;
+        value = static_cast<u64>(pc->offset);
+        if (idx == 0) // not currently on a hardware counter; ask the kernel
+          break;
+        const unsigned width = pc->pmc_width;
+        i64 pmc = static_cast<i64>(__rdpmc(static_cast<int>(idx - 1)));
+        pmc = static_cast<i64>(static_cast<u64>(pmc) << (64 - width)) >> (64 - width);
+        value += static_cast<u64>(pmc);
+        std::atomic_signal_fence(std::memory_order_acquire);
+        if (pc->lock == seq)
+          return value;
+      } while (true);
+    }
+#endif
+    u64 value = 0;
+    if (::read(_fd[i], &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+      return 0;
+    return value;
+  }
+#endif
+
+public:
+  CounterGroup() = default;
+  CounterGroup(const CounterGroup &) = delete;
+  CounterGroup &operator=(const CounterGroup &) = delete;
+
+  ~CounterGroup()
+  {
+    close();
+  }
+
+  // Open the counters on the calling thread. Returns false (and leaves the group inert) when the
+  // PMU is missing, e.g. in most VMs, or perf_event_paranoid forbids it.
+  bool open() noexcept
+  {
+#if defined(__linux__)
+    const u64 l1d = cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                 PERF_COUNT_HW_CACHE_RESULT_MISS);
+    const struct
+    {
+      u32 type;
+      u64 config;
+    } events[kEventCount] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, l1d},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    for (std::size_t i = 0; i < kEventCount; ++i)
+    {
+      _fd[i] = open_event(events[i].type, events[i].config, i == 0 ? -1 : _fd[0]);
+      if (_fd[i] < 0)
+      {
+        HFT_WARN("perf: counter %zu unavailable (no PMU access?); phase counters disabled", i);
+        close();
+        return false;
+      }
+      void *p = mmap(nullptr, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)), PROT_READ,
+                     MAP_SHARED, _fd[i], 0);
+      _page[i] = p == MAP_FAILED ? nullptr : static_cast<perf_event_mmap_page *>(p);
+    }
+    ioctl(_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    _ok = true;
+    return true;
+#else
+    HFT_WARN("perf: hardware counters need Linux perf_event_open; phase counters disabled");
+    return false;
+#endif
+  }
+
+  void close() noexcept
+  {
+#if defined(__linux__)
+    for (std::size_t i = 0; i < kEventCount; ++i)
+    {
+      if (_page[i] != nullptr)
+        munmap(_page[i], static_cast<std::size_t>(sysconf(_SC_PAGESIZE)));
+      if (_fd[i] >= 0)
+        ::close(_fd[i]);
+      _page[i] = nullptr;
+      _fd[i] = -1;
+    }
+#endif
+    _ok = false;
+  }
+
+  bool ok() const noexcept
+  {
+    return _ok;
+  }
+
+  void read(u64 (&out)[kEventCount]) const noexcept
+  {
+#if defined(__linux__)
+    if (_ok)
+    {
+      for (std::size_t i = 0; i < kEventCount; ++i)
+        out[i] = read_one(i);
+      return;
+    }
+#endif
+    for (u64 &v : out)
+      v = 0;
+  }
+};
+
+// Charges counter deltas to the innermost active phase. Owned and used by one thread.
+class PhaseCounters
+{
+  static constexpr std::size_t kMaxDepth = 8;
+
+  CounterGroup _group;
+  u64 _totals[kPhaseCount][kEventCount]{};
+  u64 _entries[kPhaseCount]{};
+  u64 _last[kEventCount]{};
+  Phase _stack[kMaxDepth]{};
+  std::size_t _depth{0}; // _stack[_depth] is the active phase; Other at the bottom
+  std::size_t _too_deep{0}; // enters ignored because the stack was full, so leaves stay paired
+
+  void charge() noexcept
+  {
+    u64 now[kEventCount];
+    _group.read(now);
+    u64 *t = _totals[static_cast<std::size_t>(_stack[_depth])];
+    for (std::size_t e = 0; e < kEventCount; ++e)
+    {
+      t[e] += now[e] - _last[e];
+      _last[e] = now[e];
+    }
+  }
+
+public:
+  // Open the counters on the calling thread (the thread that will enter/leave phases).
+  bool start() noexcept
+  {
+    if (!_group.open())
+      return false;
+    _group.read(_last);
+    return true;
+  }
+
+  bool ok() const noexcept
+  {
+    return _group.ok();
+  }
+
+  void enter(Phase p) noexcept
+  {
+    if (!_group.ok())
+      return;
+    if (_depth + 1 == kMaxDepth)
+    {
+      ++_too_deep;
+      return;
+    }
+    charge();
+    _stack[++_depth] = p;
+    ++_entries[static_cast<std::size_t>(p)];
+  }
+
+  void leave() noexcept
+  {
+    if (!_group.ok() || _depth == 0)
+      return;
+    if (_too_deep > 0)
+    {
+      --_too_deep;
+      return;
+    }
+    charge();
+    --_depth;
+  }
+
+  u64 total(Phase p, Event e) const noexcept
+  {
+    return _totals[static_cast<std::size_t>(p)][static_cast<std::size_t>(e)];
+  }
+
+  u64 entries(Phase p) const noexcept
+  {
+    return _entries[static_cast<std::size_t>(p)];
+  }
+
+  // Log per-phase totals plus per-command averages (commands = entries into Match).
+  void report() const
+  {
+    if (!_group.ok())
+      return;
+    const u64 commands = entries(Phase::Match);
+    const double per = commands == 0 ? 0.0 : 1.0 / static_cast<double>(commands);
+    for (std::size_t p = 0; p < kPhaseCount; ++p)
+    {
+      const u64 *t = _totals[p];
+      const double ipc = t[0] == 0 ? 0.0 : static_cast<double>(t[1]) / static_cast<double>(t[0]);
+      HFT_INFO("perf %-7s cycles=%llu instr=%llu ipc=%.2f l1d_miss=%llu llc_miss=%llu "
+               "br_miss=%llu",
+               to_string(static_cast<Phase>(p)), static_cast<unsigned long long>(t[0]),
+               static_cast<unsigned long long>(t[1]), ipc, static_cast<unsigned long long>(t[2]),
+               static_cast<unsigned long long>(t[3]), static_cast<unsigned long long>(t[4]));
+      HFT_INFO("perf %-7s per command: cycles=%.1f instr=%.1f l1d_miss=%.2f llc_miss=%.3f "
+               "br_miss=%.2f",
+               to_string(static_cast<Phase>(p)), static_cast<double>(t[0]) * per,
+               static_cast<double>(t[1]) * per, static_cast<double>(t[2]) * per,
+               static_cast<double>(t[3]) * per, static_cast<double>(t[4]) * per);
+    }
+    HFT_INFO("perf commands=%llu", static_cast<unsigned long long>(commands));
+  }
+};
+} // namespace hft::perf
+
+#if defined(HFT_PERF_COUNTERS)
+#define HFT_PERF_ENTER(counters, phase) (counters).enter(::hft::perf::Phase::phase)
+#define HFT_PERF_LEAVE(counters) (counters).leave()
+#else
+#define HFT_PERF_ENTER(counters, phase) ((void)0)
+#define HFT_PERF_LEAVE(counters) ((void)0)
+#endif
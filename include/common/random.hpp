@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+// Random numbers for simulation hot paths. Xoshiro256 runs kLanes independent xoshiro256++
+// generators (Blackman and Vigna) side by side and refills a buffer of kBatch numbers at a time.
+// The per-lane update is shifts, xors and adds over plain arrays, so the refill loop vectorises,
+// and a draw is usually just a load from the buffer. Every draw is specified bit for bit here,
+// with no std::*_distribution, so a seed gives the same numbers on every platform.
+namespace hft::rng
+{
+inline u64 splitmix64(u64 &x) noexcept
+{
+  u64 z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+class Xoshiro256
+{
+public:
+  static constexpr std::size_t kLanes = 8;
+  static constexpr std::size_t kBatch = 512; // numbers per refill, a multiple of kLanes
+
+private:
+  alignas(64) u64 _s0[kLanes];
+  alignas(64) u64 _s1[kLanes];
+  alignas(64) u64 _s2[kLanes];
+  alignas(64) u64 _s3[kLanes];
+  alignas(64) u64 _buf[kBatch];
+  std::size_t _pos{kBatch};
+
+  static constexpr u64 rotl(u64 x, int k) noexcept
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  // Buffer slot i * kLanes + l holds lane l's i-th output.
+  void refill() noexcept
+  {
+    for (std::size_t i = 0; i < kBatch; i += kLanes)
+    {
+      for (std::size_t l = 0; l < kLanes; ++l)
+      {
+        _buf[i + l] = rotl(_s0[l] + _s3[l], 23) + _s0[l];
+        const u64 t = _s1[l] << 17;
+        _s2[l] ^= _s0[l];
+        _s3[l] ^= _s1[l];
+        _s1[l] ^= _s2[l];
+        _s0[l] ^= _s3[l];
+        _s2[l] ^= t;
+        _s3[l] = rotl(_s3[l], 45);
+      }
+    }
+    _pos = 0;
+  }
+
+public:
+  // Lane l's four state words are splitmix64 outputs 4l .. 4l+3 from `seed`.
+  explicit Xoshiro256(u64 seed = 1) noexcept
+  {
+    for (std::size_t l = 0; l < kLanes; ++l)
+    {
+      _s0[l] = splitmix64(seed);
+      _s1[l] = splitmix64(seed);
+      _s2[l] = splitmix64(seed);
+      _s3[l] = splitmix64(seed);
+    }
+  }
+
+  u64 next() noexcept
+  {
+    if (_pos == kBatch)
+      refill();
+    return _buf[_pos++];
+  }
+
+  // Uniform in [0, 1), 53 bits.
+  double uniform() noexcept
+  {
+    return static_cast<double>(next() >> 11) * 0x1.0p-53;
+  }
+
+  bool chance(double p) noexcept
+  {
+    return uniform() < p;
+  }
+
+  // Uniform in [0, n) for n > 0, by multiply-shift on the top 32 bits (n well below 2^32).
+  u64 below(u64 n) noexcept
+  {
+    return ((next() >> 32) * n) >> 32;
+  }
+
+  // Waiting time of a Poisson process with `rate` events per unit.
+  double exponential(double rate) noexcept
+  {
+    return -std::log1p(-uniform()) / rate;
+  }
+};
+} // namespace hft::rng
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "wait_strategy.hpp"
+
 #include <atomic>
 #include <cstddef>
 #include <new>
@@ -12,6 +14,8 @@
 //       producer thread -> release-store tail after publishing element
 //       consumer thread -> acquire-load tail before reading element
 //     This ensures that object construction/destruction is observed in the correct order.
+//   * push() never wakes anyone. Producers call notify() once per batch so a consumer parked in a
+//     SpinPark wait strategy (see wait_strategy.hpp) resumes without a syscall per element.
 namespace hft::spsc
 {
 template <typename T, std::size_t CapacityPow2> class Queue
@@ -26,6 +30,8 @@ template <typename T, std::size_t CapacityPow2> class Queue
   alignas(64) std::atomic<std::size_t> _tail{0};
   // Raw byte storage for the ring buffer slots. Objects are placement-new'ed on demand.
   alignas(64) std::byte _storage[sizeof(T) * CapacityPow2];
+  // Parking spot for an idle consumer.
+  wait::EventCount _event;
 
   T *slot(std::size_t index) noexcept
   {
@@ -101,6 +107,11 @@ public:
     return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
   }
 
+  static constexpr std::size_t capacity() noexcept
+  {
+    return CapacityPow2;
+  }
+
   std::size_t size() const noexcept
   {
     // Size is simply the distance between writer and reader indices.
@@ -108,5 +119,26 @@ public:
     const std::size_t t = _tail.load(std::memory_order_acquire);
     return t - h;
   }
+
+  // Producer side: wake a parked consumer after publishing a batch. Nearly free when none waits.
+  void notify() noexcept
+  {
+    _event.notify();
+  }
+
+  // Fault the slot pages in from the calling thread so the kernel's first-touch policy places them
+  // on that thread's NUMA node. Call from the pinned producer before any element is pushed; pages
+  // some other thread already touched stay where they are.
+  void prefault() noexcept
+  {
+    for (std::size_t off = 0; off < sizeof(_storage); off += 4096)
+      reinterpret_cast<volatile std::byte &>(_storage[off]) = std::byte{0};
+  }
+
+  // Consumer side: hand this to a wait::Waiter so SpinPark can sleep until notify().
+  wait::EventCount &event() noexcept
+  {
+    return _event;
+  }
 };
 } // namespace hft::spsc
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "logging.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFT_HAVE_SHM_STATS 1
+#endif
+
+// Process statistics in a fixed-layout page that an external viewer (hft_stat) can map read-only.
+// Every stat owns one cache line: the name is written once at registration and the value is
+// updated with relaxed loads/stores by a single thread, so hot paths never share a line with each
+// other and the viewer never writes anything the process reads.
+//
+//   stats::Counter fills_ = stats::counter("engine.fills"); // register once, keep the handle
+//   fills_.add();                                           // hot path: load + store
+//
+// The page starts as private anonymous memory; stats::publish() (called early in main) moves it
+// into POSIX shared memory at the same address so handles taken before or after stay valid.
+namespace hft::stats
+{
+inline constexpr char kMagic[8] = {'H', 'F', 'T', 'S', 'T', 'A', 'T', '1'};
+inline constexpr u32 kVersion = 1;
+inline constexpr u32 kMaxStats = 255;
+inline constexpr std::size_t kNameLen = 48;
+
+enum class Kind : u32
+{
+  Counter = 0, // monotonically increasing; viewers show the rate
+  Gauge = 1    // instantaneous level (queue depth, book size)
+};
+
+struct alignas(64) Header
+{
+  char magic[8];
+  u32 version;
+  u32 capacity;
+  std::atomic<u32> count; // entries [0, count) are fully registered (release on publish)
+  u32 pad;
+  u64 pid;
+  u64 start_ns;
+};
+
+struct alignas(64) Entry
+{
+  char name[kNameLen];
+  Kind kind;
+  u32 pad;
+  std::atomic<u64> value;
+};
+
+struct Page
+{
+  Header header;
+  Entry entries[kMaxStats];
+};
+
+static_assert(sizeof(Header) == 64 && sizeof(Entry) == 64, "one cache line per stat");
+static_assert(std::atomic<u64>::is_always_lock_free && std::atomic<u32>::is_always_lock_free,
+              "the page is shared with another process");
+
+// Handle for a monotonically increasing stat. One writing thread per counter.
+class Counter
+{
+  std::atomic<u64> *_v{nullptr};
+
+public:
+  Counter() = default;
+  explicit Counter(std::atomic<u64> *v) noexcept : _v(v) {}
+
+  void add(u64 n = 1) noexcept
+  {
+    _v->store(_v->load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  u64 value() const noexcept
+  {
+    return _v->load(std::memory_order_relaxed);
+  }
+};
+
+// Handle for a level that is overwritten rather than accumulated. One writing thread per gauge.
+class Gauge
+{
+  std::atomic<u64> *_v{nullptr};
+
+public:
+  Gauge() = default;
+  explicit Gauge(std::atomic<u64> *v) noexcept : _v(v) {}
+
+  void set(u64 x) noexcept
+  {
+    _v->store(x, std::memory_order_relaxed);
+  }
+
+  u64 value() const noexcept
+  {
+    return _v->load(std::memory_order_relaxed);
+  }
+};
+
+// While a Private scope is alive on a thread, registrations from that thread get slots of their
+// own instead of entries in the page. For running many copies of the same components side by
+// side (a backtest sweep): each copy keeps its own counts, and no two threads write one line.
+// Handles taken in the scope must not outlive it. Scopes nest; the innermost wins.
+class Private
+{
+  std::deque<Entry> _entries;
+  Private *_outer;
+
+  static Private *&current_ref() noexcept
+  {
+    thread_local Private *scope = nullptr;
+    return scope;
+  }
+
+public:
+  Private() : _outer(current_ref())
+  {
+    current_ref() = this;
+  }
+
+  ~Private()
+  {
+    current_ref() = _outer;
+  }
+
+  Private(const Private &) = delete;
+  Private &operator=(const Private &) = delete;
+
+  static Private *current() noexcept
+  {
+    return current_ref();
+  }
+
+  std::atomic<u64> *slot(const char *name, Kind kind)
+  {
+    for (Entry &e : _entries)
+      if (std::strncmp(e.name, name, kNameLen) == 0)
+        return &e.value;
+    Entry &e = _entries.emplace_back();
+    std::snprintf(e.name, kNameLen, "%s", name);
+    e.kind = kind;
+    return &e.value;
+  }
+
+  // Value of `name` in this scope, 0 if nothing registered it.
+  u64 value(const char *name) const noexcept
+  {
+    for (const Entry &e : _entries)
+      if (std::strncmp(e.name, name, kNameLen) == 0)
+        return e.value.load(std::memory_order_relaxed);
+    return 0;
+  }
+};
+
+class Registry
+{
+  Page *_page{nullptr};
+  std::mutex _mu;
+  std::atomic<u64> _overflow{0}; // returned to registrations beyond kMaxStats
+  char _shm_name[64]{};
+
+  static Page *map_private() noexcept
+  {
+#if defined(HFT_HAVE_SHM_STATS)
+    void *p = mmap(nullptr, sizeof(Page), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                   0);
+    return p == MAP_FAILED ? nullptr : static_cast<Page *>(p);
+#else
+    return static_cast<Page *>(::operator new(sizeof(Page), std::align_val_t{64}, std::nothrow));
+#endif
+  }
+
+  std::atomic<u64> *slot(const char *name, Kind kind)
+  {
+    if (Private *scope = Private::current())
+      return scope->slot(name, kind);
+    if (_page == nullptr)
+      return &_overflow;
+    std::lock_guard<std::mutex> lock(_mu);
+    const u32 n = _page->header.count.load(std::memory_order_relaxed);
+    for (u32 i = 0; i < n; ++i)
+      if (std::strncmp(_page->entries[i].name, name, kNameLen) == 0)
+        return &_page->entries[i].value;
+    if (n == kMaxStats)
+    {
+      HFT_WARN("stats: page full, '%s' is not exported", name);
+      return &_overflow;
+    }
+    Entry &e = _page->entries[n];
+    std::snprintf(e.name, kNameLen, "%s", name);
+    e.kind = kind;
+    e.value.store(0, std::memory_order_relaxed);
+    _page->header.count.store(n + 1, std::memory_order_release);
+    return &e.value;
+  }
+
+public:
+  Registry()
+  {
+    _page = map_private();
+    if (_page == nullptr)
+      return;
+    std::memset(static_cast<void *>(_page), 0, sizeof(Page));
+    std::memcpy(_page->header.magic, kMagic, sizeof(kMagic));
+    _page->header.version = kVersion;
+    _page->header.capacity = kMaxStats;
+#if defined(HFT_HAVE_SHM_STATS)
+    _page->header.pid = static_cast<u64>(getpid());
+#endif
+    _page->header.start_ns = now_ns();
+  }
+
+  Registry(const Registry &) = delete;
+  Registry &operator=(const Registry &) = delete;
+
+  ~Registry()
+  {
+#if defined(HFT_HAVE_SHM_STATS)
+    if (_shm_name[0] != '\0')
+      shm_unlink(_shm_name);
+    if (_page != nullptr)
+      munmap(_page, sizeof(Page));
+#else
+    ::operator delete(_page, std::align_val_t{64});
+#endif
+  }
+
+  static Registry &instance()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  Counter counter(const char *name)
+  {
+    return Counter(slot(name, Kind::Counter));
+  }
+
+  Gauge gauge(const char *name)
+  {
+    return Gauge(slot(name, Kind::Gauge));
+  }
+
+  const Page *page() const noexcept
+  {
+    return _page;
+  }
+
+  // Name of the shared-memory object once published, empty before.
+  const char *shm_name() const noexcept
+  {
+    return _shm_name;
+  }
+
+  // Export the page as POSIX shared memory `name` (default "/hft_stats.<pid>"). The shared mapping
+  // replaces the private one at the same address. Call before hot threads start: increments that
+  // race with the switch may be lost. The object is unlinked when the registry is destroyed.
+  bool publish(const char *name = nullptr)
+  {
+#if defined(HFT_HAVE_SHM_STATS)
+    if (_page == nullptr || _shm_name[0] != '\0')
+      return false;
+    char buf[sizeof(_shm_name)];
+    if (name == nullptr)
+      std::snprintf(buf, sizeof(buf), "/hft_stats.%d", static_cast<int>(getpid()));
+    else
+      std::snprintf(buf, sizeof(buf), "%s", name);
+
+    std::lock_guard<std::mutex> lock(_mu);
+    const int fd = shm_open(buf, O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if (fd < 0)
+    {
+      HFT_WARN("stats: shm_open(%s) failed; counters stay process-local", buf);
+      return false;
+    }
+    bool ok = ftruncate(fd, sizeof(Page)) == 0 &&
+              pwrite(fd, _page, sizeof(Page), 0) == static_cast<ssize_t>(sizeof(Page));
+    if (ok)
+      ok = mmap(_page, sizeof(Page), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) !=
+           MAP_FAILED;
+    close(fd);
+    if (!ok)
+    {
+      shm_unlink(buf);
+      HFT_WARN("stats: mapping %s failed; counters stay process-local", buf);
+      return false;
+    }
+    std::memcpy(_shm_name, buf, sizeof(buf));
+    HFT_INFO("stats: exported at %s (view with: hft_stat %d)", _shm_name,
+             static_cast<int>(getpid()));
+    return true;
+#else
+    (void)name;
+    return false;
+#endif
+  }
+};
+
+inline Counter counter(const char *name)
+{
+  return Registry::instance().counter(name);
+}
+
+inline Gauge gauge(const char *name)
+{
+  return Registry::instance().gauge(name);
+}
+
+inline bool publish(const char *name = nullptr)
+{
+  return Registry::instance().publish(name);
+}
+} // namespace hft::stats
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "logging.hpp"
+#include "types.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Thread placement: which core each role runs on and whether it gets a real-time priority.
+// Pinning keeps the engine and its consumers from migrating between cores (and NUMA nodes), which
+// otherwise dominates tail latency. The config is parsed from a compact spec such as
+//   "engine=2:fifo,md=3,exec=4"
+// validated once at startup, and applied by each thread to itself as its first action.
+namespace hft
+{
+enum class ThreadRole : u8
+{
+  Engine = 0,
+  MdConsumer = 1,
+  ExecConsumer = 2,
+  Simulator = 3 // runs inside the engine loop today; kept separate so configs stay stable
+};
+
+inline constexpr std::size_t kThreadRoleCount = 4;
+
+inline const char *to_string(ThreadRole r) noexcept
+{
+  switch (r)
+  {
+  case ThreadRole::Engine:
+    return "engine";
+  case ThreadRole::MdConsumer:
+    return "md";
+  case ThreadRole::ExecConsumer:
+    return "exec";
+  case ThreadRole::Simulator:
+    return "sim";
+  }
+  return "unknown";
+}
+
+struct ThreadPlacement
+{
+  int cpu{-1};           // -1 leaves the thread to the scheduler
+  bool fifo{false};      // request SCHED_FIFO (needs CAP_SYS_NICE or an RLIMIT_RTPRIO grant)
+  int fifo_priority{50}; // 1..99, only used with fifo
+};
+
+struct PlacementConfig
+{
+  ThreadPlacement roles[kThreadRoleCount]{};
+
+  ThreadPlacement &operator[](ThreadRole r) noexcept
+  {
+    return roles[static_cast<std::size_t>(r)];
+  }
+
+  const ThreadPlacement &operator[](ThreadRole r) const noexcept
+  {
+    return roles[static_cast<std::size_t>(r)];
+  }
+};
+
+// Parse a Linux cpu list ("0-3,8,10-11") as found in /sys. Malformed pieces are skipped.
+inline std::vector<int> parse_cpu_list(sv list)
+{
+  std::vector<int> cpus;
+  while (!list.empty())
+  {
+    const std::size_t comma = list.find(',');
+    sv item = list.substr(0, comma);
+    list = comma == sv::npos ? sv{} : list.substr(comma + 1);
+    while (!item.empty() && (item.back() == '\n' || item.back() == ' '))
+      item.remove_suffix(1);
+    int lo = 0;
+    int hi = 0;
+    const std::size_t dash = item.find('-');
+    const sv a = item.substr(0, dash);
+    if (std::from_chars(a.data(), a.data() + a.size(), lo).ec != std::errc{})
+      continue;
+    hi = lo;
+    if (dash != sv::npos)
+    {
+      const sv b = item.substr(dash + 1);
+      if (std::from_chars(b.data(), b.data() + b.size(), hi).ec != std::errc{})
+        continue;
+    }
+    for (int c = lo; c <= hi; ++c)
+      cpus.push_back(c);
+  }
+  return cpus;
+}
+
+// Parse "role=cpu[:fifo[:prio]]" entries separated by commas. Roles: engine, md, exec, sim.
+// Returns false (and logs the offending token) on any syntax error.
+inline bool parse_placement(sv spec, PlacementConfig &out)
+{
+  while (!spec.empty())
+  {
+    const std::size_t comma = spec.find(',');
+    const sv item = spec.substr(0, comma);
+    spec = comma == sv::npos ? sv{} : spec.substr(comma + 1);
+    if (item.empty())
+      continue;
+
+    const std::size_t eq = item.find('=');
+    if (eq == sv::npos)
+    {
+      HFT_ERROR("placement: expected role=cpu in '%.*s'", static_cast<int>(item.size()),
+                item.data());
+      return false;
+    }
+    const sv role = item.substr(0, eq);
+    ThreadPlacement *target = nullptr;
+    for (std::size_t i = 0; i < kThreadRoleCount; ++i)
+      if (role == to_string(static_cast<ThreadRole>(i)))
+        target = &out.roles[i];
+    if (target == nullptr)
+    {
+      HFT_ERROR("placement: unknown role '%.*s'", static_cast<int>(role.size()), role.data());
+      return false;
+    }
+
+    sv rest = item.substr(eq + 1);
+    const std::size_t colon = rest.find(':');
+    const sv cpu = rest.substr(0, colon);
+    ThreadPlacement p{};
+    if (std::from_chars(cpu.data(), cpu.data() + cpu.size(), p.cpu).ec != std::errc{} || p.cpu < 0)
+    {
+      HFT_ERROR("placement: bad cpu '%.*s' for %.*s", static_cast<int>(cpu.size()), cpu.data(),
+                static_cast<int>(role.size()), role.data());
+      return false;
+    }
+    if (colon != sv::npos)
+    {
+      rest = rest.substr(colon + 1);
+      const std::size_t colon2 = rest.find(':');
+      if (rest.substr(0, colon2) != "fifo")
+      {
+        HFT_ERROR("placement: unknown flag '%.*s'", static_cast<int>(rest.size()), rest.data());
+        return false;
+      }
+      p.fifo = true;
+      if (colon2 != sv::npos)
+      {
+        const sv prio = rest.substr(colon2 + 1);
+        if (std::from_chars(prio.data(), prio.data() + prio.size(), p.fifo_priority).ec !=
+                std::errc{} ||
+            p.fifo_priority < 1 || p.fifo_priority > 99)
+        {
+          HFT_ERROR("placement: fifo priority must be 1..99, got '%.*s'",
+                    static_cast<int>(prio.size()), prio.data());
+          return false;
+        }
+      }
+    }
+    *target = p;
+  }
+  return true;
+}
+
+// Check a config against the machine and log every problem found. Returns the number of
+// problems; the caller decides whether to run anyway (placement failures are never fatal).
+inline int validate_placement(const PlacementConfig &cfg)
+{
+  int problems = 0;
+  const ThreadPlacement &engine = cfg[ThreadRole::Engine];
+  const ThreadPlacement &sim = cfg[ThreadRole::Simulator];
+  if (sim.cpu >= 0 && sim.cpu != engine.cpu)
+  {
+    HFT_WARN("placement: the simulator runs on the engine thread; sim=%d is ignored", sim.cpu);
+    ++problems;
+  }
+
+#if defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  const bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+  std::vector<int> isolated;
+  if (std::FILE *f = std::fopen("/sys/devices/system/cpu/isolated", "r"))
+  {
+    char buf[256] = {};
+    const std::size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+    std::fclose(f);
+    isolated = parse_cpu_list(sv{buf, n});
+  }
+
+  rlimit rt{};
+  const bool can_fifo = geteuid() == 0 || (getrlimit(RLIMIT_RTPRIO, &rt) == 0 && rt.rlim_cur > 0);
+  const unsigned ncpu = std::thread::hardware_concurrency();
+
+  for (std::size_t i = 0; i < kThreadRoleCount; ++i)
+  {
+    const auto role = static_cast<ThreadRole>(i);
+    const ThreadPlacement &p = cfg.roles[i];
+    if (role == ThreadRole::Simulator || p.cpu < 0)
+      continue;
+    if (ncpu != 0 && static_cast<unsigned>(p.cpu) >= ncpu)
+    {
+      HFT_WARN("placement: %s cpu %d does not exist (%u cpus)", to_string(role), p.cpu, ncpu);
+      ++problems;
+      continue;
+    }
+    if (have_mask && (p.cpu >= CPU_SETSIZE || !CPU_ISSET(p.cpu, &allowed)))
+    {
+      HFT_WARN("placement: %s cpu %d is outside this process's affinity mask", to_string(role),
+               p.cpu);
+      ++problems;
+    }
+    bool is_isolated = false;
+    for (int c : isolated)
+      is_isolated = is_isolated || c == p.cpu;
+    if (!is_isolated)
+      HFT_WARN("placement: %s cpu %d is not isolated (isolcpus); expect scheduler jitter",
+               to_string(role), p.cpu);
+    if (p.fifo && !can_fifo)
+    {
+      HFT_WARN("placement: %s wants SCHED_FIFO but RLIMIT_RTPRIO is 0 and we are not root",
+               to_string(role));
+      ++problems;
+    }
+    for (std::size_t j = i + 1; j < kThreadRoleCount; ++j)
+    {
+      if (static_cast<ThreadRole>(j) != ThreadRole::Simulator && cfg.roles[j].cpu == p.cpu)
+      {
+        HFT_WARN("placement: %s and %s share cpu %d", to_string(role),
+                 to_string(static_cast<ThreadRole>(j)), p.cpu);
+        ++problems;
+      }
+    }
+  }
+#else
+  for (const ThreadPlacement &p : cfg.roles)
+  {
+    if (p.cpu >= 0 || p.fifo)
+    {
+      HFT_WARN("placement: thread pinning is only implemented on Linux; config ignored");
+      ++problems;
+      break;
+    }
+  }
+#endif
+  return problems;
+}
+
+// NUMA node of the cpu the caller currently runs on, or -1 when unknown.
+inline int current_numa_node() noexcept
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+    return static_cast<int>(node);
+#endif
+  return -1;
+}
+
+// Apply a placement to the calling thread. Failures are logged and reported, never fatal, so a
+// misconfigured box degrades to unpinned behaviour instead of refusing to start.
+inline bool apply_placement(ThreadRole role, const ThreadPlacement &p)
+{
+  if (p.cpu < 0 && !p.fifo)
+    return true;
+#if defined(__linux__)
+  bool ok = true;
+  if (p.cpu >= 0)
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(p.cpu, &set);
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0)
+    {
+      HFT_WARN("placement: pinning %s to cpu %d failed (errno %d)", to_string(role), p.cpu, rc);
+      ok = false;
+    }
+  }
+  if (p.fifo)
+  {
+    sched_param sp{};
+    sp.sched_priority = p.fifo_priority;
+    const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0)
+    {
+      HFT_WARN("placement: SCHED_FIFO for %s failed (errno %d)", to_string(role), rc);
+      ok = false;
+    }
+  }
+  if (ok)
+    HFT_INFO("placement: %s on cpu %d node %d%s", to_string(role), sched_getcpu(),
+             current_numa_node(), p.fifo ? " SCHED_FIFO" : "");
+  return ok;
+#else
+  HFT_WARN("placement: %s left unpinned (unsupported platform)", to_string(role));
+  return false;
+#endif
+}
+} // namespace hft
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <chrono>
+#include "clock.hpp"
+
 #include <cstdint>
 #include <string_view>
 
@@ -29,12 +30,12 @@ enum class Side : u8
   Sell = 1
 };
 
-// Monotonic time in nanoseconds for ordering and latency metrics.
-// Steady clock is immune to wall adjustments, providing stable latencies for backtests.
+// Monotonic time in nanoseconds for ordering and latency metrics. Backed by the calibrated TSC
+// when the CPU has an invariant one, steady_clock otherwise (see clock.hpp). Hot paths should take
+// one reading per unit of work and pass it down rather than calling this repeatedly.
 inline u64 now_ns() noexcept
 {
-  using namespace std::chrono;
-  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+  return clock::instance().now();
 }
 
 // Simple string identifiers are passed as string_view at API boundary to avoid copies yet remain
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// Wait strategies shared by every polling loop (engine, strategy consumers) and the queues feeding
+// them. A loop calls `Waiter::idle()` when a poll found nothing to do and `Waiter::reset()` after
+// doing work; the configured policy decides how an idle poll is spent:
+//   Sleep     -> fixed sleep each idle poll (the old behaviour: cheap on CPU, adds a latency floor)
+//   BusySpin  -> `pause` forever: lowest latency, burns the whole core
+//   SpinYield -> bounded spin, then yield the core between polls
+//   SpinPark  -> bounded spin, short yield phase, then park on the queue's EventCount until the
+//                producer calls notify() or the timeout expires (futex on Linux)
+namespace hft::wait
+{
+enum class WaitPolicy : std::uint8_t
+{
+  Sleep = 0,
+  BusySpin = 1,
+  SpinYield = 2,
+  SpinPark = 3
+};
+
+inline const char *to_string(WaitPolicy p) noexcept
+{
+  switch (p)
+  {
+  case WaitPolicy::Sleep:
+    return "sleep";
+  case WaitPolicy::BusySpin:
+    return "busy-spin";
+  case WaitPolicy::SpinYield:
+    return "spin-yield";
+  case WaitPolicy::SpinPark:
+    return "spin-park";
+  }
+  return "unknown";
+}
+
+// Tell the core we are spinning: frees pipeline resources for the sibling hyperthread and avoids
+// the memory-order mis-speculation penalty when the awaited store finally lands.
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Event count: lets consumers sleep without the producer paying for a syscall on every publish.
+//   consumer: key = prepare_wait(); if (ready()) cancel_wait(); else wait(key, timeout);
+//   producer: publish; notify();
+// notify() is a fence plus one load while nobody is parked; it only bumps the epoch and wakes
+// sleepers when a waiter has registered.
+class EventCount
+{
+  alignas(64) std::atomic<std::uint32_t> _epoch{0};
+  std::atomic<std::uint32_t> _waiters{0};
+
+public:
+  void notify() noexcept
+  {
+    // Order the caller's publish before the waiter check (pairs with the fence in prepare_wait).
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_relaxed) == 0)
+      return;
+    _epoch.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&_epoch), FUTEX_WAKE_PRIVATE, INT_MAX,
+            nullptr, nullptr, 0);
+#endif
+  }
+
+  std::uint32_t prepare_wait() noexcept
+  {
+    _waiters.fetch_add(1, std::memory_order_relaxed);
+    // Register before re-checking the condition so a concurrent notify() cannot be missed.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return _epoch.load(std::memory_order_acquire);
+  }
+
+  void cancel_wait() noexcept
+  {
+    _waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Sleep until notify() moves the epoch past `key` or `timeout_ns` elapses.
+  void wait(std::uint32_t key, std::uint64_t timeout_ns) noexcept
+  {
+    if (_epoch.load(std::memory_order_acquire) == key)
+    {
+#if defined(__linux__)
+      timespec ts{};
+      ts.tv_sec = static_cast<time_t>(timeout_ns / 1'000'000'000ULL);
+      ts.tv_nsec = static_cast<long>(timeout_ns % 1'000'000'000ULL);
+      syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&_epoch), FUTEX_WAIT_PRIVATE, key, &ts,
+              nullptr, 0);
+#else
+      // No portable timed wait on an atomic: fall back to a bounded sleep.
+      std::this_thread::sleep_for(std::chrono::nanoseconds(timeout_ns));
+#endif
+    }
+    _waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+};
+
+struct WaitConfig
+{
+  WaitPolicy policy{WaitPolicy::SpinPark};
+  std::uint32_t spin_polls{256};  // idle polls spent in cpu_relax() before escalating
+  std::uint32_t yield_polls{64};  // further idle polls spent in std::this_thread::yield()
+  std::uint64_t park_ns{100'000}; // longest single sleep/park; also the Sleep policy period
+};
+
+// Counters describing how a loop spent its idle time. Read them after the owning thread joined.
+struct WaitStats
+{
+  WaitPolicy policy{WaitPolicy::SpinPark};
+  std::uint64_t spins{0};
+  std::uint64_t yields{0};
+  std::uint64_t parks{0};
+};
+
+// Per-thread idle helper. Not thread-safe: each polling loop owns one.
+class Waiter
+{
+  WaitConfig _cfg;
+  EventCount *_event; // optional: SpinPark parks here, otherwise it sleeps
+  std::uint32_t _idle{0};
+  WaitStats _stats{};
+
+public:
+  explicit Waiter(WaitConfig cfg = {}, EventCount *event = nullptr) noexcept
+      : _cfg(cfg), _event(event)
+  {
+    _stats.policy = cfg.policy;
+  }
+
+  // Call after a poll that did useful work so the next idle period starts with spinning again.
+  void reset() noexcept
+  {
+    _idle = 0;
+  }
+
+  // Spend one idle poll. `ready` re-checks the awaited condition right before parking, and
+  // `max_wait_ns` caps the sleep so callers with timers (simulator cadence, strategy on_timer)
+  // wake up on time.
+  template <typename Ready> void idle(Ready &&ready, std::uint64_t max_wait_ns = UINT64_MAX)
+  {
+    const std::uint64_t nap = max_wait_ns < _cfg.park_ns ? max_wait_ns : _cfg.park_ns;
+    switch (_cfg.policy)
+    {
+    case WaitPolicy::Sleep:
+      sleep(nap);
+      return;
+    case WaitPolicy::BusySpin:
+      spin();
+      return;
+    case WaitPolicy::SpinYield:
+      if (_idle < _cfg.spin_polls)
+        spin();
+      else
+        yield();
+      break;
+    case WaitPolicy::SpinPark:
+      if (_idle < _cfg.spin_polls)
+        spin();
+      else if (_idle < _cfg.spin_polls + _cfg.yield_polls)
+        yield();
+      else
+        park(ready, nap);
+      break;
+    }
+    if (_idle != UINT32_MAX)
+      ++_idle;
+  }
+
+  WaitPolicy policy() const noexcept
+  {
+    return _cfg.policy;
+  }
+
+  const WaitStats &stats() const noexcept
+  {
+    return _stats;
+  }
+
+private:
+  void spin() noexcept
+  {
+    cpu_relax();
+    ++_stats.spins;
+  }
+
+  void yield() noexcept
+  {
+    std::this_thread::yield();
+    ++_stats.yields;
+  }
+
+  void sleep(std::uint64_t ns) noexcept
+  {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+    ++_stats.parks;
+  }
+
+  template <typename Ready> void park(Ready &ready, std::uint64_t ns)
+  {
+    if (_event == nullptr)
+    {
+      sleep(ns);
+      return;
+    }
+    const std::uint32_t key = _event->prepare_wait();
+    if (ready())
+    {
+      _event->cancel_wait();
+      return;
+    }
+    _event->wait(key, ns);
+    ++_stats.parks;
+  }
+};
+} // namespace hft::wait
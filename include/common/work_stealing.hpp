@@ -0,0 +1,88 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a batch of independent, coarse jobs on a fixed set of worker threads. Every worker owns a
+// deque: jobs are dealt round-robin up front, a worker takes from the back of its own deque and,
+// once that is empty, steals from the front of the others'. Uneven jobs (a parameter set that
+// trades ten times as much) then even out without a central queue every worker contends on.
+// Meant for jobs far longer than a lock, such as whole backtests; each deque has a mutex.
+namespace hft
+{
+struct ParallelStats
+{
+  unsigned workers{0};
+  u64 steals{0}; // jobs run by a worker other than the one they were dealt to
+};
+
+// Calls fn(index, worker) exactly once for every index in [0, n) and returns once all calls have
+// finished. `workers` 0 means one per hardware thread, and there are never more workers than
+// jobs. The calling thread is worker 0. Jobs must not share mutable state with each other.
+template <typename Fn> ParallelStats parallel_for(std::size_t n, unsigned workers, Fn &&fn)
+{
+  struct alignas(64) Lane
+  {
+    std::mutex mu;
+    std::deque<std::size_t> jobs;
+  };
+
+  if (workers == 0)
+    workers = std::max(1U, std::thread::hardware_concurrency());
+  workers = static_cast<unsigned>(std::min<std::size_t>(workers, std::max<std::size_t>(n, 1)));
+
+  std::vector<Lane> lanes(workers);
+  for (std::size_t i = 0; i < n; ++i)
+    lanes[i % workers].jobs.push_back(i);
+  std::atomic<u64> steals{0};
+
+  // No job is ever added after dealing, so a worker that finds every deque empty is done.
+  const auto take = [&](unsigned self, std::size_t &job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(lanes[self].mu);
+      if (!lanes[self].jobs.empty())
+      {
+        job = lanes[self].jobs.back();
+        lanes[self].jobs.pop_back();
+        return true;
+      }
+    }
+    for (unsigned k = 1; k < workers; ++k)
+    {
+      Lane &victim = lanes[(self + k) % workers];
+      std::lock_guard<std::mutex> lock(victim.mu);
+      if (!victim.jobs.empty())
+      {
+        job = victim.jobs.front();
+        victim.jobs.pop_front();
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  };
+
+  const auto work = [&](unsigned self)
+  {
+    std::size_t job = 0;
+    while (take(self, job))
+      fn(job, self);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (unsigned w = 1; w < workers; ++w)
+    threads.emplace_back(work, w);
+  work(0);
+  for (std::thread &t : threads)
+    t.join();
+  return ParallelStats{workers, steals.load(std::memory_order_relaxed)};
+}
+} // namespace hft
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "common/broadcast_ring.hpp"
 #include "common/logging.hpp"
+#include "common/perf_counters.hpp"
 #include "common/spsc_queue.hpp"
+#include "common/stats.hpp"
+#include "common/thread_placement.hpp"
+#include "common/wait_strategy.hpp"
 #include "market/matching_engine.hpp"
 #include "market/simulator.hpp"
 
@@ -11,92 +16,257 @@
 namespace hft
 {
 // EngineThread wraps the order book + matching engine + simulator in one loop.
-// It reads commands from a single SPSC queue and emits execs + market data to their queues.
+// It reads commands from an SPSC queue (one more per extra producer, see add_input), emits execs to
+// an SPSC queue and writes market data once into a broadcast ring shared by every subscribed
+// strategy.
 // Think of it as the "exchange side" counterpart to a strategy: you can plug in different
 // strategies without touching this class.
 class EngineThread
 {
-  OrderBook book_;                                // shared order book instance
-  spsc::Queue<EngineCommand, 1 << 14> &cmd_in_;   // strategy -> engine commands
-  spsc::Queue<ExecEvent, 1 << 14> &exec_out_;     // exec reports -> strategy
-  spsc::Queue<MarketDataEvent, 1 << 14> &md_out_; // market data -> strategy
-  Simulator sim_;                                 // generates artificial street flow
-  std::atomic<bool> running_{false};              // controls lifecycle of the thread
-  std::thread thread_;                            // actual engine worker thread
+public:
+  using CommandQueue = spsc::Queue<EngineCommand, 1 << 14>;
+  static constexpr std::size_t kMaxExtraInputs = 8;
+
+private:
+  OrderBook book_;                                    // shared order book instance
+  CommandQueue &cmd_in_;                              // strategy -> engine commands
+  CommandQueue *extra_in_[kMaxExtraInputs]{};         // further producers, one queue each
+  std::size_t extra_count_{0};
+  spsc::Queue<ExecEvent, 1 << 14> &exec_out_;         // exec reports -> strategy
+  broadcast::Ring<MarketDataEvent, 1 << 14> &md_out_; // market data -> strategies
+  MatchingEngine engine_;                             // matches strategy and simulator orders
+  Simulator sim_;                                     // generates artificial street flow
+  u64 sim_step_ns_;                                   // cadence of simulator steps
+  wait::Waiter waiter_;                               // how the loop idles between polls
+  ThreadPlacement placement_{};                       // core/priority applied by the worker
+  stats::Counter loops_ = stats::counter("engine.loops");
+  stats::Counter sim_steps_ = stats::counter("engine.sim_steps");
+  stats::Gauge cmd_depth_ = stats::gauge("engine.cmd_queue_depth");
+  stats::Counter throttled_ = stats::counter("engine.intake_throttled");
+#if defined(HFT_PERF_COUNTERS)
+  perf::PhaseCounters perf_; // hardware counters per loop phase, engine thread only
+#endif
+  std::atomic<bool> running_{false};                  // controls lifecycle of the thread
+  std::thread thread_;                                // actual engine worker thread
 
 public:
   EngineThread(spsc::Queue<EngineCommand, 1 << 14> &cmd_in,
                spsc::Queue<ExecEvent, 1 << 14> &exec_out,
-               spsc::Queue<MarketDataEvent, 1 << 14> &md_out, StreetFlowConfig cfg = {})
-      : cmd_in_(cmd_in), exec_out_(exec_out), md_out_(md_out), sim_(cfg)
+               broadcast::Ring<MarketDataEvent, 1 << 14> &md_out, StreetFlowConfig cfg = {},
+               wait::WaitConfig wait_cfg = {}, OutputPolicy output = {})
+      : cmd_in_(cmd_in), exec_out_(exec_out), md_out_(md_out),
+        engine_(book_, exec_out, md_out, nullptr, output),
+        sim_(cfg), sim_step_ns_(cfg.step_interval_ns), waiter_(wait_cfg, &cmd_in.event())
+  {
+  }
+
+  // Record engine-side latency hops (queue wait, match, tick-to-trade) into `tracer`. Call before
+  // start(); the engine thread becomes the single writer of those hops.
+  void set_tracer(latency::Tracer *tracer) noexcept
+  {
+    engine_.set_tracer(tracer);
+  }
+
+  // Another command source with its own producer thread, so every queue keeps a single producer.
+  // Call before start(). The engine parks on cmd_in's event only, so producers on extra inputs
+  // wake it with notify_input(). False once kMaxExtraInputs are attached.
+  bool add_input(CommandQueue &q) noexcept
+  {
+    if (extra_count_ == kMaxExtraInputs)
+      return false;
+    extra_in_[extra_count_++] = &q;
+    return true;
+  }
+
+  // Wake the engine if it is parked waiting for commands.
+  void notify_input() noexcept
+  {
+    cmd_in_.notify();
+  }
+
+  // Also report each fill to the resting order's owner (see MatchingEngine). Call before start().
+  void set_passive_fills(bool on)
   {
+    engine_.set_passive_fills(on);
   }
 
-  void start()
+  // Pre-trade limits for one user (see MatchingEngine). Call before start().
+  bool set_risk_limits(u64 user_id, const RiskLimits &limits)
+  {
+    return engine_.set_risk_limits(user_id, limits);
+  }
+
+  // Journal every command (strategy and simulator alike) and the engine's output. Call before
+  // start(); the journal is written from the engine thread.
+  void set_journal(Journal *journal)
+  {
+    engine_.set_journal(journal);
+  }
+
+  void start(ThreadPlacement placement = {})
   {
     // Launch the engine thread. The lambda captures `this` so run() operates on the same object.
+    placement_ = placement;
     running_.store(true, std::memory_order_release);
     thread_ = std::thread([this] { this->run(); });
   }
 
   void stop()
   {
-    // Signal the loop to exit and join the worker before returning to caller.
+    // Signal the loop to exit, wake it if parked and join the worker before returning to caller.
     running_.store(false, std::memory_order_release);
+    cmd_in_.notify();
     if (thread_.joinable())
       thread_.join();
   }
 
+  // Idle-time counters and the wait policy in use. Only meaningful after stop().
+  const wait::WaitStats &wait_stats() const noexcept
+  {
+    return waiter_.stats();
+  }
+
   TopOfBook top_snapshot() const
   {
     // Expose best prices to the simulator (runs on same thread, so no need for locks).
     return book_.top();
   }
 
+  // Whether a simulator order still rests, so its order pool can forget fills.
+  bool resting(u64 order_id) const noexcept
+  {
+    Price px;
+    Side side;
+    return book_.find(order_id, px, side);
+  }
+
   // Used by simulator, runs in the same thread:
   void inject_new(const NewOrder &n)
   {
-    // We instantiate a short-lived MatchingEngine view to reuse its command handling helpers.
-    MatchingEngine me(book_, exec_out_, md_out_);
-    me.on_command(EngineCommand{EngineCommand::Kind::New, n, {}});
+    // Simulator flow goes through the same MatchingEngine as strategy commands, so execs, prints
+    // and counters stay consistent. The simulator stamps each step once; reuse that stamp (the
+    // engine times the match hop from its own clock read, not from this one).
+    HFT_PERF_ENTER(perf_, Match);
+    engine_.on_command(EngineCommand{EngineCommand::Kind::New, n, {}},
+                       n.ts_ns ? n.ts_ns : now_ns());
+    HFT_PERF_LEAVE(perf_);
   }
 
+  // Lifecycle cancels and modifies carry the same step stamp as the orders they retire.
   void inject_cancel(const CancelOrder &c)
   {
-    // Same story for cancels; by reusing MatchingEngine logic we ensure consistent execs/prints.
-    MatchingEngine me(book_, exec_out_, md_out_);
-    me.on_command(EngineCommand{EngineCommand::Kind::Cancel, {}, c});
+    HFT_PERF_ENTER(perf_, Match);
+    engine_.on_command(EngineCommand{EngineCommand::Kind::Cancel, {}, c},
+                       c.ts_ns ? c.ts_ns : now_ns());
+    HFT_PERF_LEAVE(perf_);
   }
 
 private:
+  int drain(CommandQueue &q)
+  {
+    EngineCommand cmd;
+    int drained = 0;
+    while (q.pop(cmd))
+    {
+      HFT_PERF_ENTER(perf_, Match);
+      engine_.on_command(cmd);
+      HFT_PERF_LEAVE(perf_);
+      ++drained;
+      if (drained > 256)
+        break; // avoid starving simulator and the other inputs
+    }
+    return drained;
+  }
+
+  bool has_input() const noexcept
+  {
+    if (!cmd_in_.empty())
+      return true;
+    for (std::size_t i = 0; i < extra_count_; ++i)
+      if (!extra_in_[i]->empty())
+        return true;
+    return false;
+  }
+
   void run()
   {
-    MatchingEngine me(book_, exec_out_, md_out_);
+    // Pin first so every page we touch from here on is allocated on the engine's NUMA node. The
+    // engine is the only producer of both output queues, so it owns their first touch too.
+    if (apply_placement(ThreadRole::Engine, placement_) && placement_.cpu >= 0)
+    {
+      exec_out_.prefault();
+      md_out_.prefault();
+    }
+#if defined(HFT_PERF_COUNTERS)
+    perf_.start(); // counters are per-thread, so open them from the engine thread itself
+#endif
+
     // Seed book so strategies receive a top-of-book early.
-    sim_.seed_book(book_);
+    sim_.seed_book(engine_);
     md_out_.push(MarketDataEvent{book_.top()});
+    md_out_.notify();
 
     // Loop
+    u64 next_step = now_ns();
     while (running_.load(std::memory_order_acquire))
     {
-      // 1) Drain strategy commands
-      EngineCommand cmd;
+      // 1) Drain strategy commands, unless the exec consumer is behind: each command produces
+      // execs, so taking more would only grow the spill. Commands then wait in cmd_in_, where
+      // the strategy's own overflow policy applies.
+      engine_.flush_output();
+      const bool throttled = engine_.output_saturated();
+      if (throttled)
+        throttled_.add();
       int drained = 0;
-      while (cmd_in_.pop(cmd))
+      HFT_PERF_ENTER(perf_, Drain);
+      if (!throttled)
       {
-        me.on_command(cmd);
-        ++drained;
-        if (drained > 256)
-          break; // avoid starving simulator
+        drained += drain(cmd_in_);
+        for (std::size_t i = 0; i < extra_count_; ++i)
+          drained += drain(*extra_in_[i]);
       }
+      HFT_PERF_LEAVE(perf_);
 
-      // 2) Simulate a bit of street flow
-      sim_.step(*this);
+      // 2) Simulate a bit of street flow. Steps follow a fixed cadence so flow intensity does not
+      // depend on how fast the wait strategy lets us poll.
+      const u64 now = now_ns();
+      const bool stepped = now >= next_step;
+      if (stepped)
+      {
+        HFT_PERF_ENTER(perf_, Sim);
+        sim_.step(*this);
+        HFT_PERF_LEAVE(perf_);
+        sim_steps_.add();
+        next_step = now + sim_step_ns_;
+      }
+      loops_.add();
 
-      // 3) Small pause to avoid burning 100% CPU in sample
-      // In a real engine you'd busy-wait or use timerfd. Here we sleep a micro-burst.
-      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      // 3) Wake consumers once per batch, or idle until a command arrives or the next step is due.
+      if (drained > 0 || stepped)
+      {
+        HFT_PERF_ENTER(perf_, Publish);
+        cmd_depth_.set(cmd_in_.size());
+        exec_out_.notify();
+        md_out_.notify();
+        HFT_PERF_LEAVE(perf_);
+        waiter_.reset();
+      }
+      else
+      {
+        clock::instance().maybe_resync();
+        engine_.flush_journal();
+        waiter_.idle(
+            [this]
+            {
+              return (has_input() && !engine_.output_saturated()) ||
+                     !running_.load(std::memory_order_relaxed);
+            },
+            next_step - now);
+      }
     }
+#if defined(HFT_PERF_COUNTERS)
+    perf_.report();
+#endif
   }
 };
 } // namespace hft
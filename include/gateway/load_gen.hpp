@@ -0,0 +1,282 @@
+#pragma once
+
+#include "common/clock.hpp"
+#include "common/latency.hpp"
+#include "common/spsc_queue.hpp"
+#include "common/wait_strategy.hpp"
+#include "gateway_sim.hpp"
+#include "market/order_flow.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Open-loop load generation against a running EngineThread. Producer threads each pre-generate a
+// command stream (OrderFlowGenerator) and push it into the engine through their own SPSC input on
+// a fixed schedule: at offered rate R, command i of the combined stream is due at t0 + i / R,
+// however far behind the engine is. Each command's origin stamp is its due time, not the moment it
+// actually went out, so time spent waiting behind a slow engine or a full queue counts as latency
+// (no coordinated omission). The engine finishes every command with exactly one final exec (Ack,
+// CancelAck, Reject, or a Trade leaving nothing open); the time from due to that exec is the
+// command's latency.
+//
+// Offered rates are held for step_ns each, from a list or doubling from ramp_start, until the
+// engine falls behind: achieved throughput under saturated_below of offered, or answers missing
+// once the producers are done. Rate 0 pushes back to back, stamping each command when its push is
+// first attempted.
+namespace hft::loadgen
+{
+inline constexpr u64 kFirstUser = 3'000'000; // producer p sends as user kFirstUser + p
+
+struct Config
+{
+  unsigned producers{1};
+  u64 step_ns{1'000'000'000};  // how long each offered rate is held
+  std::vector<double> rates{}; // commands per second over all producers; empty: ramp
+  double ramp_start{25'000};
+  double ramp_factor{2.0};
+  double ramp_limit{100'000'000};
+  double saturated_below{0.9};
+  std::size_t burst_commands{1'000'000}; // per producer at rate 0
+  u64 drain_timeout_ns{1'000'000'000};   // wait for answers this long after the last push
+  OrderFlowConfig flow{.cancel_ratio = 0.4, .marketable_ratio = 0.15}; // about as many out as in
+};
+
+struct Point
+{
+  double offered{0}; // commands per second; 0 = as fast as possible
+  double achieved{0};
+  u64 sent{0};
+  u64 answered{0};
+  u64 p50_ns{0};
+  u64 p99_ns{0};
+  u64 p999_ns{0};
+  u64 max_ns{0};
+  bool saturated{false};
+};
+
+class Producer
+{
+  OrderFlowGenerator gen_;
+  std::unique_ptr<EngineThread::CommandQueue> q_ = std::make_unique<EngineThread::CommandQueue>();
+  std::vector<EngineCommand> stream_;
+
+public:
+  explicit Producer(const OrderFlowConfig &flow) : gen_(flow)
+  {
+  }
+
+  EngineThread::CommandQueue &queue() noexcept
+  {
+    return *q_;
+  }
+
+  // Generate the next `n` commands now, outside the timed send.
+  void prepare(std::size_t n)
+  {
+    stream_.clear();
+    gen_.generate(n, stream_);
+  }
+
+  std::size_t size() const noexcept
+  {
+    return stream_.size();
+  }
+
+  // Command i is due at first_due + i * interval_ns; interval 0 sends back to back from first_due.
+  void send(EngineThread &engine, u64 first_due, double interval_ns)
+  {
+    const bool paced = interval_ns > 0;
+    while (now_ns() < first_due)
+      std::this_thread::yield();
+    for (std::size_t i = 0; i < stream_.size(); ++i)
+    {
+      EngineCommand &cmd = stream_[i];
+      if (paced)
+      {
+        const u64 due = first_due + static_cast<u64>(static_cast<double>(i) * interval_ns);
+        for (u64 now = now_ns(); now < due; now = now_ns())
+        {
+          if (due - now > 20'000)
+            std::this_thread::yield(); // far off: let the engine have the core if it shares ours
+          else
+            wait::cpu_relax();
+        }
+        cmd.lat.origin_ns = due;
+      }
+      else
+        cmd.lat.origin_ns = now_ns();
+      for (int polls = 0; !q_->push(cmd); ++polls)
+      {
+        if (polls < 256)
+          wait::cpu_relax();
+        else
+          std::this_thread::yield(); // the engine may be waiting for our core
+      }
+      if (paced || i % 64 == 63)
+        engine.notify_input();
+    }
+    engine.notify_input();
+  }
+};
+
+class Driver
+{
+  Config cfg_;
+  std::vector<Producer> producers_;
+
+  // The last exec a command of ours produces.
+  static bool final_answer(const ExecEvent &e) noexcept
+  {
+    return e.user_id >= kFirstUser && e.user_id < kFirstUser + EngineThread::kMaxExtraInputs &&
+           (e.type != ExecType::Trade || e.leaves == 0);
+  }
+
+  Point step(EngineThread &engine, spsc::Queue<ExecEvent, 1 << 14> &exec_q, double rate)
+  {
+    const std::size_t n = producers_.size();
+    const bool paced = rate > 0;
+    const std::size_t per =
+        paced ? std::max<std::size_t>(1, static_cast<std::size_t>(
+                                             rate * static_cast<double>(cfg_.step_ns) / 1e9 /
+                                             static_cast<double>(n)))
+              : cfg_.burst_commands;
+    for (Producer &p : producers_)
+      p.prepare(per);
+    ExecEvent e;
+    while (exec_q.pop(e))
+    {
+    }
+
+    auto hist = std::make_unique<latency::Histogram>();
+    // Producer p takes every n-th slot of the combined schedule.
+    const double interval = paced ? 1e9 / rate : 0;
+    const u64 t0 = now_ns() + 1'000'000; // every producer is running before the first due time
+    std::atomic<std::size_t> done{0};
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < n; ++i)
+      threads.emplace_back(
+          [&, i]
+          {
+            producers_[i].send(engine, t0 + static_cast<u64>(static_cast<double>(i) * interval),
+                               interval * static_cast<double>(n));
+            done.fetch_add(1, std::memory_order_release);
+          });
+
+    const u64 sent = static_cast<u64>(per) * n;
+    u64 answered = 0;
+    u64 last = t0;
+    u64 all_sent_at = 0;
+    while (answered < sent)
+    {
+      if (!exec_q.pop(e))
+      {
+        const u64 now = now_ns();
+        if (all_sent_at == 0 && done.load(std::memory_order_acquire) == n)
+          all_sent_at = now;
+        if (all_sent_at != 0 && now - all_sent_at > cfg_.drain_timeout_ns)
+          break;
+        std::this_thread::yield();
+        continue;
+      }
+      if (!final_answer(e) || e.lat.origin_ns < t0)
+        continue; // a late answer from the previous step counts for neither
+      last = now_ns();
+      hist->record(last > e.lat.origin_ns ? last - e.lat.origin_ns : 0);
+      ++answered;
+    }
+    for (std::thread &t : threads)
+      t.join();
+
+    Point pt{};
+    pt.offered = rate;
+    pt.sent = sent;
+    pt.answered = answered;
+    pt.achieved = last > t0 ? static_cast<double>(answered) * 1e9 / static_cast<double>(last - t0)
+                            : 0.0;
+    pt.p50_ns = hist->percentile(0.50);
+    pt.p99_ns = hist->percentile(0.99);
+    pt.p999_ns = hist->percentile(0.999);
+    pt.max_ns = hist->max();
+    pt.saturated =
+        answered < sent || (paced && pt.achieved < cfg_.saturated_below * pt.offered);
+    return pt;
+  }
+
+public:
+  explicit Driver(const Config &cfg) : cfg_(cfg)
+  {
+    const unsigned n = std::clamp<unsigned>(cfg.producers, 1, EngineThread::kMaxExtraInputs);
+    producers_.reserve(n);
+    for (unsigned p = 0; p < n; ++p)
+    {
+      OrderFlowConfig flow = cfg.flow;
+      flow.seed = cfg.flow.seed + p;
+      flow.user_id = kFirstUser + p;
+      flow.first_order_id = (u64{p} + 1) << 40; // clear of street and strategy ids
+      producers_.emplace_back(flow);
+    }
+  }
+
+  // Give every producer its own engine input. Call before engine.start().
+  bool attach(EngineThread &engine)
+  {
+    for (Producer &p : producers_)
+      if (!engine.add_input(p.queue()))
+        return false;
+    return true;
+  }
+
+  // Run the configured rates (or the ramp) against a started engine whose execs arrive on
+  // `exec_q`, which nothing else may drain meanwhile. With `progress`, prints each point as it
+  // completes.
+  std::vector<Point> run(EngineThread &engine, spsc::Queue<ExecEvent, 1 << 14> &exec_q,
+                         std::FILE *progress = nullptr)
+  {
+    std::vector<Point> curve;
+    if (progress != nullptr)
+      print_header(progress);
+    const auto one = [&](double rate)
+    {
+      curve.push_back(step(engine, exec_q, rate));
+      if (progress != nullptr)
+        print_point(progress, curve.back());
+      return curve.back().saturated;
+    };
+    if (!cfg_.rates.empty())
+    {
+      for (double r : cfg_.rates)
+        one(r);
+      return curve;
+    }
+    for (double r = cfg_.ramp_start; r <= cfg_.ramp_limit; r *= cfg_.ramp_factor)
+      if (one(r))
+        break;
+    return curve;
+  }
+
+  static void print_header(std::FILE *out)
+  {
+    std::fprintf(out, "%12s %12s %10s %10s %10s %10s %10s %10s\n", "offered/s", "achieved/s",
+                 "sent", "answered", "p50_us", "p99_us", "p99.9_us", "max_us");
+  }
+
+  static void print_point(std::FILE *out, const Point &p)
+  {
+    char offered[32];
+    if (p.offered > 0)
+      std::snprintf(offered, sizeof offered, "%.0f", p.offered);
+    else
+      std::snprintf(offered, sizeof offered, "max");
+    std::fprintf(out, "%12s %12.0f %10llu %10llu %10.1f %10.1f %10.1f %10.1f%s\n", offered,
+                 p.achieved, static_cast<unsigned long long>(p.sent),
+                 static_cast<unsigned long long>(p.answered), static_cast<double>(p.p50_ns) / 1e3,
+                 static_cast<double>(p.p99_ns) / 1e3, static_cast<double>(p.p999_ns) / 1e3,
+                 static_cast<double>(p.max_ns) / 1e3, p.saturated ? "  saturated" : "");
+    std::fflush(out);
+  }
+};
+} // namespace hft::loadgen
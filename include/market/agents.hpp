@@ -0,0 +1,316 @@
+#pragma once
+
+#include "arrivals.hpp"
+#include "common/random.hpp"
+#include "order.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// A population of street participants, each with its own user id, sizes and reaction rule:
+//   Noise     -> at random times, a limit add at a power-law depth or a marketable order, with a
+//                power-law size
+//   Provider  -> keeps one bid and one ask a fixed number of ticks around the mid, and requotes
+//                when the mid has moved
+//   Momentum  -> looks at the mid now and then and takes liquidity in the direction it moved
+//   Twap      -> works a large parent order in equal marketable slices over a horizon, then starts
+//                another on a random side
+// Agents cannot see their fills; a Provider learns that a quote traded away only from engines that
+// expose resting(id), and a Twap counts a slice as done once sent.
+//
+// Each agent has a next action time in a min-heap, so an action costs O(log N) in the population
+// size and agents with nothing to do cost nothing.
+namespace hft
+{
+enum class AgentKind : u8
+{
+  Noise,
+  Provider,
+  Momentum,
+  Twap
+};
+
+struct AgentsConfig
+{
+  u32 noise{500}; // agents of each kind
+  u32 providers{20};
+  u32 momentum{10};
+  u32 twap{2};
+  u64 first_user{1'000'000}; // agents take consecutive user ids from here, in the order above
+
+  double noise_rate{4};          // actions per second per noise trader
+  double noise_market_prob{0.3}; // share of noise actions that take liquidity
+  double size_exponent{2.0};     // noise sizes: P(q) ~ q^-k on [1, max_size]
+  Qty max_size{50};
+  double depth_exponent{1.5}; // noise adds: ticks from the tightest passive price, as arrivals.hpp
+  int max_depth{20};
+
+  u64 provider_refresh_ns{5'000'000}; // mean time between looks at the book
+  int provider_levels{3};             // provider i quotes 1 + i % levels ticks from the mid
+  Qty provider_qty{20};
+
+  u64 momentum_check_ns{20'000'000}; // mean time between looks at the mid
+  int momentum_threshold{2};         // ticks the mid must move between looks to trigger a take
+  Qty momentum_qty{10};
+
+  Qty twap_parent{2'000};
+  u64 twap_horizon_ns{60'000'000'000};
+  u32 twap_slices{120};
+};
+
+class AgentPopulation
+{
+  struct Agent
+  {
+    AgentKind kind{AgentKind::Noise};
+    Side side{Side::Buy}; // Twap: parent side
+    int level{0};         // Provider: ticks from the mid, less one
+    u32 slices_left{0};   // Twap
+    Qty qty{0};           // Provider: quote size; Twap: parent left
+    u64 user_id{0};
+    Price ref_mid2{0}; // Momentum: twice the mid at the last look
+    u64 bid_id{0};     // Provider quotes; 0 when none
+    u64 ask_id{0};
+    Price bid_px{0};
+    Price ask_px{0};
+  };
+
+  struct Wake
+  {
+    u64 at{0};
+    u32 agent{0};
+
+    bool operator>(const Wake &o) const noexcept
+    {
+      return at != o.at ? at > o.at : agent > o.agent; // ties in agent order: deterministic
+    }
+  };
+
+  AgentsConfig _cfg;
+  Price _mid;
+  Price _tick;
+  rng::Xoshiro256 _rng;
+  DepthSampler _size;  // noise size less one
+  DepthSampler _depth; // noise add depth
+  std::vector<Agent> _agents;
+  std::priority_queue<Wake, std::vector<Wake>, std::greater<>> _wakes;
+  u64 _actions{0};
+
+  u64 after(u64 t, double mean_ns) noexcept
+  {
+    return t + 1 + static_cast<u64>(_rng.exponential(1.0 / mean_ns));
+  }
+
+  // Touch with the configured mid standing in for an empty side.
+  void touch(const TopOfBook &t, Price &bid, Price &ask) const noexcept
+  {
+    bid = t.bid_price ? t.bid_price : (t.ask_price ? t.ask_price : _mid) - _tick;
+    ask = t.ask_price ? t.ask_price : (t.bid_price ? t.bid_price : _mid) + _tick;
+  }
+
+  template <typename Engine, typename Place>
+  u64 noise(Engine &engine, Agent &a, u64 ts, u64 &next_id, Place &place)
+  {
+    Price bid, ask;
+    touch(engine.top_snapshot(), bid, ask);
+    const Side side = (_rng.next() >> 63) != 0 ? Side::Sell : Side::Buy;
+    const Qty q = static_cast<Qty>(1 + _size(_rng));
+    if (_rng.chance(_cfg.noise_market_prob))
+      engine.inject_new(
+          NewOrder{next_id++, a.user_id, side, side == Side::Buy ? ask : bid, q, TIF::IOC, ts});
+    else
+    {
+      const Price off = (1 + _depth(_rng)) * _tick;
+      place(NewOrder{next_id++, a.user_id, side, side == Side::Buy ? ask - off : bid + off, q,
+                     TIF::Day, ts});
+    }
+    return after(ts, 1e9 / _cfg.noise_rate);
+  }
+
+  template <typename Engine> u64 provide(Engine &engine, Agent &a, u64 ts, u64 &next_id)
+  {
+    Price bid, ask;
+    touch(engine.top_snapshot(), bid, ask);
+    // The mid rounded down to a tick; quotes at least a tick either side of it never cross.
+    const Price mid = (bid + ask) / 2 / _tick * _tick;
+    const Price off = (1 + a.level) * _tick;
+    quote(engine, a, Side::Buy, a.bid_id, a.bid_px, mid - off, ts, next_id);
+    quote(engine, a, Side::Sell, a.ask_id, a.ask_px, mid + off, ts, next_id);
+    return after(ts, static_cast<double>(_cfg.provider_refresh_ns));
+  }
+
+  template <typename Engine>
+  void quote(Engine &engine, const Agent &a, Side side, u64 &id, Price &px, Price want, u64 ts,
+             u64 &next_id)
+  {
+    if constexpr (requires { engine.resting(u64{}); })
+    {
+      if (id != 0 && !engine.resting(id))
+        id = 0; // traded away
+    }
+    if (id != 0 && px == want)
+      return;
+    if constexpr (requires { engine.inject_cancel(CancelOrder{}); })
+    {
+      if (id != 0)
+        engine.inject_cancel(CancelOrder{id, a.user_id, ts});
+    }
+    id = next_id++;
+    px = want;
+    engine.inject_new(NewOrder{id, a.user_id, side, want, a.qty, TIF::Day, ts});
+  }
+
+  template <typename Engine> u64 chase(Engine &engine, Agent &a, u64 ts, u64 &next_id)
+  {
+    Price bid, ask;
+    touch(engine.top_snapshot(), bid, ask);
+    const Price mid2 = bid + ask;
+    const Price moved = mid2 - a.ref_mid2;
+    if (a.ref_mid2 != 0 && (moved >= 2 * _cfg.momentum_threshold * _tick ||
+                            -moved >= 2 * _cfg.momentum_threshold * _tick))
+    {
+      const Side side = moved > 0 ? Side::Buy : Side::Sell;
+      engine.inject_new(NewOrder{next_id++, a.user_id, side, side == Side::Buy ? ask : bid,
+                                 _cfg.momentum_qty, TIF::IOC, ts});
+    }
+    a.ref_mid2 = mid2;
+    return after(ts, static_cast<double>(_cfg.momentum_check_ns));
+  }
+
+  template <typename Engine> u64 slice(Engine &engine, Agent &a, u64 ts, u64 &next_id)
+  {
+    const u32 slices = std::max(1U, _cfg.twap_slices);
+    if (a.slices_left == 0)
+    {
+      a.side = (_rng.next() >> 63) != 0 ? Side::Sell : Side::Buy;
+      a.qty = _cfg.twap_parent;
+      a.slices_left = slices;
+    }
+    const Qty q = static_cast<Qty>((a.qty + static_cast<Qty>(a.slices_left) - 1) /
+                                   static_cast<Qty>(a.slices_left));
+    a.qty -= q;
+    --a.slices_left;
+    if (q > 0)
+    {
+      Price bid, ask;
+      touch(engine.top_snapshot(), bid, ask);
+      engine.inject_new(
+          NewOrder{next_id++, a.user_id, a.side, a.side == Side::Buy ? ask : bid, q, TIF::IOC, ts});
+    }
+    return ts + std::max<u64>(1, _cfg.twap_horizon_ns / slices);
+  }
+
+  // First action. Agents that act at random start in their stationary state (memoryless waits),
+  // and a Twap starts somewhere in its first period, so agents of a kind do not act in step.
+  u64 first(const Agent &a, u64 t0) noexcept
+  {
+    switch (a.kind)
+    {
+    case AgentKind::Noise:
+      return after(t0, 1e9 / _cfg.noise_rate);
+    case AgentKind::Provider:
+      return t0; // quote at once
+    case AgentKind::Momentum:
+      return after(t0, static_cast<double>(_cfg.momentum_check_ns));
+    case AgentKind::Twap:
+      break;
+    }
+    const u64 period = _cfg.twap_horizon_ns / std::max(1U, _cfg.twap_slices);
+    return t0 + static_cast<u64>(_rng.uniform() * static_cast<double>(period));
+  }
+
+public:
+  // `mid` and `tick` price orders while a side of the book is empty.
+  explicit AgentPopulation(const AgentsConfig &cfg = {}, Price mid = 10'000, Price tick = 1,
+                           u64 seed = 1)
+      : _cfg(cfg), _mid(mid), _tick(tick), _rng(seed),
+        _size(cfg.size_exponent, std::max<int>(1, cfg.max_size)),
+        _depth(cfg.depth_exponent, cfg.max_depth)
+  {
+    u64 user = cfg.first_user;
+    const auto add = [&](AgentKind kind, u32 n)
+    {
+      for (u32 i = 0; i < n; ++i)
+      {
+        Agent a{};
+        a.kind = kind;
+        a.user_id = user++;
+        if (kind == AgentKind::Provider)
+        {
+          a.level = static_cast<int>(i % static_cast<u32>(std::max(1, cfg.provider_levels)));
+          a.qty = cfg.provider_qty;
+        }
+        _agents.push_back(a);
+      }
+    };
+    add(AgentKind::Noise, cfg.noise_rate > 0 ? cfg.noise : 0);
+    add(AgentKind::Provider, cfg.providers);
+    add(AgentKind::Momentum, cfg.momentum);
+    add(AgentKind::Twap, cfg.twap);
+  }
+
+  // Schedule every agent's first action at or after `t0`.
+  void start(u64 t0)
+  {
+    _wakes = {};
+    for (u32 i = 0; i < _agents.size(); ++i)
+      _wakes.push(Wake{first(_agents[i], t0), i});
+  }
+
+  bool started() const noexcept
+  {
+    return !_wakes.empty();
+  }
+
+  std::size_t size() const noexcept
+  {
+    return _agents.size();
+  }
+
+  u64 actions() const noexcept
+  {
+    return _actions;
+  }
+
+  // Time of the next action; UINT64_MAX before start() or with no agents.
+  u64 next_ns() const noexcept
+  {
+    return _wakes.empty() ? UINT64_MAX : _wakes.top().at;
+  }
+
+  // Run every action due by `ts` in time order, each stamped with its own time. Order ids come
+  // from `next_id`. Noise limit adds go to `place(const NewOrder &)` so the caller can track and
+  // retire them; everything else goes straight to `engine`.
+  template <typename Engine, typename Place>
+  void run(Engine &engine, u64 ts, u64 &next_id, Place &&place)
+  {
+    while (!_wakes.empty() && _wakes.top().at <= ts)
+    {
+      const Wake w = _wakes.top();
+      _wakes.pop();
+      Agent &a = _agents[w.agent];
+      u64 next = 0;
+      switch (a.kind)
+      {
+      case AgentKind::Noise:
+        next = noise(engine, a, w.at, next_id, place);
+        break;
+      case AgentKind::Provider:
+        next = provide(engine, a, w.at, next_id);
+        break;
+      case AgentKind::Momentum:
+        next = chase(engine, a, w.at, next_id);
+        break;
+      case AgentKind::Twap:
+        next = slice(engine, a, w.at, next_id);
+        break;
+      }
+      ++_actions;
+      _wakes.push(Wake{next, w.agent});
+    }
+  }
+};
+} // namespace hft
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "common/random.hpp"
+#include "order.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Street order flow as point processes in time rather than draws per loop iteration. Limit adds,
+// marketable orders and cancels each arrive at their own rate, either constant (Poisson) or
+// self-exciting (Hawkes with an exponential kernel: every event lifts its own type's intensity by
+// alpha, which decays back to the base rate at beta per second). Cancels are per resting order,
+// as in queue-reactive book models: their base rate is cancel_rate times the resting count the
+// caller reports with set_resting(), so a deep book thins out faster and stays bounded. Arrivals
+// are drawn by Ogata thinning: between events the intensity only decays, so its value at the last
+// event bounds it until the next candidate.
+//
+// Adds are placed a power-law number of ticks d >= 0 away from the opposite best, P(d) ~ (d+1)^-k:
+// d = 0 is the tightest passive price, one tick inside the far touch, so a wide spread fills in
+// quickly while most orders still land near the top and a few far behind it.
+namespace hft
+{
+enum class ArrivalKind : u8
+{
+  Add,
+  Market,
+  Cancel
+};
+
+inline constexpr std::size_t kArrivalKinds = 3;
+
+struct ArrivalConfig
+{
+  double add_rate{2'000}; // base intensities, events per second
+  double market_rate{600};
+  double cancel_rate{20}; // per resting order
+  bool hawkes{false};         // false: Poisson at the base rates
+  double hawkes_alpha{600};   // intensity jump per event, per second; keep alpha < beta
+  double hawkes_beta{1'000};  // decay rate of the jump, per second
+  double depth_exponent{1.5}; // k in P(d) ~ (d+1)^-k
+  int max_depth{20};          // adds land at d in [0, max_depth)
+  Qty qty{5};
+};
+
+// Draws d in [0, levels) with P(d) ~ (d+1)^-exponent from a precomputed CDF.
+class DepthSampler
+{
+  std::vector<double> _cdf;
+
+public:
+  explicit DepthSampler(double exponent = 1.5, int levels = 20)
+  {
+    const int n = std::max(1, levels);
+    double sum = 0;
+    for (int d = 0; d < n; ++d)
+    {
+      sum += std::pow(static_cast<double>(d + 1), -exponent);
+      _cdf.push_back(sum);
+    }
+    for (double &c : _cdf)
+      c /= sum;
+    _cdf.back() = 1.0;
+  }
+
+  int operator()(rng::Xoshiro256 &rng) const noexcept
+  {
+    // The last entry is exactly 1 and u < 1, so this never runs off the end.
+    const double u = rng.uniform();
+    return static_cast<int>(std::upper_bound(_cdf.begin(), _cdf.end(), u) - _cdf.begin());
+  }
+};
+
+struct Arrival
+{
+  u64 ts_ns{0};
+  ArrivalKind kind{ArrivalKind::Add};
+  Side side{Side::Buy};
+  int depth{0}; // adds only: ticks away from the tightest passive price
+};
+
+class ArrivalProcess
+{
+  ArrivalConfig _cfg;
+  rng::Xoshiro256 _rng;
+  double _base[kArrivalKinds]{};   // per ns
+  double _excess[kArrivalKinds]{}; // Hawkes intensity above base at _t, per ns
+  double _alpha{0};                // per ns
+  double _beta{0};                 // per ns
+  double _cancel_per_order{0};     // per ns
+  DepthSampler _depth;
+  u64 _origin{0};
+  double _t{0}; // ns since _origin of the last event or rejected candidate
+  Arrival _pending{};
+  bool _drawn{false}; // _pending is the next arrival under the current intensities
+  bool _started{false};
+
+  double total() const noexcept
+  {
+    double sum = 0;
+    for (std::size_t k = 0; k < kArrivalKinds; ++k)
+      sum += _base[k] + _excess[k];
+    return sum;
+  }
+
+  void draw() noexcept
+  {
+    _drawn = true;
+    for (;;)
+    {
+      const double bound = total();
+      if (bound <= 0)
+      {
+        _pending.ts_ns = UINT64_MAX; // nothing ever arrives
+        return;
+      }
+      const double t = _t + _rng.exponential(bound);
+      if (_cfg.hawkes)
+      {
+        const double f = std::exp(-_beta * (t - _t));
+        for (double &x : _excess)
+          x *= f;
+      }
+      _t = t;
+      // Accept with probability intensity(t) / bound and pick the kind in proportion.
+      double u = _rng.uniform() * bound;
+      std::size_t k = 0;
+      for (; k < kArrivalKinds; ++k)
+      {
+        const double rate = _base[k] + _excess[k];
+        if (u < rate)
+          break;
+        u -= rate;
+      }
+      if (k == kArrivalKinds)
+        continue; // thinned away
+      if (_cfg.hawkes)
+        _excess[k] += _alpha;
+      _pending.ts_ns = _origin + static_cast<u64>(t);
+      _pending.kind = static_cast<ArrivalKind>(k);
+      _pending.side = (_rng.next() >> 63) != 0 ? Side::Sell : Side::Buy;
+      _pending.depth = _pending.kind == ArrivalKind::Add ? _depth(_rng) : 0;
+      return;
+    }
+  }
+
+public:
+  explicit ArrivalProcess(const ArrivalConfig &cfg = {}, u64 seed = 1)
+      : _cfg(cfg), _rng(seed), _alpha(cfg.hawkes_alpha * 1e-9), _beta(cfg.hawkes_beta * 1e-9),
+        _depth(cfg.depth_exponent, cfg.max_depth)
+  {
+    _base[static_cast<std::size_t>(ArrivalKind::Add)] = std::max(0.0, cfg.add_rate) * 1e-9;
+    _base[static_cast<std::size_t>(ArrivalKind::Market)] = std::max(0.0, cfg.market_rate) * 1e-9;
+    _cancel_per_order = std::max(0.0, cfg.cancel_rate) * 1e-9;
+  }
+
+  // Begin the process at `t0`; the first arrival comes at or after it.
+  void start(u64 t0) noexcept
+  {
+    _origin = t0;
+    _t = 0;
+    _started = true;
+    _drawn = false;
+  }
+
+  bool started() const noexcept
+  {
+    return _started;
+  }
+
+  // Orders resting that a cancel could hit. Takes effect from the next draw, so call it between
+  // pop() and the following next_ns().
+  void set_resting(std::size_t n) noexcept
+  {
+    _base[static_cast<std::size_t>(ArrivalKind::Cancel)] =
+        _cancel_per_order * static_cast<double>(n);
+  }
+
+  // Time of the next arrival; UINT64_MAX when every rate is zero.
+  u64 next_ns() noexcept
+  {
+    if (!_drawn)
+      draw();
+    return _pending.ts_ns;
+  }
+
+  Arrival pop() noexcept
+  {
+    if (!_drawn)
+      draw();
+    _drawn = false;
+    return _pending;
+  }
+
+  // Current intensity of one kind (at the last candidate time), events per second.
+  double rate(ArrivalKind k) const noexcept
+  {
+    const std::size_t i = static_cast<std::size_t>(k);
+    return (_base[i] + _excess[i]) * 1e9;
+  }
+};
+} // namespace hft
@@ -0,0 +1,500 @@
+#pragma once
+
+#include "common/types.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// NASDAQ TotalView-ITCH 5.0 binary messages, the subset that builds a market-by-order book:
+// stock directory, add (with and without MPID), executed (with and without price), cancel, delete,
+// replace and non-displayed trade. Everything else is skipped by its length.
+//
+// Files use the usual "BinaryFILE" framing: each message is preceded by a big-endian u16 length.
+// All fields are big-endian. Every message starts with the same 11-byte header:
+//   type u8 (ASCII), stock locate u16, tracking number u16, timestamp u48 (ns since midnight)
+// Prices are u32 with four implied decimals and are kept in those units as ticks.
+//
+// parse() decodes each message straight from the caller's buffer (typically a MappedFile) into a
+// small struct on the stack and hands it to the handler: no copies of the input, no allocation.
+namespace hft::itch
+{
+inline constexpr std::size_t kHeaderLen = 11;
+
+enum class MsgType : char
+{
+  SystemEvent = 'S',
+  StockDirectory = 'R',
+  AddOrder = 'A',
+  AddOrderMpid = 'F',
+  Executed = 'E',
+  ExecutedWithPrice = 'C',
+  Cancel = 'X',
+  Delete = 'D',
+  Replace = 'U',
+  Trade = 'P'
+};
+
+// Length of a message type, header included; 0 for types this parser does not decode.
+constexpr std::size_t msg_length(char type) noexcept
+{
+  switch (static_cast<MsgType>(type))
+  {
+  case MsgType::SystemEvent:
+    return 12;
+  case MsgType::StockDirectory:
+    return 39;
+  case MsgType::AddOrder:
+    return 36;
+  case MsgType::AddOrderMpid:
+    return 40;
+  case MsgType::Executed:
+    return 31;
+  case MsgType::ExecutedWithPrice:
+    return 36;
+  case MsgType::Cancel:
+    return 23;
+  case MsgType::Delete:
+    return 19;
+  case MsgType::Replace:
+    return 35;
+  case MsgType::Trade:
+    return 44;
+  }
+  return 0;
+}
+
+template <typename V> inline V load_be(const std::byte *p) noexcept
+{
+  V v;
+  std::memcpy(&v, p, sizeof(V));
+  if constexpr (std::endian::native == std::endian::little)
+    v = std::byteswap(v);
+  return v;
+}
+
+inline u64 load_be48(const std::byte *p) noexcept
+{
+  return static_cast<u64>(load_be<u16>(p)) << 32 | load_be<u32>(p + 2);
+}
+
+struct Header
+{
+  char type{0};
+  u16 locate{0};
+  u16 tracking{0};
+  u64 ts_ns{0};
+};
+
+struct StockDirectory
+{
+  Header h;
+  char stock[8]; // space padded
+};
+
+struct AddOrder // 'A' and 'F'
+{
+  Header h;
+  u64 ref{0};
+  Side side{Side::Buy};
+  u32 shares{0};
+  char stock[8];
+  u32 price{0};
+};
+
+struct Executed // 'E' and 'C'
+{
+  Header h;
+  u64 ref{0};
+  u32 shares{0};
+  u64 match{0};
+  bool with_price{false}; // 'C': executed at `price` rather than the order's price
+  bool printable{true};   // 'C' with printable 'N' must not reach the tape
+  u32 price{0};
+};
+
+struct Cancel // partial
+{
+  Header h;
+  u64 ref{0};
+  u32 shares{0};
+};
+
+struct Delete
+{
+  Header h;
+  u64 ref{0};
+};
+
+struct Replace // cancel `orig_ref` and add `new_ref` on the same side, losing priority
+{
+  Header h;
+  u64 orig_ref{0};
+  u64 new_ref{0};
+  u32 shares{0};
+  u32 price{0};
+};
+
+struct Trade // execution against a non-displayed order; `side` is that order's side
+{
+  Header h;
+  u64 ref{0};
+  Side side{Side::Buy};
+  u32 shares{0};
+  char stock[8];
+  u32 price{0};
+  u64 match{0};
+};
+
+struct ParseResult
+{
+  u64 messages{0};         // framed messages seen, decoded or skipped
+  u64 skipped{0};          // types without a decoder, or a handler callback
+  std::size_t consumed{0}; // bytes up to the end of the last whole message
+  bool truncated{false};   // the buffer ends inside a message
+  bool malformed{false};   // a known type shorter than its fixed length; parsing stopped there
+};
+
+// Decode every message in [data, data + len) and call the matching handler member. Handlers only
+// implement the callbacks they need: on_system(Header), on_directory, on_add, on_executed,
+// on_cancel, on_delete, on_replace, on_trade.
+template <typename Handler>
+ParseResult parse(const std::byte *data, std::size_t len, Handler &h) noexcept
+{
+  ParseResult r;
+  std::size_t pos = 0;
+  while (pos + sizeof(u16) <= len)
+  {
+    const std::size_t n = load_be<u16>(data + pos);
+    const std::byte *m = data + pos + sizeof(u16);
+    if (pos + sizeof(u16) + n > len)
+    {
+      r.truncated = true;
+      break;
+    }
+    if (n == 0)
+    {
+      r.malformed = true;
+      break;
+    }
+    const char type = static_cast<char>(m[0]);
+    const std::size_t need = msg_length(type);
+    if (need == 0)
+    {
+      ++r.messages;
+      ++r.skipped;
+      pos += sizeof(u16) + n;
+      continue;
+    }
+    if (n < need)
+    {
+      r.malformed = true;
+      break;
+    }
+
+    const Header hdr{type, load_be<u16>(m + 1), load_be<u16>(m + 3), load_be48(m + 5)};
+    const std::byte *b = m + kHeaderLen;
+    bool handled = false;
+    switch (static_cast<MsgType>(type))
+    {
+    case MsgType::SystemEvent:
+      if constexpr (requires { h.on_system(hdr); })
+      {
+        h.on_system(hdr);
+        handled = true;
+      }
+      break;
+    case MsgType::StockDirectory:
+      if constexpr (requires(const StockDirectory &v) { h.on_directory(v); })
+      {
+        StockDirectory v{hdr, {}};
+        std::memcpy(v.stock, b, sizeof(v.stock));
+        h.on_directory(v);
+        handled = true;
+      }
+      break;
+    case MsgType::AddOrder:
+    case MsgType::AddOrderMpid:
+      if constexpr (requires(const AddOrder &v) { h.on_add(v); })
+      {
+        AddOrder v{hdr, load_be<u64>(b), static_cast<char>(b[8]) == 'S' ? Side::Sell : Side::Buy,
+                   load_be<u32>(b + 9), {}, load_be<u32>(b + 21)};
+        std::memcpy(v.stock, b + 13, sizeof(v.stock));
+        h.on_add(v);
+        handled = true;
+      }
+      break;
+    case MsgType::Executed:
+    case MsgType::ExecutedWithPrice:
+      if constexpr (requires(const Executed &v) { h.on_executed(v); })
+      {
+        Executed v{hdr, load_be<u64>(b), load_be<u32>(b + 8), load_be<u64>(b + 12)};
+        if (type == static_cast<char>(MsgType::ExecutedWithPrice))
+        {
+          v.with_price = true;
+          v.printable = static_cast<char>(b[20]) != 'N';
+          v.price = load_be<u32>(b + 21);
+        }
+        h.on_executed(v);
+        handled = true;
+      }
+      break;
+    case MsgType::Cancel:
+      if constexpr (requires(const Cancel &v) { h.on_cancel(v); })
+      {
+        h.on_cancel(Cancel{hdr, load_be<u64>(b), load_be<u32>(b + 8)});
+        handled = true;
+      }
+      break;
+    case MsgType::Delete:
+      if constexpr (requires(const Delete &v) { h.on_delete(v); })
+      {
+        h.on_delete(Delete{hdr, load_be<u64>(b)});
+        handled = true;
+      }
+      break;
+    case MsgType::Replace:
+      if constexpr (requires(const Replace &v) { h.on_replace(v); })
+      {
+        h.on_replace(
+            Replace{hdr, load_be<u64>(b), load_be<u64>(b + 8), load_be<u32>(b + 16),
+                    load_be<u32>(b + 20)});
+        handled = true;
+      }
+      break;
+    case MsgType::Trade:
+      if constexpr (requires(const Trade &v) { h.on_trade(v); })
+      {
+        Trade v{hdr, load_be<u64>(b), static_cast<char>(b[8]) == 'S' ? Side::Sell : Side::Buy,
+                load_be<u32>(b + 9), {}, load_be<u32>(b + 21), load_be<u64>(b + 25)};
+        std::memcpy(v.stock, b + 13, sizeof(v.stock));
+        h.on_trade(v);
+        handled = true;
+      }
+      break;
+    }
+    ++r.messages;
+    r.skipped += handled ? 0 : 1;
+    pos += sizeof(u16) + n;
+  }
+  r.consumed = pos;
+  return r;
+}
+
+// Appends framed messages to a buffer: fixtures, tests and benchmark input.
+class Encoder
+{
+  std::vector<std::byte> &_out;
+  std::size_t _start{0};
+
+  template <typename V> void put(V v)
+  {
+    if constexpr (sizeof(V) > 1 && std::endian::native == std::endian::little)
+      v = std::byteswap(v);
+    const auto *p = reinterpret_cast<const std::byte *>(&v);
+    _out.insert(_out.end(), p, p + sizeof(V));
+  }
+
+  void begin(MsgType type, u16 locate, u64 ts_ns)
+  {
+    _start = _out.size();
+    put(u16{0}); // length, patched by end()
+    put(static_cast<char>(type));
+    put(locate);
+    put(u16{0});
+    put(static_cast<u16>(ts_ns >> 32));
+    put(static_cast<u32>(ts_ns));
+  }
+
+  void end()
+  {
+    const u16 n = static_cast<u16>(_out.size() - _start - sizeof(u16));
+    _out[_start] = static_cast<std::byte>(n >> 8);
+    _out[_start + 1] = static_cast<std::byte>(n & 0xff);
+  }
+
+  void put_stock(sv stock)
+  {
+    for (std::size_t i = 0; i < 8; ++i)
+      put(i < stock.size() ? stock[i] : ' ');
+  }
+
+  void put_side(Side s)
+  {
+    put(s == Side::Buy ? 'B' : 'S');
+  }
+
+public:
+  explicit Encoder(std::vector<std::byte> &out) noexcept : _out(out) {}
+
+  void system_event(u64 ts_ns, char code)
+  {
+    begin(MsgType::SystemEvent, 0, ts_ns);
+    put(code);
+    end();
+  }
+
+  void directory(u16 locate, u64 ts_ns, sv stock)
+  {
+    begin(MsgType::StockDirectory, locate, ts_ns);
+    put_stock(stock);
+    put('Q');      // market category
+    put('N');      // financial status
+    put(u32{100}); // round lot
+    for (int i = 0; i < 14; ++i)
+      put(' '); // remaining flags, as "not available"
+    end();
+  }
+
+  void add(u16 locate, u64 ts_ns, u64 ref, Side side, u32 shares, sv stock, u32 price)
+  {
+    begin(MsgType::AddOrder, locate, ts_ns);
+    put(ref);
+    put_side(side);
+    put(shares);
+    put_stock(stock);
+    put(price);
+    end();
+  }
+
+  void executed(u16 locate, u64 ts_ns, u64 ref, u32 shares, u64 match)
+  {
+    begin(MsgType::Executed, locate, ts_ns);
+    put(ref);
+    put(shares);
+    put(match);
+    end();
+  }
+
+  void executed_at(u16 locate, u64 ts_ns, u64 ref, u32 shares, u64 match, u32 price,
+                   bool printable = true)
+  {
+    begin(MsgType::ExecutedWithPrice, locate, ts_ns);
+    put(ref);
+    put(shares);
+    put(match);
+    put(printable ? 'Y' : 'N');
+    put(price);
+    end();
+  }
+
+  void cancel(u16 locate, u64 ts_ns, u64 ref, u32 shares)
+  {
+    begin(MsgType::Cancel, locate, ts_ns);
+    put(ref);
+    put(shares);
+    end();
+  }
+
+  void remove(u16 locate, u64 ts_ns, u64 ref)
+  {
+    begin(MsgType::Delete, locate, ts_ns);
+    put(ref);
+    end();
+  }
+
+  void replace(u16 locate, u64 ts_ns, u64 orig_ref, u64 new_ref, u32 shares, u32 price)
+  {
+    begin(MsgType::Replace, locate, ts_ns);
+    put(orig_ref);
+    put(new_ref);
+    put(shares);
+    put(price);
+    end();
+  }
+
+  void trade(u16 locate, u64 ts_ns, u64 ref, Side side, u32 shares, sv stock, u32 price, u64 match)
+  {
+    begin(MsgType::Trade, locate, ts_ns);
+    put(ref);
+    put_side(side);
+    put(shares);
+    put_stock(stock);
+    put(price);
+    put(match);
+    end();
+  }
+};
+
+// Seeded synthetic session for benchmarks and large replay files: adds, executions, partial
+// cancels, deletes and replaces across `instruments` stocks, bids below and asks above a fixed
+// mid so books never cross. About 20k orders stay live, as on a quiet book. Same seed, same bytes.
+inline void generate_session(std::vector<std::byte> &out, u64 messages, u64 seed = 1,
+                             u16 instruments = 8)
+{
+  struct Live
+  {
+    u64 ref;
+    u16 locate;
+    Side side;
+    u32 shares;
+    u32 price;
+  };
+  constexpr u32 kMid = 1'000'000;
+  constexpr u32 kTick = 100;
+  std::mt19937_64 rng(seed);
+  std::vector<Live> live;
+  Encoder enc(out);
+  u64 ts = 34'200'000'000'000;
+  u64 next_ref = 1;
+  u64 match = 1;
+  char name[16];
+  for (u16 l = 1; l <= instruments; ++l)
+  {
+    std::snprintf(name, sizeof(name), "SYM%u", static_cast<unsigned>(l));
+    enc.directory(l, ts, name);
+  }
+  for (u64 i = instruments; i < messages; ++i)
+  {
+    ts += 1 + rng() % 500;
+    const u64 roll = rng() % 100;
+    if (live.size() < 1'000 || (roll < 45 && live.size() < 20'000))
+    {
+      const u16 l = static_cast<u16>(1 + rng() % instruments);
+      const Side side = rng() % 2 == 0 ? Side::Buy : Side::Sell;
+      const u32 off = static_cast<u32>(1 + rng() % 50) * kTick;
+      const Live o{next_ref++, l, side, static_cast<u32>(100 * (1 + rng() % 10)),
+                   side == Side::Buy ? kMid - off : kMid + off};
+      std::snprintf(name, sizeof(name), "SYM%u", static_cast<unsigned>(l));
+      enc.add(o.locate, ts, o.ref, o.side, o.shares, name, o.price);
+      live.push_back(o);
+      continue;
+    }
+    const std::size_t at = rng() % live.size();
+    Live &o = live[at];
+    bool gone = false;
+    if (roll < 65)
+    {
+      const u32 n = o.shares <= 100 ? o.shares : 100;
+      enc.executed(o.locate, ts, o.ref, n, match++);
+      o.shares -= n;
+      gone = o.shares == 0;
+    }
+    else if (roll < 75 && o.shares > 100)
+    {
+      enc.cancel(o.locate, ts, o.ref, 100);
+      o.shares -= 100;
+    }
+    else if (roll < 90)
+    {
+      enc.remove(o.locate, ts, o.ref);
+      gone = true;
+    }
+    else
+    {
+      const u32 off = static_cast<u32>(1 + rng() % 50) * kTick;
+      const u32 px = o.side == Side::Buy ? kMid - off : kMid + off;
+      enc.replace(o.locate, ts, o.ref, next_ref, o.shares, px);
+      o.ref = next_ref++;
+      o.price = px;
+    }
+    if (gone)
+    {
+      o = live.back();
+      live.pop_back();
+    }
+  }
+}
+} // namespace hft::itch
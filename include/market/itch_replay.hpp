@@ -0,0 +1,241 @@
+#pragma once
+
+#include "common/broadcast_ring.hpp"
+#include "itch.hpp"
+#include "market_data.hpp"
+#include "order_book.hpp"
+
+#include <cstring>
+#include <vector>
+
+// Historical feed replay: applies decoded ITCH messages to one market-by-order OrderBook per
+// instrument (indexed by stock locate) and publishes what a strategy would see from the venue.
+// Each event goes to a sink `sink(locate, const MarketDataEvent &)`:
+//   TopOfBook  -> whenever a message changed the instrument's best bid or ask price or size
+//   TradePrint -> for each printable execution and non-displayed trade; the aggressor is the side
+//                 opposite the resting order
+// Events carry the message timestamp. Book updates never match: the feed reports executions, it
+// does not ask the book to find them.
+namespace hft
+{
+// Discards everything: replay for the books alone.
+struct NullSink
+{
+  void operator()(u16, const MarketDataEvent &) const noexcept {}
+};
+
+// Forwards one instrument's events into a broadcast ring, where strategies subscribe exactly as
+// they do to the engine's market data.
+template <typename Ring> struct RingSink
+{
+  Ring *ring{nullptr};
+  u16 locate{0};
+
+  void operator()(u16 l, const MarketDataEvent &ev) const noexcept
+  {
+    if (l == locate)
+      ring->push(ev);
+  }
+};
+
+struct ItchStats
+{
+  u64 adds{0};
+  u64 executions{0};
+  u64 cancels{0};
+  u64 deletes{0};
+  u64 replaces{0};
+  u64 trades{0};       // non-displayed trade messages
+  u64 tops{0};         // TopOfBook events published
+  u64 prints{0};       // TradePrint events published
+  u64 unknown_refs{0}; // messages naming an order not on the book (e.g. a file started mid-day)
+};
+
+template <typename Sink = NullSink> class ItchBooks
+{
+public:
+  struct Instrument
+  {
+    OrderBook book;
+    TopOfBook top{};
+    char symbol[9]{}; // from the stock directory or the first add, trailing spaces removed
+  };
+
+private:
+  std::vector<Instrument> _instruments;
+  Sink _sink;
+  ItchStats _stats;
+
+  Instrument &at(u16 locate)
+  {
+    if (locate >= _instruments.size())
+      _instruments.resize(static_cast<std::size_t>(locate) + 1);
+    return _instruments[locate];
+  }
+
+  static void set_symbol(Instrument &ins, const char (&stock)[8]) noexcept
+  {
+    std::size_t n = 8;
+    while (n > 0 && stock[n - 1] == ' ')
+      --n;
+    std::memcpy(ins.symbol, stock, n);
+    ins.symbol[n] = '\0';
+  }
+
+  // Could a change at `price` on `side` move the inside? Saves rebuilding the top for deep orders.
+  static bool at_top(const Instrument &ins, Side side, Price price) noexcept
+  {
+    if (side == Side::Buy)
+      return ins.top.bid_qty == 0 || price >= ins.top.bid_price;
+    return ins.top.ask_qty == 0 || price <= ins.top.ask_price;
+  }
+
+  void refresh_top(u16 locate, Instrument &ins, u64 ts_ns)
+  {
+    const TopOfBook t = ins.book.top(ts_ns);
+    if (t.bid_price == ins.top.bid_price && t.bid_qty == ins.top.bid_qty &&
+        t.ask_price == ins.top.ask_price && t.ask_qty == ins.top.ask_qty)
+      return;
+    ins.top = t;
+    ++_stats.tops;
+    _sink(locate, MarketDataEvent{t});
+  }
+
+  void print(u16 locate, Price price, Qty qty, Side resting, u64 ts_ns)
+  {
+    ++_stats.prints;
+    const Side aggressor = resting == Side::Buy ? Side::Sell : Side::Buy;
+    _sink(locate, MarketDataEvent{TradePrint{price, qty, aggressor, ts_ns}});
+  }
+
+public:
+  ItchBooks() = default;
+  explicit ItchBooks(Sink sink) : _sink(sink) {}
+
+  void on_directory(const itch::StockDirectory &m)
+  {
+    set_symbol(at(m.h.locate), m.stock);
+  }
+
+  void on_add(const itch::AddOrder &m)
+  {
+    ++_stats.adds;
+    Instrument &ins = at(m.h.locate);
+    if (ins.symbol[0] == '\0')
+      set_symbol(ins, m.stock);
+    const Price px = static_cast<Price>(m.price);
+    ins.book.add_passive(
+        NewOrder{m.ref, 0, m.side, px, static_cast<Qty>(m.shares), TIF::Day, m.h.ts_ns});
+    if (at_top(ins, m.side, px))
+      refresh_top(m.h.locate, ins, m.h.ts_ns);
+  }
+
+  void on_executed(const itch::Executed &m)
+  {
+    ++_stats.executions;
+    Instrument &ins = at(m.h.locate);
+    Price px = 0;
+    Side side = Side::Buy;
+    if (!ins.book.find(m.ref, px, side))
+    {
+      ++_stats.unknown_refs;
+      return;
+    }
+    const Qty qty = ins.book.reduce(m.ref, static_cast<Qty>(m.shares));
+    if (m.printable)
+      print(m.h.locate, m.with_price ? static_cast<Price>(m.price) : px, qty, side, m.h.ts_ns);
+    if (at_top(ins, side, px))
+      refresh_top(m.h.locate, ins, m.h.ts_ns);
+  }
+
+  void on_cancel(const itch::Cancel &m)
+  {
+    ++_stats.cancels;
+    Instrument &ins = at(m.h.locate);
+    Price px = 0;
+    Side side = Side::Buy;
+    if (!ins.book.find(m.ref, px, side))
+    {
+      ++_stats.unknown_refs;
+      return;
+    }
+    ins.book.reduce(m.ref, static_cast<Qty>(m.shares));
+    if (at_top(ins, side, px))
+      refresh_top(m.h.locate, ins, m.h.ts_ns);
+  }
+
+  void on_delete(const itch::Delete &m)
+  {
+    ++_stats.deletes;
+    Instrument &ins = at(m.h.locate);
+    Price px = 0;
+    Side side = Side::Buy;
+    if (!ins.book.find(m.ref, px, side))
+    {
+      ++_stats.unknown_refs;
+      return;
+    }
+    ins.book.cancel(m.ref);
+    if (at_top(ins, side, px))
+      refresh_top(m.h.locate, ins, m.h.ts_ns);
+  }
+
+  void on_replace(const itch::Replace &m)
+  {
+    ++_stats.replaces;
+    Instrument &ins = at(m.h.locate);
+    Price old_px = 0;
+    Side side = Side::Buy;
+    if (!ins.book.find(m.orig_ref, old_px, side))
+    {
+      ++_stats.unknown_refs;
+      return;
+    }
+    const Price px = static_cast<Price>(m.price);
+    const bool touched = at_top(ins, side, old_px) || at_top(ins, side, px);
+    ins.book.cancel(m.orig_ref);
+    ins.book.add_passive(
+        NewOrder{m.new_ref, 0, side, px, static_cast<Qty>(m.shares), TIF::Day, m.h.ts_ns});
+    if (touched)
+      refresh_top(m.h.locate, ins, m.h.ts_ns);
+  }
+
+  void on_trade(const itch::Trade &m)
+  {
+    ++_stats.trades;
+    print(m.h.locate, static_cast<Price>(m.price), static_cast<Qty>(m.shares), m.side, m.h.ts_ns);
+  }
+
+  // nullptr for a locate that never appeared.
+  const Instrument *instrument(u16 locate) const noexcept
+  {
+    return locate < _instruments.size() ? &_instruments[locate] : nullptr;
+  }
+
+  // Locate of `symbol`, or 0 (never a valid locate) when unknown.
+  u16 find(sv symbol) const noexcept
+  {
+    for (std::size_t i = 1; i < _instruments.size(); ++i)
+      if (symbol == _instruments[i].symbol)
+        return static_cast<u16>(i);
+    return 0;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return _instruments.size();
+  }
+
+  const ItchStats &stats() const noexcept
+  {
+    return _stats;
+  }
+};
+
+// Apply a whole ITCH buffer (e.g. a MappedFile) to `books`.
+template <typename Sink>
+itch::ParseResult replay_itch(const std::byte *data, std::size_t len, ItchBooks<Sink> &books)
+{
+  return itch::parse(data, len, books);
+}
+} // namespace hft
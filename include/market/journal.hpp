@@ -0,0 +1,426 @@
+#pragma once
+
+#include "common/async_writer.hpp"
+#include "common/overflow.hpp"
+#include "common/stats.hpp"
+#include "market_data.hpp"
+#include "risk/risk_gate.hpp"
+
+#include <cstring>
+#include <variant>
+#include <vector>
+
+// Binary journal of everything the matching engine consumes and produces, so a run can be
+// reproduced offline (see market/replay.hpp and hft_replay). The engine thread encodes frames and
+// copies them into an aio::AsyncWriter buffer; journaling costs it an encode and a memcpy per
+// frame, never a write or fsync, and nothing at all when no journal is attached.
+//
+// File layout (host byte order):
+//   "HFTJRNL1"                           file magic
+//   then frames: u16 len, followed by len bytes of
+//     u8 type, u64 seq, u64 ts_ns, body
+//   Seed    order_id u64, user_id u64, side u8, price i64, qty i32, tif u8, order ts u64
+//           (resting liquidity placed without matching, e.g. the simulator's initial book)
+//   New     same body as Seed; ts_ns is the engine's stamp for the command
+//   Cancel  order_id u64, user_id u64, cancel ts u64
+//   Exec    type u8, order_id u64, user_id u64, filled i32, price i64, leaves i32,
+//           reason u8 length + bytes
+//   Top     bid_price i64, bid_qty i32, ask_price i64, ask_qty i32
+//   Trade   price i64, qty i32, aggressor u8
+//   Config  passive_fills u8, then for exec and md: policy u8, spill_limit u64, high_water u64
+//   Limits  user_id u64, max_order_qty i32, max_open_orders u32, max_position i64,
+//           max_notional i64, price_collar i64
+// seq numbers every frame from 0 without gaps; the outputs of a command follow its input frame.
+// Config and Limits (ts_ns 0) describe the engine: whatever differs from a default engine when the
+// journal is attached, then every later change. A default engine writes neither.
+// Latency stamps are not journaled: they measure a run rather than describe it.
+namespace hft
+{
+enum class JournalType : u8
+{
+  Seed = 1,
+  New = 2,
+  Cancel = 3,
+  Exec = 4,
+  Top = 5,
+  Trade = 6,
+  Config = 7,
+  Limits = 8
+};
+
+inline const char *to_string(JournalType t) noexcept
+{
+  switch (t)
+  {
+  case JournalType::Seed:
+    return "seed";
+  case JournalType::New:
+    return "new";
+  case JournalType::Cancel:
+    return "cancel";
+  case JournalType::Exec:
+    return "exec";
+  case JournalType::Top:
+    return "top";
+  case JournalType::Trade:
+    return "trade";
+  case JournalType::Config:
+    return "config";
+  case JournalType::Limits:
+    return "limits";
+  }
+  return "unknown";
+}
+
+inline constexpr char kJournalMagic[8] = {'H', 'F', 'T', 'J', 'R', 'N', 'L', '1'};
+
+// One encoded frame, length prefix included. Sized for the largest (an exec with a full reason).
+struct JournalFrame
+{
+  static constexpr std::size_t kMaxBytes = 126;
+  static constexpr std::size_t kMaxReason = 63;
+  u16 size{0};
+  std::byte bytes[kMaxBytes];
+};
+static_assert(sizeof(JournalFrame) == 128, "JournalFrame should stay two cache lines");
+
+class JournalEncoder
+{
+  JournalFrame &_f;
+
+public:
+  JournalEncoder(JournalFrame &f, JournalType type, u64 seq, u64 ts_ns) noexcept : _f(f)
+  {
+    _f.size = sizeof(u16);
+    put(static_cast<u8>(type));
+    put(seq);
+    put(ts_ns);
+  }
+
+  template <typename V> void put(V v) noexcept
+  {
+    std::memcpy(&_f.bytes[_f.size], &v, sizeof(V));
+    _f.size = static_cast<u16>(_f.size + sizeof(V));
+  }
+
+  void put_str(sv s) noexcept
+  {
+    const std::size_t n = s.size() < JournalFrame::kMaxReason ? s.size() : JournalFrame::kMaxReason;
+    put(static_cast<u8>(n));
+    std::memcpy(&_f.bytes[_f.size], s.data(), n);
+    _f.size = static_cast<u16>(_f.size + n);
+  }
+
+  void put_order(const NewOrder &n) noexcept
+  {
+    put(n.order_id);
+    put(n.user_id);
+    put(static_cast<u8>(n.side));
+    put(n.price);
+    put(n.qty);
+    put(static_cast<u8>(n.tif));
+    put(n.ts_ns);
+  }
+
+  void put_policy(const overflow::Config &c) noexcept
+  {
+    put(static_cast<u8>(c.policy));
+    put(static_cast<u64>(c.spill_limit));
+    put(static_cast<u64>(c.high_water));
+  }
+
+  // Write the length prefix; call once the body is complete.
+  void finish() noexcept
+  {
+    const u16 len = static_cast<u16>(_f.size - sizeof(u16));
+    std::memcpy(&_f.bytes[0], &len, sizeof(len));
+  }
+};
+
+// A decoded frame. Inputs are decoded into new_order/cancel; every frame keeps its raw bytes so
+// outputs can be compared byte for byte.
+struct JournalRecord
+{
+  JournalType type{JournalType::Seed};
+  u64 seq{0};
+  u64 ts_ns{0};
+  const std::byte *frame{nullptr}; // length prefix included
+  std::size_t size{0};
+  NewOrder new_order{};           // Seed, New
+  CancelOrder cancel{};           // Cancel
+  bool passive_fills{false};      // Config
+  overflow::Config exec_policy{}; // Config
+  overflow::Config md_policy{};   // Config
+  u64 limits_user{0};             // Limits
+  RiskLimits limits{};            // Limits
+
+  bool is_input() const noexcept
+  {
+    return type == JournalType::Seed || type == JournalType::New ||
+           type == JournalType::Cancel || type == JournalType::Config ||
+           type == JournalType::Limits;
+  }
+};
+
+// Walks the frames of a journal body (the bytes after the magic). Stops at the end or at the first
+// frame that is cut short, e.g. by a crash mid-write; truncated() tells the two apart.
+class JournalReader
+{
+  const std::byte *_p;
+  std::size_t _len;
+  std::size_t _pos{0};
+  bool _truncated{false};
+
+  template <typename V> V get(std::size_t &at) const noexcept
+  {
+    V v;
+    std::memcpy(&v, &_p[at], sizeof(V));
+    at += sizeof(V);
+    return v;
+  }
+
+  overflow::Config get_policy(std::size_t &at) const noexcept
+  {
+    overflow::Config c;
+    c.policy = static_cast<overflow::Policy>(get<u8>(at));
+    c.spill_limit = static_cast<std::size_t>(get<u64>(at));
+    c.high_water = static_cast<std::size_t>(get<u64>(at));
+    return c;
+  }
+
+public:
+  JournalReader(const std::byte *p, std::size_t len) noexcept : _p(p), _len(len) {}
+
+  bool next(JournalRecord &r) noexcept
+  {
+    constexpr std::size_t kHeader = sizeof(u16) + 1 + 2 * sizeof(u64);
+    if (_pos == _len)
+      return false;
+    u16 len = 0;
+    if (_pos + sizeof(len) <= _len)
+      std::memcpy(&len, &_p[_pos], sizeof(len));
+    const std::size_t size = sizeof(len) + len;
+    if (_pos + sizeof(len) > _len || size < kHeader || _pos + size > _len)
+    {
+      _truncated = true;
+      return false;
+    }
+    std::size_t at = _pos + sizeof(len);
+    r.type = static_cast<JournalType>(get<u8>(at));
+    r.seq = get<u64>(at);
+    r.ts_ns = get<u64>(at);
+    r.frame = &_p[_pos];
+    r.size = size;
+    constexpr std::size_t kOrderBody = 2 * sizeof(u64) + 1 + sizeof(Price) + sizeof(Qty) + 1 +
+                                       sizeof(u64);
+    if ((r.type == JournalType::Seed || r.type == JournalType::New) && size >= kHeader + kOrderBody)
+    {
+      r.new_order.order_id = get<u64>(at);
+      r.new_order.user_id = get<u64>(at);
+      r.new_order.side = static_cast<Side>(get<u8>(at));
+      r.new_order.price = get<Price>(at);
+      r.new_order.qty = get<Qty>(at);
+      r.new_order.tif = static_cast<TIF>(get<u8>(at));
+      r.new_order.ts_ns = get<u64>(at);
+    }
+    else if (r.type == JournalType::Cancel && size >= kHeader + 3 * sizeof(u64))
+    {
+      r.cancel.order_id = get<u64>(at);
+      r.cancel.user_id = get<u64>(at);
+      r.cancel.ts_ns = get<u64>(at);
+    }
+    else if (r.type == JournalType::Config && size >= kHeader + 1 + 2 * (1 + 2 * sizeof(u64)))
+    {
+      r.passive_fills = get<u8>(at) != 0;
+      r.exec_policy = get_policy(at);
+      r.md_policy = get_policy(at);
+    }
+    else if (r.type == JournalType::Limits &&
+             size >= kHeader + sizeof(u64) + sizeof(Qty) + sizeof(u32) + 2 * sizeof(i64) +
+                         sizeof(Price))
+    {
+      r.limits_user = get<u64>(at);
+      r.limits.max_order_qty = get<Qty>(at);
+      r.limits.max_open_orders = get<u32>(at);
+      r.limits.max_position = get<i64>(at);
+      r.limits.max_notional = get<i64>(at);
+      r.limits.price_collar = get<Price>(at);
+    }
+    else if (r.is_input())
+    {
+      _truncated = true; // an input frame too short for its body
+      return false;
+    }
+    _pos += size;
+    return true;
+  }
+
+  bool truncated() const noexcept
+  {
+    return _truncated;
+  }
+
+  std::size_t position() const noexcept
+  {
+    return _pos;
+  }
+};
+
+// Engine-side journal. Append methods are called from the engine thread only. Either writes to a
+// file through an aio::AsyncWriter (open) or appends synchronously to a caller's buffer (capture),
+// which is how replay re-encodes its own output for comparison.
+class Journal
+{
+  aio::AsyncWriter _file;
+  std::vector<std::byte> *_capture{nullptr};
+  u64 _seq{0};
+  stats::Counter _frames = stats::counter("journal.frames");
+
+  void append(JournalFrame &f)
+  {
+    ++_seq;
+    _frames.add();
+    if (_capture != nullptr)
+      _capture->insert(_capture->end(), f.bytes, f.bytes + f.size);
+    else if (_file.is_open())
+      _file.append(f.bytes, f.size);
+  }
+
+public:
+  Journal() = default;
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  // Start journaling to `path` (truncated). Call before the engine thread starts.
+  bool open(const char *path, aio::Config cfg = {})
+  {
+    if (!_file.open(path, cfg, "journal"))
+      return false;
+    _file.append(kJournalMagic, sizeof(kJournalMagic));
+    return true;
+  }
+
+  // Append frames (without the file magic) to `buf` instead of a file.
+  void capture(std::vector<std::byte> *buf) noexcept
+  {
+    _capture = buf;
+  }
+
+  bool active() const noexcept
+  {
+    return _capture != nullptr || _file.is_open();
+  }
+
+  // Hand the partly filled buffer to the writer so a quiet engine's frames still reach the disk.
+  // Engine thread, typically when idle; never waits.
+  void flush() noexcept
+  {
+    _file.flush();
+  }
+
+  // Write out the rest and close the file. Call after the engine thread has stopped appending.
+  void close()
+  {
+    _file.close();
+  }
+
+  // Frames appended so far, which is also the next frame's seq.
+  u64 frames() const noexcept
+  {
+    return _seq;
+  }
+
+  void seed(const NewOrder &n)
+  {
+    JournalFrame f;
+    JournalEncoder enc(f, JournalType::Seed, _seq, n.ts_ns);
+    enc.put_order(n);
+    enc.finish();
+    append(f);
+  }
+
+  void new_order(const NewOrder &n, u64 ts_ns)
+  {
+    JournalFrame f;
+    JournalEncoder enc(f, JournalType::New, _seq, ts_ns);
+    enc.put_order(n);
+    enc.finish();
+    append(f);
+  }
+
+  void cancel(const CancelOrder &c, u64 ts_ns)
+  {
+    JournalFrame f;
+    JournalEncoder enc(f, JournalType::Cancel, _seq, ts_ns);
+    enc.put(c.order_id);
+    enc.put(c.user_id);
+    enc.put(c.ts_ns);
+    enc.finish();
+    append(f);
+  }
+
+  void config(bool passive_fills, const overflow::Config &exec, const overflow::Config &md)
+  {
+    JournalFrame f;
+    JournalEncoder enc(f, JournalType::Config, _seq, 0);
+    enc.put(static_cast<u8>(passive_fills));
+    enc.put_policy(exec);
+    enc.put_policy(md);
+    enc.finish();
+    append(f);
+  }
+
+  void limits(u64 user_id, const RiskLimits &l)
+  {
+    JournalFrame f;
+    JournalEncoder enc(f, JournalType::Limits, _seq, 0);
+    enc.put(user_id);
+    enc.put(l.max_order_qty);
+    enc.put(l.max_open_orders);
+    enc.put(l.max_position);
+    enc.put(l.max_notional);
+    enc.put(l.price_collar);
+    enc.finish();
+    append(f);
+  }
+
+  void exec(const ExecEvent &e)
+  {
+    JournalFrame f;
+    JournalEncoder enc(f, JournalType::Exec, _seq, e.ts_ns);
+    enc.put(static_cast<u8>(e.type));
+    enc.put(e.order_id);
+    enc.put(e.user_id);
+    enc.put(e.filled);
+    enc.put(e.price);
+    enc.put(e.leaves);
+    enc.put_str(e.reason);
+    enc.finish();
+    append(f);
+  }
+
+  void market_data(const MarketDataEvent &ev)
+  {
+    JournalFrame f;
+    if (const TopOfBook *t = std::get_if<TopOfBook>(&ev))
+    {
+      JournalEncoder enc(f, JournalType::Top, _seq, t->ts_ns);
+      enc.put(t->bid_price);
+      enc.put(t->bid_qty);
+      enc.put(t->ask_price);
+      enc.put(t->ask_qty);
+      enc.finish();
+    }
+    else
+    {
+      const TradePrint &p = std::get<TradePrint>(ev);
+      JournalEncoder enc(f, JournalType::Trade, _seq, p.ts_ns);
+      enc.put(p.price);
+      enc.put(p.qty);
+      enc.put(static_cast<u8>(p.aggressor));
+      enc.finish();
+    }
+    append(f);
+  }
+};
+} // namespace hft
@@ -1,8 +1,14 @@
 #pragma once
 
+#include "common/broadcast_ring.hpp"
+#include "common/latency.hpp"
+#include "common/overflow.hpp"
+#include "common/stats.hpp"
 #include "common/spsc_queue.hpp"
+#include "journal.hpp"
 #include "market_data.hpp"
 #include "order_book.hpp"
+#include "risk/risk_gate.hpp"
 
 #include <functional>
 
@@ -18,99 +24,321 @@ struct EngineCommand
   } kind{Kind::New};
   NewOrder new_order{};
   CancelOrder cancel{};
+  LatencyStamps lat{}; // strategy fills tick/origin; the engine adds ingress
+};
+
+// What the engine does when a consumer falls behind (see common/overflow.hpp). Execs are never
+// dropped: a Drop policy for them is treated as Spill. Market data only reaches these policies
+// when its ring uses BackPressure; with DropAndFlag the ring itself drops the oldest events.
+struct OutputPolicy
+{
+  overflow::Config exec{overflow::Policy::Spill};
+  overflow::Config md{overflow::Policy::Drop};
+
+  bool operator==(const OutputPolicy &) const = default;
 };
 
 // MatchingEngine owns an OrderBook and emits ExecEvents and MarketDataEvents.
 // It is intentionally single-threaded: one engine thread reads commands from a queue and calls
-// `on_command`. Callers supply SPSC queues for outputs so we keep lock-free semantics end-to-end.
+// `on_command`. Execs go to an SPSC queue; market data is written once into a broadcast ring that
+// any number of strategies can subscribe to, so the engine never copies events per consumer.
 class MatchingEngine
 {
   OrderBook &_book;
-  spsc::Queue<ExecEvent, 1 << 14> &_exec_out;
-  spsc::Queue<MarketDataEvent, 1 << 14> &_md_out;
+  overflow::Writer<spsc::Queue<ExecEvent, 1 << 14>, ExecEvent> _exec_out;
+  overflow::Writer<broadcast::Ring<MarketDataEvent, 1 << 14>, MarketDataEvent> _md_out;
   u64 _last_trade_ts{0};
+  latency::Tracer *_tracer{nullptr}; // optional; the engine thread writes its engine-side hops
+  LatencyStamps _lat{};              // stamps of the command being processed
+  Journal *_journal{nullptr};        // optional; records every input and output frame
+  bool _passive_fills{false};        // also report each fill to the resting order's owner
+  OutputPolicy _output;              // as configured; journaled with _passive_fills
+  RiskGate _risk;                    // pre-trade limits and exposure per user
+  stats::Counter _orders = stats::counter("engine.orders");
+  stats::Counter _cancels = stats::counter("engine.cancels");
+  stats::Counter _fills = stats::counter("engine.fills");
+  stats::Counter _rejects = stats::counter("engine.rejects");
+  stats::Counter _risk_rejects = stats::counter("engine.risk_rejects");
+  stats::Gauge _book_orders = stats::gauge("engine.book_orders");
 
 public:
   MatchingEngine(OrderBook &book, spsc::Queue<ExecEvent, 1 << 14> &exec_out,
-                 spsc::Queue<MarketDataEvent, 1 << 14> &md_out)
-      : _book(book), _exec_out(exec_out), _md_out(md_out)
+                 broadcast::Ring<MarketDataEvent, 1 << 14> &md_out,
+                 latency::Tracer *tracer = nullptr, OutputPolicy output = {})
+      : _book(book), _exec_out(exec_out, "engine.exec", exec_config(output.exec)),
+        _md_out(md_out, "engine.md", output.md), _tracer(tracer), _output(output)
+  {
+  }
+
+  void set_tracer(latency::Tracer *tracer) noexcept
+  {
+    _tracer = tracer;
+  }
+
+  // Journal every command, seed and output from now on. Call before the engine thread starts.
+  // Settings that differ from a default engine are journaled first, so replay can rebuild them.
+  void set_journal(Journal *journal)
+  {
+    _journal = journal;
+    if (_journal == nullptr)
+      return;
+    if (_passive_fills || _output != OutputPolicy{})
+      _journal->config(_passive_fills, _output.exec, _output.md);
+    _risk.for_each_limits([this](u64 user_id, const RiskLimits &l)
+                          { _journal->limits(user_id, l); });
+  }
+
+  // Send a Trade exec for the resting side of every fill too (order id and leaves of the resting
+  // order), so strategies learn when their quotes are hit. Off by default: the aggressor-only
+  // exec stream is what existing consumers expect.
+  void set_passive_fills(bool on)
+  {
+    configure(on, _output);
+  }
+
+  // Passive fills and output policy together, as a journal's Config frame holds them. Call before
+  // the engine thread starts; the change is journaled.
+  void configure(bool passive_fills, const OutputPolicy &output)
+  {
+    _passive_fills = passive_fills;
+    _output = output;
+    _exec_out.set_config(exec_config(output.exec));
+    _md_out.set_config(output.md);
+    if (_journal != nullptr)
+      _journal->config(_passive_fills, _output.exec, _output.md);
+  }
+
+  // Check every new order from `user_id` against `limits` before matching and track its exposure.
+  // Users without limits pass unchecked. Call before the engine thread starts; the limits are
+  // journaled. False when the id is too large for the gate's table.
+  bool set_risk_limits(u64 user_id, const RiskLimits &limits)
+  {
+    if (!_risk.set_limits(user_id, limits))
+      return false;
+    if (_journal != nullptr)
+      _journal->limits(user_id, limits);
+    return true;
+  }
+
+  // Exposure the gate holds for `user_id`; null for a user without limits. Engine thread only.
+  const RiskExposure *exposure(u64 user_id) const noexcept
+  {
+    const RiskGate::Account *a = _risk.account(user_id);
+    return a != nullptr ? &a->exposure : nullptr;
+  }
+
+  // Rest `n` on the book without matching or publishing anything, as when seeding a book. Goes
+  // through the engine so the journal sees it. False when the id is already resting.
+  bool add_passive(const NewOrder &n)
+  {
+    if (_journal != nullptr)
+      _journal->seed(n);
+    if (!_book.add_passive(n))
+      return false;
+    if (RiskGate::Account *a = _risk.account(n.user_id))
+      RiskGate::on_rest(*a, n.side, n.qty);
+    return true;
+  }
+
+  // Retry anything spilled while the consumers were behind. Call once per loop iteration.
+  void flush_output()
+  {
+    _exec_out.flush();
+    _md_out.flush();
+  }
+
+  // Push journaled frames towards the disk. Call when idle; never waits.
+  void flush_journal() noexcept
+  {
+    if (_journal != nullptr)
+      _journal->flush();
+  }
+
+  // Exec output is backed up; taking more commands would only grow the spill.
+  bool output_saturated() const noexcept
   {
+    return _exec_out.saturated();
   }
 
   // Process a NewOrder or CancelOrder. Non-blocking.
   void on_command(const EngineCommand &cmd)
   {
+    on_command(cmd, now_ns());
+  }
+
+  // Same, with the engine's timestamp for this command. Every exec, trade print and top-of-book
+  // update the command produces carries this one stamp, so the clock is read once per command.
+  // The stamp may be older than the call (a simulator step time, a backtest's virtual clock), so
+  // the match hop is timed from a clock read of its own.
+  void on_command(const EngineCommand &cmd, u64 ts_ns)
+  {
+    const u64 match_start = _tracer != nullptr ? now_ns() : 0;
+    _lat = cmd.lat;
+    _lat.ingress_ns = ts_ns;
+    if (_journal != nullptr)
+    {
+      if (cmd.kind == EngineCommand::Kind::New)
+        _journal->new_order(cmd.new_order, ts_ns);
+      else
+        _journal->cancel(cmd.cancel, ts_ns);
+    }
     if (cmd.kind == EngineCommand::Kind::New)
     {
-      handle_new(cmd.new_order);
+      _orders.add();
+      handle_new(cmd.new_order, ts_ns);
     }
     else
     {
-      handle_cancel(cmd.cancel);
+      _cancels.add();
+      handle_cancel(cmd.cancel, ts_ns);
+    }
+    _book_orders.set(_book.order_count());
+    if (_tracer != nullptr)
+    {
+      // Tracing costs two extra clock reads per command plus one per exec (see send_exec).
+      _tracer->record(latency::Hop::CmdQueue, _lat.origin_ns, ts_ns);
+      _tracer->record(latency::Hop::TickToTrade, _lat.tick_ns, ts_ns);
+      _tracer->record(latency::Hop::Match, match_start, now_ns());
     }
   }
 
 private:
-  void publish_top()
+  static overflow::Config exec_config(overflow::Config cfg) noexcept
+  {
+    if (cfg.policy == overflow::Policy::Drop)
+    {
+      HFT_WARN("engine: execs are never dropped; spilling instead");
+      cfg.policy = overflow::Policy::Spill;
+    }
+    return cfg;
+  }
+
+  void publish_top(u64 ts_ns)
+  {
+    publish(MarketDataEvent{_book.top(ts_ns)});
+  }
+
+  void publish(const MarketDataEvent &ev)
   {
-    TopOfBook t = _book.top();
-    _md_out.push(MarketDataEvent{t});
+    if (_journal != nullptr)
+      _journal->market_data(ev);
+    _md_out.push(ev);
   }
 
   // Exec events are small enough to pass by value. SPSC queue avoids heap allocations here.
-  void send_exec(ExecEvent e)
+  // `count` is false for the passive side of a fill, so engine.fills still counts each fill once.
+  void send_exec(ExecEvent e, bool count = true)
   {
+    e.lat = _lat;
+    e.reason = reject_reason(e.code); // empty unless a reject
+    if (e.type == ExecType::Trade && count)
+      _fills.add();
+    else if (e.type == ExecType::Reject)
+      _rejects.add();
+    if (_tracer != nullptr)
+      e.lat.egress_ns = now_ns();
+    if (_journal != nullptr)
+      _journal->exec(e);
     _exec_out.push(e);
   }
 
-  void handle_cancel(const CancelOrder &cxl)
+  // Reject a new order before matching.
+  void reject(const NewOrder &n, RejectCode code, u64 ts_ns)
+  {
+    ExecEvent e{};
+    e.type = ExecType::Reject;
+    e.code = code;
+    e.order_id = n.order_id;
+    e.user_id = n.user_id;
+    e.ts_ns = ts_ns;
+    send_exec(e);
+  }
+
+  // Only the owner may cancel: another user's cancel of the same id is rejected as unknown.
+  void handle_cancel(const CancelOrder &cxl, u64 ts_ns)
   {
-    const Qty canceled = _book.cancel(cxl.order_id);
+    Order removed{};
+    const Qty canceled = _book.cancel(cxl.order_id, cxl.user_id, removed);
     ExecEvent e{};
-    e.ts_ns = now_ns();
+    e.ts_ns = ts_ns;
     e.order_id = cxl.order_id;
     e.user_id = cxl.user_id;
     if (canceled > 0)
     {
       e.type = ExecType::CancelAck;
       e.leaves = 0;
+      if (RiskGate::Account *a = _risk.account(removed.user_id))
+        RiskGate::on_cancel(*a, removed.side, canceled);
     }
     else
     {
       e.type = ExecType::Reject;
-      e.reason = sv{"unknown order id"};
+      e.code = RejectCode::UnknownOrder;
     }
     send_exec(e);
-    publish_top();
+    publish_top(ts_ns);
   }
 
   // Core matching loop. Accepts new order, executes against opposite side, then handles residue.
-  void handle_new(NewOrder n)
+  void handle_new(NewOrder n, u64 ts_ns)
   {
-    n.ts_ns = n.ts_ns ? n.ts_ns : now_ns();
+    n.ts_ns = n.ts_ns ? n.ts_ns : ts_ns;
+
+    // An id already resting could never be cancelled on its own, so refuse it before it trades.
+    if (_book.contains(n.order_id))
+    {
+      reject(n, RejectCode::DuplicateOrder, ts_ns);
+      return;
+    }
+
+    // Pre-trade risk. A rejected order never reaches the book, so there is no market data.
+    RiskGate::Account *risk = _risk.account(n.user_id);
+    if (risk != nullptr)
+    {
+      if (const RejectCode code = RiskGate::check(*risk, n, _book); code != RejectCode::None)
+      {
+        _risk_rejects.add();
+        reject(n, code, ts_ns);
+        return;
+      }
+    }
 
     // First match against opposite side.
+    Qty open = n.qty;
     Qty remaining =
         _book.match(n,
                     [&](Price px, Qty q, const Order &resting)
                     {
+                      open -= q;
                       ExecEvent trade{};
-                      (void)resting; // resting details currently unused but kept for future hooks
                       trade.type = ExecType::Trade;
                       trade.order_id = n.order_id;
                       trade.user_id = n.user_id;
                       trade.price = px;
                       trade.filled = q;
-                      trade.leaves = 0; // updated below after loop
-                      trade.ts_ns = now_ns();
+                      trade.leaves = open; // an IOC remainder is then dropped with an Ack
+                      trade.ts_ns = ts_ns;
                       _last_trade_ts = trade.ts_ns;
+                      if (risk != nullptr)
+                        RiskGate::on_fill(*risk, n.side, px, q);
+                      if (RiskGate::Account *owner = _risk.account(resting.user_id))
+                        RiskGate::on_fill(*owner, resting.side, px, q, true, resting.qty == q);
 
                       // Send the aggressor trade
-                      _exec_out.push(trade);
+                      send_exec(trade);
+
+                      if (_passive_fills)
+                      {
+                        ExecEvent fill = trade;
+                        fill.order_id = resting.order_id;
+                        fill.user_id = resting.user_id;
+                        fill.leaves = resting.qty - q; // the book reduces it after we return
+                        send_exec(fill, false);
+                      }
 
                       // And a trade print for market data
                       TradePrint tp{px, q, n.side, trade.ts_ns};
-                      _md_out.push(MarketDataEvent{tp});
+                      publish(MarketDataEvent{tp});
                     });
 
     // If not fully filled, handle TIF and add passive residue.
@@ -122,11 +350,11 @@ private:
         ExecEvent e{};
         e.order_id = n.order_id;
         e.user_id = n.user_id;
-        e.ts_ns = now_ns();
+        e.ts_ns = ts_ns;
         if (n.tif == TIF::FOK && remaining != n.qty)
         {
           e.type = ExecType::Reject;
-          e.reason = sv{"FOK not fully filled"};
+          e.code = RejectCode::FokNotFilled;
         }
         else
         {
@@ -140,18 +368,20 @@ private:
         NewOrder residue = n;
         residue.qty = remaining;
         _book.add_passive(residue);
+        if (risk != nullptr)
+          RiskGate::on_rest(*risk, n.side, remaining);
 
         ExecEvent e{};
         e.type = ExecType::Ack;
         e.order_id = n.order_id;
         e.user_id = n.user_id;
         e.leaves = remaining;
-        e.ts_ns = now_ns();
+        e.ts_ns = ts_ns;
         send_exec(e);
       }
     }
 
-    publish_top();
+    publish_top(ts_ns);
   }
 };
 } // namespace hft
@@ -48,6 +48,16 @@ struct CancelOrder
   u64 ts_ns{0};
 };
 
+// Timestamps that travel with a command and the execs it produces, so each hop can be measured
+// by the thread that observes its end (see common/latency.hpp). Zero means "not stamped".
+struct LatencyStamps
+{
+  u64 tick_ns{0};    // market data the strategy acted on (engine's publish stamp)
+  u64 origin_ns{0};  // strategy pushed the command
+  u64 ingress_ns{0}; // engine popped the command (its per-command stamp)
+  u64 egress_ns{0};  // engine published the exec (execs only)
+};
+
 // Minimal execution report types from engine to strategy. The enum keeps payload size tiny while
 // covering the typical lifecycle states you'll see on real exchanges.
 enum class ExecType : u8
@@ -59,11 +69,53 @@ enum class ExecType : u8
   DoneForDay
 };
 
+// Why the engine rejected a command. The reason string says the same for humans and the journal;
+// the code lets a strategy branch without comparing strings.
+enum class RejectCode : u8
+{
+  None,
+  UnknownOrder,   // cancel of an id not on the book, or resting for another user
+  DuplicateOrder, // new order reusing the id of one still resting
+  FokNotFilled,
+  OrderQty, // pre-trade risk (see risk/risk_gate.hpp) from here on
+  OpenOrders,
+  Position,
+  Notional,
+  PriceCollar
+};
+
+constexpr sv reject_reason(RejectCode c) noexcept
+{
+  switch (c)
+  {
+  case RejectCode::None:
+    return {};
+  case RejectCode::UnknownOrder:
+    return "unknown order id";
+  case RejectCode::DuplicateOrder:
+    return "duplicate order id";
+  case RejectCode::FokNotFilled:
+    return "FOK not fully filled";
+  case RejectCode::OrderQty:
+    return "risk: order qty";
+  case RejectCode::OpenOrders:
+    return "risk: open orders";
+  case RejectCode::Position:
+    return "risk: position";
+  case RejectCode::Notional:
+    return "risk: notional";
+  case RejectCode::PriceCollar:
+    return "risk: price collar";
+  }
+  return {};
+}
+
 // Execution reports the engine publishes back to the strategy. Only the fields relevant for the
 // selected ExecType are populated to avoid wasting bandwidth in the SPSC queue.
 struct ExecEvent
 {
   ExecType type{ExecType::Ack};
+  RejectCode code{RejectCode::None}; // for Reject; not journaled (the reason is)
   u64 order_id{0};
   u64 user_id{0};
   Qty filled{0};  // for Trade
@@ -71,6 +123,7 @@ struct ExecEvent
   Qty leaves{0};  // remaining
   sv reason{};    // for Reject
   u64 ts_ns{0};
+  LatencyStamps lat{}; // copied from the command, egress filled in when tracing
 };
 
 // Market data events pushed to strategies. Keep it tiny for cache efficiency—the queues often live
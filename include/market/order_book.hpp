@@ -16,7 +16,14 @@ class OrderBook
   using LevelQueue = std::deque<Order>;
   std::map<Price, LevelQueue, std::greater<Price>> _bids;    // highest price first
   std::map<Price, LevelQueue, std::less<Price>> _asks;       // lowest price first
-  std::unordered_map<u64, std::pair<Price, Side>> _id_index; // order_id -> (price, side)
+  // Where a resting order sits and who owns it, keyed by order id.
+  struct Location
+  {
+    Price price;
+    Side side;
+    u64 user_id;
+  };
+  std::unordered_map<u64, Location> _id_index;
 
   // Compute total quantity at a level without modifying it. Used when forming top-of-book
   // snapshots.
@@ -30,6 +37,12 @@ class OrderBook
 
 public:
   TopOfBook top() const noexcept
+  {
+    return top(now_ns());
+  }
+
+  // Snapshot stamped with a caller-supplied time, so an engine can reuse its per-command stamp.
+  TopOfBook top(u64 ts_ns) const noexcept
   {
     // Build a TopOfBook by looking at best bid/ask levels. If any side is empty we leave zeros.
     TopOfBook t{};
@@ -43,18 +56,44 @@ public:
       t.ask_price = _asks.begin()->first;
       t.ask_qty = total_qty(_asks.begin()->second);
     }
-    t.ts_ns = now_ns();
+    t.ts_ns = ts_ns;
     return t;
   }
 
+  // Best prices alone, 0 for an empty side: cheaper than top() when the sizes are not needed.
+  Price best_bid() const noexcept
+  {
+    return _bids.empty() ? 0 : _bids.begin()->first;
+  }
+
+  Price best_ask() const noexcept
+  {
+    return _asks.empty() ? 0 : _asks.begin()->first;
+  }
+
   bool empty() const noexcept
   {
     return _bids.empty() && _asks.empty();
   }
 
-  // Insert a new passive order into the book at given price.
-  void add_passive(const NewOrder &n)
+  // Number of resting orders across both sides.
+  std::size_t order_count() const noexcept
   {
+    return _id_index.size();
+  }
+
+  // Whether `order_id` is resting on the book.
+  bool contains(u64 order_id) const noexcept
+  {
+    return _id_index.contains(order_id);
+  }
+
+  // Insert a new passive order into the book at given price. False, and the book untouched, when
+  // an order with the same id is already resting: it could no longer be cancelled by id.
+  bool add_passive(const NewOrder &n)
+  {
+    if (!_id_index.try_emplace(n.order_id, Location{n.price, n.side, n.user_id}).second)
+      return false;
     // Convert the immutable NewOrder into a mutable resting Order entry.
     Order o{n.order_id, n.user_id, n.side, n.price, n.qty, n.ts_ns};
     if (n.side == Side::Buy)
@@ -67,57 +106,83 @@ public:
       auto &q = _asks[n.price];
       q.push_back(o);
     }
-    _id_index.emplace(n.order_id, std::make_pair(n.price, n.side));
+    return true;
   }
 
   // Cancel by ID. Returns canceled quantity.
   Qty cancel(u64 order_id)
+  {
+    Order removed{};
+    return cancel(order_id, removed);
+  }
+
+  // Same, also copying out the order as it rested (owner, side, leaves).
+  Qty cancel(u64 order_id, Order &removed)
   {
     auto it = _id_index.find(order_id);
     if (it == _id_index.end())
       return 0;
-    auto [price, side] = it->second;
-    Qty canceled = 0;
-    if (side == Side::Buy)
+    return cancel_at(it, removed);
+  }
+
+  // Cancel on behalf of `user_id`. An order another user owns is left alone, as if unknown.
+  Qty cancel(u64 order_id, u64 user_id, Order &removed)
+  {
+    auto it = _id_index.find(order_id);
+    if (it == _id_index.end() || it->second.user_id != user_id)
+      return 0;
+    return cancel_at(it, removed);
+  }
+
+  // Price and side of a resting order. False when the id is not on the book.
+  bool find(u64 order_id, Price &price, Side &side) const noexcept
+  {
+    auto it = _id_index.find(order_id);
+    if (it == _id_index.end())
+      return false;
+    price = it->second.price;
+    side = it->second.side;
+    return true;
+  }
+
+  // Take up to `qty` off a resting order in place, keeping its time priority, as a partial cancel
+  // or an execution reported by a feed does. The order leaves the book at zero. Returns the
+  // quantity removed.
+  Qty reduce(u64 order_id, Qty qty)
+  {
+    auto it = _id_index.find(order_id);
+    if (it == _id_index.end())
+      return 0;
+    const Price price = it->second.price;
+    const Side side = it->second.side;
+    Qty reduced = 0;
+    auto shrink = [&](auto &book_side)
     {
-      auto lit = _bids.find(price);
-      if (lit != _bids.end())
+      auto lit = book_side.find(price);
+      if (lit == book_side.end())
+        return;
+      auto &q = lit->second;
+      for (auto i = q.begin(); i != q.end(); ++i)
       {
-        auto &q = lit->second;
-        for (auto i = q.begin(); i != q.end(); ++i)
+        if (i->order_id != order_id)
+          continue;
+        reduced = qty < i->qty ? qty : i->qty;
+        i->qty -= reduced;
+        if (i->qty == 0)
         {
-          if (i->order_id == order_id)
-          {
-            canceled = i->qty;
-            q.erase(i);
-            break;
-          }
+          q.erase(i);
+          _id_index.erase(it);
         }
-        if (q.empty())
-          _bids.erase(lit);
+        break;
       }
-    }
+      if (q.empty())
+        book_side.erase(lit);
+    };
+    if (side == Side::Buy)
+      shrink(_bids);
     else
-    {
-      auto lit = _asks.find(price);
-      if (lit != _asks.end())
-      {
-        auto &q = lit->second;
-        for (auto i = q.begin(); i != q.end(); ++i)
-        {
-          if (i->order_id == order_id)
-          {
-            canceled = i->qty;
-            q.erase(i);
-            break;
-          }
-        }
-        if (q.empty())
-          _asks.erase(lit);
-      }
-    }
-    _id_index.erase(it);
-    return canceled;
+      shrink(_asks);
+    return reduced;
   }
 
   // Match an aggressive order against the opposite side.
@@ -170,5 +235,56 @@ public:
     }
     return remaining;
   }
+
+private:
+  Qty cancel_at(std::unordered_map<u64, Location>::iterator it, Order &removed)
+  {
+    const u64 order_id = it->first;
+    const Price price = it->second.price;
+    const Side side = it->second.side;
+    Qty canceled = 0;
+    if (side == Side::Buy)
+    {
+      auto lit = _bids.find(price);
+      if (lit != _bids.end())
+      {
+        auto &q = lit->second;
+        for (auto i = q.begin(); i != q.end(); ++i)
+        {
+          if (i->order_id == order_id)
+          {
+            canceled = i->qty;
+            removed = *i;
+            q.erase(i);
+            break;
+          }
+        }
+        if (q.empty())
+          _bids.erase(lit);
+      }
+    }
+    else
+    {
+      auto lit = _asks.find(price);
+      if (lit != _asks.end())
+      {
+        auto &q = lit->second;
+        for (auto i = q.begin(); i != q.end(); ++i)
+        {
+          if (i->order_id == order_id)
+          {
+            canceled = i->qty;
+            removed = *i;
+            q.erase(i);
+            break;
+          }
+        }
+        if (q.empty())
+          _asks.erase(lit);
+      }
+    }
+    _id_index.erase(it);
+    return canceled;
+  }
 };
 } // namespace hft
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "matching_engine.hpp"
+
+#include <random>
+#include <vector>
+
+namespace hft
+{
+// Reproducible synthetic order flow for benchmarks and stress runs. Unlike Simulator (which reacts
+// to the live book inside the engine thread) this generator is open-loop: the same seed always
+// yields the same command sequence, on every platform, so runs can be compared across commits.
+// Draws use mt19937_64 directly rather than std::*_distribution, whose output is not specified.
+struct OrderFlowConfig
+{
+  u64 seed{1};
+  u64 user_id{7};
+  u64 first_order_id{1};
+  Price mid{10'000};
+  Price tick{1};
+  int levels{32}; // passive orders land within this many ticks of mid
+  Qty min_qty{1};
+  Qty max_qty{10};
+  double cancel_ratio{0.2};     // share of commands that cancel an earlier passive order
+  double marketable_ratio{0.1}; // share of new orders priced to cross the whole visible range
+  double ioc_ratio{0.5};        // marketable orders sent as IOC rather than Day
+};
+
+class OrderFlowGenerator
+{
+  OrderFlowConfig cfg_;
+  std::mt19937_64 rng_;
+  u64 next_order_id_;
+  std::vector<u64> live_; // passive ids not yet cancelled by us (fills are not tracked)
+
+  u64 below(u64 n) noexcept
+  {
+    return rng_() % n;
+  }
+
+  bool chance(double p) noexcept
+  {
+    return static_cast<double>(rng_() >> 11) * 0x1.0p-53 < p;
+  }
+
+  Qty qty() noexcept
+  {
+    const u64 span = static_cast<u64>(cfg_.max_qty - cfg_.min_qty) + 1;
+    return cfg_.min_qty + static_cast<Qty>(below(span));
+  }
+
+public:
+  explicit OrderFlowGenerator(OrderFlowConfig cfg = {})
+      : cfg_(cfg), rng_(cfg.seed), next_order_id_(cfg.first_order_id)
+  {
+  }
+
+  const OrderFlowConfig &config() const noexcept
+  {
+    return cfg_;
+  }
+
+  // A resting order 1..levels ticks away from mid on a random side.
+  NewOrder passive(u64 ts_ns = 0)
+  {
+    const Side side = chance(0.5) ? Side::Buy : Side::Sell;
+    const Price offset = static_cast<Price>(1 + below(static_cast<u64>(cfg_.levels))) * cfg_.tick;
+    const Price px = side == Side::Buy ? cfg_.mid - offset : cfg_.mid + offset;
+    const NewOrder n{next_order_id_++, cfg_.user_id, side, px, qty(), TIF::Day, ts_ns};
+    live_.push_back(n.order_id);
+    return n;
+  }
+
+  // An order priced through every level the generator ever quotes.
+  NewOrder marketable(u64 ts_ns = 0)
+  {
+    const Side side = chance(0.5) ? Side::Buy : Side::Sell;
+    const Price reach = static_cast<Price>(cfg_.levels + 1) * cfg_.tick;
+    const Price px = side == Side::Buy ? cfg_.mid + reach : cfg_.mid - reach;
+    const TIF tif = chance(cfg_.ioc_ratio) ? TIF::IOC : TIF::Day;
+    return NewOrder{next_order_id_++, cfg_.user_id, side, px, qty(), tif, ts_ns};
+  }
+
+  // Cancel a random earlier passive order. Returns false when there is none to cancel.
+  bool cancel(CancelOrder &out, u64 ts_ns = 0)
+  {
+    if (live_.empty())
+      return false;
+    const std::size_t i = static_cast<std::size_t>(below(live_.size()));
+    out = CancelOrder{live_[i], cfg_.user_id, ts_ns};
+    live_[i] = live_.back();
+    live_.pop_back();
+    return true;
+  }
+
+  // Next command of the configured mix.
+  EngineCommand next(u64 ts_ns = 0)
+  {
+    EngineCommand cmd{};
+    if (chance(cfg_.cancel_ratio) && cancel(cmd.cancel, ts_ns))
+    {
+      cmd.kind = EngineCommand::Kind::Cancel;
+      return cmd;
+    }
+    cmd.kind = EngineCommand::Kind::New;
+    cmd.new_order = chance(cfg_.marketable_ratio) ? marketable(ts_ns) : passive(ts_ns);
+    return cmd;
+  }
+
+  // Fill `out` with `n` commands; generating up front keeps the generator out of timed loops.
+  void generate(std::size_t n, std::vector<EngineCommand> &out)
+  {
+    out.reserve(out.size() + n);
+    for (std::size_t i = 0; i < n; ++i)
+      out.push_back(next());
+  }
+};
+} // namespace hft
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "journal.hpp"
+#include "matching_engine.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace hft
+{
+struct ReplayResult
+{
+  bool ok{true};
+  bool truncated{false}; // the journal stops mid-frame or mid-command (ignored, but reported)
+  u64 inputs{0};         // seed/new/cancel frames fed to the engine
+  u64 outputs{0};        // output frames compared
+  u64 elapsed_ns{0};     // time spent inside the engine, verification excluded
+  u64 mismatch_seq{0};   // seq of the first frame that differs, when !ok
+  char error[160]{};
+};
+
+// Feed every input frame of a journal body (the bytes after the magic) through a fresh
+// MatchingEngine at full speed, with no pacing and the recorded engine timestamps. With `verify`,
+// the engine journals into memory and every frame it writes (the input itself, then its execs and
+// market data) must equal the next recorded frame byte for byte. The book starts empty; seed
+// frames rebuild whatever was placed on it without matching, and config and limits frames set the
+// engine up the way the recording one was.
+inline ReplayResult replay_journal(const std::byte *data, std::size_t len, bool verify = true)
+{
+  ReplayResult res;
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  OrderBook book;
+  MatchingEngine engine(book, *exec_q, *md_q);
+  Journal journal;
+  std::vector<std::byte> captured;
+  if (verify)
+  {
+    journal.capture(&captured);
+    engine.set_journal(&journal);
+  }
+
+  const auto fail = [&res](u64 seq, const char *what, JournalType type)
+  {
+    res.ok = false;
+    res.mismatch_seq = seq;
+    std::snprintf(res.error, sizeof(res.error), "frame %llu (%s): %s",
+                  static_cast<unsigned long long>(seq), to_string(type), what);
+  };
+
+  JournalReader recorded(data, len);
+  JournalRecord rec;
+  ExecEvent e;
+  while (res.ok && recorded.next(rec))
+  {
+    if (!rec.is_input())
+    {
+      if (!verify)
+        continue;
+      fail(rec.seq, "recorded output that the replay did not produce", rec.type);
+      break;
+    }
+    ++res.inputs;
+    const u64 t0 = now_ns();
+    if (rec.type == JournalType::Config)
+      engine.configure(rec.passive_fills, OutputPolicy{rec.exec_policy, rec.md_policy});
+    else if (rec.type == JournalType::Limits)
+      engine.set_risk_limits(rec.limits_user, rec.limits);
+    else if (rec.type == JournalType::Seed)
+      engine.add_passive(rec.new_order);
+    else if (rec.type == JournalType::New)
+      engine.on_command(EngineCommand{EngineCommand::Kind::New, rec.new_order, {}, {}},
+                        rec.ts_ns);
+    else
+      engine.on_command(EngineCommand{EngineCommand::Kind::Cancel, {}, rec.cancel, {}},
+                        rec.ts_ns);
+    res.elapsed_ns += now_ns() - t0;
+    while (exec_q->pop(e)) // nobody else reads it; keep it from filling up
+      ;
+
+    if (!verify)
+      continue;
+    JournalReader produced(captured.data(), captured.size());
+    JournalRecord got;
+    JournalRecord want = rec;
+    bool first = true;
+    while (res.ok && produced.next(got))
+    {
+      if (!first && !recorded.next(want))
+      {
+        // The recording stops inside this command's output (the process died mid-write):
+        // everything recorded matched, and there is nothing left to compare against.
+        res.truncated = true;
+        return res;
+      }
+      if (!first)
+        ++res.outputs;
+      first = false;
+      if (got.size != want.size || std::memcmp(got.frame, want.frame, got.size) != 0)
+        fail(want.seq, got.type == want.type ? "contents differ" : "frame type differs",
+             want.type);
+    }
+    captured.clear();
+  }
+  res.truncated = res.truncated || recorded.truncated();
+  return res;
+}
+} // namespace hft
@@ -1,17 +1,50 @@
 #pragma once
 
+#include "agents.hpp"
+#include "arrivals.hpp"
 #include "common/logging.hpp"
+#include "common/random.hpp"
+#include "common/stats.hpp"
 #include "matching_engine.hpp"
 
 #include <atomic>
-#include <random>
 #include <thread>
+#include <vector>
 
 namespace hft
 {
 // A tiny exchange simulator that injects random "street" flow to keep the book alive.
 // It runs directly inside the engine thread to avoid dealing with multiple producers on queues.
 // The goal is pedagogical: expose how external flow alters the book while keeping code compact.
+//
+// Three flow models:
+//   Steps    -> each step() makes a fixed set of random draws (move the mid, widen or tighten)
+//   Arrivals -> each step(engine, ts) plays every arrival of an ArrivalProcess (Poisson or Hawkes,
+//               see arrivals.hpp) due by `ts`, so intensity is a rate in time, not in loop passes
+//   Agents   -> each step(engine, ts) runs every action due by `ts` of a population of noise
+//               traders, liquidity providers, momentum takers and TWAP parents (agents.hpp), each
+//               under its own user id
+//
+// Under either model the simulator keeps its passive orders in a small pool and retires them the
+// way real participants do (OrderLifecycle): each gets an exponential lifetime, after which it is
+// pulled or repriced near the touch, and anything left far behind the touch is pulled. Depth
+// then settles at a steady state instead of growing for as long as the run lasts.
+enum class FlowModel : u8
+{
+  Steps,
+  Arrivals,
+  Agents
+};
+
+// What happens to a passive street order after it is placed. Needs an engine that can cancel.
+struct OrderLifecycle
+{
+  u64 mean_lifetime_ns{50'000'000}; // exponential lifetime; 0 = rest until filled
+  double modify_prob{0.2};  // share of expired orders repriced near the touch rather than pulled
+  int max_distance{25};     // pull orders more than this many ticks behind their touch; 0 = never
+  u64 sweep_ns{1'000'000};  // expiry and distance are checked at most this often
+};
+
 struct StreetFlowConfig
 {
   Price mid{10'000}; // ticks
@@ -21,43 +54,152 @@ struct StreetFlowConfig
   double move_prob{0.55};  // probability mid moves by one tick per step
   int max_depth_levels{5}; // depth to seed on start
   u64 seed{42};
+  u64 step_interval_ns{100'000}; // engine runs one step() per interval, however fast it polls
+  FlowModel model{FlowModel::Steps};
+  ArrivalConfig arrivals{}; // Arrivals model only
+  OrderLifecycle lifecycle{};
+  AgentsConfig agents{}; // Agents model only
 };
 
+// "steps", "poisson", "hawkes" (the two Arrivals models) or "agents".
+inline bool parse_flow_model(sv name, StreetFlowConfig &cfg) noexcept
+{
+  if (name == "steps")
+    cfg.model = FlowModel::Steps;
+  else if (name == "agents")
+    cfg.model = FlowModel::Agents;
+  else if (name == "poisson" || name == "hawkes")
+  {
+    cfg.model = FlowModel::Arrivals;
+    cfg.arrivals.hawkes = name == "hawkes";
+  }
+  else
+    return false;
+  return true;
+}
+
 class Simulator
 {
+  // A passive order we placed and have not cancelled. Fills are invisible to us, so an entry may
+  // already be gone from the book; engines that expose resting(id) let the sweep drop those.
+  struct LiveOrder
+  {
+    u64 order_id{0};
+    u64 user_id{0}; // street user or the agent that placed it; only the owner can cancel
+    u64 expires_ns{0};
+    Price price{0};
+    Qty qty{0};
+    Side side{Side::Buy};
+  };
+
   StreetFlowConfig cfg_;
-  std::mt19937_64 rng_;
-  std::bernoulli_distribution move_;
-  std::bernoulli_distribution widen_;
-  u64 next_order_id_{1};
+  rng::Xoshiro256 rng_;
+  ArrivalProcess arrivals_;
+  AgentPopulation agents_;
+  DepthSampler reprice_depth_;
+  u64 next_order_id_{kFirstOrderId};
   u64 street_user_{999'999};
+  std::vector<LiveOrder> live_; // unordered; removal swaps with the back
+  u64 next_sweep_ns_{0};
+  stats::Counter cancels_ = stats::counter("sim.cancels");
+  stats::Counter modifies_ = stats::counter("sim.modifies");
+  stats::Gauge live_orders_ = stats::gauge("sim.live_orders");
 
 public:
+  // Street and agent order ids start here, clear of strategy ids (from 1) and of the load
+  // generator's producers ((p+1) << 40), so the engine never sees two live orders with one id.
+  static constexpr u64 kFirstOrderId = u64{1} << 48;
+
   explicit Simulator(StreetFlowConfig cfg = {})
-      : cfg_(cfg), rng_(cfg.seed), move_(cfg.move_prob), widen_(1.0 - cfg.spread_prob)
+      : cfg_(cfg), rng_(cfg.seed), arrivals_(cfg.arrivals, ~cfg.seed),
+        agents_(cfg.model == FlowModel::Agents ? cfg.agents : AgentsConfig{0, 0, 0, 0}, cfg.mid,
+                cfg.tick, cfg.seed ^ 0xa9e17ULL),
+        reprice_depth_(cfg.arrivals.depth_exponent,
+                       cfg.lifecycle.max_distance > 0 ? cfg.lifecycle.max_distance
+                                                      : cfg.arrivals.max_depth)
+  {
+  }
+
+  // Passive orders we placed and still count as live.
+  std::size_t live_orders() const noexcept
+  {
+    return live_.size();
+  }
+
+  // When step() next has work: every step_interval_ns for the Steps model, the next arrival or
+  // agent action for the other two (once started by a first step). A discrete-event driver
+  // schedules step() there; a polling loop can ignore it.
+  u64 next_step_ns(u64 now) noexcept
   {
+    if (cfg_.model == FlowModel::Arrivals && arrivals_.started())
+      return arrivals_.next_ns();
+    if (cfg_.model == FlowModel::Agents && agents_.started())
+      return agents_.next_ns();
+    return now + cfg_.step_interval_ns;
   }
 
-  void seed_book(OrderBook &book)
+  const AgentPopulation &agents() const noexcept
+  {
+    return agents_;
+  }
+
+  // `book` is an OrderBook or anything with add_passive(const NewOrder &), such as MatchingEngine
+  // (which journals the seed orders).
+  template <typename Book> void seed_book(Book &book)
+  {
+    seed_book(book, now_ns());
+  }
+
+  // Same, stamped with a caller-supplied time (a backtest's virtual clock).
+  template <typename Book> void seed_book(Book &book, u64 ts)
   {
     // Seed symmetric levels around mid.
     for (int i = 1; i <= cfg_.max_depth_levels; ++i)
     {
       Price bid_px = cfg_.mid - i * cfg_.tick;
       Price ask_px = cfg_.mid + i * cfg_.tick;
-      NewOrder b{next_order_id_++, street_user_, Side::Buy, bid_px, 10, TIF::Day, now_ns()};
-      NewOrder s{next_order_id_++, street_user_, Side::Sell, ask_px, 10, TIF::Day, now_ns()};
+      NewOrder b{next_order_id_++, street_user_, Side::Buy, bid_px, 10, TIF::Day, ts};
+      NewOrder s{next_order_id_++, street_user_, Side::Sell, ask_px, 10, TIF::Day, ts};
       book.add_passive(b);
       book.add_passive(s);
+      track(b);
+      track(s);
     }
   }
 
   // One step of random exogenous flow.
   template <typename Engine> void step(Engine &engine)
   {
+    step(engine, now_ns());
+  }
+
+  // Same, with `ts` stamped on every order this step injects. Under the Arrivals and Agents
+  // models, plays every arrival or action due by `ts`, each stamped with its own time.
+  template <typename Engine> void step(Engine &engine, u64 ts)
+  {
+    sweep(engine, ts);
+    if (cfg_.model == FlowModel::Agents)
+    {
+      if (!agents_.started())
+        agents_.start(ts);
+      agents_.run(engine, ts, next_order_id_, [&](const NewOrder &n) { add_passive(engine, n); });
+      return;
+    }
+    if (cfg_.model == FlowModel::Arrivals)
+    {
+      if (!arrivals_.started())
+        arrivals_.start(ts);
+      while (arrivals_.next_ns() <= ts)
+      {
+        apply(engine, arrivals_.pop());
+        arrivals_.set_resting(live_.size());
+      }
+      return;
+    }
+
     // Randomly choose to lift best ask or hit best bid, or add passive liquidity.
-    const bool move_mid = move_(rng_);
-    const bool make_spread_wider = widen_(rng_);
+    const bool move_mid = rng_.chance(cfg_.move_prob);
+    const bool make_spread_wider = !rng_.chance(cfg_.spread_prob);
 
     TopOfBook t = engine.top_snapshot();
     Price best_bid = t.bid_price ? t.bid_price : (cfg_.mid - cfg_.tick);
@@ -66,16 +208,16 @@ public:
     if (move_mid)
     {
       // Marketable order to move mid by one tick. Splitting the branch keeps both sides symmetric.
-      if (std::uniform_int_distribution<int>(0, 1)(rng_) == 0)
+      if ((rng_.next() >> 63) == 0)
       {
         // lift ask
-        NewOrder m{next_order_id_++, street_user_, Side::Buy, best_ask, 5, TIF::IOC, now_ns()};
+        NewOrder m{next_order_id_++, street_user_, Side::Buy, best_ask, 5, TIF::IOC, ts};
         engine.inject_new(m);
       }
       else
       {
         // hit bid
-        NewOrder m{next_order_id_++, street_user_, Side::Sell, best_bid, 5, TIF::IOC, now_ns()};
+        NewOrder m{next_order_id_++, street_user_, Side::Sell, best_bid, 5, TIF::IOC, ts};
         engine.inject_new(m);
       }
     }
@@ -86,23 +228,153 @@ public:
       if (make_spread_wider)
       {
         // Place beyond top to widen
-        NewOrder b{next_order_id_++, street_user_, Side::Buy, best_bid - cfg_.tick, 5,
-                   TIF::Day,         now_ns()};
-        NewOrder s{next_order_id_++, street_user_, Side::Sell, best_ask + cfg_.tick, 5,
-                   TIF::Day,         now_ns()};
-        engine.inject_new(b);
-        engine.inject_new(s);
+        NewOrder b{next_order_id_++, street_user_, Side::Buy, best_bid - cfg_.tick, 5, TIF::Day,
+                   ts};
+        NewOrder s{next_order_id_++, street_user_, Side::Sell, best_ask + cfg_.tick, 5, TIF::Day,
+                   ts};
+        add_passive(engine, b);
+        add_passive(engine, s);
       }
       else
       {
         // Improve top by one tick each side
-        NewOrder b{next_order_id_++, street_user_, Side::Buy, best_bid + cfg_.tick, 5,
-                   TIF::Day,         now_ns()};
-        NewOrder s{next_order_id_++, street_user_, Side::Sell, best_ask - cfg_.tick, 5,
-                   TIF::Day,         now_ns()};
-        engine.inject_new(b);
-        engine.inject_new(s);
+        NewOrder b{next_order_id_++, street_user_, Side::Buy, best_bid + cfg_.tick, 5, TIF::Day,
+                   ts};
+        NewOrder s{next_order_id_++, street_user_, Side::Sell, best_ask - cfg_.tick, 5, TIF::Day,
+                   ts};
+        add_passive(engine, b);
+        add_passive(engine, s);
+      }
+    }
+  }
+
+private:
+  template <typename Engine> void apply(Engine &engine, const Arrival &a)
+  {
+    const TopOfBook t = engine.top_snapshot();
+    const Price best_bid = t.bid_price ? t.bid_price : (cfg_.mid - cfg_.tick);
+    const Price best_ask = t.ask_price ? t.ask_price : (cfg_.mid + cfg_.tick);
+    const Qty q = cfg_.arrivals.qty;
+    switch (a.kind)
+    {
+    case ArrivalKind::Add:
+    {
+      // Depth counts from the tightest passive price, one tick inside the opposite best.
+      const Price px = a.side == Side::Buy ? best_ask - (1 + a.depth) * cfg_.tick
+                                           : best_bid + (1 + a.depth) * cfg_.tick;
+      add_passive(engine,
+                  NewOrder{next_order_id_++, street_user_, a.side, px, q, TIF::Day, a.ts_ns});
+      break;
+    }
+    case ArrivalKind::Market:
+    {
+      const Price px = a.side == Side::Buy ? best_ask : best_bid;
+      engine.inject_new(NewOrder{next_order_id_++, street_user_, a.side, px, q, TIF::IOC, a.ts_ns});
+      break;
+    }
+    case ArrivalKind::Cancel:
+      cancel_one(engine, a.ts_ns);
+      break;
+    }
+  }
+
+  // A cancel hits one of our resting orders picked uniformly: every order is equally likely to be
+  // pulled, so a deep book loses orders faster than a thin one.
+  template <typename Engine> void cancel_one(Engine &engine, u64 ts)
+  {
+    if constexpr (requires { engine.inject_cancel(CancelOrder{}); })
+    {
+      if (live_.empty())
+        return;
+      pull(engine, static_cast<std::size_t>(rng_.below(live_.size())), ts);
+    }
+  }
+
+  bool tracking() const noexcept
+  {
+    return cfg_.model == FlowModel::Arrivals || cfg_.lifecycle.mean_lifetime_ns != 0 ||
+           cfg_.lifecycle.max_distance != 0;
+  }
+
+  void track(const NewOrder &n)
+  {
+    if (!tracking())
+      return;
+    const u64 life = cfg_.lifecycle.mean_lifetime_ns;
+    const u64 expires =
+        life == 0 ? UINT64_MAX
+                  : n.ts_ns + static_cast<u64>(rng_.exponential(1.0 / static_cast<double>(life)));
+    live_.push_back(LiveOrder{n.order_id, n.user_id, expires, n.price, n.qty, n.side});
+  }
+
+  void drop(std::size_t i) noexcept
+  {
+    live_[i] = live_.back();
+    live_.pop_back();
+  }
+
+  template <typename Engine> void pull(Engine &engine, std::size_t i, u64 ts)
+  {
+    engine.inject_cancel(CancelOrder{live_[i].order_id, live_[i].user_id, ts});
+    cancels_.add();
+    drop(i);
+  }
+
+  // Passive street orders otherwise pile up behind the top for as long as the run lasts, and a
+  // long run pays for them on every level walk; tracking them lets the sweep retire them.
+  template <typename Engine> void add_passive(Engine &engine, const NewOrder &n)
+  {
+    engine.inject_new(n);
+    if constexpr (requires { engine.inject_cancel(CancelOrder{}); })
+      track(n);
+  }
+
+  // Retire orders whose lifetime is up or that the touch has left behind. An expired order is
+  // either pulled or, with modify_prob, replaced (cancel and new, losing priority, as a venue
+  // replace does) at a power-law distance behind its own touch.
+  template <typename Engine> void sweep(Engine &engine, u64 ts)
+  {
+    if constexpr (requires { engine.inject_cancel(CancelOrder{}); })
+    {
+      if (ts < next_sweep_ns_)
+        return;
+      next_sweep_ns_ = ts + cfg_.lifecycle.sweep_ns;
+      const TopOfBook t = engine.top_snapshot();
+      const OrderLifecycle &lc = cfg_.lifecycle;
+      // Replacements go to the back and are young and near the touch, so the pass skips them.
+      for (std::size_t i = 0; i < live_.size();)
+      {
+        const LiveOrder o = live_[i];
+        if constexpr (requires { engine.resting(u64{}); })
+        {
+          if (!engine.resting(o.order_id))
+          {
+            drop(i);
+            continue;
+          }
+        }
+        const Price touch = o.side == Side::Buy ? t.bid_price : t.ask_price;
+        const Price behind = o.side == Side::Buy ? touch - o.price : o.price - touch;
+        const bool far = lc.max_distance > 0 && touch != 0 && behind > lc.max_distance * cfg_.tick;
+        if (!far && o.expires_ns > ts)
+        {
+          ++i;
+          continue;
+        }
+        pull(engine, i, ts);
+        if (!far && rng_.chance(lc.modify_prob))
+        {
+          const Price ref = touch != 0 ? touch
+                            : o.side == Side::Buy ? cfg_.mid - cfg_.tick
+                                                  : cfg_.mid + cfg_.tick;
+          const Price off = reprice_depth_(rng_) * cfg_.tick;
+          const Price px = o.side == Side::Buy ? ref - off : ref + off;
+          add_passive(engine,
+                      NewOrder{next_order_id_++, o.user_id, o.side, px, o.qty, TIF::Day, ts});
+          modifies_.add();
+        }
       }
+      live_orders_.set(live_.size());
     }
   }
 };
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "market/order_book.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+namespace hft
+{
+// Per-user pre-trade limits. Zero turns a check off.
+struct RiskLimits
+{
+  Qty max_order_qty{0};   // per order
+  u32 max_open_orders{0}; // resting orders at once
+  i64 max_position{0};    // |position| if every open order on the order's side filled too
+  i64 max_notional{0};    // gross price * qty traded, plus the order's own
+  Price price_collar{0};  // ticks a buy may go above the best ask (a sell below the best bid)
+};
+
+// What the engine knows about a user's exposure: fills for both sides of every trade, and the
+// orders resting on the book.
+struct RiskExposure
+{
+  i64 position{0}; // signed, long positive
+  i64 notional{0}; // gross traded
+  i64 open_buy{0}; // resting quantity per side
+  i64 open_sell{0};
+  u32 open_orders{0};
+};
+
+// The engine's pre-trade stage. Accounts live in a dense array indexed by user id, so finding one
+// is a bounds check and a load, and a user without limits (the street, simulated agents, ids
+// beyond kMaxUsers) costs only that: its orders are neither checked nor tracked. Single-threaded:
+// only the engine thread touches it once matching starts.
+class RiskGate
+{
+public:
+  static constexpr u64 kMaxUsers = 1 << 16;
+
+  struct Account
+  {
+    RiskLimits limits{};
+    RiskExposure exposure{};
+    bool active{false};
+  };
+
+private:
+  std::vector<Account> accounts_;
+
+  static i64 notional(Price px, Qty q) noexcept
+  {
+    return std::llabs(static_cast<i64>(px) * q);
+  }
+
+public:
+  // Check and track `user_id` from now on, keeping any exposure it already has. False when the id
+  // is too large for the table.
+  bool set_limits(u64 user_id, const RiskLimits &limits)
+  {
+    if (user_id >= kMaxUsers)
+      return false;
+    if (user_id >= accounts_.size())
+      accounts_.resize(user_id + 1);
+    accounts_[user_id].limits = limits;
+    accounts_[user_id].active = true;
+    return true;
+  }
+
+  // Null for a user without limits.
+  Account *account(u64 user_id) noexcept
+  {
+    return user_id < accounts_.size() && accounts_[user_id].active ? &accounts_[user_id] : nullptr;
+  }
+
+  const Account *account(u64 user_id) const noexcept
+  {
+    return user_id < accounts_.size() && accounts_[user_id].active ? &accounts_[user_id] : nullptr;
+  }
+
+  // Call `f(user_id, limits)` for every user with limits, in id order.
+  template <typename F> void for_each_limits(F &&f) const
+  {
+    for (std::size_t id = 0; id < accounts_.size(); ++id)
+      if (accounts_[id].active)
+        f(static_cast<u64>(id), accounts_[id].limits);
+  }
+
+  // RejectCode::None when `n` may go on to matching. The collar is measured from the touch it
+  // would trade against, or its own side's when that is empty.
+  static RejectCode check(const Account &a, const NewOrder &n, const OrderBook &book) noexcept
+  {
+    const RiskLimits &l = a.limits;
+    const RiskExposure &x = a.exposure;
+    if (l.max_order_qty > 0 && n.qty > l.max_order_qty)
+      return RejectCode::OrderQty;
+    if (l.max_open_orders > 0 && n.tif == TIF::Day && x.open_orders >= l.max_open_orders)
+      return RejectCode::OpenOrders;
+    if (l.max_position > 0)
+    {
+      const i64 worst = n.side == Side::Buy ? x.position + x.open_buy + n.qty
+                                            : x.open_sell + n.qty - x.position;
+      if (worst > l.max_position)
+        return RejectCode::Position;
+    }
+    if (l.max_notional > 0 && x.notional + notional(n.price, n.qty) > l.max_notional)
+      return RejectCode::Notional;
+    if (l.price_collar > 0)
+    {
+      if (n.side == Side::Buy)
+      {
+        const Price ref = book.best_ask() != 0 ? book.best_ask() : book.best_bid();
+        if (ref != 0 && n.price > ref + l.price_collar)
+          return RejectCode::PriceCollar;
+      }
+      else
+      {
+        const Price ref = book.best_bid() != 0 ? book.best_bid() : book.best_ask();
+        if (ref != 0 && n.price < ref - l.price_collar)
+          return RejectCode::PriceCollar;
+      }
+    }
+    return RejectCode::None;
+  }
+
+  // A fill of `q` at `px` on `side`. `resting` when it came off one of the user's open orders,
+  // `done` when that order has nothing left.
+  static void on_fill(Account &a, Side side, Price px, Qty q, bool resting = false,
+                      bool done = false) noexcept
+  {
+    RiskExposure &x = a.exposure;
+    x.position += side == Side::Buy ? q : -q;
+    x.notional += notional(px, q);
+    if (!resting)
+      return;
+    (side == Side::Buy ? x.open_buy : x.open_sell) -= q;
+    if (done && x.open_orders > 0)
+      --x.open_orders;
+  }
+
+  // `q` came to rest on `side` as a new order.
+  static void on_rest(Account &a, Side side, Qty q) noexcept
+  {
+    (side == Side::Buy ? a.exposure.open_buy : a.exposure.open_sell) += q;
+    ++a.exposure.open_orders;
+  }
+
+  // A resting order with `leaves` on `side` was cancelled.
+  static void on_cancel(Account &a, Side side, Qty leaves) noexcept
+  {
+    (side == Side::Buy ? a.exposure.open_buy : a.exposure.open_sell) -= leaves;
+    if (a.exposure.open_orders > 0)
+      --a.exposure.open_orders;
+  }
+};
+} // namespace hft
@@ -33,10 +33,14 @@ public:
     return notional_.load(std::memory_order_relaxed);
   }
 
-  bool can_quote(Qty q) const noexcept
+  // `px` is the price the quote would go out at: like the engine's gate, traded notional plus the
+  // quote's own must stay within max_notional.
+  bool can_quote(Qty q, Price px = 0) const noexcept
   {
     return q <= max_order_qty_ &&
-           std::abs(position_.load(std::memory_order_relaxed)) < max_position_;
+           std::abs(position_.load(std::memory_order_relaxed)) < max_position_ &&
+           notional_.load(std::memory_order_relaxed) + std::llabs(static_cast<i64>(px) * q) <=
+               max_notional_;
   }
 
   void on_exec(const ExecEvent &e) noexcept
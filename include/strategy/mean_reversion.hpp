@@ -1,34 +1,45 @@
 #pragma once
 
+#include "quote_manager.hpp"
+#include "signals.hpp"
 #include "strategy.hpp"
 
 namespace hft
 {
 // A tiny mean-reversion maker: maintain a rolling mean of mid-price.
 // If mid deviates by N ticks, quote both sides around mid, lean into deviation.
+// The mean is kept incrementally over at most kMaxWindow mids; longer windows are clamped to it.
+// Working quotes are tracked by a QuoteManager, which decides when one is worth replacing.
 // This file intentionally contains the full implementation so readers can inspect the whole flow
 // without jumping between declaration/definition files.
-class MeanReversion final : public IStrategy
+class MeanReversion
 {
+public:
+  static constexpr std::size_t kMaxWindow = 1024;
+
+private:
   StrategyContext &ctx_;                     // shared counters (order ids, tick size, etc.)
   RiskManager &risk_;                        // guard rails to avoid runaway quoting
-  spsc::Queue<EngineCommand, 1 << 14> &out_; // queue into the engine thread
-  std::vector<Price> window_;                // rolling window storing historical mids
-  std::size_t wlen_;                         // cached window length to avoid repeated size()
+  // Queue into the engine thread, behind the strategy's overflow policy.
+  overflow::Writer<spsc::Queue<EngineCommand, 1 << 14>, EngineCommand> out_;
+  // Mean of the last window_len mids, updated in O(1) per book update.
+  signal::RollingMean<Price, kMaxWindow> mid_mean_;
   double dev_ticks_;                         // deviation threshold expressed in ticks
   Qty quote_qty_;                            // quantity per quote
-  Price last_bid_{0}, last_ask_{0};          // last prices we quoted (for potential cancels)
+  QuoteManager quotes_;                      // our working quotes and when to replace them
   TopOfBook last_top_{};                     // most recent market snapshot seen
+  stats::Counter orders_sent_ = stats::counter("strategy.orders");
 
 public:
   MeanReversion(StrategyContext &ctx, RiskManager &risk, spsc::Queue<EngineCommand, 1 << 14> &out,
-                std::size_t window_len = 64, double dev_ticks = 2.0, Qty quote_qty = 1)
-      : ctx_(ctx), risk_(risk), out_(out), window_(window_len, 0), wlen_(window_len),
-        dev_ticks_(dev_ticks), quote_qty_(quote_qty)
+                std::size_t window_len = 64, double dev_ticks = 2.0, Qty quote_qty = 1,
+                overflow::Config cmd_overflow = {overflow::Policy::Drop}, QuoteConfig quoting = {})
+      : ctx_(ctx), risk_(risk), out_(out, "strategy.cmd", cmd_overflow), mid_mean_(window_len),
+        dev_ticks_(dev_ticks), quote_qty_(quote_qty), quotes_(quoting, ctx.tick, ctx.user_id)
   {
   }
 
-  void on_market_data(const MarketDataEvent &e) override
+  void on_market_data(const MarketDataEvent &e)
   {
     if (std::holds_alternative<TopOfBook>(e))
     {
@@ -36,19 +47,19 @@ public:
       if (last_top_.bid_price > 0 && last_top_.ask_price > 0)
       {
         const Price mid = (last_top_.bid_price + last_top_.ask_price) / 2;
-        // Update the rolling window with the fresh midpoint.
-        rotate_and_push(mid);
+        mid_mean_.push(mid);
       }
     }
   }
 
-  void on_exec(const ExecEvent &e) override
+  void on_exec(const ExecEvent &e)
   {
     // Feed trade information into the risk manager so subsequent can_quote checks stay current.
     risk_.on_exec(e);
+    quotes_.on_exec(e);
   }
 
-  void on_timer(u64 ts_ns) override
+  void on_timer(u64 ts_ns)
   {
     // If no book yet, do nothing.
     if (last_top_.bid_price == 0 || last_top_.ask_price == 0)
@@ -60,67 +71,88 @@ public:
     const Price tick = ctx_.tick;
     const Price edge = static_cast<Price>(dev_ticks_) * tick;
 
-    // Cancel previous quotes if top moved away.
-    cancel_if_stale(ts_ns);
+    // Quotes spilled while the engine was behind go first (only with a Spill policy).
+    out_.flush();
 
-    // Basic risk checks before quoting
-    if (!risk_.can_quote(quote_qty_))
-      return;
+    // Lean toward mean: if mid > mean by N ticks, shade both quotes a tick down so we sell more
+    // aggressively (and up, to buy, when mid is that far below it).
+    const double band = static_cast<double>(edge);
+    const Price lean = dev > band ? -tick : dev < -band ? tick : 0;
+    Price bid_quote = mid - edge + lean;
+    Price ask_quote = mid + edge + lean;
 
-    // Lean toward mean: if mid > mean by N ticks, skew quotes to sell more aggressively.
-    Price bid_quote = mid - edge;
-    Price ask_quote = mid + edge;
+    // Cancel previous quotes if top moved away.
+    cancel_if_stale(Side::Buy, bid_quote, ts_ns);
+    cancel_if_stale(Side::Sell, ask_quote, ts_ns);
 
-    send_new(Side::Buy, bid_quote, quote_qty_, ts_ns);
-    send_new(Side::Sell, ask_quote, quote_qty_, ts_ns);
+    // Basic risk checks before quoting; the ask is the dearer quote, so its notional bounds both.
+    if (!risk_.can_quote(quote_qty_, ask_quote))
+      return;
 
-    last_bid_ = bid_quote;
-    last_ask_ = ask_quote;
+    // A quote still resting close enough to the right price keeps its place in the queue.
+    place(Side::Buy, bid_quote, ts_ns);
+    place(Side::Sell, ask_quote, ts_ns);
   }
 
 private:
-  void rotate_and_push(Price x)
+  // Mean of the mids seen so far while the window is still filling.
+  double rolling_mean() const noexcept
   {
-    // O(1) ring buffer rolling mean without recomputing sum each time.
-    static_assert(sizeof(std::size_t) == sizeof(u64));
-    static u64 idx = 0;
-    // Overwrite oldest entry and advance index. This keeps the window at wlen_ samples.
-    window_[idx % wlen_] = x;
-    ++idx;
+    return mid_mean_.mean();
   }
 
-  double rolling_mean() const
+  // Latency stamps: the book update this decision was based on, and the moment we hand it off.
+  void stamp(EngineCommand &cmd) const noexcept
   {
-    // Simple mean to keep the example approachable. Consider incremental mean for efficiency.
-    long double sum = 0;
-    for (Price p : window_)
-      sum += p;
-    return static_cast<double>(sum / static_cast<long double>(wlen_));
+    cmd.lat.tick_ns = last_top_.ts_ns;
+    cmd.lat.origin_ns = now_ns();
   }
 
-  void send_new(Side s, Price px, Qty q, u64 ts_ns)
+  // Returns the order id, or 0 when the quote was dropped.
+  u64 send_new(Side s, Price px, Qty q, u64 ts_ns)
   {
     // Fill out EngineCommand payload and push to engine queue.
     EngineCommand cmd{};
     cmd.kind = EngineCommand::Kind::New;
     cmd.new_order = NewOrder{ctx_.next_order_id++, ctx_.user_id, s, px, q, TIF::Day, ts_ns};
-    out_.push(cmd);
+    stamp(cmd);
+    // A dropped quote is counted as strategy.cmd.drops; the next timer tick quotes afresh.
+    const bool sent = out_.push(cmd);
+    if (sent)
+      orders_sent_.add();
+    out_.notify(); // wake the engine if its wait strategy parked it
+    return sent ? cmd.new_order.order_id : 0;
   }
 
-  void send_cancel(u64 order_id, u64 ts_ns)
+  // False when the cancel was dropped.
+  bool send_cancel(u64 order_id, u64 ts_ns)
   {
-    // Helper for future exercises: demonstrate how to construct cancel commands.
     EngineCommand cmd{};
     cmd.kind = EngineCommand::Kind::Cancel;
     cmd.cancel = CancelOrder{order_id, ctx_.user_id, ts_ns};
-    out_.push(cmd);
+    stamp(cmd);
+    const bool sent = out_.push(cmd);
+    out_.notify();
+    return sent;
+  }
+
+  // Pull a working quote too far from what we would quote now. Without this every timer tick
+  // would leave another pair of orders resting on the book. A dropped cancel keeps the quote
+  // working, so the next tick retries it instead of quoting on top of an order still resting.
+  void cancel_if_stale(Side s, Price px, u64 ts_ns)
+  {
+    if (quotes_.stale(s, px, ts_ns) && send_cancel(quotes_.working(s).order_id, ts_ns))
+      quotes_.pulled(s);
   }
 
-  void cancel_if_stale(u64 ts_ns)
+  void place(Side s, Price px, u64 ts_ns)
   {
-    // This example does not store our working order ids per price. In production do that.
-    // For now this is a no-op. Left as a placeholder for user extensions.
-    (void)ts_ns;
+    if (!quotes_.can_place(s, ts_ns))
+      return;
+    if (const u64 id = send_new(s, px, quote_qty_, ts_ns); id != 0)
+      quotes_.placed(s, id, px, quote_qty_, ts_ns);
   }
 };
+
+static_assert(Strategy<MeanReversion>);
 } // namespace hft
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "market/order.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace hft
+{
+struct QuoteConfig
+{
+  Price requote_ticks{0}; // replace a working quote only when it is more than this far off
+  u64 min_requote_ns{0};  // and send at most one order per side per interval
+  // After the engine rejects a quote for position or notional, its side waits this long before
+  // quoting again, twice as long after each further such reject (up to 64 times), until an order
+  // on that side is accepted. Zero retries at once.
+  u64 risk_backoff_ns{100'000'000};
+};
+
+// Working-quote table for a two-sided maker: one order per side, with its price and leaves as the
+// execs report them. It decides; the strategy sends. A working quote within requote_ticks of the
+// wanted price keeps its place in the queue, and a side that sent an order less than
+// min_requote_ns ago waits, so a mid that flickers by a tick costs no traffic. The defaults
+// requote on any change, at once. A side the engine's risk gate turns away backs off rather than
+// sending an order it will reject on every tick.
+class QuoteManager
+{
+public:
+  struct Quote
+  {
+    u64 order_id{0}; // 0 when nothing is working
+    Price price{0};
+    Qty leaves{0};
+    u64 sent_ns{0};
+  };
+
+private:
+  QuoteConfig cfg_;
+  Price tick_;
+  u64 user_id_; // execs for other users are not ours, whatever their order id
+  Quote quotes_[2]{};
+  u64 next_send_ns_[2]{}; // rate limit per side
+  u64 backoff_ns_[2]{};   // current wait after a risk reject, 0 while the side is accepted
+
+  static constexpr std::size_t idx(Side s) noexcept
+  {
+    return static_cast<std::size_t>(s);
+  }
+
+public:
+  explicit QuoteManager(const QuoteConfig &cfg = {}, Price tick = 1, u64 user_id = 0)
+      : cfg_(cfg), tick_(tick), user_id_(user_id)
+  {
+  }
+
+  const Quote &working(Side s) const noexcept
+  {
+    return quotes_[idx(s)];
+  }
+
+  // The working quote on `s` should be pulled to quote at `want` instead.
+  bool stale(Side s, Price want, u64 ts_ns) const noexcept
+  {
+    const Quote &q = quotes_[idx(s)];
+    return q.order_id != 0 && std::llabs(want - q.price) > cfg_.requote_ticks * tick_ &&
+           ts_ns >= next_send_ns_[idx(s)];
+  }
+
+  // Nothing is working on `s` and the rate limit lets a new quote go.
+  bool can_place(Side s, u64 ts_ns) const noexcept
+  {
+    return quotes_[idx(s)].order_id == 0 && ts_ns >= next_send_ns_[idx(s)];
+  }
+
+  void placed(Side s, u64 order_id, Price px, Qty qty, u64 ts_ns) noexcept
+  {
+    quotes_[idx(s)] = Quote{order_id, px, qty, ts_ns};
+    next_send_ns_[idx(s)] = ts_ns + cfg_.min_requote_ns;
+  }
+
+  // Forget the quote on `s` once its cancel is sent; fills racing the cancel still reach risk.
+  // Returns its order id.
+  u64 pulled(Side s) noexcept
+  {
+    const u64 id = quotes_[idx(s)].order_id;
+    quotes_[idx(s)] = Quote{};
+    return id;
+  }
+
+  u64 backoff_ns(Side s) const noexcept
+  {
+    return backoff_ns_[idx(s)];
+  }
+
+  void on_exec(const ExecEvent &e) noexcept
+  {
+    if (e.user_id != user_id_)
+      return;
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+      Quote &q = quotes_[i];
+      if (q.order_id == 0 || q.order_id != e.order_id)
+        continue;
+      if (e.type == ExecType::Trade)
+        q.leaves = e.leaves;
+      if (e.type == ExecType::Ack || e.type == ExecType::Trade)
+        backoff_ns_[i] = 0;
+      else if (e.type == ExecType::Reject &&
+               (e.code == RejectCode::Position || e.code == RejectCode::Notional))
+        back_off(i, q.sent_ns);
+      // A quote that is gone (filled, cancelled or rejected) no longer needs cancelling.
+      if (e.type == ExecType::CancelAck || e.type == ExecType::Reject ||
+          (e.type == ExecType::Trade && e.leaves == 0))
+        q = Quote{};
+      return;
+    }
+  }
+
+private:
+  void back_off(std::size_t i, u64 sent_ns) noexcept
+  {
+    if (backoff_ns_[i] == 0)
+      backoff_ns_[i] = cfg_.risk_backoff_ns;
+    else if (backoff_ns_[i] < cfg_.risk_backoff_ns << 6)
+      backoff_ns_[i] *= 2;
+    next_send_ns_[i] = std::max(next_send_ns_[i], sent_ns + backoff_ns_[i]);
+  }
+};
+} // namespace hft
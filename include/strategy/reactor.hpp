@@ -0,0 +1,214 @@
+#pragma once
+
+#include "common/broadcast_ring.hpp"
+#include "common/clock.hpp"
+#include "common/latency.hpp"
+#include "common/spsc_queue.hpp"
+#include "common/stats.hpp"
+#include "common/thread_placement.hpp"
+#include "common/wait_strategy.hpp"
+#include "strategy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// One thread hosting one or more strategies, polling every source they need: the engine's exec
+// queue, a single market data subscription and a timer. Strategies and the risk state they share
+// are only ever touched from this thread, so none of it needs synchronising, and one idle loop
+// replaces a sleeping loop per source. Each pass takes, in order:
+//   1) up to exec_batch execs, each routed to the strategy whose user id it carries
+//   2) up to md_batch market data events, each handed to every strategy (fan-out)
+//   3) on_timer for every strategy, once timer_ns has passed since the last one
+// Execs go first on every pass and both batches are bounded, so a burst on one source delays the
+// other by at most one batch. An idle reactor parks on the market data ring, which EngineThread
+// notifies together with the exec queue after every batch.
+namespace hft
+{
+struct ReactorConfig
+{
+  u64 timer_ns{200'000};      // on_timer cadence
+  std::size_t exec_batch{64}; // execs per pass
+  std::size_t md_batch{16};   // market data events per pass
+  wait::WaitConfig wait{};
+};
+
+// S is bound at compile time (see strategy.hpp); Reactor<IStrategy> hosts mixed strategy types.
+template <Strategy S = IStrategy> class Reactor
+{
+public:
+  using ExecQueue = spsc::Queue<ExecEvent, 1 << 14>;
+  using MdRing = broadcast::Ring<MarketDataEvent, 1 << 14>;
+  using CommandQueue = spsc::Queue<EngineCommand, 1 << 14>;
+
+private:
+  struct Slot
+  {
+    u64 user_id{0};
+    S *strategy{nullptr};
+  };
+
+  ReactorConfig cfg_;
+  ExecQueue &exec_in_;
+  MdRing &md_ring_;
+  typename MdRing::Subscriber md_sub_;
+  std::vector<Slot> slots_;            // sorted by user id
+  CommandQueue *cmd_out_{nullptr};     // prefaulted by the reactor thread when pinned
+  latency::Tracer *tracer_{nullptr};   // optional; records the exec queue hop
+  wait::Waiter waiter_;
+  u64 next_timer_{0};
+  ThreadPlacement placement_{};
+  stats::Counter execs_ = stats::counter("strategy.execs");
+  stats::Counter unrouted_ = stats::counter("strategy.execs_unrouted");
+  stats::Counter md_events_ = stats::counter("strategy.md_events");
+  stats::Gauge md_lag_ = stats::gauge("strategy.md_lag");
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  void route(const ExecEvent &e)
+  {
+    const auto it = std::lower_bound(slots_.begin(), slots_.end(), e.user_id,
+                                     [](const Slot &s, u64 id) { return s.user_id < id; });
+    if (it != slots_.end() && it->user_id == e.user_id)
+      it->strategy->on_exec(e);
+    else
+      unrouted_.add(); // the street's, or a strategy hosted elsewhere
+  }
+
+  void run()
+  {
+    // The hosted strategies are the only producer of their command queue, so when pinned this
+    // thread takes its first touch.
+    if (apply_placement(ThreadRole::MdConsumer, placement_) && placement_.cpu >= 0 &&
+        cmd_out_ != nullptr)
+      cmd_out_->prefault();
+    next_timer_ = now_ns();
+    while (running_.load(std::memory_order_acquire))
+    {
+      const u64 now = now_ns();
+      if (poll(now))
+        waiter_.reset();
+      else
+        waiter_.idle(
+            [this]
+            {
+              return !exec_in_.empty() || !md_sub_.empty() ||
+                     !running_.load(std::memory_order_relaxed);
+            },
+            next_timer_ > now ? next_timer_ - now : 0);
+    }
+  }
+
+public:
+  // Subscribes to `md` at once, so construct the reactor before the engine publishes.
+  Reactor(ExecQueue &exec_in, MdRing &md, const ReactorConfig &cfg = {})
+      : cfg_(cfg), exec_in_(exec_in), md_ring_(md), md_sub_(md.subscribe()),
+        waiter_(cfg.wait, &md.event())
+  {
+    cfg_.exec_batch = std::max<std::size_t>(1, cfg_.exec_batch);
+    cfg_.md_batch = std::max<std::size_t>(1, cfg_.md_batch);
+  }
+
+  Reactor(const Reactor &) = delete;
+  Reactor &operator=(const Reactor &) = delete;
+
+  ~Reactor()
+  {
+    stop();
+  }
+
+  // Host `s`, which receives the execs for `user_id` and all market data. Call before start().
+  // False when another hosted strategy already has that user id.
+  bool add(S &s, u64 user_id)
+  {
+    const auto it = std::lower_bound(slots_.begin(), slots_.end(), user_id,
+                                     [](const Slot &x, u64 id) { return x.user_id < id; });
+    if (it != slots_.end() && it->user_id == user_id)
+      return false;
+    slots_.insert(it, Slot{user_id, &s});
+    return true;
+  }
+
+  // The queue the hosted strategies push commands into. Call before start().
+  void set_command_queue(CommandQueue &q) noexcept
+  {
+    cmd_out_ = &q;
+  }
+
+  // Record the engine -> strategy exec queue hop into `tracer`. Call before start().
+  void set_tracer(latency::Tracer *tracer) noexcept
+  {
+    tracer_ = tracer;
+  }
+
+  // One pass over every source, with `now` as the timer's clock. True when it did any work.
+  // run() loops over it; tests may call it directly instead of starting the thread.
+  bool poll(u64 now)
+  {
+    bool busy = false;
+    ExecEvent e;
+    for (std::size_t n = 0; n < cfg_.exec_batch && exec_in_.pop(e); ++n)
+    {
+      if (tracer_ != nullptr)
+        tracer_->record(latency::Hop::ExecQueue, e.lat.egress_ns, now_ns());
+      route(e);
+      execs_.add();
+      busy = true;
+    }
+
+    MarketDataEvent md;
+    std::size_t n = 0;
+    for (; n < cfg_.md_batch && md_sub_.pop(md); ++n)
+      for (const Slot &s : slots_)
+        s.strategy->on_market_data(md);
+    if (n > 0)
+    {
+      md_events_.add(n);
+      md_lag_.set(md_sub_.lag());
+      busy = true;
+    }
+
+    if (now >= next_timer_)
+    {
+      for (const Slot &s : slots_)
+        s.strategy->on_timer(now);
+      next_timer_ = now + cfg_.timer_ns;
+      busy = true;
+    }
+    return busy;
+  }
+
+  void start(ThreadPlacement placement = {})
+  {
+    placement_ = placement;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] { run(); });
+  }
+
+  void stop()
+  {
+    running_.store(false, std::memory_order_release);
+    md_ring_.notify(); // wake the loop if parked
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+  std::size_t size() const noexcept
+  {
+    return slots_.size();
+  }
+
+  // Overrun and drop counts of the market data subscription.
+  const typename MdRing::Subscriber &market_data() const noexcept
+  {
+    return md_sub_;
+  }
+
+  // Idle-time counters and the wait policy in use. Only meaningful after stop().
+  const wait::WaitStats &wait_stats() const noexcept
+  {
+    return waiter_.stats();
+  }
+};
+} // namespace hft
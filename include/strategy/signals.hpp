@@ -0,0 +1,335 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "market/order.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+// Streaming estimators for strategy signals. Every update is O(1) (amortised for min/max), nothing
+// allocates, and each windowed estimator keeps its samples in a ring of Capacity slots, a power of
+// two, so every index is a mask. The window length itself is chosen at construction, anywhere in
+// [1, Capacity]: the sample leaving a window of length L is the one pushed L updates ago, which is
+// still in the ring. A fixed window is simply L = Capacity.
+//   RollingMean     -> ring sum; exact for integral samples
+//   RollingVariance -> Welford's update with removal of the leaving sample
+//   RollingMin/Max  -> monotonic deque over the ring
+//   Ewma            -> exponentially weighted mean, by alpha or by half-life in samples
+//   Vwap            -> volume-weighted price of the last L trade prints, or of all of them
+namespace hft::signal
+{
+// Last Capacity samples, of which the newest `length` form the window.
+template <typename T, std::size_t Capacity> class Window
+{
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+  static constexpr u64 kMask = Capacity - 1;
+
+  T buf_[Capacity]{};
+  u64 pushed_{0};
+  std::size_t len_;
+
+public:
+  explicit constexpr Window(std::size_t length = Capacity) noexcept
+      : len_(std::clamp<std::size_t>(length, 1, Capacity))
+  {
+  }
+
+  // Add x. Returns true, with the sample that left the window in `evicted`, once it is full.
+  constexpr bool push(T x, T &evicted) noexcept
+  {
+    const bool full = pushed_ >= len_;
+    if (full)
+      evicted = buf_[(pushed_ - len_) & kMask];
+    buf_[pushed_ & kMask] = x;
+    ++pushed_;
+    return full;
+  }
+
+  // Sample pushed `age` updates ago (0 = newest); age < size().
+  constexpr T operator[](std::size_t age) const noexcept
+  {
+    return buf_[(pushed_ - 1 - age) & kMask];
+  }
+
+  constexpr std::size_t length() const noexcept
+  {
+    return len_;
+  }
+
+  constexpr std::size_t size() const noexcept
+  {
+    return pushed_ < len_ ? static_cast<std::size_t>(pushed_) : len_;
+  }
+
+  constexpr u64 pushed() const noexcept
+  {
+    return pushed_;
+  }
+};
+
+// Mean of the last L samples (fewer until L have arrived). Integral samples are summed exactly in
+// a 64-bit accumulator, so the mean never drifts however long it runs.
+template <typename T, std::size_t Capacity> class RollingMean
+{
+  using Sum = std::conditional_t<std::is_integral_v<T>, i64, double>;
+
+  Window<T, Capacity> win_;
+  Sum sum_{0};
+
+public:
+  explicit constexpr RollingMean(std::size_t length = Capacity) noexcept : win_(length)
+  {
+  }
+
+  constexpr void push(T x) noexcept
+  {
+    T out{};
+    if (win_.push(x, out))
+      sum_ -= static_cast<Sum>(out);
+    sum_ += static_cast<Sum>(x);
+  }
+
+  constexpr Sum sum() const noexcept
+  {
+    return sum_;
+  }
+
+  double mean() const noexcept
+  {
+    const std::size_t n = win_.size();
+    return n == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(n);
+  }
+
+  constexpr std::size_t size() const noexcept
+  {
+    return win_.size();
+  }
+
+  constexpr std::size_t length() const noexcept
+  {
+    return win_.length();
+  }
+};
+
+// Mean and sample variance of the last L samples by Welford's method, extended to remove the
+// sample leaving the window. Stays accurate where sum-of-squares would cancel (prices near 1e4
+// moving by a tick).
+template <std::size_t Capacity> class RollingVariance
+{
+  Window<double, Capacity> win_;
+  double mean_{0};
+  double m2_{0}; // sum of squared deviations from mean_
+
+public:
+  explicit constexpr RollingVariance(std::size_t length = Capacity) noexcept : win_(length)
+  {
+  }
+
+  void push(double x) noexcept
+  {
+    double out = 0;
+    if (win_.push(x, out))
+    {
+      // Replace `out` by `x` with n fixed.
+      const double prev = mean_;
+      mean_ += (x - out) / static_cast<double>(win_.size());
+      m2_ += (x - out) * (x - mean_ + out - prev);
+    }
+    else
+    {
+      const double d = x - mean_;
+      mean_ += d / static_cast<double>(win_.size());
+      m2_ += d * (x - mean_);
+    }
+    if (m2_ < 0)
+      m2_ = 0; // rounding on a flat window
+  }
+
+  double mean() const noexcept
+  {
+    return mean_;
+  }
+
+  // Sample variance (n - 1); 0 with fewer than two samples.
+  double variance() const noexcept
+  {
+    const std::size_t n = win_.size();
+    return n < 2 ? 0.0 : m2_ / static_cast<double>(n - 1);
+  }
+
+  double stddev() const noexcept
+  {
+    return std::sqrt(variance());
+  }
+
+  constexpr std::size_t size() const noexcept
+  {
+    return win_.size();
+  }
+};
+
+// Extreme of the last L samples under `Better` (std::less for the minimum). The deque holds the
+// samples that could still become the extreme, best at the front; each sample enters and leaves
+// it once, so an update is amortised O(1).
+template <typename T, std::size_t Capacity, typename Better> class RollingExtreme
+{
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+  static constexpr u64 kMask = Capacity - 1;
+
+  T val_[Capacity]{};
+  u64 seq_[Capacity]{};
+  u64 head_{0}; // deque occupies [head_, tail_), masked
+  u64 tail_{0};
+  u64 pushed_{0};
+  std::size_t len_;
+
+public:
+  explicit constexpr RollingExtreme(std::size_t length = Capacity) noexcept
+      : len_(std::clamp<std::size_t>(length, 1, Capacity))
+  {
+  }
+
+  constexpr void push(T x) noexcept
+  {
+    const Better better{};
+    const u64 seq = pushed_++;
+    while (head_ != tail_ && seq - seq_[head_ & kMask] >= len_)
+      ++head_; // left the window
+    while (tail_ != head_ && !better(val_[(tail_ - 1) & kMask], x))
+      --tail_; // x is at least as good and outlives it
+    val_[tail_ & kMask] = x;
+    seq_[tail_ & kMask] = seq;
+    ++tail_;
+  }
+
+  // Undefined before the first push.
+  constexpr T value() const noexcept
+  {
+    return val_[head_ & kMask];
+  }
+
+  constexpr bool empty() const noexcept
+  {
+    return pushed_ == 0;
+  }
+};
+
+template <typename T, std::size_t Capacity>
+using RollingMin = RollingExtreme<T, Capacity, std::less<>>;
+template <typename T, std::size_t Capacity>
+using RollingMax = RollingExtreme<T, Capacity, std::greater<>>;
+
+// value += alpha * (x - value), seeded by the first sample.
+class Ewma
+{
+  double alpha_;
+  double value_{0};
+  bool seeded_{false};
+
+public:
+  explicit constexpr Ewma(double alpha) noexcept : alpha_(alpha)
+  {
+  }
+
+  // A sample's weight halves every `samples` updates.
+  static Ewma half_life(double samples) noexcept
+  {
+    return Ewma(1.0 - std::exp2(-1.0 / samples));
+  }
+
+  constexpr void push(double x) noexcept
+  {
+    value_ = seeded_ ? value_ + alpha_ * (x - value_) : x;
+    seeded_ = true;
+  }
+
+  constexpr double value() const noexcept
+  {
+    return value_;
+  }
+
+  constexpr double alpha() const noexcept
+  {
+    return alpha_;
+  }
+};
+
+// Volume-weighted average price of the last L trade prints, with price times quantity summed
+// exactly in 64 bits. SessionVwap covers every print instead.
+template <std::size_t Capacity> class Vwap
+{
+  struct Fill
+  {
+    i64 notional{0};
+    i64 qty{0};
+  };
+
+  Window<Fill, Capacity> win_;
+  i64 notional_{0};
+  i64 qty_{0};
+
+public:
+  explicit constexpr Vwap(std::size_t length = Capacity) noexcept : win_(length)
+  {
+  }
+
+  constexpr void on_trade(const TradePrint &t) noexcept
+  {
+    const Fill in{static_cast<i64>(t.price) * t.qty, t.qty};
+    Fill out{};
+    if (win_.push(in, out))
+    {
+      notional_ -= out.notional;
+      qty_ -= out.qty;
+    }
+    notional_ += in.notional;
+    qty_ += in.qty;
+  }
+
+  // 0 before any volume.
+  double value() const noexcept
+  {
+    return qty_ == 0 ? 0.0 : static_cast<double>(notional_) / static_cast<double>(qty_);
+  }
+
+  constexpr i64 volume() const noexcept
+  {
+    return qty_;
+  }
+};
+
+// VWAP of every print since construction or reset().
+class SessionVwap
+{
+  i64 notional_{0};
+  i64 qty_{0};
+
+public:
+  constexpr void on_trade(const TradePrint &t) noexcept
+  {
+    notional_ += static_cast<i64>(t.price) * t.qty;
+    qty_ += t.qty;
+  }
+
+  double value() const noexcept
+  {
+    return qty_ == 0 ? 0.0 : static_cast<double>(notional_) / static_cast<double>(qty_);
+  }
+
+  constexpr i64 volume() const noexcept
+  {
+    return qty_;
+  }
+
+  constexpr void reset() noexcept
+  {
+    notional_ = 0;
+    qty_ = 0;
+  }
+};
+} // namespace hft::signal
@@ -6,6 +6,7 @@
 #include "market/matching_engine.hpp"
 #include "risk/risk_manager.hpp"
 
+#include <concepts>
 #include <optional>
 #include <vector>
 
@@ -14,6 +15,12 @@ namespace hft
 // Interface for strategies: consume market data and execs, then produce orders back into engine.
 // The goal is to let learners focus on signal logic while the surrounding infrastructure stays
 // small.
+//
+// Strategies are bound at compile time. Anything with the three callbacks below satisfies
+// `Strategy`, and the code that drives one (the backtester, the consumer loops) is a template over
+// the concrete type, so each callback is a direct call that can inline into the loop draining the
+// queue. IStrategy remains for strategies picked at run time, such as plugins: StrategyAdapter
+// wraps a concrete strategy in it, at one indirect call per event.
 struct StrategyContext
 {
   u64 next_order_id{1}; // per-strategy sequence so orders have unique identifiers
@@ -21,6 +28,13 @@ struct StrategyContext
   Price tick{1};        // minimum price increment the instrument trades in
 };
 
+template <typename S>
+concept Strategy = requires(S &s, const MarketDataEvent &md, const ExecEvent &e, u64 ts_ns) {
+  s.on_market_data(md);
+  s.on_exec(e);
+  s.on_timer(ts_ns);
+};
+
 class IStrategy
 {
 public:
@@ -29,4 +43,35 @@ public:
   virtual void on_exec(const ExecEvent &e) = 0;
   virtual void on_timer(u64 ts_ns) = 0;
 };
+
+// A concrete strategy behind the virtual interface. It does not own the strategy.
+template <Strategy S> class StrategyAdapter final : public IStrategy
+{
+  S &s_;
+
+public:
+  explicit StrategyAdapter(S &s) noexcept : s_(s)
+  {
+  }
+
+  void on_market_data(const MarketDataEvent &e) override
+  {
+    s_.on_market_data(e);
+  }
+
+  void on_exec(const ExecEvent &e) override
+  {
+    s_.on_exec(e);
+  }
+
+  void on_timer(u64 ts_ns) override
+  {
+    s_.on_timer(ts_ns);
+  }
+
+  S &strategy() noexcept
+  {
+    return s_;
+  }
+};
 } // namespace hft
@@ -0,0 +1,107 @@
+#include "backtest/backtester.hpp"
+#include "risk/risk_manager.hpp"
+#include "strategy/mean_reversion.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+using namespace hft;
+
+namespace
+{
+// Same quoting as hft_app: leave a quote alone unless it is more than a tick off, and replace each
+// side at most every 5 ms.
+constexpr QuoteConfig kQuoting{/*requote_ticks*/ 1, /*min_requote_ns*/ 5'000'000};
+
+backtest::Result run_once(const backtest::Config &cfg, const QuoteConfig &quoting)
+{
+  // Same strategy setup as hft_app, on a fresh queue and risk state per run.
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  StrategyContext ctx;
+  ctx.user_id = 1;
+  ctx.next_order_id = 1;
+  ctx.tick = 1;
+  RiskManager risk(/*max_position*/ 100, /*max_notional*/ 1'000'000'000'000, /*max_order_qty*/ 10);
+  MeanReversion strat(ctx, risk, *cmd_q, /*window_len*/ 64, /*dev_ticks*/ 2.0, /*quote_qty*/ 2,
+                      {overflow::Policy::Drop}, quoting);
+  backtest::Backtester bt(cfg, strat, ctx.user_id, *cmd_q);
+  return bt.run();
+}
+} // namespace
+
+// Runs the sample strategy against the street simulator on a virtual clock: no threads, no sleeps.
+// With --runs N > 1 every run must produce the same digest (exit status 1 otherwise).
+// Usage: hft_backtest [--hours H] [--seed S] [--step-us U] [--timer-us U] [--latency-us U]
+//                     [--jitter-us U] [--flow steps|poisson|hawkes|agents] [--runs N]
+//                     [--requote-ticks N] [--requote-us U]
+int main(int argc, char **argv)
+{
+  backtest::Config cfg{};
+  QuoteConfig quoting = kQuoting;
+  int runs = 1;
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    const auto us = [&] { return std::strtoull(argv[++i], nullptr, 10) * 1'000; };
+    if (std::strcmp(argv[i], "--hours") == 0 && has_value)
+      cfg.duration_ns = static_cast<u64>(std::strtod(argv[++i], nullptr) * 3.6e12);
+    else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+      cfg.street.seed = cfg.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--step-us") == 0 && has_value)
+      cfg.street.step_interval_ns = us();
+    else if (std::strcmp(argv[i], "--timer-us") == 0 && has_value)
+      cfg.timer_ns = us();
+    else if (std::strcmp(argv[i], "--latency-us") == 0 && has_value)
+      cfg.latency.command_ns = cfg.latency.market_data_ns = cfg.latency.exec_ns = us();
+    else if (std::strcmp(argv[i], "--jitter-us") == 0 && has_value)
+      cfg.latency.jitter_ns = us();
+    else if (std::strcmp(argv[i], "--flow") == 0 && has_value)
+    {
+      if (!parse_flow_model(argv[++i], cfg.street))
+        return 2;
+    }
+    else if (std::strcmp(argv[i], "--runs") == 0 && has_value)
+      runs = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--requote-ticks") == 0 && has_value)
+      quoting.requote_ticks = std::strtoll(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--requote-us") == 0 && has_value)
+      quoting.min_requote_ns = us();
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--hours H] [--seed S] [--step-us U] [--timer-us U] "
+                   "[--latency-us U] [--jitter-us U] [--flow steps|poisson|hawkes|agents] "
+                   "[--runs N] [--requote-ticks N] [--requote-us U]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  u64 first = 0;
+  int status = 0;
+  for (int run = 0; run < (runs < 1 ? 1 : runs); ++run)
+  {
+    const backtest::Result r = run_once(cfg, quoting);
+    std::printf("run %d: %.2f h simulated in %.3f s: events=%llu steps=%llu timers=%llu "
+                "commands=%llu execs=%llu trades=%llu md=%llu digest=%016llx\n",
+                run, static_cast<double>(r.end_ns - cfg.start_ns) / 3.6e12,
+                static_cast<double>(r.wall_ns) / 1e9, static_cast<unsigned long long>(r.events),
+                static_cast<unsigned long long>(r.sim_steps),
+                static_cast<unsigned long long>(r.timers),
+                static_cast<unsigned long long>(r.commands),
+                static_cast<unsigned long long>(r.execs),
+                static_cast<unsigned long long>(r.trades),
+                static_cast<unsigned long long>(r.md_events),
+                static_cast<unsigned long long>(r.digest));
+    if (run == 0)
+      first = r.digest;
+    else if (r.digest != first)
+    {
+      std::printf("run %d diverged from run 0\n", run);
+      status = 1;
+    }
+  }
+  return status;
+}
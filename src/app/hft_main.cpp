@@ -1,28 +1,117 @@
+#include "common/broadcast_ring.hpp"
+#include "common/latency.hpp"
 #include "common/logging.hpp"
 #include "common/spsc_queue.hpp"
+#include "common/stats.hpp"
+#include "common/thread_placement.hpp"
+#include "common/wait_strategy.hpp"
 #include "gateway/gateway_sim.hpp"
 #include "market/market_data.hpp"
 #include "market/matching_engine.hpp"
 #include "risk/risk_manager.hpp"
 #include "strategy/mean_reversion.hpp"
+#include "strategy/reactor.hpp"
 
-#include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <thread>
 
 using namespace hft;
 
-int main()
+namespace
 {
-  // Queues: strategy -> engine, engine -> strategy (execs), engine -> strategy (market data)
-  // Each queue is a single-producer/single-consumer ring buffer defined in src/common.
-  spsc::Queue<EngineCommand, 1 << 14> cmd_q;
-  spsc::Queue<ExecEvent, 1 << 14> exec_q;
-  spsc::Queue<MarketDataEvent, 1 << 14> md_q;
+void log_wait_stats(const char *who, const wait::WaitStats &s)
+{
+  HFT_INFO("%s wait=%s spins=%llu yields=%llu parks=%llu", who, wait::to_string(s.policy),
+           static_cast<unsigned long long>(s.spins), static_cast<unsigned long long>(s.yields),
+           static_cast<unsigned long long>(s.parks));
+}
+} // namespace
+
+// The strategy runs on one reactor thread (placement role "md"), which takes its execs, market data
+// and timer in turn.
+// Usage: hft_app [--placement engine=2:fifo,md=3] [--binlog file] [--journal file]
+//                [--flow steps|poisson|hawkes|agents]
+int main(int argc, char **argv)
+{
+  PlacementConfig placement{};
+  StreetFlowConfig street{};
+  LogConfig log_cfg{};
+  const char *journal_path = nullptr;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--placement") == 0 && i + 1 < argc)
+    {
+      if (!parse_placement(argv[++i], placement))
+        return 2;
+    }
+    else if (std::strcmp(argv[i], "--binlog") == 0 && i + 1 < argc)
+    {
+      log_cfg.binary = true;
+      log_cfg.path = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--journal") == 0 && i + 1 < argc)
+      journal_path = argv[++i];
+    else if (std::strcmp(argv[i], "--flow") == 0 && i + 1 < argc)
+    {
+      if (!parse_flow_model(argv[++i], street))
+        return 2;
+    }
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--placement role=cpu[:fifo[:prio]],...] [--binlog file] "
+                   "[--journal file] [--flow steps|poisson|hawkes|agents]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+  // From here on HFT_* calls only enqueue binary records; a background thread writes them.
+  if (!Logger::instance().start(log_cfg))
+    return 1;
+  // Export counters for hft_stat before any thread starts updating them.
+  stats::publish();
+  // Report misconfiguration up front; we still run, just less predictably.
+  if (validate_placement(placement) > 0)
+    HFT_WARN("placement: continuing with a partially applied thread layout");
+
+  // Queues: strategy -> engine, engine -> strategy (execs), engine -> strategies (market data)
+  // Commands and execs are single-producer/single-consumer rings; market data is a broadcast ring
+  // so additional strategies can subscribe without extra copies on the engine thread.
+  // They live on the heap without being zeroed: large allocations come from fresh pages, so the
+  // pinned thread that prefaults a queue decides which NUMA node backs it.
+  auto cmd_mem = std::make_unique_for_overwrite<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_mem = std::make_unique_for_overwrite<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_mem = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  auto &cmd_q = *cmd_mem;
+  auto &exec_q = *exec_mem;
+  auto &md_q = *md_mem;
+
+  // Each thread picks its own latency/CPU trade-off. Spin-then-park keeps wake-up latency in the
+  // microseconds while still letting an idle machine sleep.
+  const wait::WaitConfig engine_wait{};
+  ReactorConfig reactor_cfg{};
+  reactor_cfg.timer_ns = 200'000; // how often on_timer() gets a chance to requote
+
+  // Per-hop latency histograms: the engine records queue wait, match and tick-to-trade, the
+  // reactor records the engine -> strategy queue wait.
+  auto tracer = std::make_unique<latency::Tracer>();
 
   // Start engine + simulator
-  EngineThread engine(cmd_q, exec_q, md_q, StreetFlowConfig{});
-  engine.start();
+  // Optional journal of every engine input and output, for reproducing this run with hft_replay.
+  auto journal = std::make_unique<Journal>();
+  if (journal_path != nullptr && !journal->open(journal_path))
+    return 1;
+
+  EngineThread engine(cmd_q, exec_q, md_q, street, engine_wait);
+  engine.set_tracer(tracer.get());
+  engine.set_journal(journal->active() ? journal.get() : nullptr);
+  // The strategy's quotes rest on the book, so it needs the passive side of each fill to see them
+  // traded. The journal records this, so hft_replay sets its engine up the same way.
+  engine.set_passive_fills(true);
+  // Subscribes to market data now, before the engine publishes its first snapshot.
+  Reactor<MeanReversion> reactor(exec_q, md_q, reactor_cfg);
 
   // Strategy components
   StrategyContext ctx;
@@ -30,48 +119,41 @@ int main()
   ctx.next_order_id = 1;
   ctx.tick = 1;
 
-  // Risk parameters are intentionally generous so the sample strategy spends more time trading
-  // and less time being throttled.
-  RiskManager risk(/*max_position*/ 100, /*max_notional*/ 1'000'000, /*max_order_qty*/ 10);
-  MeanReversion strat(ctx, risk, cmd_q, /*window_len*/ 64, /*dev_ticks*/ 2.0, /*quote_qty*/ 2);
+  // The strategy checks these limits before quoting; the engine's gate enforces them on every
+  // order it receives for this user. Notional is gross traded and only grows, so its cap is one a
+  // demo run cannot reach (a fill here is ~20k); position counts resting quotes and does bind, and
+  // a side the gate turns away backs off (QuoteConfig::risk_backoff_ns) instead of requoting.
+  const RiskLimits limits{
+      .max_order_qty = 10, .max_position = 100, .max_notional = 1'000'000'000'000};
+  RiskManager risk(limits.max_position, limits.max_notional, limits.max_order_qty);
+  engine.set_risk_limits(ctx.user_id, limits);
+  engine.start(placement[ThreadRole::Engine]);
 
-  std::atomic<bool> running{true};
+  // Quotes within a tick of the target stay put, and each side is replaced at most every 5 ms.
+  MeanReversion strat(ctx, risk, cmd_q, /*window_len*/ 64, /*dev_ticks*/ 2.0, /*quote_qty*/ 2,
+                      {overflow::Policy::Drop},
+                      QuoteConfig{/*requote_ticks*/ 1, /*min_requote_ns*/ 5'000'000});
 
-  // Thread to consume execs
-  std::thread exec_thread(
-      [&]
-      {
-        ExecEvent e;
-        while (running.load(std::memory_order_acquire))
-        {
-          while (exec_q.pop(e))
-            strat.on_exec(e); // feed fills/rejections into strategy state
-          std::this_thread::sleep_for(std::chrono::microseconds(50));
-        }
-      });
-
-  // Thread to consume market data and drive timer
-  std::thread md_thread(
-      [&]
-      {
-        MarketDataEvent ev;
-        while (running.load(std::memory_order_acquire))
-        {
-          while (md_q.pop(ev))
-            strat.on_market_data(ev); // update rolling statistics with latest book/prints
-          strat.on_timer(now_ns());   // periodic callback that decides when to quote
-          std::this_thread::sleep_for(std::chrono::microseconds(200));
-        }
-      });
+  // Execs, market data and timer all reach the strategy on this one thread, so the strategy and
+  // its risk state need no locking.
+  reactor.add(strat, ctx.user_id);
+  reactor.set_command_queue(cmd_q);
+  reactor.set_tracer(tracer.get());
+  reactor.start(placement[ThreadRole::MdConsumer]);
 
   // Run for a short demo interval
   std::this_thread::sleep_for(std::chrono::seconds(5));
-  running.store(false, std::memory_order_release);
-
-  exec_thread.join();
-  md_thread.join();
+  reactor.stop();
   engine.stop();
+  journal->close();
 
+  log_wait_stats("engine", engine.wait_stats());
+  log_wait_stats("strategy", reactor.wait_stats());
+  tracer->dump();
+  if (reactor.market_data().overrun())
+    HFT_WARN("Market data consumer overrun: %llu events dropped",
+             static_cast<unsigned long long>(reactor.market_data().dropped()));
   HFT_INFO("Done."); // final log to confirm clean shutdown
+  Logger::instance().stop();
   return 0;
 }
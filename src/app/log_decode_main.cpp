@@ -0,0 +1,30 @@
+#include "common/log_format.hpp"
+
+#include <cstdio>
+
+using namespace hft;
+
+// Offline decoder for binary logs written by Logger in binary mode (e.g. `hft_app --binlog f`).
+// Prints one text line per record to stdout, in the same shape as the text logger.
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::fprintf(stderr, "usage: %s <binary-log-file>\n", argv[0]);
+    return 2;
+  }
+  std::FILE *in = std::fopen(argv[1], "rb");
+  if (in == nullptr)
+  {
+    std::fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+  const long records = decode_log_file(in, stdout);
+  std::fclose(in);
+  if (records < 0)
+  {
+    std::fprintf(stderr, "%s is not a binary hft log\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
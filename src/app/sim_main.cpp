@@ -1,27 +1,134 @@
+#include "common/broadcast_ring.hpp"
+#include "common/latency.hpp"
 #include "common/logging.hpp"
 #include "common/spsc_queue.hpp"
+#include "common/stats.hpp"
+#include "common/thread_placement.hpp"
 #include "gateway/gateway_sim.hpp"
+#include "gateway/load_gen.hpp"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <thread>
 
 using namespace hft;
 
+namespace
+{
+// "ramp", "max" (back to back) or a comma separated list of commands per second.
+bool parse_load(const char *s, loadgen::Config &cfg)
+{
+  cfg.rates.clear();
+  if (std::strcmp(s, "ramp") == 0)
+    return true;
+  if (std::strcmp(s, "max") == 0)
+  {
+    cfg.rates.push_back(0);
+    return true;
+  }
+  while (*s != '\0')
+  {
+    char *end = nullptr;
+    const double r = std::strtod(s, &end);
+    if (end == s || r <= 0)
+      return false;
+    cfg.rates.push_back(r);
+    s = *end == ',' ? end + 1 : end;
+  }
+  return !cfg.rates.empty();
+}
+} // namespace
+
 // This executable runs only the engine + simulator without any strategy.
 // Handy for profiling the matching engine and simulator in isolation or for unit tests.
-int main()
+// With --load it becomes an open-loop load generator (gateway/load_gen.hpp): producer threads
+// push pre-generated commands at the offered rates and it prints throughput and latency per rate.
+// Usage: sim_app [--placement engine=2[:fifo]] [--journal file]
+//                [--load ramp|max|R1,R2,...] [--producers N] [--step-ms M]
+int main(int argc, char **argv)
 {
+  PlacementConfig placement{};
+  const char *journal_path = nullptr;
+  loadgen::Config load{};
+  bool load_mode = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--placement") == 0 && has_value)
+    {
+      if (!parse_placement(argv[++i], placement))
+        return 2;
+    }
+    else if (std::strcmp(argv[i], "--journal") == 0 && has_value)
+      journal_path = argv[++i];
+    else if (std::strcmp(argv[i], "--load") == 0 && has_value)
+    {
+      if (!parse_load(argv[++i], load))
+        return 2;
+      load_mode = true;
+    }
+    else if (std::strcmp(argv[i], "--producers") == 0 && has_value)
+      load.producers = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (std::strcmp(argv[i], "--step-ms") == 0 && has_value)
+      load.step_ns = std::strtoull(argv[++i], nullptr, 10) * 1'000'000;
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--placement engine=cpu[:fifo[:prio]]] [--journal file] "
+                   "[--load ramp|max|R1,R2,...] [--producers N] [--step-ms M]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+  Logger::instance().start();
+  stats::publish(); // engine.* counters, view with hft_stat <pid>
+  validate_placement(placement);
+
   spsc::Queue<EngineCommand, 1 << 14> cmd_q;
   spsc::Queue<ExecEvent, 1 << 14> exec_q;
-  spsc::Queue<MarketDataEvent, 1 << 14> md_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q; // no subscribers, so nothing gates the engine
 
+  // Only the match hop applies here: simulator orders never cross a queue.
+  auto tracer = std::make_unique<latency::Tracer>();
+  Journal journal;
+  if (journal_path != nullptr && !journal.open(journal_path))
+    return 1;
   EngineThread engine(cmd_q, exec_q, md_q, StreetFlowConfig{});
-  engine.start();
+  engine.set_tracer(tracer.get());
+  engine.set_journal(journal.active() ? &journal : nullptr);
+  loadgen::Driver driver(load);
+  if (load_mode && !driver.attach(engine))
+    return 2;
+  engine.start(placement[ThreadRole::Engine]);
+
+  if (load_mode)
+  {
+    driver.run(engine, exec_q, stdout);
+    engine.stop();
+    journal.close();
+    tracer->dump();
+    Logger::instance().stop();
+    return 0;
+  }
 
-  // Let the simulator churn for a few seconds.
-  std::this_thread::sleep_for(std::chrono::seconds(3));
+  // Let the simulator churn for a few seconds. Nothing trades on the execs, but the queue is still
+  // drained: the engine spills execs it cannot publish and stops taking input once it saturates.
+  const u64 end = now_ns() + 3'000'000'000ULL;
+  u64 execs = 0;
+  ExecEvent e;
+  while (now_ns() < end)
+  {
+    while (exec_q.pop(e))
+      ++execs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
 
   engine.stop();
-  HFT_INFO("Simulator finished.");
+  journal.close();
+  tracer->dump();
+  HFT_INFO("Simulator finished: %llu execs.", static_cast<unsigned long long>(execs));
+  Logger::instance().stop();
   return 0;
 }
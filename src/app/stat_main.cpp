@@ -0,0 +1,118 @@
+#include "common/stats.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <signal.h>
+
+using namespace hft;
+
+// Live viewer for the stats page a running hft_app/sim_app exports (see common/stats.hpp).
+// Maps the page read-only and samples it once per interval, so the observed process never sees
+// a write, a lock or a syscall from us.
+// Usage: hft_stat <pid | /shm-name> [--interval ms] [--count n]
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: %s <pid|/shm-name> [--interval ms] [--count n]\n", argv[0]);
+    return 2;
+  }
+  char name[64];
+  if (argv[1][0] == '/')
+    std::snprintf(name, sizeof(name), "%s", argv[1]);
+  else
+    std::snprintf(name, sizeof(name), "/hft_stats.%s", argv[1]);
+  long interval_ms = 1000;
+  long count = -1; // forever
+  for (int i = 2; i + 1 < argc; i += 2)
+  {
+    if (std::strcmp(argv[i], "--interval") == 0)
+      interval_ms = std::strtol(argv[i + 1], nullptr, 10);
+    else if (std::strcmp(argv[i], "--count") == 0)
+      count = std::strtol(argv[i + 1], nullptr, 10);
+  }
+  if (interval_ms <= 0)
+    interval_ms = 1000;
+
+#if defined(HFT_HAVE_SHM_STATS)
+  const int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0)
+  {
+    std::fprintf(stderr, "cannot open %s (is the process running with stats exported?)\n", name);
+    return 1;
+  }
+  void *mem = mmap(nullptr, sizeof(stats::Page), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED)
+  {
+    std::fprintf(stderr, "cannot map %s\n", name);
+    return 1;
+  }
+  const auto &page = *static_cast<const stats::Page *>(mem);
+  if (std::memcmp(page.header.magic, stats::kMagic, sizeof(stats::kMagic)) != 0 ||
+      page.header.version != stats::kVersion)
+  {
+    std::fprintf(stderr, "%s is not an hft stats page (or a different version)\n", name);
+    return 1;
+  }
+  const pid_t pid = static_cast<pid_t>(page.header.pid);
+  const bool tty = isatty(STDOUT_FILENO) != 0;
+
+  u64 prev[stats::kMaxStats] = {};
+  auto prev_t = std::chrono::steady_clock::now();
+  for (long iter = 0; count < 0 || iter <= count; ++iter)
+  {
+    const auto t = std::chrono::steady_clock::now();
+    const double secs = std::chrono::duration<double>(t - prev_t).count();
+    prev_t = t;
+    const u32 n = page.header.count.load(std::memory_order_acquire);
+
+    // The first pass only primes the deltas.
+    if (iter > 0)
+    {
+      if (tty)
+        std::fputs("\x1b[H\x1b[2J", stdout);
+      std::printf("%s  pid %d  %u stats  every %ldms\n\n", name, static_cast<int>(pid), n,
+                  interval_ms);
+      std::printf("%-40s %16s %14s %14s\n", "name", "value", "delta", "rate/s");
+      for (u32 i = 0; i < n; ++i)
+      {
+        const stats::Entry &e = page.entries[i];
+        const u64 v = e.value.load(std::memory_order_relaxed);
+        if (e.kind == stats::Kind::Gauge)
+        {
+          std::printf("%-40.*s %16llu %14s %14s\n", static_cast<int>(stats::kNameLen), e.name,
+                      static_cast<unsigned long long>(v), "-", "-");
+        }
+        else
+        {
+          const u64 d = v - prev[i];
+          std::printf("%-40.*s %16llu %14llu %14.0f\n", static_cast<int>(stats::kNameLen), e.name,
+                      static_cast<unsigned long long>(v), static_cast<unsigned long long>(d),
+                      secs > 0 ? static_cast<double>(d) / secs : 0.0);
+        }
+      }
+      std::fflush(stdout);
+    }
+    for (u32 i = 0; i < n; ++i)
+      prev[i] = page.entries[i].value.load(std::memory_order_relaxed);
+
+    if (kill(pid, 0) != 0)
+    {
+      std::printf("process %d exited\n", static_cast<int>(pid));
+      break;
+    }
+    if (count < 0 || iter < count)
+      std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+  }
+  munmap(mem, sizeof(stats::Page));
+  return 0;
+#else
+  std::fprintf(stderr, "%s: shared-memory stats need a POSIX platform\n", name);
+  return 1;
+#endif
+}
@@ -0,0 +1,113 @@
+#include "backtest/sweep.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace hft;
+
+namespace
+{
+// "32,64,128" -> {32, 64, 128}; anything unparsable ends the list.
+template <typename T, typename Parse> std::vector<T> list(const char *s, Parse parse)
+{
+  std::vector<T> out;
+  while (*s != '\0')
+  {
+    char *end = nullptr;
+    const auto v = parse(s, &end);
+    if (end == s)
+      break;
+    out.push_back(static_cast<T>(v));
+    s = *end == ',' ? end + 1 : end;
+  }
+  return out;
+}
+
+std::vector<u64> u64_list(const char *s)
+{
+  return list<u64>(s, [](const char *p, char **e) { return std::strtoull(p, e, 10); });
+}
+
+std::vector<double> double_list(const char *s)
+{
+  return list<double>(s, [](const char *p, char **e) { return std::strtod(p, e); });
+}
+} // namespace
+
+// Backtests every combination of the given MeanReversion and street flow values on all cores and
+// prints one row per combination. Lists are comma separated; unset dimensions keep their defaults.
+// Usage: hft_sweep [--window L] [--dev L] [--qty L] [--requote-ticks L] [--requote-us L]
+//                  [--move L] [--spread L] [--seed L] [--hours H] [--threads N]
+int main(int argc, char **argv)
+{
+  backtest::Config cfg{};
+  cfg.duration_ns = 60'000'000'000; // a minute per combination unless told otherwise
+  backtest::Grid grid{};
+  unsigned threads = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    const char *opt = argv[i];
+    if (!has_value)
+      opt = "";
+    if (std::strcmp(opt, "--window") == 0)
+    {
+      grid.window_len.clear();
+      for (u64 v : u64_list(argv[++i]))
+        grid.window_len.push_back(static_cast<std::size_t>(v));
+    }
+    else if (std::strcmp(opt, "--dev") == 0)
+      grid.dev_ticks = double_list(argv[++i]);
+    else if (std::strcmp(opt, "--qty") == 0)
+    {
+      grid.quote_qty.clear();
+      for (u64 v : u64_list(argv[++i]))
+        grid.quote_qty.push_back(static_cast<Qty>(v));
+    }
+    else if (std::strcmp(opt, "--requote-ticks") == 0)
+    {
+      grid.requote_ticks.clear();
+      for (u64 v : u64_list(argv[++i]))
+        grid.requote_ticks.push_back(static_cast<Price>(v));
+    }
+    else if (std::strcmp(opt, "--requote-us") == 0)
+    {
+      grid.min_requote_ns.clear();
+      for (u64 v : u64_list(argv[++i]))
+        grid.min_requote_ns.push_back(v * 1'000);
+    }
+    else if (std::strcmp(opt, "--move") == 0)
+      grid.move_prob = double_list(argv[++i]);
+    else if (std::strcmp(opt, "--spread") == 0)
+      grid.spread_prob = double_list(argv[++i]);
+    else if (std::strcmp(opt, "--seed") == 0)
+      grid.seed = u64_list(argv[++i]);
+    else if (std::strcmp(opt, "--hours") == 0)
+      cfg.duration_ns = static_cast<u64>(std::strtod(argv[++i], nullptr) * 3.6e12);
+    else if (std::strcmp(opt, "--threads") == 0)
+      threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--window L] [--dev L] [--qty L] [--requote-ticks L] "
+                   "[--requote-us L] [--move L] [--spread L] [--seed L] [--hours H] "
+                   "[--threads N]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  const std::size_t combos = backtest::expand(grid).size();
+  if (combos == 0)
+  {
+    std::fprintf(stderr, "empty grid\n");
+    return 2;
+  }
+  std::printf("sweeping %zu combinations of %.3f h each\n", combos,
+              static_cast<double>(cfg.duration_ns) / 3.6e12);
+  const backtest::SweepSummary summary = backtest::sweep(cfg, grid, threads);
+  backtest::print_table(stdout, summary);
+  return 0;
+}
@@ -1,7 +1,9 @@
 #include "common/logging.hpp"
+#include "common/wait_strategy.hpp"
 #include "gateway/gateway_sim.hpp"
 #include "risk/risk_manager.hpp"
 #include "strategy/mean_reversion.hpp"
+#include "strategy/reactor.hpp"
 
 #include <cassert>
 #include <cstdio>
@@ -15,10 +17,10 @@ int main()
 {
   spsc::Queue<EngineCommand, 1 << 14> cmd_q;
   spsc::Queue<ExecEvent, 1 << 14> exec_q;
-  spsc::Queue<MarketDataEvent, 1 << 14> md_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
 
   EngineThread engine(cmd_q, exec_q, md_q, StreetFlowConfig{});
-  engine.start();
+  engine.set_passive_fills(true); // the strategy's quotes trade passively
 
   StrategyContext ctx;
   ctx.user_id = 42;
@@ -28,50 +30,43 @@ int main()
   RiskManager risk(200, 5'000'000, 50);
   MeanReversion strat(ctx, risk, cmd_q, 64, 2.0, 5);
 
-  std::atomic<bool> running{true};
-  std::atomic<int> trade_count{0};
+  // Counts the strategy's own trades on the way in.
+  struct Counted
+  {
+    MeanReversion &strat;
+    int trades{0};
 
-  // Exec consumer counts trades
-  std::thread exec_thread(
-      [&]
-      {
-        ExecEvent e;
-        while (running.load(std::memory_order_acquire))
-        {
-          while (exec_q.pop(e))
-          {
-            strat.on_exec(e);
-            if (e.type == ExecType::Trade)
-              trade_count.fetch_add(1);
-          }
-          std::this_thread::sleep_for(std::chrono::microseconds(50));
-        }
-      });
+    void on_market_data(const MarketDataEvent &e)
+    {
+      strat.on_market_data(e);
+    }
 
-  // Market data consumer
-  std::thread md_thread(
-      [&]
-      {
-        MarketDataEvent ev;
-        while (running.load(std::memory_order_acquire))
-        {
-          while (md_q.pop(ev))
-            strat.on_market_data(ev);
-          strat.on_timer(now_ns());
-          std::this_thread::sleep_for(std::chrono::microseconds(200));
-        }
-      });
+    void on_exec(const ExecEvent &e)
+    {
+      strat.on_exec(e);
+      if (e.type == ExecType::Trade)
+        ++trades;
+    }
+
+    void on_timer(u64 ts_ns)
+    {
+      strat.on_timer(ts_ns);
+    }
+  } counted{strat};
+
+  // Execs, market data and the 200us timer all reach the strategy on the reactor's one thread.
+  Reactor<Counted> reactor(exec_q, md_q);
+  reactor.add(counted, ctx.user_id);
+  engine.start(); // after the reactor subscribed, so it sees the seeded top
+  reactor.start();
 
   // Run scenario
   std::this_thread::sleep_for(std::chrono::seconds(4));
-  running.store(false);
-
-  exec_thread.join();
-  md_thread.join();
+  reactor.stop();
   engine.stop();
 
   // Assertions
-  assert(trade_count.load() > 0 && "Strategy should trade at least once");
-  HFT_INFO("Functional test passed with %d trades.", trade_count.load());
+  assert(counted.trades > 0 && "Strategy should trade at least once");
+  HFT_INFO("Functional test passed with %d trades.", counted.trades);
   return 0;
 }
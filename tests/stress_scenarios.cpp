@@ -0,0 +1,382 @@
+#include "common/latency.hpp"
+#include "common/logging.hpp"
+#include "common/stats.hpp"
+#include "common/wait_strategy.hpp"
+#include "gateway/gateway_sim.hpp"
+#include "gateway/load_gen.hpp"
+#include "market/order_flow.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hft;
+
+// Stress scenarios: drive EngineThread (with its simulator running) at a fixed message rate or in
+// bursts, and fail when the round-trip latency budget is blown or anything is dropped. Meant for a
+// nightly performance gate on pinned hardware; exit status is the number of failed scenarios.
+// Usage: stress_scenarios [--only name] [--seed S] [--budget-scale F] [--list]
+//
+// Round trip = strategy push (EngineCommand::lat.origin_ns) -> first exec of that command popped
+// by the consumer, so it covers queueing, matching and the exec queue. Burst budgets include the
+// time a command waits behind the rest of its burst.
+//
+// The open-loop checks run gateway/load_gen.hpp at a fixed offered rate and fail when the engine
+// does not keep up: achieved throughput outside [min_achieved, 1.1] of offered, or a saturated or
+// unanswered step.
+namespace
+{
+enum class OnFull : u8
+{
+  Drop, // a failed push is a drop and fails the scenario
+  Wait  // spin until there is room; counted as a stall (bursts larger than the queue)
+};
+
+struct Scenario
+{
+  const char *name;
+  u64 rate_per_sec; // 0: burst mode
+  u64 duration_ms;  // rate mode
+  u64 burst_size;   // burst mode
+  u64 bursts;
+  u64 burst_gap_ms;
+  OnFull on_full;
+  u64 p99_budget_ns;
+  u64 max_budget_ns;
+};
+
+// clang-format off
+constexpr Scenario kScenarios[] = {
+    // name         rate/s    ms    burst   n  gap  on full              p99          max
+    {"rate_10k",     10'000, 2'000,       0,  0,   0, OnFull::Drop,     50'000,   1'000'000},
+    {"rate_100k",   100'000, 2'000,       0,  0,   0, OnFull::Drop,    100'000,   2'000'000},
+    {"burst_1k",          0,     0,   1'000, 20,  50, OnFull::Drop,    500'000,   2'000'000},
+    {"burst_10k",         0,     0,  10'000,  5, 100, OnFull::Drop,  5'000'000,  10'000'000},
+    {"burst_100k",        0,     0, 100'000,  2, 200, OnFull::Wait, 50'000'000, 100'000'000},
+};
+// clang-format on
+
+struct LoadCheck
+{
+  const char *name;
+  unsigned producers;
+  double rate_per_sec;
+  u64 step_ms;
+  double min_achieved; // share of the offered rate
+};
+
+// clang-format off
+constexpr LoadCheck kLoadChecks[] = {
+    // name             producers  rate/s     ms   achieved
+    {"open_loop_20k",    2,         20'000,    500, 0.8},
+    {"open_loop_100k",   1,        100'000,    500, 0.8},
+};
+// clang-format on
+
+struct Options
+{
+  const char *only{nullptr};
+  u64 seed{1};
+  double budget_scale{1.0}; // multiply every budget, e.g. for shared CI machines
+};
+
+struct Outcome
+{
+  u64 sent{0};
+  u64 dropped{0};      // producer pushes refused by a full command queue
+  u64 stalls{0};       // OnFull::Wait pushes that had to spin for room
+  u64 exec_spilled{0}; // execs the engine had to spill because the exec queue was full
+  u64 throttled{0};    // engine loops that skipped command intake while execs were backed up
+  u64 md_dropped{0};   // market data events the consumer was lapped on
+  u64 completed{0};    // commands whose first exec reached the consumer
+  u64 cmd_hwm{0};      // command queue high-water mark, seen by the producer
+  u64 exec_hwm{0};     // exec queue high-water mark, seen by the consumer
+};
+
+template <typename Op> void spin_until(Op done)
+{
+  for (int polls = 0; !done(); ++polls)
+  {
+    if (polls < 256)
+      wait::cpu_relax();
+    else
+      std::this_thread::yield();
+  }
+}
+
+void wait_until_ns(u64 deadline)
+{
+  spin_until([&] { return now_ns() >= deadline; });
+}
+
+// Each command yields a contiguous run of execs (the engine finishes one command before the next),
+// so a change of key marks the first exec of the next command. New orders answer with Trade/Ack,
+// cancels with CancelAck/Reject, so the same id can appear for both without being merged.
+u64 command_key(const ExecEvent &e) noexcept
+{
+  const bool cancel_reply = e.type == ExecType::CancelAck || e.type == ExecType::Reject;
+  return e.order_id * 2 + (cancel_reply ? 1 : 0);
+}
+
+bool run_scenario(const Scenario &sc, const Options &opts)
+{
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  auto md_sub = md_q->subscribe();
+  auto tracer = std::make_unique<latency::Tracer>();
+  auto round_trip = std::make_unique<latency::Histogram>();
+
+  // Generate the whole run up front so the producer only stamps and pushes.
+  const u64 total = sc.rate_per_sec > 0 ? sc.rate_per_sec * sc.duration_ms / 1'000
+                                        : sc.burst_size * sc.bursts;
+  OrderFlowConfig flow{};
+  flow.seed = opts.seed;
+  flow.user_id = 42;
+  flow.first_order_id = 1'000'000; // clear of the simulator's ids
+  std::vector<EngineCommand> cmds;
+  OrderFlowGenerator(flow).generate(total, cmds);
+
+  const stats::Counter exec_spilled = stats::counter("engine.exec.spilled");
+  const stats::Counter throttled = stats::counter("engine.intake_throttled");
+  const u64 exec_spilled_before = exec_spilled.value();
+  const u64 throttled_before = throttled.value();
+
+  EngineThread engine(*cmd_q, *exec_q, *md_q, StreetFlowConfig{});
+  engine.set_tracer(tracer.get());
+  engine.start();
+
+  Outcome out;
+  std::atomic<bool> running{true};
+  std::atomic<u64> completed{0};
+  std::thread consumer(
+      [&]
+      {
+        ExecEvent e;
+        MarketDataEvent ev;
+        u64 last_key = 0;
+        u64 exec_hwm = 0;
+        while (running.load(std::memory_order_acquire))
+        {
+          bool busy = false;
+          const u64 depth = exec_q->size();
+          exec_hwm = depth > exec_hwm ? depth : exec_hwm;
+          while (exec_q->pop(e))
+          {
+            busy = true;
+            if (e.user_id != flow.user_id || e.lat.origin_ns == 0)
+              continue; // simulator flow
+            const u64 key = command_key(e);
+            if (key == last_key)
+              continue;
+            last_key = key;
+            const u64 now = now_ns();
+            round_trip->record(now > e.lat.origin_ns ? now - e.lat.origin_ns : 0);
+            completed.fetch_add(1, std::memory_order_release);
+          }
+          while (md_sub.pop(ev))
+            busy = true;
+          if (!busy)
+            std::this_thread::yield();
+        }
+        out.exec_hwm = exec_hwm;
+      });
+
+  // Let the engine seed its book before the clock starts.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  auto push = [&](EngineCommand &cmd)
+  {
+    cmd.lat.origin_ns = now_ns();
+    if (!cmd_q->push(cmd))
+    {
+      if (sc.on_full == OnFull::Drop)
+      {
+        ++out.dropped;
+        return;
+      }
+      ++out.stalls;
+      cmd_q->notify();
+      spin_until([&] { return cmd_q->push(cmd); });
+    }
+    ++out.sent;
+    const u64 depth = cmd_q->size();
+    out.cmd_hwm = depth > out.cmd_hwm ? depth : out.cmd_hwm;
+  };
+
+  // Every accepted command answers with at least one exec; give stragglers a second.
+  auto wait_for_completion = [&](u64 expected)
+  {
+    const u64 give_up = now_ns() + 1'000'000'000;
+    spin_until([&]
+               {
+                 return completed.load(std::memory_order_acquire) >= expected ||
+                        now_ns() > give_up;
+               });
+  };
+
+  const u64 t0 = now_ns();
+  if (sc.rate_per_sec > 0)
+  {
+    const u64 interval = 1'000'000'000 / sc.rate_per_sec;
+    for (u64 i = 0; i < total; ++i)
+    {
+      wait_until_ns(t0 + i * interval);
+      push(cmds[i]);
+      cmd_q->notify();
+    }
+  }
+  else
+  {
+    for (u64 b = 0; b < sc.bursts; ++b)
+    {
+      for (u64 i = 0; i < sc.burst_size; ++i)
+        push(cmds[b * sc.burst_size + i]);
+      cmd_q->notify();
+      wait_for_completion(out.sent);
+      std::this_thread::sleep_for(std::chrono::milliseconds(sc.burst_gap_ms));
+    }
+  }
+  const u64 elapsed = now_ns() - t0;
+
+  wait_for_completion(out.sent);
+  running.store(false, std::memory_order_release);
+  consumer.join();
+  engine.stop();
+
+  out.completed = completed.load(std::memory_order_acquire);
+  out.exec_spilled = exec_spilled.value() - exec_spilled_before;
+  out.throttled = throttled.value() - throttled_before;
+  out.md_dropped = md_sub.dropped();
+
+  const auto budget = [&](u64 ns)
+  { return static_cast<u64>(static_cast<double>(ns) * opts.budget_scale); };
+  const u64 p99 = round_trip->percentile(0.99);
+  const u64 max = round_trip->max();
+  std::string failures;
+  if (p99 > budget(sc.p99_budget_ns))
+    failures += " p99";
+  if (max > budget(sc.max_budget_ns))
+    failures += " max";
+  if (out.dropped > 0 || out.md_dropped > 0)
+    failures += " drops";
+  if (out.completed < out.sent)
+    failures += " lost";
+
+  const latency::Histogram &match = tracer->histogram(latency::Hop::Match);
+  HFT_INFO("%-11s sent=%llu in %.1fms drops=%llu stalls=%llu md_dropped=%llu "
+           "completed=%llu cmd_hwm=%llu exec_hwm=%llu exec_spilled=%llu throttled=%llu",
+           sc.name, static_cast<unsigned long long>(out.sent), static_cast<double>(elapsed) / 1e6,
+           static_cast<unsigned long long>(out.dropped),
+           static_cast<unsigned long long>(out.stalls),
+           static_cast<unsigned long long>(out.md_dropped),
+           static_cast<unsigned long long>(out.completed),
+           static_cast<unsigned long long>(out.cmd_hwm),
+           static_cast<unsigned long long>(out.exec_hwm),
+           static_cast<unsigned long long>(out.exec_spilled),
+           static_cast<unsigned long long>(out.throttled));
+  HFT_INFO("%-11s round trip p50=%lluns p99=%lluns (budget %llu) max=%lluns (budget %llu); "
+           "match p99=%lluns -> %s%s",
+           sc.name, static_cast<unsigned long long>(round_trip->percentile(0.50)),
+           static_cast<unsigned long long>(p99),
+           static_cast<unsigned long long>(budget(sc.p99_budget_ns)),
+           static_cast<unsigned long long>(max),
+           static_cast<unsigned long long>(budget(sc.max_budget_ns)),
+           static_cast<unsigned long long>(match.percentile(0.99)),
+           failures.empty() ? "PASS" : "FAIL:", failures.c_str());
+  return failures.empty();
+}
+bool run_load_check(const LoadCheck &lc, const Options &opts)
+{
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  EngineThread engine(*cmd_q, *exec_q, *md_q, StreetFlowConfig{});
+
+  loadgen::Config cfg{};
+  cfg.producers = lc.producers;
+  cfg.step_ns = lc.step_ms * 1'000'000;
+  cfg.rates = {lc.rate_per_sec};
+  cfg.flow.seed = opts.seed;
+  loadgen::Driver driver(cfg);
+  if (!driver.attach(engine))
+    return false;
+  engine.start();
+  const std::vector<loadgen::Point> curve = driver.run(engine, *exec_q);
+  engine.stop();
+
+  const loadgen::Point &p = curve.front();
+  std::string failures;
+  if (p.achieved < lc.min_achieved * p.offered || p.achieved > 1.1 * p.offered)
+    failures += " throughput";
+  if (p.saturated)
+    failures += " saturated";
+  if (p.answered < p.sent)
+    failures += " lost";
+  HFT_INFO("%-15s offered=%.0f/s achieved=%.0f/s sent=%llu answered=%llu p99=%lluns -> %s%s",
+           lc.name, p.offered, p.achieved, static_cast<unsigned long long>(p.sent),
+           static_cast<unsigned long long>(p.answered), static_cast<unsigned long long>(p.p99_ns),
+           failures.empty() ? "PASS" : "FAIL:", failures.c_str());
+  return failures.empty();
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options opts{};
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--only") == 0 && has_value)
+      opts.only = argv[++i];
+    else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+      opts.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--budget-scale") == 0 && has_value)
+      opts.budget_scale = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "--list") == 0)
+    {
+      for (const Scenario &sc : kScenarios)
+        std::printf("%s\n", sc.name);
+      for (const LoadCheck &lc : kLoadChecks)
+        std::printf("%s\n", lc.name);
+      return 0;
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--only name] [--seed S] [--budget-scale F] [--list]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  int failed = 0;
+  int ran = 0;
+  for (const Scenario &sc : kScenarios)
+  {
+    if (opts.only != nullptr && std::strcmp(opts.only, sc.name) != 0)
+      continue;
+    ++ran;
+    if (!run_scenario(sc, opts))
+      ++failed;
+  }
+  for (const LoadCheck &lc : kLoadChecks)
+  {
+    if (opts.only != nullptr && std::strcmp(opts.only, lc.name) != 0)
+      continue;
+    ++ran;
+    if (!run_load_check(lc, opts))
+      ++failed;
+  }
+  if (ran == 0)
+  {
+    std::fprintf(stderr, "no scenario named %s (see --list)\n", opts.only);
+    return 2;
+  }
+  HFT_INFO("Stress scenarios: %d run, %d failed.", ran, failed);
+  return failed;
+}
@@ -0,0 +1,210 @@
+#include "market/agents.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+struct FakeEngine
+{
+  TopOfBook top{};
+  std::vector<NewOrder> seen;
+  std::vector<CancelOrder> cancels;
+
+  TopOfBook top_snapshot() const
+  {
+    return top;
+  }
+
+  void inject_new(const NewOrder &n)
+  {
+    seen.push_back(n);
+  }
+
+  void inject_cancel(const CancelOrder &c)
+  {
+    cancels.push_back(c);
+  }
+};
+
+AgentsConfig only(AgentKind kind, u32 n)
+{
+  AgentsConfig cfg{};
+  cfg.noise = kind == AgentKind::Noise ? n : 0;
+  cfg.providers = kind == AgentKind::Provider ? n : 0;
+  cfg.momentum = kind == AgentKind::Momentum ? n : 0;
+  cfg.twap = kind == AgentKind::Twap ? n : 0;
+  return cfg;
+}
+
+TEST(AgentsTest, NoiseTradersActAtTheirRateWithPowerLawSizes)
+{
+  AgentsConfig cfg = only(AgentKind::Noise, 100);
+  AgentPopulation pop(cfg, 100, 1, 7);
+  FakeEngine engine;
+  engine.top.bid_price = 99;
+  engine.top.ask_price = 101;
+  std::vector<NewOrder> placed;
+  u64 next_id = 1;
+  pop.start(0);
+  pop.run(engine, 10'000'000'000, next_id, [&](const NewOrder &n) { placed.push_back(n); });
+
+  // 100 traders at 4 actions a second for 10 s.
+  EXPECT_NEAR(static_cast<double>(pop.actions()), 4'000.0, 300.0);
+  EXPECT_EQ(engine.seen.size() + placed.size(), pop.actions());
+  EXPECT_NEAR(static_cast<double>(engine.seen.size()) / static_cast<double>(pop.actions()),
+              cfg.noise_market_prob, 0.05);
+  EXPECT_GT(pop.next_ns(), 10'000'000'000U);
+
+  std::set<u64> users;
+  std::map<Qty, u64> sizes;
+  for (const NewOrder &n : engine.seen) // marketable: at the opposite best
+  {
+    EXPECT_EQ(n.tif, TIF::IOC);
+    EXPECT_EQ(n.price, n.side == Side::Buy ? 101 : 99);
+    users.insert(n.user_id);
+    ++sizes[n.qty];
+  }
+  for (const NewOrder &n : placed) // passive: at most one tick inside the opposite best
+  {
+    EXPECT_EQ(n.tif, TIF::Day);
+    EXPECT_TRUE(n.side == Side::Buy ? n.price <= 100 : n.price >= 100);
+    users.insert(n.user_id);
+    ++sizes[n.qty];
+  }
+  EXPECT_EQ(users.size(), 100U);
+  EXPECT_GE(*users.begin(), cfg.first_user);
+  EXPECT_LT(*users.rbegin(), cfg.first_user + 100);
+  // P(q) ~ q^-2: one lot about four times as common as two, nothing above max_size.
+  EXPECT_NEAR(static_cast<double>(sizes[1]) / static_cast<double>(sizes[2]), 4.0, 0.8);
+  EXPECT_LE(sizes.rbegin()->first, cfg.max_size);
+}
+
+TEST(AgentsTest, ProvidersRequoteOnlyWhenTheMidMoves)
+{
+  AgentsConfig cfg = only(AgentKind::Provider, 3);
+  AgentPopulation pop(cfg, 100, 1, 7);
+  FakeEngine engine;
+  engine.top.bid_price = 99;
+  engine.top.ask_price = 101;
+  u64 next_id = 1;
+  const auto no_place = [](const NewOrder &) {};
+  pop.start(0);
+  pop.run(engine, 0, next_id, no_place); // everyone quotes at once
+  ASSERT_EQ(engine.seen.size(), 6U);
+  for (std::size_t i = 0; i < 6; ++i)
+  {
+    const NewOrder &n = engine.seen[i];
+    const Price off = 1 + static_cast<Price>(i / 2); // provider i: 1 + i ticks from the mid
+    EXPECT_EQ(n.price, n.side == Side::Buy ? 100 - off : 100 + off);
+    EXPECT_EQ(n.user_id, cfg.first_user + i / 2);
+    EXPECT_EQ(n.qty, cfg.provider_qty);
+  }
+
+  pop.run(engine, 100'000'000, next_id, no_place); // many looks, same mid
+  EXPECT_EQ(engine.seen.size(), 6U);
+  EXPECT_TRUE(engine.cancels.empty());
+
+  engine.top.bid_price = 103;
+  engine.top.ask_price = 105;
+  pop.run(engine, 200'000'000, next_id, no_place);
+  ASSERT_EQ(engine.seen.size(), 12U);
+  ASSERT_EQ(engine.cancels.size(), 6U);
+  for (std::size_t i = 6; i < 12; ++i)
+  {
+    const NewOrder &n = engine.seen[i];
+    EXPECT_TRUE(n.side == Side::Buy ? n.price < 104 : n.price > 104);
+  }
+}
+
+TEST(AgentsTest, MomentumTakesInTheDirectionOfTheMove)
+{
+  AgentsConfig cfg = only(AgentKind::Momentum, 1);
+  AgentPopulation pop(cfg, 100, 1, 7);
+  FakeEngine engine;
+  engine.top.bid_price = 99;
+  engine.top.ask_price = 101;
+  u64 next_id = 1;
+  const auto no_place = [](const NewOrder &) {};
+  pop.start(0);
+  pop.run(engine, 1'000'000'000, next_id, no_place);
+  EXPECT_TRUE(engine.seen.empty()); // the mid never moved
+
+  engine.top.bid_price = 102; // up three ticks
+  engine.top.ask_price = 104;
+  pop.run(engine, 2'000'000'000, next_id, no_place);
+  ASSERT_EQ(engine.seen.size(), 1U);
+  EXPECT_EQ(engine.seen[0].side, Side::Buy);
+  EXPECT_EQ(engine.seen[0].price, 104);
+  EXPECT_EQ(engine.seen[0].tif, TIF::IOC);
+
+  engine.top.bid_price = 101; // down one tick: below the threshold
+  engine.top.ask_price = 103;
+  pop.run(engine, 3'000'000'000, next_id, no_place);
+  EXPECT_EQ(engine.seen.size(), 1U);
+}
+
+TEST(AgentsTest, TwapWorksTheParentInEvenSlices)
+{
+  AgentsConfig cfg = only(AgentKind::Twap, 1);
+  cfg.twap_parent = 1'000;
+  cfg.twap_slices = 30;
+  cfg.twap_horizon_ns = 3'000'000'000;
+  AgentPopulation pop(cfg, 100, 1, 7);
+  FakeEngine engine;
+  engine.top.bid_price = 99;
+  engine.top.ask_price = 101;
+  u64 next_id = 1;
+  pop.start(0);
+  pop.run(engine, 3'000'000'000 - 1, next_id, [](const NewOrder &) {});
+
+  ASSERT_EQ(engine.seen.size(), 30U);
+  Qty total = 0;
+  for (std::size_t i = 0; i < engine.seen.size(); ++i)
+  {
+    const NewOrder &n = engine.seen[i];
+    EXPECT_EQ(n.side, engine.seen[0].side);
+    EXPECT_TRUE(n.qty == 33 || n.qty == 34);
+    if (i > 0)
+    {
+      EXPECT_EQ(n.ts_ns - engine.seen[i - 1].ts_ns, 100'000'000U);
+    }
+    total += n.qty;
+  }
+  EXPECT_EQ(total, 1'000);
+}
+
+TEST(AgentsTest, LargePopulationsAreSteppedInTimeOrder)
+{
+  AgentsConfig cfg{};
+  cfg.noise = 100'000;
+  AgentPopulation pop(cfg, 100, 1, 7);
+  EXPECT_EQ(pop.size(), 100'000U + cfg.providers + cfg.momentum + cfg.twap);
+
+  FakeEngine engine;
+  engine.top.bid_price = 99;
+  engine.top.ask_price = 101;
+  u64 next_id = 1;
+  u64 last = 0;
+  u64 placed = 0;
+  bool ordered = true;
+  pop.start(0);
+  pop.run(engine, 100'000'000, next_id,
+          [&](const NewOrder &n)
+          {
+            ordered = ordered && n.ts_ns >= last;
+            last = n.ts_ns;
+            ++placed;
+          });
+  EXPECT_TRUE(ordered);
+  // 100k traders at 4 a second for 0.1 s, plus about 450 looks by providers and momentum takers.
+  EXPECT_NEAR(static_cast<double>(pop.actions()), 40'450.0, 1'000.0);
+  EXPECT_EQ(next_id - 1, engine.seen.size() + placed); // one id per order, none reused
+}
+} // namespace
+} // namespace hft
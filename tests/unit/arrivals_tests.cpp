@@ -0,0 +1,149 @@
+#include "market/arrivals.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+constexpr u64 kSecond = 1'000'000'000;
+
+// Counts per kind and per 100 ms window over `seconds` of arrivals.
+struct Tally
+{
+  u64 kinds[kArrivalKinds]{};
+  std::vector<u64> windows;
+  std::vector<u64> depths;
+};
+
+Tally run(const ArrivalConfig &cfg, u64 seconds, std::size_t resting = 50)
+{
+  ArrivalProcess p(cfg, 3);
+  p.start(0);
+  p.set_resting(resting);
+  Tally t;
+  t.windows.assign(seconds * 10, 0);
+  t.depths.assign(static_cast<std::size_t>(cfg.max_depth), 0);
+  u64 last = 0;
+  while (p.next_ns() < seconds * kSecond)
+  {
+    const Arrival a = p.pop();
+    EXPECT_GE(a.ts_ns, last);
+    last = a.ts_ns;
+    ++t.kinds[static_cast<std::size_t>(a.kind)];
+    ++t.windows[a.ts_ns / (kSecond / 10)];
+    if (a.kind == ArrivalKind::Add)
+      ++t.depths[static_cast<std::size_t>(a.depth)];
+  }
+  return t;
+}
+
+// Variance over mean of the per-window counts: about 1 for Poisson, well above for clustered flow.
+double dispersion(const std::vector<u64> &w)
+{
+  double mean = 0;
+  for (u64 c : w)
+    mean += static_cast<double>(c);
+  mean /= static_cast<double>(w.size());
+  double var = 0;
+  for (u64 c : w)
+    var += (static_cast<double>(c) - mean) * (static_cast<double>(c) - mean);
+  return var / static_cast<double>(w.size()) / mean;
+}
+
+TEST(ArrivalsTest, PoissonMatchesConfiguredRates)
+{
+  ArrivalConfig cfg{};
+  cfg.add_rate = 3'000;
+  cfg.market_rate = 500;
+  cfg.cancel_rate = 20; // per order, with 50 resting
+  const Tally t = run(cfg, 20);
+  EXPECT_NEAR(static_cast<double>(t.kinds[0]) / 20, 3'000, 90);
+  EXPECT_NEAR(static_cast<double>(t.kinds[1]) / 20, 500, 30);
+  EXPECT_NEAR(static_cast<double>(t.kinds[2]) / 20, 1'000, 45);
+  EXPECT_NEAR(dispersion(t.windows), 1.0, 0.3);
+}
+
+TEST(ArrivalsTest, HawkesClustersAroundItsStationaryRate)
+{
+  ArrivalConfig cfg{};
+  cfg.add_rate = 1'000;
+  cfg.market_rate = 0;
+  cfg.cancel_rate = 0;
+  cfg.hawkes = true;
+  cfg.hawkes_alpha = 50; // branching ratio alpha / beta = 0.5
+  cfg.hawkes_beta = 100;
+  const Tally t = run(cfg, 60);
+  // Stationary rate mu / (1 - alpha / beta) = 2000/s.
+  EXPECT_NEAR(static_cast<double>(t.kinds[0]) / 60, 2'000, 200);
+  EXPECT_GT(dispersion(t.windows), 2.0);
+}
+
+TEST(ArrivalsTest, DepthFollowsThePowerLaw)
+{
+  ArrivalConfig cfg{};
+  cfg.market_rate = 0;
+  cfg.cancel_rate = 0;
+  cfg.depth_exponent = 2.0;
+  cfg.max_depth = 4;
+  const Tally t = run(cfg, 20);
+  const double n = static_cast<double>(t.kinds[0]);
+  const double norm = 1.0 + 1.0 / 4 + 1.0 / 9 + 1.0 / 16;
+  for (std::size_t d = 0; d < 4; ++d)
+  {
+    const double expected = 1.0 / static_cast<double>((d + 1) * (d + 1)) / norm;
+    EXPECT_NEAR(static_cast<double>(t.depths[d]) / n, expected, 0.01) << "depth " << d;
+  }
+}
+
+TEST(ArrivalsTest, CancelRateScalesWithRestingOrders)
+{
+  ArrivalConfig cfg{};
+  cfg.add_rate = 0;
+  cfg.market_rate = 0;
+  cfg.cancel_rate = 10;
+  ArrivalProcess p(cfg);
+  p.start(0);
+  EXPECT_EQ(p.next_ns(), UINT64_MAX); // nothing resting, nothing to cancel
+
+  ArrivalProcess q(cfg);
+  q.start(0);
+  q.set_resting(100);
+  EXPECT_DOUBLE_EQ(q.rate(ArrivalKind::Cancel), 1'000);
+  u64 n = 0;
+  while (q.next_ns() < 10 * kSecond)
+  {
+    q.pop();
+    ++n;
+  }
+  EXPECT_NEAR(static_cast<double>(n), 10'000, 300);
+}
+
+TEST(ArrivalsTest, SameSeedSameSequence)
+{
+  ArrivalConfig cfg{};
+  cfg.hawkes = true;
+  ArrivalProcess a(cfg, 9);
+  ArrivalProcess b(cfg, 9);
+  a.start(100);
+  b.start(100);
+  for (int i = 0; i < 10'000; ++i)
+  {
+    const Arrival x = a.pop();
+    const Arrival y = b.pop();
+    ASSERT_EQ(x.ts_ns, y.ts_ns);
+    ASSERT_EQ(x.kind, y.kind);
+    ASSERT_EQ(x.side, y.side);
+    ASSERT_EQ(x.depth, y.depth);
+  }
+
+  ArrivalConfig none{};
+  none.add_rate = none.market_rate = none.cancel_rate = 0;
+  ArrivalProcess idle(none);
+  idle.start(0);
+  EXPECT_EQ(idle.next_ns(), UINT64_MAX);
+}
+} // namespace
+} // namespace hft
@@ -0,0 +1,146 @@
+#include "common/async_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace hft::aio
+{
+namespace
+{
+std::vector<std::byte> pattern(std::size_t n)
+{
+  std::vector<std::byte> v(n);
+  for (std::size_t i = 0; i < n; ++i)
+    v[i] = static_cast<std::byte>((i * 131 + i / 7) & 0xff);
+  return v;
+}
+
+std::vector<std::byte> read_file(const char *path)
+{
+  std::vector<std::byte> out;
+  std::FILE *f = std::fopen(path, "rb");
+  if (f == nullptr)
+    return out;
+  std::byte buf[1 << 14];
+  std::size_t n = 0;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    out.insert(out.end(), buf, buf + n);
+  std::fclose(f);
+  return out;
+}
+
+// Append `data` in uneven chunks, flushing now and then, and return what ended up on disk.
+std::vector<std::byte> write_through(const char *path, const Config &cfg,
+                                     const std::vector<std::byte> &data, Backend *used = nullptr)
+{
+  {
+    AsyncWriter w;
+    EXPECT_TRUE(w.open(path, cfg, "test.aio"));
+    if (used != nullptr)
+      *used = w.backend();
+    std::size_t at = 0;
+    for (std::size_t chunk = 1; at < data.size(); chunk = chunk * 7 % 1'009 + 1)
+    {
+      const std::size_t n = chunk < data.size() - at ? chunk : data.size() - at;
+      w.append(data.data() + at, n);
+      at += n;
+      if (chunk % 5 == 0)
+        w.flush();
+    }
+    w.close();
+    EXPECT_FALSE(w.failed());
+    EXPECT_EQ(w.appended(), data.size());
+  }
+  std::vector<std::byte> disk = read_file(path);
+  std::remove(path);
+  return disk;
+}
+
+TEST(AsyncWriterTest, BackendsWriteIdenticalFiles)
+{
+  const std::vector<std::byte> data = pattern(1'000'003);
+  for (Backend b : {Backend::Uring, Backend::Thread})
+  {
+    Config cfg{};
+    cfg.backend = b;
+    Backend used = Backend::Auto;
+    EXPECT_EQ(write_through("aio_backend.bin", cfg, data, &used), data) << to_string(b);
+    if (b == Backend::Thread)
+    {
+      EXPECT_EQ(used, Backend::Thread);
+    }
+  }
+}
+
+TEST(AsyncWriterTest, ExhaustedPoolBacklogsInsteadOfWaiting)
+{
+  Config cfg{};
+  cfg.buffers = 2;
+  cfg.buffer_size = kAlign;
+  cfg.idle_ns = 1'000'000; // a slow I/O thread, so the two buffers run out
+  const stats::Counter starved = stats::counter("test.aio.starved");
+  const u64 before = starved.value();
+
+  const std::vector<std::byte> data = pattern(256 * kAlign + 17);
+  EXPECT_EQ(write_through("aio_backlog.bin", cfg, data), data);
+  EXPECT_GT(starved.value(), before);
+}
+
+TEST(AsyncWriterTest, AcquireNeverBlocks)
+{
+  const char *path = "aio_acquire.bin";
+  Config cfg{};
+  cfg.buffers = 4;
+  cfg.buffer_size = kAlign;
+  std::vector<std::byte> expected;
+  {
+    AsyncWriter w;
+    ASSERT_TRUE(w.open(path, cfg));
+    std::vector<std::byte *> bufs;
+    while (std::byte *b = w.acquire())
+    {
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b) % kAlign, 0U);
+      bufs.push_back(b);
+    }
+    ASSERT_EQ(bufs.size(), 4U); // the fifth acquire returned nullptr rather than waiting
+    for (std::size_t i = 0; i < bufs.size(); ++i)
+    {
+      std::memset(bufs[i], static_cast<int>('a' + i), kAlign);
+      w.submit(bufs[i], kAlign);
+      expected.insert(expected.end(), kAlign, static_cast<std::byte>('a' + i));
+    }
+    w.close();
+  }
+  EXPECT_EQ(read_file(path), expected);
+  std::remove(path);
+}
+
+TEST(AsyncWriterTest, DirectModeKeepsExactLength)
+{
+  Config cfg{};
+  cfg.direct = true;
+  cfg.buffer_size = 3 * kAlign;
+  const std::vector<std::byte> data = pattern(10 * kAlign + 123);
+  EXPECT_EQ(write_through("aio_direct.bin", cfg, data), data);
+}
+
+TEST(AsyncWriterTest, SyncRunsOnTheWriterThread)
+{
+  const char *path = "aio_sync.bin";
+  AsyncWriter w;
+  Config cfg{};
+  cfg.sync_on_close = false;
+  ASSERT_TRUE(w.open(path, cfg));
+  const std::vector<std::byte> data = pattern(5'000);
+  w.append(data.data(), data.size());
+  w.flush();
+  EXPECT_TRUE(w.sync()); // queued, not performed: returns without touching the disk
+  w.close();
+  EXPECT_EQ(w.syncs(), 1U);
+  EXPECT_EQ(read_file(path), data);
+  std::remove(path);
+}
+} // namespace
+} // namespace hft::aio
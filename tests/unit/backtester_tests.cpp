@@ -0,0 +1,175 @@
+#include "backtest/backtester.hpp"
+#include "backtest/sweep.hpp"
+#include "strategy/mean_reversion.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+using CommandQueue = spsc::Queue<EngineCommand, 1 << 14>;
+
+backtest::Config short_run()
+{
+  backtest::Config cfg{};
+  cfg.duration_ns = 200'000'000; // 200 ms of virtual time
+  cfg.latency.jitter_ns = 1'500;
+  return cfg;
+}
+
+backtest::Result run_mean_reversion(const backtest::Config &cfg)
+{
+  auto cmd_q = std::make_unique<CommandQueue>();
+  StrategyContext ctx;
+  RiskManager risk(100, 1'000'000'000'000, 10);
+  MeanReversion strat(ctx, risk, *cmd_q, 8, 1.0, 2);
+  backtest::Backtester bt(cfg, strat, ctx.user_id, *cmd_q);
+  return bt.run();
+}
+
+// Crosses the book once, on its first timer, and notes the virtual time of every delivery. Driven
+// through the virtual interface.
+struct Probe : IStrategy
+{
+  CommandQueue &out;
+  const backtest::Backtester<IStrategy> *bt{nullptr};
+  u64 sent_at{0};
+  std::vector<u64> md_at;
+  std::vector<u64> exec_at;
+  std::size_t foreign_execs{0}; // execs for any user but ours
+
+  explicit Probe(CommandQueue &q) : out(q) {}
+
+  void on_market_data(const MarketDataEvent &) override
+  {
+    md_at.push_back(bt->now());
+  }
+
+  void on_exec(const ExecEvent &e) override
+  {
+    if (e.user_id == 1)
+      exec_at.push_back(bt->now());
+    else
+      ++foreign_execs;
+  }
+
+  void on_timer(u64 ts_ns) override
+  {
+    if (sent_at != 0)
+      return;
+    sent_at = ts_ns;
+    EngineCommand cmd{};
+    cmd.kind = EngineCommand::Kind::New;
+    cmd.new_order = NewOrder{1, 1, Side::Buy, 20'000, 1, TIF::IOC, ts_ns};
+    out.push(cmd);
+  }
+};
+
+TEST(BacktesterTest, SameConfigurationSameDigest)
+{
+  const backtest::Config cfg = short_run();
+  const backtest::Result a = run_mean_reversion(cfg);
+  const backtest::Result b = run_mean_reversion(cfg);
+  EXPECT_GT(a.commands, 0U);
+  EXPECT_GT(a.trades, 0U);
+  EXPECT_EQ(a.events, b.events);
+  EXPECT_EQ(a.digest, b.digest);
+
+  backtest::Config other = cfg;
+  other.street.seed = cfg.street.seed + 1;
+  EXPECT_NE(run_mean_reversion(other).digest, a.digest);
+}
+
+TEST(BacktesterTest, VirtualAdapterMatchesCompileTimeBinding)
+{
+  const backtest::Config cfg = short_run();
+  auto cmd_q = std::make_unique<CommandQueue>();
+  StrategyContext ctx;
+  RiskManager risk(100, 1'000'000'000'000, 10);
+  MeanReversion strat(ctx, risk, *cmd_q, 8, 1.0, 2);
+  StrategyAdapter<MeanReversion> plugin(strat);
+  IStrategy &any = plugin;
+  backtest::Backtester<IStrategy> bt(cfg, any, ctx.user_id, *cmd_q);
+  const backtest::Result r = bt.run();
+  EXPECT_GT(r.trades, 0U);
+  EXPECT_EQ(r.digest, run_mean_reversion(cfg).digest);
+}
+
+TEST(BacktesterTest, DeliversAfterConfiguredLatency)
+{
+  backtest::Config cfg{};
+  cfg.duration_ns = 5'000'000;
+  cfg.latency = backtest::Latency{7'000, 2'000, 11'000, 0};
+  CommandQueue q;
+  Probe probe(q);
+  backtest::Backtester<IStrategy> bt(cfg, probe, 1, q);
+  probe.bt = &bt;
+  const backtest::Result r = bt.run();
+
+  ASSERT_EQ(probe.sent_at, cfg.start_ns);
+  ASSERT_FALSE(probe.exec_at.empty()); // the IOC buy traded against the seeded asks
+  EXPECT_EQ(probe.exec_at.front(), cfg.start_ns + 7'000 + 11'000);
+  ASSERT_FALSE(probe.md_at.empty());
+  EXPECT_EQ(probe.md_at.front(), cfg.start_ns + 2'000); // the top published after seeding
+  EXPECT_EQ(r.commands, 1U);
+  EXPECT_EQ(probe.foreign_execs, 0U); // street fills stay with the street
+  EXPECT_EQ(r.execs, probe.exec_at.size());
+
+  // Ledger: the buy filled against the best seeded ask and nothing else of ours traded.
+  EXPECT_EQ(r.fills, 1U);
+  EXPECT_EQ(r.position, 1);
+  EXPECT_EQ(r.fill_p50_ns, 18'000U);
+}
+
+TEST(BacktesterTest, RunsOnVirtualTime)
+{
+  backtest::Config cfg{};
+  cfg.duration_ns = 10'000'000'000; // 10 s
+  cfg.timer_ns = 10'000'000;
+  cfg.street.step_interval_ns = 5'000'000;
+  auto cmd_q = std::make_unique<CommandQueue>();
+  StrategyContext ctx;
+  RiskManager risk(100, 1'000'000'000'000, 10);
+  MeanReversion strat(ctx, risk, *cmd_q);
+  backtest::Backtester bt(cfg, strat, ctx.user_id, *cmd_q);
+  const backtest::Result r = bt.run();
+
+  EXPECT_EQ(r.timers, cfg.duration_ns / cfg.timer_ns + 1);
+  EXPECT_EQ(r.sim_steps, cfg.duration_ns / cfg.street.step_interval_ns + 1);
+  EXPECT_LE(r.end_ns, cfg.start_ns + cfg.duration_ns);
+  EXPECT_GE(r.end_ns, cfg.start_ns + cfg.duration_ns - cfg.timer_ns);
+  EXPECT_LT(r.wall_ns, cfg.duration_ns); // nothing sleeps
+}
+TEST(BacktesterTest, SweepMatchesSerialRuns)
+{
+  backtest::Config base{};
+  base.duration_ns = 50'000'000;
+  backtest::Grid grid{};
+  grid.dev_ticks = {1.0, 2.0};
+  grid.requote_ticks = {0, 1};
+  grid.seed = {1, 2, 3};
+  const std::vector<backtest::Params> params = backtest::expand(grid);
+  ASSERT_EQ(params.size(), 12U);
+  EXPECT_EQ(params[1].dev_ticks, 1.0);
+  EXPECT_EQ(params[1].seed, 2U);
+  EXPECT_EQ(params[3].requote_ticks, 1);
+  EXPECT_EQ(params[3].min_requote_ns, 5'000'000U); // hft_app's quoting unless swept
+  EXPECT_EQ(params[6].dev_ticks, 2.0);
+
+  const backtest::SweepSummary s = backtest::sweep(base, grid, 3);
+  ASSERT_EQ(s.outcomes.size(), params.size());
+  for (std::size_t i = 0; i < params.size(); ++i)
+  {
+    const backtest::Outcome serial = backtest::run_one(base, params[i]);
+    EXPECT_EQ(s.outcomes[i].params.seed, params[i].seed);
+    EXPECT_EQ(s.outcomes[i].result.digest, serial.result.digest) << "combination " << i;
+    EXPECT_EQ(s.outcomes[i].result.pnl, serial.result.pnl);
+    EXPECT_GT(serial.result.fills, 0U);
+  }
+}
+} // namespace
+} // namespace hft
@@ -0,0 +1,116 @@
+#include "common/broadcast_ring.hpp"
+
+#include <gtest/gtest.h>
+
+namespace hft::broadcast
+{
+namespace
+{
+TEST(BroadcastRingTest, EverySubscriberSeesEveryEvent)
+{
+  Ring<int, 8> ring;
+  auto a = ring.subscribe();
+  auto b = ring.subscribe();
+  ASSERT_TRUE(a.valid());
+  ASSERT_TRUE(b.valid());
+
+  EXPECT_TRUE(ring.push(1));
+  EXPECT_TRUE(ring.push(2));
+  EXPECT_TRUE(ring.push(3));
+
+  int value = 0;
+  for (int expected : {1, 2, 3})
+  {
+    ASSERT_TRUE(a.pop(value));
+    EXPECT_EQ(value, expected);
+  }
+  EXPECT_FALSE(a.pop(value));
+
+  // The second subscriber reads independently of the first.
+  EXPECT_EQ(b.lag(), 3U);
+  for (int expected : {1, 2, 3})
+  {
+    ASSERT_TRUE(b.pop(value));
+    EXPECT_EQ(value, expected);
+  }
+  EXPECT_TRUE(b.empty());
+  EXPECT_FALSE(a.overrun());
+  EXPECT_FALSE(b.overrun());
+}
+
+TEST(BroadcastRingTest, LateSubscriberStartsAtCurrentTail)
+{
+  Ring<int, 8> ring;
+  EXPECT_TRUE(ring.push(7));
+
+  auto late = ring.subscribe();
+  int value = 0;
+  EXPECT_FALSE(late.pop(value));
+
+  EXPECT_TRUE(ring.push(8));
+  ASSERT_TRUE(late.pop(value));
+  EXPECT_EQ(value, 8);
+}
+
+TEST(BroadcastRingTest, DropAndFlagSkipsLappedEvents)
+{
+  Ring<int, 4> ring(OverrunPolicy::DropAndFlag);
+  auto sub = ring.subscribe();
+
+  // The producer never waits: ten pushes into four slots all succeed.
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(ring.push(i));
+
+  int value = 0;
+  ASSERT_TRUE(sub.pop(value));
+  EXPECT_TRUE(sub.overrun());
+  EXPECT_EQ(sub.dropped(), 7U);
+  EXPECT_EQ(value, 7);
+  ASSERT_TRUE(sub.pop(value));
+  EXPECT_EQ(value, 8);
+  ASSERT_TRUE(sub.pop(value));
+  EXPECT_EQ(value, 9);
+  EXPECT_FALSE(sub.pop(value));
+
+  sub.clear_overrun();
+  EXPECT_FALSE(sub.overrun());
+}
+
+TEST(BroadcastRingTest, BackPressureGatesOnSlowestSubscriber)
+{
+  Ring<int, 4> ring(OverrunPolicy::BackPressure);
+  auto fast = ring.subscribe();
+  auto slow = ring.subscribe();
+
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(ring.push(i));
+  EXPECT_FALSE(ring.push(4)); // both subscribers still need slot 0
+
+  int value = 0;
+  while (fast.pop(value))
+  {
+  }
+  EXPECT_FALSE(ring.push(4)); // the slow subscriber still gates the producer
+
+  ASSERT_TRUE(slow.pop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(ring.push(4));
+  EXPECT_FALSE(ring.push(5));
+  EXPECT_FALSE(slow.overrun());
+}
+
+TEST(BroadcastRingTest, ReleasedSubscriberStopsGating)
+{
+  Ring<int, 2, 1> ring(OverrunPolicy::BackPressure);
+  {
+    auto sub = ring.subscribe();
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_FALSE(ring.push(3));
+    EXPECT_FALSE(ring.subscribe().valid()); // the only cursor slot is taken
+  }
+  EXPECT_TRUE(ring.push(3));
+  EXPECT_TRUE(ring.subscribe().valid());
+}
+} // namespace
+} // namespace hft::broadcast
@@ -0,0 +1,56 @@
+#include "common/clock.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace hft::clock
+{
+namespace
+{
+TEST(ClockTest, SteadySourceFollowsSteadyClock)
+{
+  TscClock c(Source::Steady);
+  EXPECT_EQ(c.source(), Source::Steady);
+  EXPECT_EQ(c.ghz(), 0.0);
+  const std::uint64_t before = steady_ns();
+  const std::uint64_t t = c.now();
+  EXPECT_GE(t, before);
+  EXPECT_LE(t, steady_ns());
+  EXPECT_FALSE(c.maybe_resync());
+}
+
+TEST(ClockTest, ReadingsAreMonotonicAcrossResync)
+{
+  TscClock c;
+  std::uint64_t last = c.now();
+  for (int i = 0; i < 100'000; ++i)
+  {
+    if (i % 10'000 == 0)
+      c.resync();
+    const std::uint64_t t = c.now();
+    ASSERT_GE(t, last);
+    last = t;
+  }
+}
+
+TEST(ClockTest, TscTracksMonotonicClock)
+{
+  TscClock c;
+  if (c.source() != Source::Tsc)
+    GTEST_SKIP() << "no invariant TSC on this machine";
+  EXPECT_GT(c.ghz(), 0.2);
+
+  const std::uint64_t tsc0 = c.now();
+  const std::uint64_t mono0 = steady_ns();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  c.resync();
+  const std::uint64_t tsc_elapsed = c.now() - tsc0;
+  const std::uint64_t mono_elapsed = steady_ns() - mono0;
+  // Generous bound: the initial calibration window is only 2ms.
+  const std::uint64_t diff =
+      tsc_elapsed > mono_elapsed ? tsc_elapsed - mono_elapsed : mono_elapsed - tsc_elapsed;
+  EXPECT_LT(diff, mono_elapsed / 50);
+}
+} // namespace
+} // namespace hft::clock
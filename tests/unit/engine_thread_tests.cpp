@@ -1,8 +1,12 @@
 #include "gateway/gateway_sim.hpp"
+#include "strategy/mean_reversion.hpp"
+#include "strategy/reactor.hpp"
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
 #include <variant>
 
@@ -14,7 +18,8 @@ TEST(EngineThreadTest, PublishesInitialTopOfBook)
 {
   spsc::Queue<EngineCommand, 1 << 14> cmd_q;
   spsc::Queue<ExecEvent, 1 << 14> exec_q;
-  spsc::Queue<MarketDataEvent, 1 << 14> md_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  auto md_sub = md_q.subscribe();
 
   StreetFlowConfig cfg{};
   cfg.max_depth_levels = 1;
@@ -26,7 +31,7 @@ TEST(EngineThreadTest, PublishesInitialTopOfBook)
   bool received_top = false;
   while (std::chrono::steady_clock::now() < deadline)
   {
-    if (md_q.pop(ev))
+    if (md_sub.pop(ev))
     {
       if (std::holds_alternative<TopOfBook>(ev))
       {
@@ -42,5 +47,136 @@ TEST(EngineThreadTest, PublishesInitialTopOfBook)
   engine.stop();
   EXPECT_TRUE(received_top);
 }
+TEST(EngineThreadTest, DrainsExtraInputs)
+{
+  spsc::Queue<EngineCommand, 1 << 14> cmd_q;
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  auto extra = std::make_unique<EngineThread::CommandQueue[]>(EngineThread::kMaxExtraInputs + 1);
+
+  EngineThread engine(cmd_q, exec_q, md_q, StreetFlowConfig{});
+  for (std::size_t i = 0; i < EngineThread::kMaxExtraInputs; ++i)
+    ASSERT_TRUE(engine.add_input(extra[i]));
+  EXPECT_FALSE(engine.add_input(extra[EngineThread::kMaxExtraInputs]));
+  engine.start();
+
+  // A resting order far from the street book on the last extra input, then wake the engine.
+  constexpr u64 kUser = 77;
+  EngineCommand cmd{};
+  cmd.new_order = NewOrder{1ULL << 50, kUser, Side::Buy, 1, 1, TIF::Day, 0};
+  ASSERT_TRUE(extra[EngineThread::kMaxExtraInputs - 1].push(cmd));
+  engine.notify_input();
+
+  ExecEvent e;
+  bool acked = false;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+  while (!acked && std::chrono::steady_clock::now() < deadline)
+  {
+    if (exec_q.pop(e))
+      acked = e.user_id == kUser && e.type == ExecType::Ack && e.order_id == cmd.new_order.order_id;
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  engine.stop();
+  EXPECT_TRUE(acked);
+}
+TEST(EngineThreadTest, InjectedFlowKeepsTheSimulatorStamp)
+{
+  spsc::Queue<EngineCommand, 1 << 14> cmd_q;
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  EngineThread engine(cmd_q, exec_q, md_q, StreetFlowConfig{}); // injected on this thread
+
+  engine.inject_new(NewOrder{5, 9, Side::Buy, 1, 1, TIF::Day, 1'000});
+  engine.inject_cancel(CancelOrder{5, 9, 2'000});
+
+  ExecEvent ack{};
+  ExecEvent cxl{};
+  ASSERT_TRUE(exec_q.pop(ack));
+  ASSERT_TRUE(exec_q.pop(cxl));
+  EXPECT_EQ(ack.type, ExecType::Ack);
+  EXPECT_EQ(ack.ts_ns, 1'000U);
+  EXPECT_EQ(cxl.type, ExecType::CancelAck);
+  EXPECT_EQ(cxl.ts_ns, 2'000U);
+}
+
+// Counts the strategy's own fills on the way in.
+struct CountingStrategy
+{
+  MeanReversion &strat;
+  std::atomic<u64> fills{0};
+
+  void on_market_data(const MarketDataEvent &e)
+  {
+    strat.on_market_data(e);
+  }
+
+  void on_exec(const ExecEvent &e)
+  {
+    if (e.type == ExecType::Trade)
+      fills.fetch_add(1, std::memory_order_relaxed);
+    strat.on_exec(e);
+  }
+
+  void on_timer(u64 ts_ns)
+  {
+    strat.on_timer(ts_ns);
+  }
+};
+
+// hft_app's setup: the strategy's limits in the engine's gate, passive fills on. The strategy must
+// keep trading well past the fills a small gross-notional cap would allow, without the gate
+// turning away a steady stream of its orders.
+TEST(EngineThreadTest, StrategyKeepsTradingUnderTheAppRiskLimits)
+{
+  stats::Private scope;
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+
+  EngineThread engine(*cmd_q, *exec_q, *md_q, StreetFlowConfig{});
+  engine.set_passive_fills(true);
+  StrategyContext ctx;
+  ctx.user_id = 1;
+  ctx.next_order_id = 1;
+  ctx.tick = 1;
+  const RiskLimits limits{
+      .max_order_qty = 10, .max_position = 100, .max_notional = 1'000'000'000'000};
+  ASSERT_TRUE(engine.set_risk_limits(ctx.user_id, limits));
+  ReactorConfig reactor_cfg{};
+  reactor_cfg.timer_ns = 200'000;
+  Reactor<CountingStrategy> reactor(*exec_q, *md_q, reactor_cfg);
+  engine.start();
+
+  RiskManager risk(limits.max_position, limits.max_notional, limits.max_order_qty);
+  MeanReversion strat(ctx, risk, *cmd_q, 64, 2.0, 2, {overflow::Policy::Drop},
+                      QuoteConfig{.requote_ticks = 1, .min_requote_ns = 5'000'000});
+  CountingStrategy counted{strat};
+  reactor.add(counted, ctx.user_id);
+  reactor.set_command_queue(*cmd_q);
+  reactor.start();
+
+  // About 50 fills exhausted the old 1'000'000 cap; trade past twice that, then some more.
+  constexpr u64 kFills = 100;
+  const auto wait_for = [&](u64 n)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (counted.fills.load(std::memory_order_relaxed) < n &&
+           std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return counted.fills.load(std::memory_order_relaxed) >= n;
+  };
+  const bool reached = wait_for(kFills);
+  const bool still_trading = reached && wait_for(kFills + 20);
+  reactor.stop();
+  engine.stop();
+
+  EXPECT_TRUE(reached);
+  EXPECT_TRUE(still_trading);
+  const u64 orders = scope.value("strategy.orders");
+  const u64 rejects = scope.value("engine.risk_rejects");
+  EXPECT_GT(orders, 0U);
+  EXPECT_LT(rejects * 10, orders) << rejects << " of " << orders << " orders rejected";
+}
 } // namespace
 } // namespace hft
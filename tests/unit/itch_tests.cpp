@@ -0,0 +1,169 @@
+#include "common/mapped_file.hpp"
+#include "market/itch_replay.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <vector>
+
+#ifndef HFT_TEST_DATA_DIR
+#define HFT_TEST_DATA_DIR "tests/data"
+#endif
+
+namespace hft
+{
+namespace
+{
+constexpr u16 kAapl = 1;
+constexpr u16 kMsft = 2;
+
+// The session in tests/data/itch_sample.bin, which was written from this function.
+std::vector<std::byte> build_sample()
+{
+  std::vector<std::byte> out;
+  itch::Encoder enc(out);
+  u64 ts = 34'200'000'000'000; // 09:30
+  enc.system_event(ts, 'O');
+  enc.directory(kAapl, ++ts, "AAPL");
+  enc.directory(kMsft, ++ts, "MSFT");
+  enc.add(kAapl, ++ts, 1, Side::Buy, 100, "AAPL", 1'500'000);
+  enc.add(kAapl, ++ts, 2, Side::Buy, 200, "AAPL", 1'499'000);
+  enc.add(kAapl, ++ts, 3, Side::Sell, 150, "AAPL", 1'501'000);
+  enc.add(kAapl, ++ts, 4, Side::Sell, 300, "AAPL", 1'502'000);
+  enc.executed(kAapl, ++ts, 3, 50, 1);               // print 50 @ 150.10
+  enc.cancel(kAapl, ++ts, 2, 50);                    // deep level, no top change
+  enc.replace(kAapl, ++ts, 1, 5, 120, 1'500'500);    // bid improves to 150.05 x 120
+  enc.executed_at(kAapl, ++ts, 4, 100, 2, 1'501'500); // print 100 @ 150.15
+  enc.remove(kAapl, ++ts, 3);                        // ask falls back to 150.20 x 200
+  enc.trade(kAapl, ++ts, 0, Side::Buy, 25, "AAPL", 1'501'000, 3);
+  enc.executed_at(kAapl, ++ts, 5, 20, 4, 1'500'500, false); // not printable
+  const std::byte halt[] = {std::byte{0}, std::byte{3}, std::byte{'H'}, std::byte{0},
+                            std::byte{kMsft}};
+  out.insert(out.end(), std::begin(halt), std::end(halt)); // unknown to the parser: skipped
+  enc.add(kMsft, ++ts, 10, Side::Buy, 10, "MSFT", 4'000'000);
+  enc.add(kMsft, ++ts, 11, Side::Sell, 10, "MSFT", 4'001'000);
+  enc.executed(kMsft, ++ts, 11, 10, 5);
+  enc.executed(kMsft, ++ts, 999, 1, 6); // never added
+  return out;
+}
+
+struct Recorder
+{
+  std::vector<std::pair<u16, MarketDataEvent>> *events;
+
+  void operator()(u16 locate, const MarketDataEvent &ev) const
+  {
+    events->emplace_back(locate, ev);
+  }
+};
+
+TEST(ItchTest, EncodedFieldsDecodeBack)
+{
+  std::vector<std::byte> buf;
+  itch::Encoder enc(buf);
+  enc.add(7, 0x123456789aULL, 0x0102030405060708ULL, Side::Sell, 4'000'000'000U, "XYZ",
+          0xfedcba98U);
+  enc.replace(7, 1, 11, 12, 13, 14);
+
+  struct Handler
+  {
+    itch::AddOrder add{};
+    itch::Replace rep{};
+    void on_add(const itch::AddOrder &m)
+    {
+      add = m;
+    }
+    void on_replace(const itch::Replace &m)
+    {
+      rep = m;
+    }
+  } h;
+  const itch::ParseResult r = itch::parse(buf.data(), buf.size(), h);
+  EXPECT_EQ(r.messages, 2U);
+  EXPECT_EQ(r.skipped, 0U);
+  EXPECT_EQ(r.consumed, buf.size());
+  EXPECT_EQ(buf.size(), 2 + itch::msg_length('A') + 2 + itch::msg_length('U'));
+  EXPECT_EQ(h.add.h.locate, 7);
+  EXPECT_EQ(h.add.h.ts_ns, 0x123456789aULL);
+  EXPECT_EQ(h.add.ref, 0x0102030405060708ULL);
+  EXPECT_EQ(h.add.side, Side::Sell);
+  EXPECT_EQ(h.add.shares, 4'000'000'000U);
+  EXPECT_EQ(sv(h.add.stock, 8), "XYZ     ");
+  EXPECT_EQ(h.add.price, 0xfedcba98U);
+  EXPECT_EQ(h.rep.orig_ref, 11U);
+  EXPECT_EQ(h.rep.new_ref, 12U);
+  EXPECT_EQ(h.rep.shares, 13U);
+  EXPECT_EQ(h.rep.price, 14U);
+}
+
+TEST(ItchTest, StopsAtATruncatedMessage)
+{
+  std::vector<std::byte> buf = build_sample();
+  const std::size_t full = buf.size();
+  buf.resize(full - 5);
+  ItchBooks<> books;
+  const itch::ParseResult r = itch::parse(buf.data(), buf.size(), books);
+  EXPECT_TRUE(r.truncated);
+  EXPECT_FALSE(r.malformed);
+  EXPECT_EQ(r.consumed, full - (2 + itch::msg_length('E')));
+}
+
+TEST(ItchTest, FixtureMatchesTheEncoder)
+{
+  MappedFile file;
+  ASSERT_TRUE(file.open(HFT_TEST_DATA_DIR "/itch_sample.bin"));
+  const std::vector<std::byte> expected = build_sample();
+  ASSERT_EQ(file.size(), expected.size());
+  EXPECT_EQ(std::memcmp(file.data(), expected.data(), expected.size()), 0);
+}
+
+TEST(ItchTest, ReplayBuildsBooksAndPublishes)
+{
+  MappedFile file;
+  ASSERT_TRUE(file.open(HFT_TEST_DATA_DIR "/itch_sample.bin"));
+  std::vector<std::pair<u16, MarketDataEvent>> events;
+  ItchBooks<Recorder> books(Recorder{&events});
+  const itch::ParseResult r = replay_itch(file.data(), file.size(), books);
+  EXPECT_FALSE(r.truncated);
+  EXPECT_FALSE(r.malformed);
+  EXPECT_EQ(r.messages, 19U);
+  EXPECT_EQ(r.skipped, 2U); // the system event (no handler) and the unknown 'H'
+
+  ASSERT_EQ(books.find("AAPL"), kAapl);
+  ASSERT_EQ(books.find("MSFT"), kMsft);
+  EXPECT_EQ(books.find("GOOG"), 0);
+  const TopOfBook aapl = books.instrument(kAapl)->top;
+  EXPECT_EQ(aapl.bid_price, 1'500'500);
+  EXPECT_EQ(aapl.bid_qty, 100);
+  EXPECT_EQ(aapl.ask_price, 1'502'000);
+  EXPECT_EQ(aapl.ask_qty, 200);
+  const TopOfBook msft = books.instrument(kMsft)->top;
+  EXPECT_EQ(msft.bid_price, 4'000'000);
+  EXPECT_EQ(msft.ask_qty, 0);
+  EXPECT_EQ(books.instrument(kMsft)->book.order_count(), 1U);
+
+  const ItchStats &st = books.stats();
+  EXPECT_EQ(st.unknown_refs, 1U);
+  EXPECT_EQ(st.prints, 4U);
+  EXPECT_EQ(st.tops, events.size() - st.prints);
+
+  std::vector<TradePrint> aapl_prints;
+  for (const auto &[locate, ev] : events)
+    if (const TradePrint *p = std::get_if<TradePrint>(&ev); p != nullptr && locate == kAapl)
+      aapl_prints.push_back(*p);
+  ASSERT_EQ(aapl_prints.size(), 3U);
+  EXPECT_EQ(aapl_prints[0].price, 1'501'000);
+  EXPECT_EQ(aapl_prints[0].qty, 50);
+  EXPECT_EQ(aapl_prints[0].aggressor, Side::Buy); // hit the resting sell
+  EXPECT_EQ(aapl_prints[1].price, 1'501'500);     // executed with price
+  EXPECT_EQ(aapl_prints[2].qty, 25);
+  EXPECT_EQ(aapl_prints[2].aggressor, Side::Sell);
+
+  // The deep-level cancel and the non-printable execution still reach the book.
+  Price px = 0;
+  Side side = Side::Buy;
+  EXPECT_TRUE(books.instrument(kAapl)->book.find(2, px, side));
+  EXPECT_EQ(px, 1'499'000);
+}
+} // namespace
+} // namespace hft
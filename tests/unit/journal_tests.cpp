@@ -0,0 +1,210 @@
+#include "market/journal.hpp"
+#include "market/order_flow.hpp"
+#include "market/replay.hpp"
+#include "market/simulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+struct SessionExecs
+{
+  u64 passive_fills{0};
+  u64 risk_rejects{0};
+};
+
+// Run a seeded book plus generated flow through an engine journaling into `out`. `configured`
+// turns passive fills on before the journal is attached and sets limits for the flow's user after.
+SessionExecs record_session(std::vector<std::byte> &out, u64 commands, bool configured = false)
+{
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  OrderBook book;
+  MatchingEngine engine(book, *exec_q, *md_q);
+  Journal journal;
+  journal.capture(&out);
+  if (configured)
+    engine.set_passive_fills(true);
+  engine.set_journal(&journal);
+  if (configured)
+    engine.set_risk_limits(OrderFlowConfig{}.user_id,
+                           RiskLimits{.max_order_qty = 8, .max_open_orders = 200});
+
+  Simulator sim{};
+  sim.seed_book(engine);
+  OrderFlowConfig flow{};
+  flow.first_order_id = 1'000;
+  OrderFlowGenerator gen(flow);
+  SessionExecs seen;
+  ExecEvent e;
+  for (u64 i = 0; i < commands; ++i)
+  {
+    const EngineCommand cmd = gen.next();
+    engine.on_command(cmd, 1'000 + i);
+    while (exec_q->pop(e))
+    {
+      if (e.type == ExecType::Trade && e.order_id != cmd.new_order.order_id)
+        ++seen.passive_fills;
+      else if (e.code == RejectCode::OrderQty)
+        ++seen.risk_rejects;
+    }
+  }
+  return seen;
+}
+
+TEST(JournalTest, FramesAreSequencedAndDecodeBack)
+{
+  std::vector<std::byte> buf;
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  OrderBook book;
+  MatchingEngine engine(book, *exec_q, *md_q);
+  Journal journal;
+  journal.capture(&buf);
+  engine.set_journal(&journal);
+
+  engine.add_passive(NewOrder{1, 9, Side::Sell, 101, 4, TIF::Day, 5});
+  EngineCommand buy{};
+  buy.new_order = NewOrder{2, 7, Side::Buy, 101, 3, TIF::IOC, 0};
+  engine.on_command(buy, 77);
+
+  JournalReader reader(buf.data(), buf.size());
+  JournalRecord r;
+  std::vector<JournalType> types;
+  u64 seq = 0;
+  while (reader.next(r))
+  {
+    EXPECT_EQ(r.seq, seq++);
+    types.push_back(r.type);
+    if (r.type == JournalType::Seed)
+    {
+      EXPECT_EQ(r.new_order.order_id, 1U);
+      EXPECT_EQ(r.new_order.price, 101);
+      EXPECT_EQ(r.ts_ns, 5U);
+    }
+    else if (r.type == JournalType::New)
+    {
+      EXPECT_EQ(r.new_order.order_id, 2U);
+      EXPECT_EQ(r.new_order.tif, TIF::IOC);
+      EXPECT_EQ(r.ts_ns, 77U);
+    }
+    else
+    {
+      EXPECT_EQ(r.ts_ns, 77U); // outputs carry the command's engine stamp
+    }
+  }
+  EXPECT_FALSE(reader.truncated());
+  EXPECT_EQ(journal.frames(), seq);
+  const std::vector<JournalType> expected{JournalType::Seed, JournalType::New, JournalType::Exec,
+                                          JournalType::Trade, JournalType::Top};
+  EXPECT_EQ(types, expected);
+}
+
+TEST(JournalTest, ReplayReproducesTheRecordedStream)
+{
+  std::vector<std::byte> recorded;
+  record_session(recorded, 5'000);
+
+  const ReplayResult r = replay_journal(recorded.data(), recorded.size());
+  EXPECT_TRUE(r.ok) << r.error;
+  EXPECT_FALSE(r.truncated);
+  EXPECT_EQ(r.inputs, 10U + 5'000U); // simulator seeds 5 levels a side
+  EXPECT_GT(r.outputs, 5'000U);
+}
+
+TEST(JournalTest, ReplayRebuildsTheRecordedEngineConfig)
+{
+  std::vector<std::byte> recorded;
+  const SessionExecs seen = record_session(recorded, 5'000, true);
+  ASSERT_GT(seen.passive_fills, 0U);
+  ASSERT_GT(seen.risk_rejects, 0U);
+
+  JournalReader reader(recorded.data(), recorded.size());
+  JournalRecord r;
+  std::vector<JournalType> types;
+  while (reader.next(r) && types.size() < 2)
+    types.push_back(r.type);
+  const std::vector<JournalType> expected{JournalType::Config, JournalType::Limits};
+  EXPECT_EQ(types, expected);
+
+  const ReplayResult res = replay_journal(recorded.data(), recorded.size());
+  EXPECT_TRUE(res.ok) << res.error;
+  EXPECT_EQ(res.inputs, 2U + 10U + 5'000U);
+}
+
+TEST(JournalTest, ReplayReportsTheFirstDivergentFrame)
+{
+  std::vector<std::byte> recorded;
+  record_session(recorded, 200);
+
+  // Find the first exec and change its order id.
+  JournalReader reader(recorded.data(), recorded.size());
+  JournalRecord r;
+  while (reader.next(r) && r.type != JournalType::Exec)
+    ;
+  ASSERT_EQ(r.type, JournalType::Exec);
+  const std::size_t offset = static_cast<std::size_t>(r.frame - recorded.data()) + 20;
+  recorded[offset] ^= std::byte{1};
+
+  const ReplayResult res = replay_journal(recorded.data(), recorded.size());
+  EXPECT_FALSE(res.ok);
+  EXPECT_EQ(res.mismatch_seq, r.seq);
+}
+
+TEST(JournalTest, PartialTrailingFrameIsIgnored)
+{
+  std::vector<std::byte> recorded;
+  record_session(recorded, 100);
+  recorded.resize(recorded.size() - 3);
+
+  const ReplayResult r = replay_journal(recorded.data(), recorded.size());
+  EXPECT_TRUE(r.ok) << r.error;
+  EXPECT_TRUE(r.truncated);
+}
+
+TEST(JournalTest, FileJournalMatchesCapture)
+{
+  const char *path = "journal_tests.bin";
+  std::vector<std::byte> captured;
+  {
+    auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+    auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+    OrderBook book;
+    MatchingEngine engine(book, *exec_q, *md_q);
+    Journal file;
+    ASSERT_TRUE(file.open(path));
+    engine.set_journal(&file);
+    OrderFlowGenerator gen{};
+    std::vector<EngineCommand> cmds;
+    gen.generate(20'000, cmds); // more frames than the writer queue holds
+    for (const EngineCommand &c : cmds)
+      engine.on_command(c, 42);
+    file.close();
+
+    OrderBook book2;
+    MatchingEngine engine2(book2, *exec_q, *md_q);
+    Journal mem;
+    mem.capture(&captured);
+    engine2.set_journal(&mem);
+    for (const EngineCommand &c : cmds)
+      engine2.on_command(c, 42);
+  }
+
+  std::FILE *f = std::fopen(path, "rb");
+  ASSERT_NE(f, nullptr);
+  std::vector<std::byte> disk(captured.size() + sizeof(kJournalMagic) + 1);
+  const std::size_t n = std::fread(disk.data(), 1, disk.size(), f);
+  std::fclose(f);
+  std::remove(path);
+  ASSERT_EQ(n, captured.size() + sizeof(kJournalMagic));
+  EXPECT_EQ(std::memcmp(disk.data(), kJournalMagic, sizeof(kJournalMagic)), 0);
+  EXPECT_EQ(std::memcmp(disk.data() + sizeof(kJournalMagic), captured.data(), captured.size()), 0);
+}
+} // namespace
+} // namespace hft
@@ -0,0 +1,95 @@
+#include "common/latency.hpp"
+#include "market/matching_engine.hpp"
+
+#include <gtest/gtest.h>
+
+namespace hft
+{
+namespace
+{
+TEST(LatencyHistogramTest, BucketsRoundTripWithinRelativeError)
+{
+  using H = latency::Histogram;
+  for (u64 v : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 1000ULL, 123'456ULL, 1ULL << 40, ~0ULL})
+  {
+    const std::size_t b = H::bucket_of(v);
+    ASSERT_LT(b, H::kBuckets);
+    const u64 hi = H::bucket_high(b);
+    EXPECT_GE(hi, v);
+    EXPECT_LE(hi - v, v / H::kSubCount);
+    EXPECT_EQ(H::bucket_of(hi), b);
+  }
+}
+
+TEST(LatencyHistogramTest, ReportsPercentilesAndMax)
+{
+  latency::Histogram h;
+  EXPECT_EQ(h.percentile(0.5), 0U);
+  for (u64 v = 1; v <= 1000; ++v)
+    h.record(v * 100); // 100ns .. 100us, uniform
+
+  EXPECT_EQ(h.count(), 1000U);
+  EXPECT_EQ(h.max(), 100'000U);
+  EXPECT_NEAR(static_cast<double>(h.percentile(0.50)), 50'000.0, 50'000.0 / 16);
+  EXPECT_NEAR(static_cast<double>(h.percentile(0.99)), 99'000.0, 99'000.0 / 16);
+  EXPECT_EQ(h.percentile(1.0), 100'000U);
+  EXPECT_NEAR(h.mean(), 50'050.0, 1.0);
+}
+
+TEST(LatencyTracerTest, EngineCarriesStampsIntoExecs)
+{
+  OrderBook book;
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  latency::Tracer tracer;
+  MatchingEngine engine(book, exec_q, md_q, &tracer);
+
+  EngineCommand cmd{};
+  cmd.kind = EngineCommand::Kind::New;
+  cmd.new_order = NewOrder{1, 1, Side::Buy, 100, 5, TIF::Day, 0};
+  const u64 ingress = now_ns();
+  cmd.lat.tick_ns = ingress - 3'000;
+  cmd.lat.origin_ns = ingress - 1'000;
+  engine.on_command(cmd, ingress);
+
+  ExecEvent exec{};
+  ASSERT_TRUE(exec_q.pop(exec));
+  EXPECT_EQ(exec.lat.tick_ns, cmd.lat.tick_ns);
+  EXPECT_EQ(exec.lat.origin_ns, cmd.lat.origin_ns);
+  EXPECT_EQ(exec.lat.ingress_ns, ingress);
+  EXPECT_GE(exec.lat.egress_ns, ingress);
+
+  using latency::Hop;
+  EXPECT_EQ(tracer.histogram(Hop::CmdQueue).max(), 1'000U);
+  EXPECT_EQ(tracer.histogram(Hop::TickToTrade).max(), 3'000U);
+  EXPECT_EQ(tracer.histogram(Hop::Match).count(), 1U);
+  EXPECT_EQ(tracer.histogram(Hop::ExecQueue).count(), 0U); // recorded by the consumer
+
+  // Unstamped commands (e.g. simulator flow) only contribute to the match hop.
+  EngineCommand bare{};
+  bare.kind = EngineCommand::Kind::Cancel;
+  bare.cancel = CancelOrder{1, 1, 0};
+  engine.on_command(bare);
+  EXPECT_EQ(tracer.histogram(Hop::CmdQueue).count(), 1U);
+  EXPECT_EQ(tracer.histogram(Hop::Match).count(), 2U);
+}
+
+TEST(LatencyTracerTest, MatchHopExcludesAStaleStamp)
+{
+  OrderBook book;
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  latency::Tracer tracer;
+  MatchingEngine engine(book, exec_q, md_q, &tracer);
+
+  // Simulator flow carries its step time, which can be a whole step interval old.
+  EngineCommand cmd{};
+  cmd.kind = EngineCommand::Kind::New;
+  cmd.new_order = NewOrder{1, 1, Side::Buy, 100, 5, TIF::Day, 0};
+  engine.on_command(cmd, now_ns() - 1'000'000'000);
+  const latency::Histogram &match = tracer.histogram(latency::Hop::Match);
+  EXPECT_EQ(match.count(), 1U);
+  EXPECT_LT(match.max(), 100'000'000U);
+}
+} // namespace
+} // namespace hft
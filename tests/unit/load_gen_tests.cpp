@@ -0,0 +1,95 @@
+#include "gateway/load_gen.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace hft
+{
+namespace
+{
+TEST(LoadGenTest, AnswersEveryCommandAtALightOfferedRate)
+{
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  EngineThread engine(*cmd_q, *exec_q, *md_q, StreetFlowConfig{});
+
+  loadgen::Config cfg{};
+  cfg.producers = 2;
+  cfg.step_ns = 200'000'000;
+  cfg.rates = {20'000};
+  loadgen::Driver driver(cfg);
+  ASSERT_TRUE(driver.attach(engine));
+  engine.start();
+  const std::vector<loadgen::Point> curve = driver.run(engine, *exec_q);
+  engine.stop();
+
+  ASSERT_EQ(curve.size(), 1U);
+  const loadgen::Point &p = curve[0];
+  EXPECT_EQ(p.offered, 20'000.0);
+  EXPECT_EQ(p.sent, 4'000U); // 20k/s for 0.2 s, split over both producers
+  EXPECT_EQ(p.answered, p.sent);
+  EXPECT_LE(p.p50_ns, p.p99_ns);
+  EXPECT_LE(p.p99_ns, p.p999_ns);
+  EXPECT_LE(p.p999_ns, p.max_ns);
+  EXPECT_GT(p.max_ns, 0U);
+}
+
+TEST(LoadGenTest, OriginIsTheDueTimeNotTheSendTime)
+{
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  EngineThread engine(*cmd_q, *exec_q, *md_q, StreetFlowConfig{}); // never started
+
+  loadgen::Producer producer(OrderFlowConfig{});
+  producer.prepare(200);
+  const u64 first_due = now_ns() + 1'000'000;
+  const double interval = 5'000.5;
+  producer.send(engine, first_due, interval);
+
+  EngineCommand cmd;
+  for (u64 i = 0; i < 200; ++i)
+  {
+    ASSERT_TRUE(producer.queue().pop(cmd));
+    EXPECT_EQ(cmd.lat.origin_ns,
+              first_due + static_cast<u64>(static_cast<double>(i) * interval));
+  }
+  EXPECT_FALSE(producer.queue().pop(cmd));
+}
+
+// Whether a rate saturates depends on the machine; the stress scenarios check throughput. Here
+// only the shape of the ramp is checked.
+TEST(LoadGenTest, RampIsMonotoneAndEndsAtTheFirstSaturatedRate)
+{
+  auto cmd_q = std::make_unique<spsc::Queue<EngineCommand, 1 << 14>>();
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  EngineThread engine(*cmd_q, *exec_q, *md_q, StreetFlowConfig{});
+
+  loadgen::Config cfg{};
+  cfg.step_ns = 20'000'000;
+  cfg.ramp_start = 10'000;
+  cfg.ramp_factor = 10;
+  cfg.ramp_limit = 1e6;
+  loadgen::Driver driver(cfg);
+  ASSERT_TRUE(driver.attach(engine));
+  engine.start();
+  const std::vector<loadgen::Point> curve = driver.run(engine, *exec_q);
+  engine.stop();
+
+  ASSERT_GE(curve.size(), 1U);
+  ASSERT_LE(curve.size(), 3U); // 10k, 100k, 1M
+  EXPECT_EQ(curve[0].offered, cfg.ramp_start);
+  for (std::size_t i = 0; i + 1 < curve.size(); ++i)
+  {
+    EXPECT_EQ(curve[i + 1].offered, cfg.ramp_factor * curve[i].offered);
+    EXPECT_FALSE(curve[i].saturated); // the ramp stops at the first saturated rate
+  }
+  EXPECT_TRUE(curve.back().saturated || curve.back().offered * cfg.ramp_factor > cfg.ramp_limit);
+  for (const loadgen::Point &p : curve)
+    EXPECT_EQ(p.sent, static_cast<u64>(p.offered * 0.02));
+}
+} // namespace
+} // namespace hft
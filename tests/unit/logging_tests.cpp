@@ -0,0 +1,148 @@
+#include "common/logging.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace hft
+{
+namespace
+{
+std::string render(const char *fmt, const LogRecord &r)
+{
+  char out[256];
+  format_log(fmt, r.payload, r.used, out, sizeof(out));
+  return out;
+}
+
+template <typename... Args> LogRecord encode(const Args &...args)
+{
+  LogRecord r{};
+  LogArgWriter w(r);
+  (w.add(args), ...);
+  return r;
+}
+
+std::string read_all(std::FILE *f)
+{
+  std::string text;
+  std::rewind(f);
+  char buf[512];
+  std::size_t n = 0;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    text.append(buf, n);
+  return text;
+}
+
+TEST(LoggingTest, FormatsEncodedArgumentsLikePrintf)
+{
+  const char *name = "engine";
+  EXPECT_EQ(render("%s on cpu %d node %u", encode(name, 3, 1u)), "engine on cpu 3 node 1");
+  EXPECT_EQ(render("%llu trades, %5.2f%%", encode(42ULL, 3.14159)), "42 trades,  3.14%");
+  EXPECT_EQ(render("[%-4d|%04x]", encode(7, 255)), "[7   |00ff]");
+  EXPECT_EQ(render("'%.*s'", encode(3, "abcdef")), "'abc'");
+  EXPECT_EQ(render("%d and %d", encode(1)), "1 and <?>");
+}
+
+TEST(LoggingTest, StarPrecisionBoundsTheStringCopy)
+{
+  EXPECT_EQ(bounded_string_args("%*d %.*s %s %-8.*s %%"), (u64{1} << 3) | (u64{1} << 6));
+  EXPECT_EQ(bounded_string_args("%.3s %.*f"), 0U);
+
+  // A slice of a longer buffer: only the three bytes the precision names are copied.
+  const char text[] = "abcdef";
+  LogRecord r{};
+  LogArgWriter w(r, bounded_string_args("'%.*s'"));
+  w.add(3);
+  w.add(static_cast<const char *>(text));
+  EXPECT_EQ(r.used, 1 + 8 + 2 + 3);
+  EXPECT_EQ(render("'%.*s'", r), "'abc'");
+}
+
+TEST(LoggingTest, LongStringsAreTruncatedNotOverrun)
+{
+  const std::string big(500, 'x');
+  const LogRecord r = encode(big.c_str(), 5);
+  EXPECT_EQ(r.truncated, 1);
+  EXPECT_LE(r.used, LogRecord::kPayload);
+  EXPECT_EQ(r.nargs, 1);
+}
+
+TEST(LoggingTest, BinaryLogRoundTripsThroughDecoder)
+{
+  const std::string path = ::testing::TempDir() + "hft_logging_test.bin";
+  {
+    Logger logger;
+    const u32 info = logger.register_site(LogLevel::Info, "order %llu filled %d @ %lld");
+    const u32 warn = logger.register_site(LogLevel::Warn, "queue %s full");
+    LogConfig cfg{};
+    cfg.binary = true;
+    cfg.path = path.c_str();
+    ASSERT_TRUE(logger.start(cfg));
+    logger.write(info, "order %llu filled %d @ %lld", 17ULL, 5, -3LL);
+    logger.write(warn, "queue %s full", "exec");
+    logger.stop();
+  }
+
+  std::FILE *in = std::fopen(path.c_str(), "rb");
+  ASSERT_NE(in, nullptr);
+  std::FILE *out = std::tmpfile();
+  ASSERT_NE(out, nullptr);
+  EXPECT_EQ(decode_log_file(in, out), 2);
+  const std::string text = read_all(out);
+  std::fclose(in);
+  std::fclose(out);
+  std::remove(path.c_str());
+
+  EXPECT_NE(text.find("INFO ["), std::string::npos);
+  EXPECT_NE(text.find("] order 17 filled 5 @ -3\n"), std::string::npos);
+  EXPECT_NE(text.find("WARN ["), std::string::npos);
+  EXPECT_NE(text.find("] queue exec full\n"), std::string::npos);
+}
+
+TEST(LoggingTest, FullThreadBufferCountsDrops)
+{
+  const std::string path = ::testing::TempDir() + "hft_logging_drops.bin";
+  Logger logger;
+  const u32 site = logger.register_site(LogLevel::Info, "tick %d");
+  LogConfig cfg{};
+  cfg.binary = true;
+  cfg.path = path.c_str();
+  cfg.flush_interval_ns = 10'000'000'000ULL; // writer parks between drains; stop() wakes it
+  ASSERT_TRUE(logger.start(cfg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50)); // let the writer park
+
+  constexpr int kBurst = 5000;
+  for (int i = 0; i < kBurst; ++i)
+    logger.write(site, "tick %d", i);
+  const u64 dropped = logger.dropped();
+  logger.stop();
+
+  std::FILE *in = std::fopen(path.c_str(), "rb");
+  ASSERT_NE(in, nullptr);
+  std::FILE *out = std::tmpfile();
+  const long records = decode_log_file(in, out);
+  const std::string text = read_all(out);
+  std::fclose(in);
+  std::fclose(out);
+  std::remove(path.c_str());
+
+  EXPECT_GT(dropped, 0U);
+  EXPECT_EQ(static_cast<u64>(records) + dropped, static_cast<u64>(kBurst));
+  EXPECT_NE(text.find("dropped " + std::to_string(dropped) + " records"), std::string::npos);
+}
+
+TEST(LoggingTest, MacrosFallBackToSynchronousOutputWhenStopped)
+{
+  ASSERT_FALSE(Logger::instance().running());
+  ::testing::internal::CaptureStderr();
+  HFT_WARN("sync path %d", 7);
+  const std::string err = ::testing::internal::GetCapturedStderr();
+  EXPECT_NE(err.find("WARN ["), std::string::npos);
+  EXPECT_NE(err.find("] sync path 7\n"), std::string::npos);
+}
+} // namespace
+} // namespace hft
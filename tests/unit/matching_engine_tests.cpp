@@ -12,7 +12,8 @@ TEST(MatchingEngineTest, PublishesAckForPassiveOrder)
 {
   OrderBook book;
   spsc::Queue<ExecEvent, 1 << 14> exec_q;
-  spsc::Queue<MarketDataEvent, 1 << 14> md_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  auto md_sub = md_q.subscribe();
   MatchingEngine engine(book, exec_q, md_q);
 
   EngineCommand cmd{};
@@ -28,7 +29,7 @@ TEST(MatchingEngineTest, PublishesAckForPassiveOrder)
   EXPECT_EQ(exec.leaves, 5);
 
   MarketDataEvent ev;
-  ASSERT_TRUE(md_q.pop(ev));
+  ASSERT_TRUE(md_sub.pop(ev));
   ASSERT_TRUE(std::holds_alternative<TopOfBook>(ev));
   const TopOfBook &top = std::get<TopOfBook>(ev);
   EXPECT_EQ(top.bid_price, 100);
@@ -41,7 +42,8 @@ TEST(MatchingEngineTest, MatchesAgainstRestingLiquidity)
   book.add_passive(NewOrder{50, 2, Side::Sell, 101, 4, TIF::Day, now_ns()});
 
   spsc::Queue<ExecEvent, 1 << 14> exec_q;
-  spsc::Queue<MarketDataEvent, 1 << 14> md_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  auto md_sub = md_q.subscribe();
   MatchingEngine engine(book, exec_q, md_q);
 
   EngineCommand aggressive{};
@@ -58,17 +60,128 @@ TEST(MatchingEngineTest, MatchesAgainstRestingLiquidity)
   EXPECT_EQ(trade.order_id, 60);
 
   MarketDataEvent ev;
-  ASSERT_TRUE(md_q.pop(ev));
+  ASSERT_TRUE(md_sub.pop(ev));
   ASSERT_TRUE(std::holds_alternative<TradePrint>(ev));
   const TradePrint &print = std::get<TradePrint>(ev);
   EXPECT_EQ(print.price, 101);
   EXPECT_EQ(print.qty, 3);
 
-  ASSERT_TRUE(md_q.pop(ev));
+  ASSERT_TRUE(md_sub.pop(ev));
   ASSERT_TRUE(std::holds_alternative<TopOfBook>(ev));
   const TopOfBook &top = std::get<TopOfBook>(ev);
   EXPECT_EQ(top.ask_price, 101);
   EXPECT_EQ(top.ask_qty, 1);
 }
+
+TEST(MatchingEngineTest, StampsEveryEventOfACommandOnce)
+{
+  OrderBook book;
+  book.add_passive(NewOrder{50, 2, Side::Sell, 101, 2, TIF::Day, 1});
+  book.add_passive(NewOrder{51, 2, Side::Sell, 102, 2, TIF::Day, 1});
+
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  auto md_sub = md_q.subscribe();
+  MatchingEngine engine(book, exec_q, md_q);
+
+  EngineCommand sweep{};
+  sweep.kind = EngineCommand::Kind::New;
+  sweep.new_order = NewOrder{60, 3, Side::Buy, 102, 5, TIF::Day, 0};
+  constexpr u64 kStamp = 123'456'789;
+  engine.on_command(sweep, kStamp);
+
+  // Two fills and the ack for the resting residue.
+  ExecEvent exec{};
+  int execs = 0;
+  while (exec_q.pop(exec))
+  {
+    EXPECT_EQ(exec.ts_ns, kStamp);
+    ++execs;
+  }
+  EXPECT_EQ(execs, 3);
+
+  MarketDataEvent ev;
+  int events = 0;
+  while (md_sub.pop(ev))
+  {
+    std::visit([&](const auto &e) { EXPECT_EQ(e.ts_ns, kStamp); }, ev);
+    ++events;
+  }
+  EXPECT_EQ(events, 3); // two prints and one top-of-book
+}
+TEST(MatchingEngineTest, ReportsPassiveFillsWhenAsked)
+{
+  OrderBook book;
+  book.add_passive(NewOrder{50, 2, Side::Sell, 101, 4, TIF::Day, 1});
+
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  MatchingEngine engine(book, exec_q, md_q);
+  engine.set_passive_fills(true);
+
+  EngineCommand ioc{};
+  ioc.kind = EngineCommand::Kind::New;
+  ioc.new_order = NewOrder{60, 3, Side::Buy, 101, 6, TIF::IOC, 0};
+  engine.on_command(ioc, 5);
+
+  ExecEvent aggressor{};
+  ASSERT_TRUE(exec_q.pop(aggressor));
+  EXPECT_EQ(aggressor.type, ExecType::Trade);
+  EXPECT_EQ(aggressor.order_id, 60);
+  EXPECT_EQ(aggressor.filled, 4);
+  EXPECT_EQ(aggressor.leaves, 2); // then dropped by the IOC ack below
+
+  ExecEvent passive{};
+  ASSERT_TRUE(exec_q.pop(passive));
+  EXPECT_EQ(passive.type, ExecType::Trade);
+  EXPECT_EQ(passive.order_id, 50);
+  EXPECT_EQ(passive.user_id, 2);
+  EXPECT_EQ(passive.price, 101);
+  EXPECT_EQ(passive.filled, 4);
+  EXPECT_EQ(passive.leaves, 0);
+
+  ExecEvent ack{};
+  ASSERT_TRUE(exec_q.pop(ack));
+  EXPECT_EQ(ack.type, ExecType::Ack);
+  EXPECT_EQ(ack.leaves, 0);
+  EXPECT_FALSE(exec_q.pop(ack));
+}
+TEST(MatchingEngineTest, IdsAreOwnedByOneUser)
+{
+  OrderBook book;
+  spsc::Queue<ExecEvent, 1 << 14> exec_q;
+  broadcast::Ring<MarketDataEvent, 1 << 14> md_q;
+  MatchingEngine engine(book, exec_q, md_q);
+  auto send = [&](const EngineCommand &cmd)
+  {
+    engine.on_command(cmd, 1);
+    ExecEvent e{};
+    EXPECT_TRUE(exec_q.pop(e));
+    return e;
+  };
+
+  // A street order rests under id 1; user 1 then reuses the id.
+  EXPECT_TRUE(engine.add_passive(NewOrder{1, 999, Side::Sell, 10'005, 5, TIF::Day, 0}));
+  EXPECT_FALSE(engine.add_passive(NewOrder{1, 999, Side::Sell, 10'006, 5, TIF::Day, 0}));
+  const NewOrder reused{1, 1, Side::Buy, 9'995, 2, TIF::Day, 0};
+  const ExecEvent dup = send(EngineCommand{EngineCommand::Kind::New, reused, {}, {}});
+  EXPECT_EQ(dup.type, ExecType::Reject);
+  EXPECT_EQ(dup.code, RejectCode::DuplicateOrder);
+  EXPECT_EQ(book.best_bid(), 0); // never reached the book
+  EXPECT_EQ(book.order_count(), 1U);
+
+  // User 1 cannot cancel the street order either.
+  const ExecEvent foreign =
+      send(EngineCommand{EngineCommand::Kind::Cancel, {}, CancelOrder{1, 1, 0}, {}});
+  EXPECT_EQ(foreign.type, ExecType::Reject);
+  EXPECT_EQ(foreign.code, RejectCode::UnknownOrder);
+  EXPECT_EQ(book.best_ask(), 10'005);
+
+  const ExecEvent own =
+      send(EngineCommand{EngineCommand::Kind::Cancel, {}, CancelOrder{1, 999, 0}, {}});
+  EXPECT_EQ(own.type, ExecType::CancelAck);
+  EXPECT_TRUE(book.empty());
+  EXPECT_EQ(book.order_count(), 0U);
+}
 } // namespace
 } // namespace hft
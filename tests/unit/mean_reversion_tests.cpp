@@ -66,6 +66,164 @@ TEST_F(MeanReversionTest, PostsQuotesWhenTopAvailable)
   EXPECT_GT(seen[1].new_order.price, 0);
 }
 
+TEST_F(MeanReversionTest, LeansQuotesTowardTheMean)
+{
+  TopOfBook top{};
+  top.bid_price = 100;
+  top.ask_price = 102;
+  for (int i = 0; i < 8; ++i)
+    strategy->on_market_data(MarketDataEvent{top});
+
+  // Mid jumps to 111 while the mean is still near 102: both quotes shade a tick down.
+  top.bid_price = 110;
+  top.ask_price = 112;
+  strategy->on_market_data(MarketDataEvent{top});
+  strategy->on_timer(1);
+
+  EngineCommand bid{};
+  EngineCommand ask{};
+  ASSERT_TRUE(cmd_q.pop(bid));
+  ASSERT_TRUE(cmd_q.pop(ask));
+  EXPECT_EQ(bid.new_order.price, 111 - 2 - 1);
+  EXPECT_EQ(ask.new_order.price, 111 + 2 - 1);
+}
+
+TEST_F(MeanReversionTest, RequotesOnlyWhenPriceMoves)
+{
+  TopOfBook top{};
+  top.bid_price = 100;
+  top.ask_price = 102;
+  strategy->on_market_data(MarketDataEvent{top});
+  strategy->on_timer(1);
+
+  std::vector<EngineCommand> first;
+  EngineCommand cmd{};
+  while (cmd_q.pop(cmd))
+    first.push_back(cmd);
+  ASSERT_EQ(first.size(), 2U);
+
+  // Same top: both quotes stay where they are.
+  strategy->on_timer(2);
+  EXPECT_FALSE(cmd_q.pop(cmd));
+
+  // The bid filled completely; only it is replaced.
+  ExecEvent fill{};
+  fill.type = ExecType::Trade;
+  fill.order_id = first[0].new_order.order_id;
+  fill.user_id = ctx.user_id;
+  fill.filled = 2;
+  fill.leaves = 0;
+  strategy->on_exec(fill);
+  strategy->on_timer(3);
+  ASSERT_TRUE(cmd_q.pop(cmd));
+  EXPECT_EQ(cmd.kind, EngineCommand::Kind::New);
+  EXPECT_EQ(cmd.new_order.side, Side::Buy);
+  EXPECT_FALSE(cmd_q.pop(cmd));
+
+  // The top moved: both working quotes are cancelled before new ones go out.
+  top.bid_price = 110;
+  top.ask_price = 112;
+  strategy->on_market_data(MarketDataEvent{top});
+  strategy->on_timer(4);
+  std::vector<EngineCommand> moved;
+  while (cmd_q.pop(cmd))
+    moved.push_back(cmd);
+  ASSERT_EQ(moved.size(), 4U);
+  EXPECT_EQ(moved[0].kind, EngineCommand::Kind::Cancel);
+  EXPECT_EQ(moved[1].kind, EngineCommand::Kind::Cancel);
+  EXPECT_EQ(moved[1].cancel.order_id, first[1].new_order.order_id);
+  EXPECT_EQ(moved[2].kind, EngineCommand::Kind::New);
+  EXPECT_EQ(moved[3].kind, EngineCommand::Kind::New);
+}
+
+TEST_F(MeanReversionTest, LeavesQuotesWithinTheRequoteThreshold)
+{
+  StrategyContext alt_ctx = ctx;
+  spsc::Queue<EngineCommand, 1 << 14> alt_queue;
+  MeanReversion held(alt_ctx, risk, alt_queue, 8, 2.0, 2, {overflow::Policy::Drop},
+                     QuoteConfig{.requote_ticks = 1, .min_requote_ns = 1'000});
+  TopOfBook top{};
+  top.bid_price = 100;
+  top.ask_price = 102;
+  held.on_market_data(MarketDataEvent{top});
+  held.on_timer(0);
+  EngineCommand cmd{};
+  int sent = 0;
+  while (alt_queue.pop(cmd))
+    ++sent;
+  ASSERT_EQ(sent, 2);
+
+  // A one-tick move leaves both quotes working.
+  top.bid_price = 101;
+  top.ask_price = 103;
+  held.on_market_data(MarketDataEvent{top});
+  held.on_timer(2'000);
+  EXPECT_FALSE(alt_queue.pop(cmd));
+
+  // Three ticks is too far: cancel and replace.
+  top.bid_price = 103;
+  top.ask_price = 105;
+  held.on_market_data(MarketDataEvent{top});
+  held.on_timer(3'000);
+  std::vector<EngineCommand> moved;
+  while (alt_queue.pop(cmd))
+    moved.push_back(cmd);
+  ASSERT_EQ(moved.size(), 4U);
+  EXPECT_EQ(moved[0].kind, EngineCommand::Kind::Cancel);
+  EXPECT_EQ(moved[2].new_order.price, 102);
+  EXPECT_EQ(moved[3].new_order.price, 106);
+
+  // Another jump within 1 us of the last requote waits for the rate limit.
+  top.bid_price = 107;
+  top.ask_price = 109;
+  held.on_market_data(MarketDataEvent{top});
+  held.on_timer(3'500);
+  EXPECT_FALSE(alt_queue.pop(cmd));
+  held.on_timer(4'000);
+  sent = 0;
+  while (alt_queue.pop(cmd))
+    ++sent;
+  EXPECT_EQ(sent, 4);
+}
+
+TEST_F(MeanReversionTest, RetriesADroppedCancelBeforeRequoting)
+{
+  TopOfBook top{};
+  top.bid_price = 100;
+  top.ask_price = 102;
+  strategy->on_market_data(MarketDataEvent{top});
+  strategy->on_timer(1);
+  EngineCommand cmd{};
+  std::vector<EngineCommand> first;
+  while (cmd_q.pop(cmd))
+    first.push_back(cmd);
+  ASSERT_EQ(first.size(), 2U);
+
+  // The engine falls behind: the queue is full when the top moves, so both cancels are dropped.
+  while (cmd_q.push(EngineCommand{}))
+  {
+  }
+  top.bid_price = 110;
+  top.ask_price = 112;
+  strategy->on_market_data(MarketDataEvent{top});
+  strategy->on_timer(2);
+  while (cmd_q.pop(cmd))
+    EXPECT_EQ(cmd.cancel.order_id, 0U); // only the filler
+
+  // Once there is room the same orders are cancelled before anything new goes out.
+  strategy->on_timer(3);
+  std::vector<EngineCommand> retried;
+  while (cmd_q.pop(cmd))
+    retried.push_back(cmd);
+  ASSERT_EQ(retried.size(), 4U);
+  EXPECT_EQ(retried[0].kind, EngineCommand::Kind::Cancel);
+  EXPECT_EQ(retried[0].cancel.order_id, first[0].new_order.order_id);
+  EXPECT_EQ(retried[1].kind, EngineCommand::Kind::Cancel);
+  EXPECT_EQ(retried[1].cancel.order_id, first[1].new_order.order_id);
+  EXPECT_EQ(retried[2].kind, EngineCommand::Kind::New);
+  EXPECT_EQ(retried[3].kind, EngineCommand::Kind::New);
+}
+
 TEST_F(MeanReversionTest, SkipsQuotesWhenRiskBlocks)
 {
   StrategyContext alt_ctx = ctx;
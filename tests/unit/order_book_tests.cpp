@@ -38,6 +38,49 @@ TEST(OrderBookTest, CancelRemovesOrder)
   EXPECT_EQ(book.cancel(999), 0); // unknown id
 }
 
+TEST(OrderBookTest, DuplicateIdsAndForeignCancelsLeaveTheBookAlone)
+{
+  OrderBook book;
+  EXPECT_TRUE(book.add_passive(NewOrder{1, 7, Side::Sell, 105, 5, TIF::Day, 1}));
+  EXPECT_FALSE(book.add_passive(NewOrder{1, 8, Side::Buy, 99, 3, TIF::Day, 2}));
+  EXPECT_TRUE(book.contains(1));
+  EXPECT_EQ(book.order_count(), 1U);
+  EXPECT_EQ(book.best_bid(), 0);
+
+  Order removed{};
+  EXPECT_EQ(book.cancel(1, 8, removed), 0); // not user 8's order
+  EXPECT_EQ(book.best_ask(), 105);
+  EXPECT_EQ(book.cancel(1, 7, removed), 5);
+  EXPECT_EQ(removed.user_id, 7U);
+  EXPECT_FALSE(book.contains(1));
+  EXPECT_TRUE(book.empty());
+}
+
+TEST(OrderBookTest, ReduceKeepsPriorityUntilEmpty)
+{
+  OrderBook book;
+  book.add_passive(NewOrder{1, 7, Side::Sell, 105, 5, TIF::Day, 1});
+  book.add_passive(NewOrder{2, 7, Side::Sell, 105, 4, TIF::Day, 2});
+
+  EXPECT_EQ(book.reduce(1, 3), 3);
+  EXPECT_EQ(book.top().ask_qty, 6);
+  std::vector<u64> hit;
+  book.match(NewOrder{3, 8, Side::Buy, 105, 1, TIF::IOC, 3},
+             [&](Price, Qty, const Order &resting) { hit.push_back(resting.order_id); });
+  EXPECT_EQ(hit, std::vector<u64>{1}); // still first in the queue
+
+  Price px = 0;
+  Side side = Side::Buy;
+  EXPECT_EQ(book.reduce(1, 10), 1); // only what is left
+  EXPECT_FALSE(book.find(1, px, side));
+  ASSERT_TRUE(book.find(2, px, side));
+  EXPECT_EQ(px, 105);
+  EXPECT_EQ(side, Side::Sell);
+  EXPECT_EQ(book.reduce(2, 4), 4);
+  EXPECT_TRUE(book.empty());
+  EXPECT_EQ(book.reduce(2, 1), 0);
+}
+
 TEST(OrderBookTest, MatchConsumesLiquidity)
 {
   OrderBook book;
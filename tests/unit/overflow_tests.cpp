@@ -0,0 +1,145 @@
+#include "common/overflow.hpp"
+#include "common/spsc_queue.hpp"
+#include "market/matching_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+namespace hft::overflow
+{
+namespace
+{
+using SmallQueue = spsc::Queue<int, 4>;
+
+TEST(OverflowTest, DropCountsAndReportsLoss)
+{
+  SmallQueue q;
+  Writer<SmallQueue, int> w(q, "test.overflow.drop", Config{Policy::Drop});
+  const stats::Counter drops = stats::counter("test.overflow.drop.drops");
+
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(w.push(i));
+  EXPECT_FALSE(w.push(4));
+  EXPECT_EQ(drops.value(), 1U);
+  EXPECT_EQ(q.size(), 4U);
+}
+
+TEST(OverflowTest, SpillKeepsOrderAcrossTheQueue)
+{
+  SmallQueue q;
+  Writer<SmallQueue, int> w(q, "test.overflow.spill", Config{Policy::Spill});
+
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(w.push(i));
+  EXPECT_EQ(w.spilled(), 6U);
+  EXPECT_TRUE(w.saturated());
+  EXPECT_EQ(stats::counter("test.overflow.spill.spilled").value(), 6U);
+
+  int v = 0;
+  int expected = 0;
+  while (expected < 10)
+  {
+    while (q.pop(v))
+      EXPECT_EQ(v, expected++);
+    w.flush();
+  }
+  EXPECT_EQ(w.spilled(), 0U);
+  EXPECT_FALSE(w.saturated());
+}
+
+TEST(OverflowTest, NewElementsQueueBehindTheSpill)
+{
+  SmallQueue q;
+  Writer<SmallQueue, int> w(q, "test.overflow.order", Config{Policy::Spill});
+  for (int i = 0; i < 6; ++i)
+    w.push(i); // 0..3 queued, 4 and 5 spilled
+
+  int v = 0;
+  ASSERT_TRUE(q.pop(v)); // one free slot: the next push must deliver 4 first, then spill 6
+  w.push(6);
+  while (q.pop(v) && v < 4)
+    ;
+  EXPECT_EQ(v, 4);
+  EXPECT_EQ(w.spilled(), 2U);
+}
+
+TEST(OverflowTest, BlockWaitsForTheConsumer)
+{
+  SmallQueue q;
+  Writer<SmallQueue, int> w(q, "test.overflow.block", Config{Policy::Block});
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(w.push(i)); // full before the consumer starts, so the next push must stall
+  std::thread consumer(
+      [&]
+      {
+        int v = 0;
+        for (int expected = 0; expected < 100;)
+          if (q.pop(v))
+            EXPECT_EQ(v, expected++);
+          else
+            std::this_thread::yield();
+      });
+  for (int i = 4; i < 100; ++i)
+    EXPECT_TRUE(w.push(i));
+  consumer.join();
+  EXPECT_EQ(w.spilled(), 0U);
+  EXPECT_GT(stats::counter("test.overflow.block.stalls").value(), 0U);
+}
+
+TEST(OverflowTest, SpillLimitFallsBackToBlocking)
+{
+  SmallQueue q;
+  Writer<SmallQueue, int> w(q, "test.overflow.limit", Config{Policy::Spill, 2, 0});
+  std::thread consumer(
+      [&]
+      {
+        int v = 0;
+        for (int expected = 0; expected < 50;)
+          if (q.pop(v))
+            EXPECT_EQ(v, expected++);
+          else
+            std::this_thread::yield();
+      });
+  for (int i = 0; i < 50; ++i)
+  {
+    w.push(i);
+    EXPECT_LE(w.spilled(), 2U);
+  }
+  while (!w.flush())
+    std::this_thread::yield();
+  consumer.join();
+}
+
+TEST(OverflowTest, EngineSpillsExecsInsteadOfDroppingThem)
+{
+  OrderBook book;
+  auto exec_q = std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  auto md_q = std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  OutputPolicy output{};
+  output.exec.policy = Policy::Drop; // refused: execs are never dropped
+  MatchingEngine engine(book, *exec_q, *md_q, nullptr, output);
+
+  const u64 n = exec_q->capacity() + 100;
+  for (u64 i = 0; i < n; ++i)
+  {
+    EngineCommand cmd{};
+    const Price px = 1'000 - static_cast<Price>(i % 512);
+    cmd.new_order = NewOrder{i + 1, 1, Side::Buy, px, 1, TIF::Day, 0};
+    engine.on_command(cmd, 1);
+  }
+  EXPECT_TRUE(engine.output_saturated());
+
+  ExecEvent e;
+  u64 next_id = 1;
+  while (next_id <= n)
+  {
+    while (exec_q->pop(e))
+      EXPECT_EQ(e.order_id, next_id++);
+    engine.flush_output();
+  }
+  EXPECT_FALSE(engine.output_saturated());
+}
+} // namespace
+} // namespace hft::overflow
@@ -0,0 +1,53 @@
+// Exercise the macros as the HFT_ENABLE_PERF_COUNTERS build sees them.
+#define HFT_PERF_COUNTERS 1
+#include "common/perf_counters.hpp"
+
+#include <gtest/gtest.h>
+
+namespace hft::perf
+{
+namespace
+{
+u64 busy_work(u64 n)
+{
+  volatile u64 acc = 0;
+  for (u64 i = 0; i < n; ++i)
+    acc = acc + i * 2654435761u;
+  return acc;
+}
+
+TEST(PerfCountersTest, InertWithoutStart)
+{
+  PhaseCounters pc;
+  EXPECT_FALSE(pc.ok());
+  HFT_PERF_ENTER(pc, Match);
+  busy_work(1000);
+  HFT_PERF_LEAVE(pc);
+  EXPECT_EQ(pc.entries(Phase::Match), 0U);
+  EXPECT_EQ(pc.total(Phase::Match, Event::Instructions), 0U);
+  pc.report(); // nothing to report, must not crash
+}
+
+TEST(PerfCountersTest, ChargesInnermostPhase)
+{
+  PhaseCounters pc;
+  if (!pc.start())
+    GTEST_SKIP() << "no PMU access (VM or perf_event_paranoid)";
+
+  HFT_PERF_ENTER(pc, Sim);
+  busy_work(1'000);
+  HFT_PERF_ENTER(pc, Match);
+  busy_work(100'000);
+  HFT_PERF_LEAVE(pc);
+  HFT_PERF_LEAVE(pc);
+
+  EXPECT_EQ(pc.entries(Phase::Sim), 1U);
+  EXPECT_EQ(pc.entries(Phase::Match), 1U);
+  const u64 sim = pc.total(Phase::Sim, Event::Instructions);
+  const u64 match = pc.total(Phase::Match, Event::Instructions);
+  EXPECT_GT(match, 100'000U);
+  EXPECT_LT(sim, match); // nested work is not double counted
+  EXPECT_GT(pc.total(Phase::Match, Event::Cycles), 0U);
+}
+} // namespace
+} // namespace hft::perf
@@ -0,0 +1,102 @@
+#include "strategy/quote_manager.hpp"
+
+#include <gtest/gtest.h>
+
+namespace hft
+{
+namespace
+{
+ExecEvent exec(ExecType type, u64 order_id, Qty leaves = 0, u64 user_id = 0)
+{
+  ExecEvent e{};
+  e.type = type;
+  e.order_id = order_id;
+  e.user_id = user_id;
+  e.leaves = leaves;
+  return e;
+}
+
+TEST(QuoteManagerTest, TracksLeavesUntilTheQuoteIsGone)
+{
+  QuoteManager qm;
+  EXPECT_TRUE(qm.can_place(Side::Buy, 0));
+  qm.placed(Side::Buy, 7, 100, 5, 0);
+  qm.placed(Side::Sell, 8, 102, 5, 0);
+  EXPECT_FALSE(qm.can_place(Side::Buy, 1));
+
+  qm.on_exec(exec(ExecType::Ack, 7, 5));
+  qm.on_exec(exec(ExecType::Trade, 7, 3));
+  EXPECT_EQ(qm.working(Side::Buy).order_id, 7U);
+  EXPECT_EQ(qm.working(Side::Buy).leaves, 3);
+  qm.on_exec(exec(ExecType::Trade, 99, 0)); // someone else's order
+  qm.on_exec(exec(ExecType::Trade, 7, 0, 5)); // same id, another user's
+  EXPECT_EQ(qm.working(Side::Buy).leaves, 3);
+  qm.on_exec(exec(ExecType::Trade, 7, 0));
+  EXPECT_EQ(qm.working(Side::Buy).order_id, 0U);
+  EXPECT_TRUE(qm.can_place(Side::Buy, 1));
+
+  EXPECT_EQ(qm.working(Side::Sell).leaves, 5);
+  qm.on_exec(exec(ExecType::Reject, 8));
+  EXPECT_EQ(qm.working(Side::Sell).order_id, 0U);
+}
+
+TEST(QuoteManagerTest, KeepsQuotesWithinTheThreshold)
+{
+  QuoteManager qm(QuoteConfig{.requote_ticks = 2}, 5);
+  qm.placed(Side::Buy, 1, 1'000, 1, 0);
+  EXPECT_FALSE(qm.stale(Side::Buy, 1'000, 1));
+  EXPECT_FALSE(qm.stale(Side::Buy, 1'010, 1)); // two ticks of 5
+  EXPECT_FALSE(qm.stale(Side::Buy, 990, 1));
+  EXPECT_TRUE(qm.stale(Side::Buy, 1'015, 1));
+  EXPECT_FALSE(qm.stale(Side::Sell, 0, 1)); // nothing working there
+
+  EXPECT_EQ(qm.pulled(Side::Buy), 1U);
+  EXPECT_EQ(qm.working(Side::Buy).order_id, 0U);
+  EXPECT_FALSE(qm.stale(Side::Buy, 2'000, 1));
+}
+
+TEST(QuoteManagerTest, RateLimitsEachSide)
+{
+  QuoteManager qm(QuoteConfig{.min_requote_ns = 1'000});
+  qm.placed(Side::Buy, 1, 100, 1, 10);
+  EXPECT_FALSE(qm.stale(Side::Buy, 105, 500)); // far off, but too soon to replace
+  EXPECT_TRUE(qm.stale(Side::Buy, 105, 1'010));
+  EXPECT_TRUE(qm.can_place(Side::Sell, 500)); // the other side has its own budget
+
+  qm.on_exec(exec(ExecType::Trade, 1, 0)); // filled: the side still waits out its interval
+  EXPECT_FALSE(qm.can_place(Side::Buy, 500));
+  EXPECT_TRUE(qm.can_place(Side::Buy, 1'010));
+}
+
+TEST(QuoteManagerTest, BacksOffASideTheRiskGateRejects)
+{
+  QuoteManager qm(QuoteConfig{.min_requote_ns = 10, .risk_backoff_ns = 1'000});
+  ExecEvent rejected = exec(ExecType::Reject, 1);
+  rejected.code = RejectCode::Position;
+  qm.placed(Side::Buy, 1, 100, 1, 0);
+  qm.on_exec(rejected);
+  EXPECT_EQ(qm.working(Side::Buy).order_id, 0U);
+  EXPECT_FALSE(qm.can_place(Side::Buy, 999));
+  EXPECT_TRUE(qm.can_place(Side::Buy, 1'000));
+  EXPECT_TRUE(qm.can_place(Side::Sell, 10)); // the other side is not held back
+
+  rejected.order_id = 2;
+  rejected.code = RejectCode::Notional;
+  qm.placed(Side::Buy, 2, 100, 1, 1'000);
+  qm.on_exec(rejected);
+  EXPECT_EQ(qm.backoff_ns(Side::Buy), 2'000U); // doubles while the gate keeps saying no
+  EXPECT_FALSE(qm.can_place(Side::Buy, 2'999));
+  EXPECT_TRUE(qm.can_place(Side::Buy, 3'000));
+
+  rejected.order_id = 3;
+  rejected.code = RejectCode::DuplicateOrder; // not a risk reject: no back-off
+  qm.placed(Side::Buy, 3, 100, 1, 3'000);
+  qm.on_exec(rejected);
+  EXPECT_TRUE(qm.can_place(Side::Buy, 3'010));
+
+  qm.placed(Side::Buy, 4, 100, 1, 3'010);
+  qm.on_exec(exec(ExecType::Ack, 4, 1)); // accepted: the next risk reject starts over
+  EXPECT_EQ(qm.backoff_ns(Side::Buy), 0U);
+}
+} // namespace
+} // namespace hft
@@ -0,0 +1,146 @@
+#include "strategy/reactor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+using ExecQueue = Reactor<>::ExecQueue;
+using MdRing = Reactor<>::MdRing;
+
+// Appends what it saw to a log shared by every recorder, so tests can check the interleaving.
+struct Recorder
+{
+  std::string name;
+  std::vector<std::string> &log;
+  std::atomic<int> events{0};
+
+  void on_market_data(const MarketDataEvent &e)
+  {
+    log.push_back(name + ":md" + std::to_string(std::get<TopOfBook>(e).ts_ns));
+    events.fetch_add(1, std::memory_order_release);
+  }
+
+  void on_exec(const ExecEvent &e)
+  {
+    log.push_back(name + ":exec" + std::to_string(e.order_id));
+    events.fetch_add(1, std::memory_order_release);
+  }
+
+  void on_timer(u64)
+  {
+    log.push_back(name + ":timer");
+  }
+};
+
+ExecEvent exec_for(u64 user_id, u64 order_id)
+{
+  ExecEvent e{};
+  e.type = ExecType::Ack;
+  e.user_id = user_id;
+  e.order_id = order_id;
+  return e;
+}
+
+MarketDataEvent top(u64 ts_ns)
+{
+  return TopOfBook{99, 1, 101, 1, ts_ns};
+}
+
+class ReactorTest : public ::testing::Test
+{
+protected:
+  std::unique_ptr<ExecQueue> exec_q = std::make_unique<ExecQueue>();
+  std::unique_ptr<MdRing> md_q = std::make_unique<MdRing>();
+  std::vector<std::string> log;
+};
+
+TEST_F(ReactorTest, RoutesExecsByUserAndFansOutMarketData)
+{
+  Recorder a{"a", log};
+  Recorder b{"b", log};
+  ReactorConfig cfg{};
+  cfg.timer_ns = 1'000;
+  Reactor<Recorder> reactor(*exec_q, *md_q, cfg);
+  ASSERT_TRUE(reactor.add(b, 2));
+  ASSERT_TRUE(reactor.add(a, 1));
+  EXPECT_FALSE(reactor.add(a, 1));
+  EXPECT_EQ(reactor.size(), 2U);
+
+  exec_q->push(exec_for(2, 20));
+  exec_q->push(exec_for(9, 90)); // nobody's
+  exec_q->push(exec_for(1, 10));
+  md_q->push(top(5));
+  EXPECT_TRUE(reactor.poll(0));
+
+  const std::vector<std::string> expect{"b:exec20", "a:exec10", "a:md5",
+                                        "b:md5",    "a:timer",  "b:timer"};
+  EXPECT_EQ(log, expect);
+
+  log.clear();
+  EXPECT_FALSE(reactor.poll(999)); // nothing queued and the timer not yet due
+  EXPECT_TRUE(reactor.poll(1'000));
+  EXPECT_EQ(log, (std::vector<std::string>{"a:timer", "b:timer"}));
+}
+
+TEST_F(ReactorTest, ExecsGoFirstInBoundedBatches)
+{
+  Recorder a{"a", log};
+  ReactorConfig cfg{};
+  cfg.timer_ns = 1'000'000;
+  cfg.exec_batch = 2;
+  cfg.md_batch = 3;
+  Reactor<Recorder> reactor(*exec_q, *md_q, cfg);
+  reactor.add(a, 1);
+  for (u64 i = 1; i <= 5; ++i)
+  {
+    md_q->push(top(i));
+    exec_q->push(exec_for(1, i));
+  }
+
+  reactor.poll(0);
+  EXPECT_EQ(log, (std::vector<std::string>{"a:exec1", "a:exec2", "a:md1", "a:md2", "a:md3",
+                                           "a:timer"}));
+  log.clear();
+  reactor.poll(1);
+  EXPECT_EQ(log, (std::vector<std::string>{"a:exec3", "a:exec4", "a:md4", "a:md5"}));
+  log.clear();
+  reactor.poll(2);
+  EXPECT_EQ(log, (std::vector<std::string>{"a:exec5"}));
+}
+
+TEST_F(ReactorTest, HostsStrategiesBehindTheVirtualInterface)
+{
+  Recorder a{"a", log};
+  StrategyAdapter<Recorder> any(a);
+  Reactor<IStrategy> reactor(*exec_q, *md_q);
+  reactor.add(any, 7);
+  exec_q->push(exec_for(7, 70));
+  reactor.poll(0);
+  EXPECT_EQ(log, (std::vector<std::string>{"a:exec70", "a:timer"}));
+}
+
+TEST_F(ReactorTest, RunsOnItsOwnThread)
+{
+  Recorder a{"a", log};
+  Reactor<Recorder> reactor(*exec_q, *md_q);
+  reactor.add(a, 1);
+  reactor.start();
+  for (u64 i = 1; i <= 100; ++i)
+  {
+    exec_q->push(exec_for(1, i));
+    md_q->push(top(i));
+    md_q->notify(); // as EngineThread does after each batch
+  }
+  for (int spins = 0; a.events.load(std::memory_order_acquire) < 200 && spins < 5'000; ++spins)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  reactor.stop();
+  EXPECT_EQ(a.events.load(), 200);
+}
+} // namespace
+} // namespace hft
@@ -0,0 +1,121 @@
+#include "market/matching_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace hft
+{
+namespace
+{
+class RiskGateTest : public ::testing::Test
+{
+protected:
+  OrderBook book;
+  std::unique_ptr<spsc::Queue<ExecEvent, 1 << 14>> exec_q =
+      std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  std::unique_ptr<broadcast::Ring<MarketDataEvent, 1 << 14>> md_q =
+      std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  MatchingEngine engine{book, *exec_q, *md_q};
+
+  // Sends the order and returns the last exec it produced.
+  ExecEvent send(u64 order_id, u64 user_id, Side side, Price px, Qty qty, TIF tif = TIF::Day)
+  {
+    engine.on_command(EngineCommand{EngineCommand::Kind::New,
+                                    NewOrder{order_id, user_id, side, px, qty, tif, 0},
+                                    {},
+                                    {}},
+                      1);
+    ExecEvent e{}, last{};
+    while (exec_q->pop(e))
+      last = e;
+    return last;
+  }
+
+  ExecEvent cancel(u64 order_id, u64 user_id)
+  {
+    engine.on_command(
+        EngineCommand{EngineCommand::Kind::Cancel, {}, CancelOrder{order_id, user_id, 0}, {}}, 1);
+    ExecEvent e{};
+    EXPECT_TRUE(exec_q->pop(e));
+    return e;
+  }
+};
+
+TEST_F(RiskGateTest, RejectsBreachesBeforeMatching)
+{
+  ASSERT_TRUE(engine.set_risk_limits(1, RiskLimits{.max_order_qty = 5, .price_collar = 2}));
+  EXPECT_FALSE(engine.set_risk_limits(RiskGate::kMaxUsers, RiskLimits{}));
+  auto md = md_q->subscribe();
+  engine.add_passive(NewOrder{10, 9, Side::Sell, 101, 10, TIF::Day, 0});
+
+  const ExecEvent big = send(1, 1, Side::Buy, 101, 6);
+  EXPECT_EQ(big.type, ExecType::Reject);
+  EXPECT_EQ(big.code, RejectCode::OrderQty);
+  EXPECT_EQ(big.reason, "risk: order qty");
+  MarketDataEvent ev;
+  EXPECT_FALSE(md.pop(ev)); // never reached the book
+
+  EXPECT_EQ(send(2, 1, Side::Buy, 104, 1).code, RejectCode::PriceCollar); // 3 over the ask
+  EXPECT_EQ(send(3, 1, Side::Buy, 103, 1).type, ExecType::Trade);
+  EXPECT_EQ(send(4, 1, Side::Sell, 98, 1).code, RejectCode::PriceCollar); // asks only: 3 under
+  EXPECT_EQ(send(5, 9, Side::Buy, 200, 50).type, ExecType::Ack);          // user 9 has no limits
+  EXPECT_EQ(engine.exposure(9), nullptr);
+
+  const ExecEvent unknown = cancel(77, 1);
+  EXPECT_EQ(unknown.code, RejectCode::UnknownOrder);
+  EXPECT_EQ(unknown.reason, "unknown order id");
+}
+
+TEST_F(RiskGateTest, TracksBothSidesOfEveryFill)
+{
+  engine.set_risk_limits(1, RiskLimits{});
+  engine.set_risk_limits(2, RiskLimits{});
+  engine.add_passive(NewOrder{10, 1, Side::Sell, 101, 4, TIF::Day, 0});
+  EXPECT_EQ(send(11, 1, Side::Sell, 102, 2).type, ExecType::Ack);
+  EXPECT_EQ(engine.exposure(1)->open_orders, 2U);
+  EXPECT_EQ(engine.exposure(1)->open_sell, 6);
+
+  EXPECT_EQ(send(20, 2, Side::Buy, 101, 3, TIF::IOC).type, ExecType::Trade);
+  const RiskExposure &maker = *engine.exposure(1);
+  const RiskExposure &taker = *engine.exposure(2);
+  EXPECT_EQ(maker.position, -3);
+  EXPECT_EQ(taker.position, 3);
+  EXPECT_EQ(maker.notional, 303);
+  EXPECT_EQ(taker.notional, 303);
+  EXPECT_EQ(maker.open_sell, 3);
+  EXPECT_EQ(maker.open_orders, 2U);
+  EXPECT_EQ(taker.open_orders, 0U);
+
+  send(21, 2, Side::Buy, 101, 1); // takes the rest of order 10
+  EXPECT_EQ(maker.open_orders, 1U);
+  EXPECT_EQ(maker.position, -4);
+  EXPECT_EQ(cancel(11, 1).type, ExecType::CancelAck);
+  EXPECT_EQ(maker.open_orders, 0U);
+  EXPECT_EQ(maker.open_sell, 0);
+}
+
+TEST_F(RiskGateTest, CountsOpenOrdersTowardsPositionAndOpenOrderLimits)
+{
+  engine.set_risk_limits(1, RiskLimits{.max_open_orders = 2, .max_position = 5});
+  EXPECT_EQ(send(1, 1, Side::Buy, 100, 3).type, ExecType::Ack);
+  EXPECT_EQ(send(2, 1, Side::Buy, 99, 3).code, RejectCode::Position); // 3 resting + 3 > 5
+  EXPECT_EQ(send(3, 1, Side::Sell, 110, 5).type, ExecType::Ack); // sells only offset the long
+  EXPECT_EQ(send(4, 1, Side::Buy, 98, 1).code, RejectCode::OpenOrders);
+  EXPECT_EQ(send(5, 1, Side::Buy, 98, 1, TIF::IOC).type, ExecType::Ack); // never rests
+
+  cancel(3, 1);
+  EXPECT_EQ(send(6, 1, Side::Buy, 98, 2).type, ExecType::Ack);
+}
+
+TEST_F(RiskGateTest, CapsGrossNotional)
+{
+  engine.set_risk_limits(1, RiskLimits{.max_notional = 1'000});
+  engine.add_passive(NewOrder{10, 9, Side::Sell, 100, 20, TIF::Day, 0});
+  EXPECT_EQ(send(1, 1, Side::Buy, 100, 8).type, ExecType::Trade);
+  EXPECT_EQ(send(2, 1, Side::Buy, 100, 3).code, RejectCode::Notional); // 800 + 300
+  EXPECT_EQ(send(3, 1, Side::Buy, 100, 2).type, ExecType::Trade);
+  EXPECT_EQ(engine.exposure(1)->notional, 1'000);
+}
+} // namespace
+} // namespace hft
@@ -19,6 +19,19 @@ TEST(RiskManagerTest, CanQuoteBlockedWhenPositionLimitZero)
   EXPECT_FALSE(risk.can_quote(1));
 }
 
+TEST(RiskManagerTest, CanQuoteCountsTheQuoteAgainstTradedNotional)
+{
+  RiskManager risk(10, 1'000, 5);
+  ExecEvent traded{};
+  traded.type = ExecType::Trade;
+  traded.price = 100;
+  traded.filled = 7;
+  risk.on_exec(traded);
+
+  EXPECT_TRUE(risk.can_quote(3, 100));
+  EXPECT_FALSE(risk.can_quote(4, 100)); // 700 + 400
+}
+
 TEST(RiskManagerTest, OnExecAccumulatesNotional)
 {
   RiskManager risk(10, 1'000'000, 5);
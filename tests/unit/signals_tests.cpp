@@ -0,0 +1,160 @@
+#include "strategy/signals.hpp"
+
+#include "common/random.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+// A random walk in ticks around 10'000, the shape of a mid-price series.
+std::vector<Price> walk(std::size_t n, u64 seed)
+{
+  rng::Xoshiro256 gen(seed);
+  std::vector<Price> out;
+  Price p = 10'000;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    p += static_cast<Price>(gen.next() % 5) - 2;
+    out.push_back(p);
+  }
+  return out;
+}
+
+// The newest min(L, i + 1) samples ending at index i.
+std::vector<Price> tail(const std::vector<Price> &xs, std::size_t i, std::size_t len)
+{
+  const std::size_t from = i + 1 >= len ? i + 1 - len : 0;
+  return {xs.begin() + static_cast<std::ptrdiff_t>(from),
+          xs.begin() + static_cast<std::ptrdiff_t>(i + 1)};
+}
+
+TEST(SignalsTest, RollingMeanMatchesARecomputedWindow)
+{
+  const std::vector<Price> xs = walk(3'000, 1);
+  for (const std::size_t len : {std::size_t{1}, std::size_t{7}, std::size_t{64}, std::size_t{256}})
+  {
+    signal::RollingMean<Price, 256> mean(len);
+    EXPECT_EQ(mean.length(), len);
+    for (std::size_t i = 0; i < xs.size(); ++i)
+    {
+      mean.push(xs[i]);
+      const std::vector<Price> w = tail(xs, i, len);
+      i64 sum = 0;
+      for (const Price p : w)
+        sum += p;
+      ASSERT_EQ(mean.sum(), sum) << "len " << len << " at " << i;
+      ASSERT_EQ(mean.size(), w.size());
+      ASSERT_DOUBLE_EQ(mean.mean(), static_cast<double>(sum) / static_cast<double>(w.size()));
+    }
+  }
+  signal::RollingMean<Price, 16> clamped(100);
+  EXPECT_EQ(clamped.length(), 16U);
+}
+
+TEST(SignalsTest, RollingVarianceMatchesATwoPassVariance)
+{
+  const std::vector<Price> xs = walk(3'000, 2);
+  for (const std::size_t len : {std::size_t{2}, std::size_t{20}, std::size_t{128}})
+  {
+    signal::RollingVariance<128> var(len);
+    for (std::size_t i = 0; i < xs.size(); ++i)
+    {
+      var.push(static_cast<double>(xs[i]));
+      const std::vector<Price> w = tail(xs, i, len);
+      double mean = 0;
+      for (const Price p : w)
+        mean += static_cast<double>(p);
+      mean /= static_cast<double>(w.size());
+      double ss = 0;
+      for (const Price p : w)
+        ss += (static_cast<double>(p) - mean) * (static_cast<double>(p) - mean);
+      const double expect = w.size() < 2 ? 0.0 : ss / static_cast<double>(w.size() - 1);
+      ASSERT_NEAR(var.mean(), mean, 1e-6) << "len " << len << " at " << i;
+      ASSERT_NEAR(var.variance(), expect, 1e-6 * std::max(1.0, expect)) << "len " << len;
+    }
+  }
+
+  signal::RollingVariance<8> flat;
+  for (int i = 0; i < 100; ++i)
+    flat.push(10'000.0);
+  EXPECT_EQ(flat.variance(), 0.0);
+  EXPECT_EQ(flat.stddev(), 0.0);
+}
+
+TEST(SignalsTest, RollingMinAndMaxFollowTheWindow)
+{
+  const std::vector<Price> xs = walk(3'000, 3);
+  for (const std::size_t len : {std::size_t{1}, std::size_t{5}, std::size_t{64}})
+  {
+    signal::RollingMin<Price, 64> lo(len);
+    signal::RollingMax<Price, 64> hi(len);
+    EXPECT_TRUE(lo.empty());
+    for (std::size_t i = 0; i < xs.size(); ++i)
+    {
+      lo.push(xs[i]);
+      hi.push(xs[i]);
+      const std::vector<Price> w = tail(xs, i, len);
+      ASSERT_EQ(lo.value(), *std::min_element(w.begin(), w.end())) << "len " << len << " at " << i;
+      ASSERT_EQ(hi.value(), *std::max_element(w.begin(), w.end())) << "len " << len << " at " << i;
+    }
+  }
+
+  // On a falling series the minimum is always the newest sample and the maximum the oldest still
+  // in the window, so the min deque holds one entry and the max deque a full window.
+  signal::RollingMax<Price, 4> hi;
+  signal::RollingMin<Price, 4> lo;
+  for (Price p = 100; p > 0; --p)
+  {
+    hi.push(p);
+    lo.push(p);
+    EXPECT_EQ(lo.value(), p);
+    EXPECT_EQ(hi.value(), std::min<Price>(100, p + 3));
+  }
+}
+
+TEST(SignalsTest, EwmaHalvesAStepEveryHalfLife)
+{
+  signal::Ewma e = signal::Ewma::half_life(10);
+  e.push(0); // seeds without smoothing
+  EXPECT_EQ(e.value(), 0.0);
+  for (int i = 0; i < 10; ++i)
+    e.push(100);
+  EXPECT_NEAR(e.value(), 50.0, 1e-9);
+  for (int i = 0; i < 10; ++i)
+    e.push(100);
+  EXPECT_NEAR(e.value(), 75.0, 1e-9);
+
+  signal::Ewma fast(1.0);
+  fast.push(3);
+  fast.push(7);
+  EXPECT_EQ(fast.value(), 7.0);
+}
+
+TEST(SignalsTest, VwapWeightsPricesByQuantity)
+{
+  signal::Vwap<4> last2(2);
+  signal::SessionVwap session;
+  EXPECT_EQ(last2.value(), 0.0);
+  const TradePrint prints[] = {{100, 1, Side::Buy, 0}, {102, 3, Side::Sell, 0},
+                               {104, 1, Side::Buy, 0}, {90, 5, Side::Sell, 0}};
+  for (const TradePrint &t : prints)
+  {
+    last2.on_trade(t);
+    session.on_trade(t);
+  }
+  EXPECT_EQ(last2.volume(), 6); // the last two prints
+  EXPECT_DOUBLE_EQ(last2.value(), (104.0 * 1 + 90.0 * 5) / 6);
+  EXPECT_EQ(session.volume(), 10);
+  EXPECT_DOUBLE_EQ(session.value(), (100.0 + 102.0 * 3 + 104.0 + 90.0 * 5) / 10);
+  session.reset();
+  EXPECT_EQ(session.volume(), 0);
+  EXPECT_EQ(session.value(), 0.0);
+}
+} // namespace
+} // namespace hft
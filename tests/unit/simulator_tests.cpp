@@ -1,8 +1,12 @@
+#include "market/matching_engine.hpp"
 #include "market/order_book.hpp"
 #include "market/simulator.hpp"
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace hft
@@ -43,6 +47,21 @@ struct RecordingEngine
   }
 };
 
+struct CancellingEngine : RecordingEngine
+{
+  std::vector<CancelOrder> cancels;
+
+  void add_passive(const NewOrder &n) // seed_book
+  {
+    seen.push_back(n);
+  }
+
+  void inject_cancel(const CancelOrder &c)
+  {
+    cancels.push_back(c);
+  }
+};
+
 TEST(SimulatorTest, StepTightensSpreadWhenConfigured)
 {
   StreetFlowConfig cfg{};
@@ -66,5 +85,219 @@ TEST(SimulatorTest, StepTightensSpreadWhenConfigured)
   EXPECT_EQ(engine.seen[1].side, Side::Sell);
   EXPECT_EQ(engine.seen[1].price, 103);
 }
+TEST(SimulatorTest, ArrivalModelPlaysArrivalsDueByEachStep)
+{
+  StreetFlowConfig cfg{};
+  cfg.model = FlowModel::Arrivals;
+  cfg.arrivals.add_rate = 10'000;
+  cfg.arrivals.market_rate = 1'000;
+  cfg.arrivals.cancel_rate = 50; // per resting order: about 200 rest once adds and cancels balance
+
+  Simulator sim(cfg);
+  CancellingEngine engine;
+  engine.snapshot.bid_price = 100;
+  engine.snapshot.ask_price = 104;
+
+  sim.step(engine, 1'000'000); // starts the process; nothing is due yet
+  EXPECT_TRUE(engine.seen.empty());
+  EXPECT_GT(sim.next_step_ns(1'000'000), 1'000'000U);
+  sim.step(engine, 101'000'000); // 100 ms: about 1100 orders and 800 cancels
+
+  ASSERT_GT(engine.seen.size(), 900U);
+  EXPECT_LT(engine.seen.size(), 1'300U);
+  EXPECT_GT(engine.cancels.size(), 500U);
+  EXPECT_LT(engine.cancels.size(), 1'000U);
+  EXPECT_GT(sim.next_step_ns(101'000'000), 101'000'000U);
+  u64 last = 0;
+  for (const NewOrder &n : engine.seen)
+  {
+    EXPECT_GE(n.ts_ns, last);
+    EXPECT_LE(n.ts_ns, 101'000'000U);
+    last = n.ts_ns;
+    if (n.tif == TIF::IOC) // marketable: at the opposite best
+      EXPECT_EQ(n.price, n.side == Side::Buy ? 104 : 100);
+    else if (n.side == Side::Buy) // passive: at most one tick inside the ask
+      EXPECT_LE(n.price, 103);
+    else
+      EXPECT_GE(n.price, 101);
+  }
+}
+TEST(SimulatorTest, ExpiredOrdersArePulledOrRepricedNearTheTouch)
+{
+  StreetFlowConfig cfg{};
+  cfg.mid = 100;
+  cfg.max_depth_levels = 3;
+  cfg.lifecycle.mean_lifetime_ns = 1'000; // everything expires within the first sweep
+  cfg.lifecycle.max_distance = 4;
+
+  for (double modify : {0.0, 1.0})
+  {
+    cfg.lifecycle.modify_prob = modify;
+    Simulator sim(cfg);
+    CancellingEngine engine;
+    engine.snapshot.bid_price = 99;
+    engine.snapshot.ask_price = 101;
+    sim.seed_book(engine, 0);
+    ASSERT_EQ(sim.live_orders(), 6U);
+    const std::size_t seeded = engine.seen.size();
+
+    sim.step(engine, 1'000'000);
+    ASSERT_EQ(engine.cancels.size(), 6U);
+    // The sweep runs before the step's own flow, so replacements come first.
+    const std::size_t expect = modify == 0.0 ? 0 : 6;
+    ASSERT_GE(engine.seen.size() - seeded, expect);
+    for (std::size_t i = seeded; i < seeded + expect; ++i)
+    {
+      const NewOrder &n = engine.seen[i];
+      if (n.side == Side::Buy) // at or behind its own touch, within max_distance
+      {
+        EXPECT_LE(n.price, 99);
+        EXPECT_GE(n.price, 99 - 4);
+      }
+      else
+      {
+        EXPECT_GE(n.price, 101);
+        EXPECT_LE(n.price, 101 + 4);
+      }
+      EXPECT_EQ(n.qty, 10);
+    }
+  }
+}
+
+TEST(SimulatorTest, OrdersLeftBehindTheTouchArePulled)
+{
+  StreetFlowConfig cfg{};
+  cfg.mid = 100;
+  cfg.max_depth_levels = 5;
+  cfg.lifecycle.mean_lifetime_ns = 0; // live forever unless left behind
+  cfg.lifecycle.max_distance = 2;
+
+  Simulator sim(cfg);
+  CancellingEngine engine;
+  engine.snapshot.bid_price = 99;
+  engine.snapshot.ask_price = 101;
+  sim.seed_book(engine, 0); // bids 99..95, asks 101..105
+  sim.step(engine, 1'000'000);
+  // Three ticks or more behind: bids 96 and 95, asks 104 and 105.
+  ASSERT_EQ(engine.cancels.size(), 4U);
+  for (const CancelOrder &c : engine.cancels)
+  {
+    const NewOrder &n = engine.seen[c.order_id - Simulator::kFirstOrderId];
+    ASSERT_EQ(n.order_id, c.order_id);
+    EXPECT_TRUE(n.side == Side::Buy ? n.price <= 96 : n.price >= 104);
+  }
+}
+
+// Runs the simulator against a real matching engine, as the engine thread and the backtester do.
+struct BookExchange
+{
+  std::unique_ptr<spsc::Queue<ExecEvent, 1 << 14>> exec_q =
+      std::make_unique<spsc::Queue<ExecEvent, 1 << 14>>();
+  std::unique_ptr<broadcast::Ring<MarketDataEvent, 1 << 14>> md_q =
+      std::make_unique<broadcast::Ring<MarketDataEvent, 1 << 14>>();
+  OrderBook book;
+  MatchingEngine engine{book, *exec_q, *md_q};
+  u64 now{0};
+  std::set<u64> traded;                // users whose orders took liquidity
+  std::unordered_map<u64, u64> owners; // order id -> user, for orders sent through inject_new
+  std::size_t foreign_cancels{0};      // cancels sent by a user other than the order's owner
+
+  TopOfBook top_snapshot() const
+  {
+    return book.top(now);
+  }
+
+  void inject_new(const NewOrder &n)
+  {
+    owners[n.order_id] = n.user_id;
+    engine.on_command(EngineCommand{EngineCommand::Kind::New, n, {}, {}}, now);
+  }
+
+  void inject_cancel(const CancelOrder &c)
+  {
+    if (auto it = owners.find(c.order_id); it != owners.end() && it->second != c.user_id)
+      ++foreign_cancels;
+    engine.on_command(EngineCommand{EngineCommand::Kind::Cancel, {}, c, {}}, now);
+  }
+
+  bool resting(u64 order_id) const noexcept
+  {
+    Price px;
+    Side side;
+    return book.find(order_id, px, side);
+  }
+
+  // Book size after each of `checkpoints` equal slices of `duration_ns`.
+  std::vector<std::size_t> run(Simulator &sim, u64 duration_ns, int checkpoints)
+  {
+    std::vector<std::size_t> sizes;
+    sim.seed_book(engine, now);
+    ExecEvent e;
+    for (int c = 1; c <= checkpoints; ++c)
+    {
+      const u64 until = duration_ns / static_cast<u64>(checkpoints) * static_cast<u64>(c);
+      for (; now < until; now += 100'000)
+      {
+        sim.step(*this, now);
+        while (exec_q->pop(e))
+          if (e.type == ExecType::Trade)
+            traded.insert(e.user_id);
+      }
+      sizes.push_back(book.order_count());
+    }
+    return sizes;
+  }
+};
+
+TEST(SimulatorTest, LifecycleKeepsTheBookAtASteadySize)
+{
+  StreetFlowConfig cfg{};
+  Simulator sim(cfg);
+  auto ex = std::make_unique<BookExchange>();
+  const std::vector<std::size_t> sizes = ex->run(sim, 20'000'000'000, 4);
+  // Adds live 50 ms on average, and many trade or fall behind sooner: tens of orders rest at any
+  // time, early or late.
+  for (std::size_t n : sizes)
+  {
+    EXPECT_GT(n, 20U);
+    EXPECT_LT(n, 2'000U);
+  }
+  EXPECT_LT(sizes.back(), sizes.front() * 2);
+  EXPECT_LT(sim.live_orders(), 2 * sizes.back() + 100); // fills are forgotten at each sweep
+
+  // Without a lifecycle the same flow only ever grows the book.
+  cfg.lifecycle.mean_lifetime_ns = 0;
+  cfg.lifecycle.max_distance = 0;
+  Simulator unbounded(cfg);
+  auto ex2 = std::make_unique<BookExchange>();
+  const std::vector<std::size_t> grown = ex2->run(unbounded, 20'000'000'000, 4);
+  EXPECT_GT(grown.back(), grown.front());
+  EXPECT_GT(grown.back(), 10 * sizes.back());
+}
+TEST(SimulatorTest, AgentModelTradesAgainstARealBook)
+{
+  StreetFlowConfig cfg{};
+  cfg.model = FlowModel::Agents;
+  Simulator sim(cfg);
+  auto ex = std::make_unique<BookExchange>();
+  const std::vector<std::size_t> sizes = ex->run(sim, 10'000'000'000, 2);
+
+  // 500 noise traders at 4/s, 20 providers at 200/s, 10 momentum takers at 50/s, 2 TWAPs at 2/s.
+  EXPECT_NEAR(static_cast<double>(sim.agents().actions()), 65'040.0, 2'000.0);
+  // Noise takers, momentum takers and TWAP slices all trade, each under its own id.
+  EXPECT_GT(ex->traded.size(), 100U);
+  for (u64 user : ex->traded)
+    EXPECT_GE(user, cfg.agents.first_user);
+  // Orders the lifecycle pulls are cancelled by whoever placed them, and no id is reused.
+  EXPECT_EQ(ex->foreign_cancels, 0U);
+  for (const auto &[id, user] : ex->owners)
+    EXPECT_GE(id, Simulator::kFirstOrderId);
+  // Providers hold 40 quotes; noise adds are retired by the lifecycle.
+  for (std::size_t n : sizes)
+  {
+    EXPECT_GT(n, 20U);
+    EXPECT_LT(n, 2'000U);
+  }
+}
 } // namespace
 } // namespace hft
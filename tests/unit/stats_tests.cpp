@@ -0,0 +1,103 @@
+#include "common/stats.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace hft::stats
+{
+namespace
+{
+const Entry *find(const Page &page, const char *name)
+{
+  const u32 n = page.header.count.load(std::memory_order_acquire);
+  for (u32 i = 0; i < n; ++i)
+    if (std::strcmp(page.entries[i].name, name) == 0)
+      return &page.entries[i];
+  return nullptr;
+}
+
+TEST(StatsTest, RegistrationIsIdempotentAndLaidOutPerCacheLine)
+{
+  Registry reg;
+  Counter a = reg.counter("test.orders");
+  Counter b = reg.counter("test.orders"); // second registration shares the slot
+  Gauge depth = reg.gauge("test.depth");
+  a.add();
+  b.add(2);
+  depth.set(17);
+
+  const Page &page = *reg.page();
+  EXPECT_EQ(std::memcmp(page.header.magic, kMagic, sizeof(kMagic)), 0);
+  EXPECT_EQ(page.header.count.load(), 2U);
+  const Entry *orders = find(page, "test.orders");
+  const Entry *gauge = find(page, "test.depth");
+  ASSERT_NE(orders, nullptr);
+  ASSERT_NE(gauge, nullptr);
+  EXPECT_EQ(orders->kind, Kind::Counter);
+  EXPECT_EQ(orders->value.load(), 3U);
+  EXPECT_EQ(gauge->kind, Kind::Gauge);
+  EXPECT_EQ(gauge->value.load(), 17U);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&orders->value) / 64,
+            reinterpret_cast<std::uintptr_t>(orders) / 64);
+  EXPECT_NE(reinterpret_cast<std::uintptr_t>(orders) / 64,
+            reinterpret_cast<std::uintptr_t>(gauge) / 64);
+}
+
+TEST(StatsTest, PrivateScopeKeepsRegistrationsOutOfThePage)
+{
+  Registry reg;
+  Counter shared = reg.counter("test.private");
+  {
+    Private outer;
+    Counter mine = reg.counter("test.private");
+    mine.add(5);
+    {
+      Private inner;
+      reg.counter("test.private").add(7);
+      EXPECT_EQ(inner.value("test.private"), 7U);
+    }
+    reg.counter("test.private").add(); // back in the outer scope
+    EXPECT_EQ(outer.value("test.private"), 6U);
+    EXPECT_EQ(outer.value("test.missing"), 0U);
+  }
+  EXPECT_EQ(shared.value(), 0U);
+  EXPECT_EQ(reg.page()->header.count.load(), 1U);
+}
+
+#if defined(HFT_HAVE_SHM_STATS)
+TEST(StatsTest, PublishedPageIsVisibleToOtherMappings)
+{
+  Registry reg;
+  Counter before = reg.counter("test.before_publish");
+  before.add(5);
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "/hft_stats_test.%d", static_cast<int>(getpid()));
+  if (!reg.publish(name))
+    GTEST_SKIP() << "POSIX shared memory unavailable";
+  EXPECT_STREQ(reg.shm_name(), name);
+
+  Counter after = reg.counter("test.after_publish");
+  before.add(1); // handle taken before publish keeps working
+  after.add(9);
+
+  const int fd = shm_open(name, O_RDONLY, 0);
+  ASSERT_GE(fd, 0);
+  void *mem = mmap(nullptr, sizeof(Page), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(mem, MAP_FAILED);
+  const Page &view = *static_cast<const Page *>(mem);
+  const Entry *b = find(view, "test.before_publish");
+  const Entry *a = find(view, "test.after_publish");
+  ASSERT_NE(b, nullptr);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(b->value.load(), 6U);
+  EXPECT_EQ(a->value.load(), 9U);
+  EXPECT_EQ(view.header.pid, static_cast<u64>(getpid()));
+  munmap(mem, sizeof(Page));
+}
+#endif
+} // namespace
+} // namespace hft::stats
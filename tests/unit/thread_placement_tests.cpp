@@ -0,0 +1,78 @@
+#include "common/thread_placement.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace hft
+{
+namespace
+{
+TEST(ThreadPlacementTest, ParsesRolesCpusAndFifo)
+{
+  PlacementConfig cfg{};
+  ASSERT_TRUE(parse_placement("engine=2:fifo:80,md=3,exec=4", cfg));
+
+  EXPECT_EQ(cfg[ThreadRole::Engine].cpu, 2);
+  EXPECT_TRUE(cfg[ThreadRole::Engine].fifo);
+  EXPECT_EQ(cfg[ThreadRole::Engine].fifo_priority, 80);
+  EXPECT_EQ(cfg[ThreadRole::MdConsumer].cpu, 3);
+  EXPECT_FALSE(cfg[ThreadRole::MdConsumer].fifo);
+  EXPECT_EQ(cfg[ThreadRole::ExecConsumer].cpu, 4);
+  EXPECT_EQ(cfg[ThreadRole::Simulator].cpu, -1);
+}
+
+TEST(ThreadPlacementTest, RejectsMalformedSpecs)
+{
+  PlacementConfig cfg{};
+  EXPECT_FALSE(parse_placement("gateway=1", cfg));
+  EXPECT_FALSE(parse_placement("engine", cfg));
+  EXPECT_FALSE(parse_placement("engine=x", cfg));
+  EXPECT_FALSE(parse_placement("engine=1:rr", cfg));
+  EXPECT_FALSE(parse_placement("engine=1:fifo:0", cfg));
+}
+
+TEST(ThreadPlacementTest, ParsesKernelCpuLists)
+{
+  EXPECT_EQ(parse_cpu_list("0-2,5,7-8\n"), (std::vector<int>{0, 1, 2, 5, 7, 8}));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+TEST(ThreadPlacementTest, ValidationFlagsSharedAndMissingCpus)
+{
+  PlacementConfig cfg{};
+  cfg[ThreadRole::Engine].cpu = 0;
+  cfg[ThreadRole::MdConsumer].cpu = 0;     // shares the engine core
+  cfg[ThreadRole::ExecConsumer].cpu = 4096; // no such cpu
+  EXPECT_GE(validate_placement(cfg), 2);
+
+  PlacementConfig unpinned{};
+  EXPECT_EQ(validate_placement(unpinned), 0);
+}
+
+#if defined(__linux__)
+TEST(ThreadPlacementTest, PinsCallingThread)
+{
+  cpu_set_t original;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(original), &original), 0);
+  int target = -1;
+  for (int c = 0; c < CPU_SETSIZE && target < 0; ++c)
+    if (CPU_ISSET(c, &original))
+      target = c;
+  ASSERT_GE(target, 0);
+
+  ThreadPlacement p{};
+  p.cpu = target;
+  EXPECT_TRUE(apply_placement(ThreadRole::Engine, p));
+  EXPECT_EQ(sched_getcpu(), target);
+
+  // Restore the test runner's original mask.
+  sched_setaffinity(0, sizeof(original), &original);
+}
+#endif
+} // namespace
+} // namespace hft
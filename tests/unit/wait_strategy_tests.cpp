@@ -0,0 +1,88 @@
+#include "common/spsc_queue.hpp"
+#include "common/wait_strategy.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace hft::wait
+{
+namespace
+{
+TEST(WaitStrategyTest, SpinYieldEscalatesAfterSpinBudget)
+{
+  WaitConfig cfg{};
+  cfg.policy = WaitPolicy::SpinYield;
+  cfg.spin_polls = 2;
+  Waiter waiter(cfg);
+
+  for (int i = 0; i < 5; ++i)
+    waiter.idle([] { return false; });
+  EXPECT_EQ(waiter.stats().spins, 2U);
+  EXPECT_EQ(waiter.stats().yields, 3U);
+
+  // Doing work restarts the cheap spin phase.
+  waiter.reset();
+  waiter.idle([] { return false; });
+  EXPECT_EQ(waiter.stats().spins, 3U);
+  EXPECT_EQ(waiter.stats().policy, WaitPolicy::SpinYield);
+}
+
+TEST(WaitStrategyTest, SpinParkSkipsParkingWhenAlreadyReady)
+{
+  EventCount ec;
+  WaitConfig cfg{};
+  cfg.spin_polls = 0;
+  cfg.yield_polls = 0;
+  Waiter waiter(cfg, &ec);
+
+  waiter.idle([] { return true; });
+  EXPECT_EQ(waiter.stats().parks, 0U);
+}
+
+TEST(WaitStrategyTest, NotifyWakesParkedConsumer)
+{
+  spsc::Queue<int, 8> q;
+  WaitConfig cfg{};
+  cfg.policy = WaitPolicy::SpinPark;
+  cfg.spin_polls = 0;
+  cfg.yield_polls = 0;
+  cfg.park_ns = 5'000'000'000ULL; // far longer than the test is allowed to take
+
+  std::thread producer(
+      [&]
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        q.push(7);
+        q.notify();
+      });
+
+  Waiter waiter(cfg, &q.event());
+  const auto start = std::chrono::steady_clock::now();
+  int value = 0;
+  while (!q.pop(value))
+    waiter.idle([&] { return !q.empty(); });
+  const auto waited = std::chrono::steady_clock::now() - start;
+  producer.join();
+
+  EXPECT_EQ(value, 7);
+  EXPECT_GE(waiter.stats().parks, 1U);
+  EXPECT_LT(waited, std::chrono::seconds(2));
+}
+
+TEST(WaitStrategyTest, MaxWaitBoundsSleep)
+{
+  WaitConfig cfg{};
+  cfg.policy = WaitPolicy::Sleep;
+  cfg.park_ns = 5'000'000'000ULL;
+  Waiter waiter(cfg);
+
+  const auto start = std::chrono::steady_clock::now();
+  waiter.idle([] { return false; }, 1'000'000); // 1ms deadline, e.g. the next timer
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  EXPECT_EQ(waiter.stats().parks, 1U);
+}
+} // namespace
+} // namespace hft::wait
@@ -0,0 +1,56 @@
+#include "common/work_stealing.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace hft
+{
+namespace
+{
+TEST(WorkStealingTest, RunsEveryJobExactlyOnce)
+{
+  constexpr std::size_t kJobs = 1000;
+  std::vector<std::atomic<int>> runs(kJobs);
+  const ParallelStats st = parallel_for(kJobs, 4,
+                                        [&](std::size_t i, unsigned worker)
+                                        {
+                                          EXPECT_LT(worker, 4U);
+                                          runs[i].fetch_add(1, std::memory_order_relaxed);
+                                        });
+  EXPECT_EQ(st.workers, 4U);
+  for (std::size_t i = 0; i < kJobs; ++i)
+    EXPECT_EQ(runs[i].load(), 1) << "job " << i;
+}
+
+TEST(WorkStealingTest, IdleWorkersStealFromABusyOne)
+{
+  // Worker 0 is dealt the one slow job and many quick ones; the others finish their share and
+  // take the rest of worker 0's deque.
+  std::atomic<int> done{0};
+  std::atomic<bool> release{false};
+  const ParallelStats st = parallel_for(40, 2,
+                                        [&](std::size_t i, unsigned)
+                                        {
+                                          if (i == 38) // dealt to worker 0, which starts here
+                                            while (!release.load(std::memory_order_acquire))
+                                              std::this_thread::yield();
+                                          if (done.fetch_add(1) + 1 == 39)
+                                            release.store(true, std::memory_order_release);
+                                        });
+  EXPECT_EQ(done.load(), 40);
+  EXPECT_GT(st.steals, 0U);
+}
+
+TEST(WorkStealingTest, NeverMoreWorkersThanJobs)
+{
+  int calls = 0;
+  EXPECT_EQ(parallel_for(1, 8, [&](std::size_t, unsigned) { ++calls; }).workers, 1U);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(parallel_for(0, 8, [&](std::size_t, unsigned) { ++calls; }).workers, 1U);
+  EXPECT_EQ(calls, 1);
+}
+} // namespace
+} // namespace hft